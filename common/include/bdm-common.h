@@ -0,0 +1,50 @@
+/*
+# _____     ___ ____     ___ ____
+#  ____|   |    ____|   |        | |____|
+# |     ___|   |____ ___|    ____| |    \    PS2DEV Open Source Project.
+#-----------------------------------------------------------------------
+# Licenced under Academic Free License version 2.0
+# Review ps2sdk README & LICENSE files for further details.
+*/
+
+/**
+ * @file
+ * Common BDM (Block Device Manager) definitions.
+ */
+
+#ifndef __BDM_COMMON_H__
+#define __BDM_COMMON_H__
+
+#include <tamtypes.h>
+
+#define BDM_STATS_NAME_LEN    8
+/** Latency histogram buckets. Bucket 0 counts operations that took less
+ *  than 2us, bucket i those that took [2^i, 2^(i+1)) us, and the last
+ *  bucket everything slower. */
+#define BDM_STATS_LAT_BUCKETS 20
+
+/** I/O statistics of one block device, as seen below the BDM cache.
+ *  Counters start at zero when the device is connected and wrap. */
+typedef struct bdm_stats
+{
+    u64 read_sectors;
+    u64 write_sectors;
+    u64 read_bytes;
+    u64 write_bytes;
+    u32 read_ops;
+    u32 write_ops;
+    u32 read_errors;
+    u32 write_errors;
+    /** Sectors asked for by reads small enough to go through the cache */
+    u32 cache_sectors_read;
+    /** Of those, sectors served without device I/O */
+    u32 cache_sectors_hit;
+    u32 read_lat[BDM_STATS_LAT_BUCKETS];
+    u32 write_lat[BDM_STATS_LAT_BUCKETS];
+    u32 devNr;
+    u32 sectorSize;
+    /** Driver name, e.g. "usb", "ata", "sdc" */
+    char name[BDM_STATS_NAME_LEN];
+} bdm_stats_t;
+
+#endif /* __BDM_COMMON_H__ */
@@ -26,6 +26,7 @@
 #define SMB_DEVCTL_CLOSESHARE        0xC0DE0006
 #define SMB_DEVCTL_ECHO              0xC0DE0007
 #define SMB_DEVCTL_QUERYDISKINFO     0xC0DE0008
+#define SMB_DEVCTL_SETCACHETTL       0xC0DE0009
 
 // helpers for DEVCTL commands
 
@@ -76,6 +77,11 @@ typedef struct
     int FreeUnits;
 } smbQueryDiskInfo_out_t;
 
+typedef struct
+{            // size = 4
+    int ttl; // How long attributes and directory listings are cached, in milliseconds. 0 disables caching.
+} smbSetCacheTTL_in_t;
+
 typedef struct
 { // size = 512
     char ShareName[256];
@@ -99,25 +99,26 @@ typedef union
 #define NULL (void *)0
 #endif
 
+/* The casts go through a pointer-sized integer, so that host builds of 64-bit code do not warn. */
 static inline u8 _lb(u32 addr)
 {
-    return *(vu8 *)addr;
+    return *(vu8 *)(__UINTPTR_TYPE__)addr;
 }
-static inline u16 _lh(u32 addr) { return *(vu16 *)addr; }
-static inline u32 _lw(u32 addr) { return *(vu32 *)addr; }
+static inline u16 _lh(u32 addr) { return *(vu16 *)(__UINTPTR_TYPE__)addr; }
+static inline u32 _lw(u32 addr) { return *(vu32 *)(__UINTPTR_TYPE__)addr; }
 
-static inline void _sb(u8 val, u32 addr) { *(vu8 *)addr = val; }
-static inline void _sh(u16 val, u32 addr) { *(vu16 *)addr = val; }
-static inline void _sw(u32 val, u32 addr) { *(vu32 *)addr = val; }
+static inline void _sb(u8 val, u32 addr) { *(vu8 *)(__UINTPTR_TYPE__)addr = val; }
+static inline void _sh(u16 val, u32 addr) { *(vu16 *)(__UINTPTR_TYPE__)addr = val; }
+static inline void _sw(u32 val, u32 addr) { *(vu32 *)(__UINTPTR_TYPE__)addr = val; }
 
 #ifdef _EE
 static inline u64 _ld(u32 addr)
 {
-    return *(vu64 *)addr;
+    return *(vu64 *)(__UINTPTR_TYPE__)addr;
 }
-static inline u128 _lq(u32 addr) { return *(vu128 *)addr; }
-static inline void _sd(u64 val, u32 addr) { *(vu64 *)addr = val; }
-static inline void _sq(u128 val, u32 addr) { *(vu128 *)addr = val; }
+static inline u128 _lq(u32 addr) { return *(vu128 *)(__UINTPTR_TYPE__)addr; }
+static inline void _sd(u64 val, u32 addr) { *(vu64 *)(__UINTPTR_TYPE__)addr = val; }
+static inline void _sq(u128 val, u32 addr) { *(vu128 *)(__UINTPTR_TYPE__)addr = val; }
 #endif
 
 #endif /* __TAMTYPES_H__ */
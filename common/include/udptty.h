@@ -0,0 +1,40 @@
+/*
+# _____     ___ ____     ___ ____
+#  ____|   |    ____|   |        | |____|
+# |     ___|   |____ ___|    ____| |    \    PS2DEV Open Source Project.
+#-----------------------------------------------------------------------
+# Copyright ps2dev - http://www.ps2dev.org
+# Licenced under Academic Free License version 2.0
+# Review ps2sdk README & LICENSE files for further details.
+*/
+
+/**
+ * @file
+ * UDPTTY wire format and ioctl definitions.
+ */
+
+#ifndef __UDPTTY_H__
+#define __UDPTTY_H__
+
+/** UDP port the console output is broadcast to. */
+#define UDPTTY_PORT 18194
+
+/** In buffered mode ("-b"), every datagram starts with this header,
+ *  followed by console text. Both fields are in network byte order.
+ *  Without "-b", datagrams carry one write's text and no header. */
+typedef struct
+{
+    unsigned int magic;
+    /** Increments by one per datagram, so the receiver can detect drops. */
+    unsigned int seq;
+} udptty_hdr_t;
+
+#define UDPTTY_MAGIC 0x55545459 /* "UTTY" */
+
+/** Largest datagram sent: a 1500-byte Ethernet MTU less IP and UDP headers. */
+#define UDPTTY_MAX_DATAGRAM 1472
+
+/** ioctl on the tty device: send buffered output now. */
+#define UDPTTY_IOCTL_FLUSH 0x5500
+
+#endif /* __UDPTTY_H__ */
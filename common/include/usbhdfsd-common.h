@@ -43,6 +43,9 @@ typedef struct bd_fragment {
 #define USBMASS_DEVCTL_STOP_UNIT 0x0000
 /** Issues the SCSI STOP UNIT command too all devices. Use this to shut down devices properly. */
 #define USBMASS_DEVCTL_STOP_ALL  0x0001
+/** Copies one bdm_stats_t (bdm-common.h) per block device into the output buffer, as many as fit.
+ *  Returns the number of devices connected, which may be more than were copied. BDM drivers only. */
+#define USBMASS_DEVCTL_GET_BDM_STATS 0x0002
 
 // Device status bits.
 /** CONNected */
@@ -188,11 +188,12 @@ int dma_channel_send_chain(int channel, void *data, int data_size, int flags, in
 	// clear channel status
 	*DMA_REG_STAT = DMA_SET_STAT(1 << channel,0,0,0,0,0,0);
 
-	if (flags & DMA_FLAG_INTERRUPTSAFE)
+	// Scratchpad is not cached, and data is only an offset into it.
+	if (!spr && (flags & DMA_FLAG_INTERRUPTSAFE))
 	{
 		iSyncDCache(data, (void *)((u8 *)data + (data_size<<4)));
 	}
-	else
+	else if (!spr)
 	{
 		SyncDCache(data, (void *)((u8 *)data + (data_size<<4)));
 	}
@@ -244,11 +245,12 @@ int dma_channel_send_normal(int channel, void *data, int qwc, int flags, int spr
 	*DMA_REG_STAT = DMA_SET_STAT(1 << channel,0,0,0,0,0,0);
 
 	// Not sure if this should be here.
-	if (flags & DMA_FLAG_INTERRUPTSAFE)
+	// Scratchpad is not cached, and data is only an offset into it.
+	if (!spr && (flags & DMA_FLAG_INTERRUPTSAFE))
 	{
 		iSyncDCache(data, (void *)((u8 *)data + (qwc<<4)));
 	}
-	else
+	else if (!spr)
 	{
 		SyncDCache(data, (void *)((u8 *)data + (qwc<<4)));
 	}
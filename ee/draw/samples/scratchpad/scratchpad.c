@@ -0,0 +1,233 @@
+/*
+# _____     ___ ____     ___ ____
+#  ____|   |    ____|   |        | |____|
+# |     ___|   |____ ___|    ____| |    \    PS2DEV Open Source Project.
+#-----------------------------------------------------------------------
+# Copyright 2001-2004, ps2dev - http://www.ps2dev.org
+# Licenced under Academic Free License version 2.0
+# Review ps2sdk README & LICENSE files for further details.
+#
+*/
+
+// Draws the same sprites from a packet in main memory and streamed
+// through scratchpad, switching every few seconds, and prints how long
+// building and sending them took with each method.
+
+#include <kernel.h>
+#include <stdio.h>
+#include <tamtypes.h>
+#include <timer.h>
+
+#include <packet2.h>
+#include <packet2_spr.h>
+
+#include <dma_tags.h>
+#include <gif_tags.h>
+#include <gs_psm.h>
+
+#include <dma.h>
+
+#include <graph.h>
+
+#include <draw.h>
+#include <draw2d.h>
+
+#define SPRITES 4000
+// draw_rect_filled() adds 3 qwords
+#define SPRITE_QWORDS 3
+// draw_clear() of 640x512 adds a little less, draw_finish() adds 2
+#define CLEAR_QWORDS 32
+#define FINISH_QWORDS 2
+#define FRAMES_PER_METHOD 300
+
+void init_gs(framebuffer_t *frame, zbuffer_t *z)
+{
+
+	// Define a 32-bit 640x512 framebuffer.
+	frame->width = 640;
+	frame->height = 512;
+	frame->mask = 0;
+	frame->psm = GS_PSM_32;
+	frame->address = graph_vram_allocate(frame->width,frame->height, frame->psm, GRAPH_ALIGN_PAGE);
+
+	// Disable the zbuffer.
+	z->enable = DRAW_DISABLE;
+	z->mask = 1;
+	z->method = ZTEST_METHOD_ALLPASS;
+	z->zsm = GS_ZBUF_32;
+	z->address = 0;
+
+	// Initialize the screen and tie the framebuffer to the read circuits.
+	graph_initialize(frame->address,frame->width,frame->height,frame->psm,0,0);
+
+}
+
+void init_drawing_environment(framebuffer_t *frame, zbuffer_t *z)
+{
+
+	packet2_t *packet2 = packet2_create(20, P2_TYPE_NORMAL, P2_MODE_NORMAL, 0);
+
+	// This will setup a default drawing environment.
+	packet2_update(packet2, draw_setup_environment(packet2->next,0,frame,z));
+
+	// Now reset the primitive origin to 2048-width/2,2048-height/2.
+	packet2_update(packet2, draw_primitive_xyoffset(packet2->next,0,(2048-320),(2048-256)));
+
+	// Finish setting up the environment.
+	packet2_update(packet2, draw_finish(packet2->next));
+
+	// Now send the packet, no need to wait since it's the first.
+	dma_channel_send_packet2(packet2, DMA_CHANNEL_GIF, 1);
+	dma_wait_fast();
+
+	packet2_free(packet2);
+
+}
+
+// Fills the rectangle of sprite i for the given frame.
+static void sprite_rect(rect_t *rect, int i, int frame)
+{
+
+	int x = (i * 37 + frame) % 608;
+	int y = (i * 53) % 480;
+
+	rect->v0.x = x;
+	rect->v0.y = y;
+	rect->v0.z = 0;
+	rect->v1.x = x + 32;
+	rect->v1.y = y + 32;
+	rect->v1.z = 0;
+
+	rect->color.r = i & 0xFF;
+	rect->color.g = (i >> 2) & 0xFF;
+	rect->color.b = 0x80;
+	rect->color.a = 0x80;
+	rect->color.q = 1.0f;
+
+}
+
+// Builds the whole frame in main memory, then flushes the cache and sends it.
+static void render_main_ram(packet2_t *packet2, framebuffer_t *frame, int count)
+{
+
+	rect_t rect;
+	int i;
+
+	packet2_reset(packet2, 0);
+
+	packet2_update(packet2, draw_clear(packet2->next,0,2048.0f-320.0f,2048.0f-256.0f,frame->width,frame->height,0x20,0x20,0x20));
+
+	for (i = 0; i < SPRITES; i++)
+	{
+		sprite_rect(&rect, i, count);
+		packet2_update(packet2, draw_rect_filled(packet2->next,0,&rect));
+	}
+
+	packet2_update(packet2, draw_finish(packet2->next));
+
+	dma_channel_send_packet2(packet2, DMA_CHANNEL_GIF, 1);
+	dma_wait_fast();
+
+}
+
+// Builds the frame in scratchpad, one half at a time, while DMA sends the other half.
+static void render_scratchpad(packet2_spr_t *spr, framebuffer_t *frame, int count)
+{
+
+	rect_t rect;
+	int i;
+
+	packet2_spr_reserve(spr, CLEAR_QWORDS);
+	packet2_update(&spr->packet, draw_clear(spr->packet.next,0,2048.0f-320.0f,2048.0f-256.0f,frame->width,frame->height,0x20,0x20,0x20));
+
+	for (i = 0; i < SPRITES; i++)
+	{
+		sprite_rect(&rect, i, count);
+		packet2_spr_reserve(spr, SPRITE_QWORDS);
+		packet2_update(&spr->packet, draw_rect_filled(spr->packet.next,0,&rect));
+	}
+
+	packet2_spr_reserve(spr, FINISH_QWORDS);
+	packet2_update(&spr->packet, draw_finish(spr->packet.next));
+
+	packet2_spr_finish(spr);
+
+}
+
+int render(framebuffer_t *frame)
+{
+
+	packet2_t *packet2;
+	packet2_spr_t spr;
+
+	u32 start, ticks = 0;
+	int count, use_spr = 0;
+
+	// Room for the clear, all sprites and the finish event.
+	packet2 = packet2_create(SPRITES * SPRITE_QWORDS + CLEAR_QWORDS + FINISH_QWORDS, P2_TYPE_NORMAL, P2_MODE_NORMAL, 0);
+
+	// Use the whole scratchpad, 8KB per half.
+	packet2_spr_init(&spr, DMA_CHANNEL_GIF, 0, 0);
+
+	for (count = 1;; count++)
+	{
+
+		start = cpu_ticks();
+
+		if (use_spr)
+			render_scratchpad(&spr, frame, count);
+		else
+			render_main_ram(packet2, frame, count);
+
+		ticks += cpu_ticks() - start;
+
+		if (count % FRAMES_PER_METHOD == 0)
+		{
+			printf("%s: %u cpu cycles per frame\n", use_spr ? "scratchpad" : "main memory", ticks / FRAMES_PER_METHOD);
+			if (use_spr)
+				printf("  %u transfers of %u qwords on average\n", (unsigned int)spr.kicks, (unsigned int)(spr.qwords_sent / spr.kicks));
+
+			ticks = 0;
+			use_spr ^= 1;
+		}
+
+		// Wait for scene to finish drawing
+		draw_wait_finish();
+
+		graph_wait_vsync();
+
+	}
+
+	packet2_free(packet2);
+
+	return 0;
+
+}
+
+int main(int argc, char *argv[])
+{
+
+	// The buffers to be used.
+	framebuffer_t frame;
+	zbuffer_t z;
+
+	// Init GIF dma channel.
+	dma_channel_initialize(DMA_CHANNEL_GIF,NULL,0);
+	dma_channel_fast_waits(DMA_CHANNEL_GIF);
+
+	// Init the GS and framebuffer.
+	init_gs(&frame, &z);
+
+	// Init the drawing environment and framebuffer.
+	init_drawing_environment(&frame,&z);
+
+	// Draw the sprites.
+	render(&frame);
+
+	// Sleep
+	SleepThread();
+
+	// End program.
+	return 0;
+
+}
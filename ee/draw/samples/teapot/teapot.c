@@ -12,8 +12,10 @@
 #include <kernel.h>
 #include <stdlib.h>
 #include <malloc.h>
+#include <math.h>
 #include <tamtypes.h>
 #include <math3d.h>
+#include <math3d_cull.h>
 
 #include <packet.h>
 
@@ -33,10 +35,18 @@
 VECTOR camera_position = { 0.00f, 0.00f, 100.00f, 1.00f };
 VECTOR camera_rotation = { 0.00f, 0.00f,   0.00f, 1.00f };
 
-VECTOR *temp_normals;
-VECTOR *temp_lights;
-VECTOR *temp_colours;
-VECTOR *temp_vertices;
+float *temp_q;
+
+#define TEAPOTS 4
+
+VECTOR teapot_positions[TEAPOTS] = {
+	{  30.00f,   0.00f, 0.00f, 1.00f },
+	{ -30.00f,   0.00f, 0.00f, 1.00f },
+	{   0.00f, -20.00f, 0.00f, 1.00f },
+	{   0.00f,  20.00f, 0.00f, 1.00f }
+};
+
+unsigned char teapot_alphas[TEAPOTS] = { 0x40, 0x40, 0x80, 0x80 };
 
 xyz_t *xyz;
 color_t *rgbaq;
@@ -138,6 +148,24 @@ void flip_buffers(packet_t *flip,framebuffer_t *frame)
 
 }
 
+float mesh_radius(void)
+{
+
+	float radius = 0.0f;
+	float length;
+	int i;
+
+	for (i = 0; i < vertex_count; i++)
+	{
+		length = sqrtf(vertices[i][0] * vertices[i][0] + vertices[i][1] * vertices[i][1] + vertices[i][2] * vertices[i][2]);
+		if (length > radius)
+			radius = length;
+	}
+
+	return radius;
+
+}
+
 qword_t *render_teapot(qword_t *q,MATRIX view_screen, VECTOR object_position, VECTOR object_rotation, prim_t *prim, color_t *color, framebuffer_t *frame, zbuffer_t *z)
 {
 
@@ -171,23 +199,11 @@ qword_t *render_teapot(qword_t *q,MATRIX view_screen, VECTOR object_position, VE
 	// Create the local_screen matrix.
 	create_local_screen(local_screen, local_world, world_view, view_screen);
 
-	// Calculate the normal values.
-	calculate_normals(temp_normals, vertex_count, normals, local_light);
+	// Transform the vertices and convert them to fixed point, centered on the screen.
+	calculate_vertices_xyz((u64*)xyz, 1, temp_q, NULL, vertex_count, vertices, local_screen, 2048, 2048, 32);
 
-	// Calculate the lighting values.
-	calculate_lights(temp_lights, vertex_count, temp_normals, light_direction, light_colour, light_type, light_count);
-
-	// Calculate the colour values after lighting.
-	calculate_colours(temp_colours, vertex_count, colours, temp_lights);
-
-	// Calculate the vertex values.
-	calculate_vertices(temp_vertices, vertex_count, vertices, local_screen);
-
-	// Convert floating point vertices to fixed point and translate to center of screen.
-	draw_convert_xyz(xyz, 2048, 2048, 32, vertex_count, (vertex_f_t*)temp_vertices);
-
-	// Convert floating point colours to fixed point.
-	draw_convert_rgbq(rgbaq, vertex_count, (vertex_f_t*)temp_vertices, (color_f_t*)temp_colours, color->a);
+	// Light the colours and convert them to fixed point.
+	calculate_colours_rgbaq((u64*)rgbaq, 1, temp_q, vertex_count, normals, colours, local_light, light_direction, light_colour, light_type, light_count, color->a);
 
 	// Draw the triangles using triangle primitive type.
 	q = draw_prim_start(q,0,prim,color);
@@ -227,6 +243,15 @@ int render(framebuffer_t *frame, zbuffer_t *z)
 	color_t color;
 
 	MATRIX view_screen;
+	MATRIX world_view;
+	MATRIX world_screen;
+
+	frustum_t frustum;
+	cull_spheres4_t teapot_bounds;
+	int visible[TEAPOTS];
+	int visible_count;
+	float radius;
+	int i;
 
 	packets[0] = packet_init(40000,PACKET_NORMAL);
 	packets[1] = packet_init(40000,PACKET_NORMAL);
@@ -234,7 +259,6 @@ int render(framebuffer_t *frame, zbuffer_t *z)
 	// Uncached accelerated
 	flip_pkt = packet_init(3,PACKET_UCAB);
 
-	VECTOR object_position = { 0.00f, 0.00f, 0.00f, 1.00f };
 	VECTOR object_rotation = { 0.00f, 0.00f, 0.00f, 1.00f };
 
 	// Define the triangle primitive we want to use.
@@ -254,15 +278,17 @@ int render(framebuffer_t *frame, zbuffer_t *z)
 	color.q = 1.0f;
 
 	// Allocate calculation space.
-	temp_normals  = memalign(128, sizeof(VECTOR) * vertex_count);
-	temp_lights   = memalign(128, sizeof(VECTOR) * vertex_count);
-	temp_colours  = memalign(128, sizeof(VECTOR) * vertex_count);
-	temp_vertices = memalign(128, sizeof(VECTOR) * vertex_count);
+	temp_q = memalign(128, sizeof(float) * vertex_count);
 
 	// Allocate register space.
 	xyz   = memalign(128, sizeof(u64) * vertex_count);
 	rgbaq = memalign(128, sizeof(u64) * vertex_count);
 
+	// Bound each teapot with a sphere around its origin, which it spins about.
+	radius = mesh_radius();
+	for (i = 0; i < TEAPOTS; i++)
+		cull_spheres4_set(&teapot_bounds, i, teapot_positions[i], radius);
+
 	// Create the view_screen matrix.
 	create_view_screen(view_screen, graph_aspect_ratio(), -3.00f, 3.00f, -3.00f, 3.00f, 1.00f, 2000.00f);
 
@@ -284,24 +310,18 @@ int render(framebuffer_t *frame, zbuffer_t *z)
 
 		DMATAG_CNT(dmatag,q-dmatag - 1,0,0,0);
 
-		//render teapots
-		color.a = 0x40;
-		object_position[0] = 30.0f;
-		q = render_teapot(q, view_screen, object_position, object_rotation, &prim, &color, frame, z);
-
-		object_position[0] = -30.0f;
-		q = render_teapot(q, view_screen, object_position, object_rotation, &prim, &color, frame, z);
+		// Find the teapots in view, so the others are not transformed at all.
+		create_world_view(world_view, camera_position, camera_rotation);
+		matrix_multiply(world_screen, world_view, view_screen);
+		create_frustum(&frustum, world_screen);
+		visible_count = cull_spheres(visible, &frustum, &teapot_bounds, TEAPOTS);
 
-		color.a = 0x80;
-		object_position[0] = 0.0f;
-		object_position[1] = -20.0f;
-		q = render_teapot(q, view_screen, object_position, object_rotation, &prim, &color, frame, z);
-
-		object_position[1] = 20.0f;
-		q = render_teapot(q, view_screen, object_position, object_rotation, &prim, &color, frame, z);
-
-		object_position[0] = 0.0f;
-		object_position[1] = 0.0f;
+		//render teapots
+		for (i = 0; i < visible_count; i++)
+		{
+			color.a = teapot_alphas[visible[i]];
+			q = render_teapot(q, view_screen, teapot_positions[visible[i]], object_rotation, &prim, &color, frame, z);
+		}
 
 		dmatag = q;
 		q++;
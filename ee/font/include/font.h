@@ -32,6 +32,68 @@ typedef struct {
 	char *font;
 } fontx_t;
 
+/** Glyph of a precomputed string layout */
+typedef struct {
+	/** Font the glyph comes from */
+	fontx_t *font;
+	/** Character code in that font */
+	unsigned short code;
+	/** Size in pixels, the bold column not included */
+	unsigned char width;
+	unsigned char height;
+	/** Position relative to the string's origin, in pixels */
+	float x;
+	float y;
+} fontx_glyph_t;
+
+/** Precomputed string layout, for static text drawn every frame */
+typedef struct {
+	/** Number of glyphs */
+	int count;
+	/** Allocated glyphs */
+	int size;
+	fontx_glyph_t *glyphs;
+} fontx_layout_t;
+
+struct fontatlas_cell;
+
+/** GS glyph atlas.
+ * FontX2 glyphs are rasterized once into a 4-bit texture page and kept there,
+ * the least recently used ones being replaced when the page is full.
+ */
+typedef struct {
+	/** Texture page in vram */
+	int address;
+	/** Page size in pixels */
+	int width;
+	int height;
+	/** 16 colour CLUT in vram */
+	int clut_address;
+	/** Cell size in pixels */
+	int cell_width;
+	int cell_height;
+	/** Cells per row */
+	int columns;
+	/** Number of cells */
+	int cells;
+	struct fontatlas_cell *cell;
+	/** Hash chains of cached glyphs */
+	int *buckets;
+	int bucket_mask;
+	/** Least and most recently used cells */
+	int lru_tail;
+	int lru_head;
+	/** Stamp of the batch being drawn, its cells are not replaced */
+	unsigned int stamp;
+	/** The CLUT must be uploaded */
+	int clut_dirty;
+	/** Layout used by fontatlas_print_ascii() and fontatlas_print_sjis() */
+	fontx_layout_t scratch;
+	/** Glyphs found in the page and glyphs uploaded to it */
+	unsigned int hits;
+	unsigned int uploads;
+} fontatlas_t;
+
 /** FontStudio type fonts */
 typedef struct {
 	char A;
@@ -56,6 +118,24 @@ typedef struct {
 	inidata_t *chardata;
 } fsfont_t;
 
+/** A laid out FontStudio character */
+typedef struct {
+	/** Index into the font's chardata */
+	unsigned short index;
+	/** Position relative to the string's origin, in pixels */
+	float x;
+	float y;
+} fsfont_glyph_t;
+
+/** Precomputed FontStudio string layout, for static text drawn every frame */
+typedef struct {
+	/** Number of glyphs */
+	int count;
+	/** Allocated glyphs */
+	int size;
+	fsfont_glyph_t *glyphs;
+} fsfont_layout_t;
+
 /** Alignments */
 #define LEFT_ALIGN 0
 #define CENTER_ALIGN 1
@@ -85,6 +165,50 @@ extern qword_t *fontx_print_ascii(qword_t *q, int context, const unsigned char *
 /** Prints a SJIS formatted string */
 extern qword_t *fontx_print_sjis(qword_t *q, int context, const unsigned char *str, int alignment, const vertex_t *v0, color_t *c0, fontx_t *ascii, fontx_t *kanji);
 
+// FontX2 layouts and glyph atlas
+
+// README:
+// The atlas draws each string as one list of sprites, uploading missing glyphs
+// first. It sets TEX0 and TEX1 of the context, so set up the texture again
+// before drawing other textured primitives.
+
+/** Lays out an ascii/JISX201 formatted string. Blank characters get no glyph.
+ * The layout must be zeroed before its first use, and can be reused.
+ * Returns the number of glyphs, or -1 if memory allocation fails.
+ */
+extern int fontx_layout_ascii(fontx_layout_t *layout, const unsigned char *str, int alignment, fontx_t *fontx);
+
+/** Lays out a SJIS formatted string, the same way as fontx_layout_ascii() */
+extern int fontx_layout_sjis(fontx_layout_t *layout, const unsigned char *str, int alignment, fontx_t *ascii, fontx_t *kanji);
+
+/** Frees a layout's glyphs */
+extern void fontx_layout_free(fontx_layout_t *layout);
+
+/** Initializes an atlas in a 4-bit texture page and an 8x2 32-bit CLUT in vram.
+ * width and height must be powers of two, width at least 128.
+ * Cells are rounded up to 8x4 pixels and must fit the largest glyph, plus a column for bold fonts.
+ * Returns 0, or -1 if memory allocation fails.
+ */
+extern int fontatlas_init(fontatlas_t *atlas, int address, int width, int height, int clut_address, int cell_width, int cell_height);
+
+/** Frees an atlas */
+extern void fontatlas_free(fontatlas_t *atlas);
+
+/** Forgets the cached glyphs, after the atlas's vram was overwritten */
+extern void fontatlas_invalidate(fontatlas_t *atlas);
+
+/** Largest number of qwords drawing the given number of glyphs can take */
+extern int fontatlas_qwords(fontatlas_t *atlas, int glyphs);
+
+/** Draws a precomputed layout */
+extern qword_t *fontatlas_print_layout(qword_t *q, int context, const fontx_layout_t *layout, const vertex_t *v0, color_t *c0, fontatlas_t *atlas);
+
+/** Prints an ascii/JISX201 formatted string through the atlas */
+extern qword_t *fontatlas_print_ascii(qword_t *q, int context, const unsigned char *str, int alignment, const vertex_t *v0, color_t *c0, fontx_t *fontx, fontatlas_t *atlas);
+
+/** Prints a SJIS formatted string through the atlas */
+extern qword_t *fontatlas_print_sjis(qword_t *q, int context, const unsigned char *str, int alignment, const vertex_t *v0, color_t *c0, fontx_t *ascii, fontx_t *kanji, fontatlas_t *atlas);
+
 // FontStudio type fonts
 
 // README:
@@ -107,6 +231,18 @@ extern void fontstudio_unload_ini(fsfont_t *font);
 /** Prints a unicode formatted string (UTF+8) */
 extern qword_t *fontstudio_print_string(qword_t *q, int context, const unsigned char *string, int alignment, const vertex_t *v0, color_t *c0, fsfont_t *font);
 
+/** Lays out a unicode formatted string (UTF+8) once, so drawing it skips decoding and the charmap search.
+ * The layout must be zeroed before its first use, and can be reused. It is only valid for the font and scale it was made with.
+ * Returns the number of glyphs, or -1 if memory allocation fails.
+ */
+extern int fontstudio_layout_string(fsfont_layout_t *layout, const unsigned char *string, int alignment, fsfont_t *font);
+
+/** Frees a layout's glyphs */
+extern void fontstudio_layout_free(fsfont_layout_t *layout);
+
+/** Draws a precomputed layout, taking 2 qwords per glyph plus the primitive's header */
+extern qword_t *fontstudio_print_layout(qword_t *q, int context, const fsfont_layout_t *layout, const vertex_t *v0, color_t *c0, fsfont_t *font);
+
 #ifdef __cplusplus
 }
 #endif
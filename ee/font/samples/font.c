@@ -23,6 +23,9 @@ fsfont_t impress;
 fontx_t krom_u;
 fontx_t krom_k;
 
+// KROM glyphs are cached in a 4-bit page and drawn as sprites
+fontatlas_t atlas;
+
 void draw_init_env()
 {
 
@@ -73,6 +76,10 @@ void init_texture()
 	q = draw_texture_transfer(q,image_clut32,8,2,GS_PSM_32,clutaddress,64);
 	q = draw_texture_flush(q);
 
+	// Room for 16x15 kanji, plus a column for bold
+	fontatlas_init(&atlas, graph_vram_allocate(256,256,GS_PSM_4, GRAPH_ALIGN_BLOCK), 256, 256,
+				   graph_vram_allocate(8,2,GS_PSM_32, GRAPH_ALIGN_BLOCK), 17, 15);
+
 	dma_channel_send_chain(DMA_CHANNEL_GIF,packet->data, q - packet->data, 0,0);
 	dma_wait_fast();
 
@@ -147,6 +154,13 @@ void run_demo(packet_t *packet)
 	unsigned char str1[] = {0x81, 0xBC, 0x93, 0xF1, 0x93, 0xF1, 0x93, 0xF1, 0x81, 0x69, 0x81, 0x40, 0x81,
 							0x4F, 0x83, 0xD6, 0x81, 0x4F, 0x81, 0x6A, 0x93, 0xF1, 0x81, 0xBD, 0x0D, '\0' };
 
+	// The FontStudio string never changes, so it is laid out once.
+	fsfont_layout_t layout0;
+	memset(&layout0,0,sizeof(layout0));
+
+	impress.scale = 3.0f;
+	fontstudio_layout_string(&layout0,str0,CENTER_ALIGN,&impress);
+
 	while(1)
 	{
 		qword_t *q;
@@ -156,13 +170,13 @@ void run_demo(packet_t *packet)
 
 		q = draw_clear(q,0,0,0,640.0f,448.0f,0x40,0x40,0x40);
 
+		// The atlas sets its own texture, so it draws before the FontStudio texture is set.
+		q = fontatlas_print_sjis(q,0,str1,CENTER_ALIGN,&v0,&c0,&krom_u,&krom_k,&atlas);
+
 		q = draw_texture_sampling(q,0,&lod);
 		q = draw_texturebuffer(q,0,&texbuf,&clut);
 
-		impress.scale = 3.0f;
-
-		q = fontx_print_sjis(q,0,str1,CENTER_ALIGN,&v0,&c0,&krom_u,&krom_k);
-		q = fontstudio_print_string(q,0,str0,CENTER_ALIGN,&v0,&c1,&impress);
+		q = fontstudio_print_layout(q,0,&layout0,&v0,&c1,&impress);
 
 		q = draw_finish(q);
 
@@ -177,6 +191,8 @@ void run_demo(packet_t *packet)
 
 	}
 
+	fontstudio_layout_free(&layout0);
+
 	free(packets[0]);
 	free(packets[1]);
 }
@@ -205,6 +221,8 @@ int main(void)
 
 		fontstudio_unload_ini(&impress);
 
+		fontatlas_free(&atlas);
+
 		fontx_unload(&krom_u);
 		fontx_unload(&krom_k);
 	} else {
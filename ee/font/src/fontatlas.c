@@ -0,0 +1,465 @@
+#include <draw.h>
+#include <draw_buffers.h>
+
+#include <gif_tags.h>
+#include <gs_gp.h>
+#include <gs_psm.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <font.h>
+
+// Largest sprite list a single GIF tag can hold
+#define MAX_BATCH 0x7FFF
+
+// Glyph upload, A+D tag, BITBLTBUF, TRXPOS, TRXREG, TRXDIR and image tag
+#define UPLOAD_QWORDS 6
+// Batch setup, A+D tag, TEXFLUSH, TEX0, TEX1, RGBAQ and sprite tag
+#define BATCH_QWORDS 6
+// CLUT upload, 16 colours in 4 qwords
+#define CLUT_QWORDS (UPLOAD_QWORDS + 4)
+
+struct fontatlas_cell {
+	/** Cached glyph, font is NULL when the cell is free */
+	fontx_t *font;
+	unsigned short code;
+	/** Next cell in the hash chain */
+	int next;
+	/** Neighbours in the LRU list, prev towards the head */
+	int prev;
+	int newer;
+	/** Batch that last used the cell */
+	unsigned int stamp;
+};
+
+extern char *fontx_get_char(fontx_t* fontx, unsigned short c);
+
+static int fontatlas_hash(fontatlas_t *atlas, fontx_t *font, unsigned short code)
+{
+
+	return (((u32)font >> 4) ^ code ^ (code >> 7)) & atlas->bucket_mask;
+
+}
+
+static void fontatlas_unlink(fontatlas_t *atlas, int cell)
+{
+
+	struct fontatlas_cell *c = &atlas->cell[cell];
+
+	if (c->prev >= 0)
+		atlas->cell[c->prev].newer = c->newer;
+	else
+		atlas->lru_tail = c->newer;
+
+	if (c->newer >= 0)
+		atlas->cell[c->newer].prev = c->prev;
+	else
+		atlas->lru_head = c->prev;
+
+}
+
+// Makes the cell the most recently used one
+static void fontatlas_touch(fontatlas_t *atlas, int cell)
+{
+
+	struct fontatlas_cell *c = &atlas->cell[cell];
+
+	c->stamp = atlas->stamp;
+
+	if (atlas->lru_head == cell)
+		return;
+
+	fontatlas_unlink(atlas,cell);
+
+	c->prev = atlas->lru_head;
+	c->newer = -1;
+	atlas->cell[atlas->lru_head].newer = cell;
+	atlas->lru_head = cell;
+
+}
+
+static int fontatlas_find(fontatlas_t *atlas, fontx_t *font, unsigned short code)
+{
+
+	int cell = atlas->buckets[fontatlas_hash(atlas,font,code)];
+
+	while (cell >= 0)
+	{
+
+		if (atlas->cell[cell].font == font && atlas->cell[cell].code == code)
+			return cell;
+
+		cell = atlas->cell[cell].next;
+
+	}
+
+	return -1;
+
+}
+
+// Takes the least recently used cell for a new glyph, unless the current batch uses it
+static int fontatlas_replace(fontatlas_t *atlas, fontx_t *font, unsigned short code)
+{
+
+	int cell = atlas->lru_tail;
+	int *link;
+
+	struct fontatlas_cell *c = &atlas->cell[cell];
+
+	if (c->stamp == atlas->stamp)
+		return -1;
+
+	if (c->font != NULL)
+	{
+
+		link = &atlas->buckets[fontatlas_hash(atlas,c->font,c->code)];
+
+		while (*link != cell)
+			link = &atlas->cell[*link].next;
+
+		*link = c->next;
+
+	}
+
+	link = &atlas->buckets[fontatlas_hash(atlas,font,code)];
+
+	c->font = font;
+	c->code = code;
+	c->next = *link;
+	*link = cell;
+
+	return cell;
+
+}
+
+static qword_t *fontatlas_upload_clut(qword_t *q, fontatlas_t *atlas)
+{
+
+	u32 *clut;
+
+	PACK_GIFTAG(q,GIF_SET_TAG(4,0,0,0,GIF_FLG_PACKED,1),GIF_REG_AD);
+	q++;
+	PACK_GIFTAG(q,GS_SET_BITBLTBUF(0,0,0,atlas->clut_address>>6,1,GS_PSM_32),GS_REG_BITBLTBUF);
+	q++;
+	PACK_GIFTAG(q,GS_SET_TRXPOS(0,0,0,0,0),GS_REG_TRXPOS);
+	q++;
+	PACK_GIFTAG(q,GS_SET_TRXREG(8,2),GS_REG_TRXREG);
+	q++;
+	PACK_GIFTAG(q,GS_SET_TRXDIR(0),GS_REG_TRXDIR);
+	q++;
+	PACK_GIFTAG(q,GIF_SET_TAG(4,0,0,0,GIF_FLG_IMAGE,0),0);
+	q++;
+
+	// Index 0 is transparent, index 1 is white and modulated by the string's colour
+	clut = (u32*)q;
+	memset(clut,0,64);
+	clut[1] = 0x80808080;
+	q += 4;
+
+	atlas->clut_dirty = 0;
+
+	return q;
+
+}
+
+static qword_t *fontatlas_upload(qword_t *q, fontatlas_t *atlas, int cell, const fontx_glyph_t *glyph)
+{
+
+	int i, j;
+	int qwords = (atlas->cell_width * atlas->cell_height) >> 5;
+	int width = glyph->width + (glyph->font->bold ? 1 : 0);
+	int height = glyph->height;
+
+	u8 *pixels;
+	char *row;
+	int bit, prev;
+
+	if (width > atlas->cell_width)
+		width = atlas->cell_width;
+
+	if (height > atlas->cell_height)
+		height = atlas->cell_height;
+
+	PACK_GIFTAG(q,GIF_SET_TAG(4,0,0,0,GIF_FLG_PACKED,1),GIF_REG_AD);
+	q++;
+	PACK_GIFTAG(q,GS_SET_BITBLTBUF(0,0,0,atlas->address>>6,atlas->width>>6,GS_PSM_4),GS_REG_BITBLTBUF);
+	q++;
+	PACK_GIFTAG(q,GS_SET_TRXPOS(0,0,(cell % atlas->columns) * atlas->cell_width,(cell / atlas->columns) * atlas->cell_height,0),GS_REG_TRXPOS);
+	q++;
+	PACK_GIFTAG(q,GS_SET_TRXREG(atlas->cell_width,atlas->cell_height),GS_REG_TRXREG);
+	q++;
+	PACK_GIFTAG(q,GS_SET_TRXDIR(0),GS_REG_TRXDIR);
+	q++;
+	PACK_GIFTAG(q,GIF_SET_TAG(qwords,0,0,0,GIF_FLG_IMAGE,0),0);
+	q++;
+
+	// Rasterize the glyph straight into the packet, two pixels per byte, low nibble first
+	pixels = (u8*)q;
+	memset(pixels,0,qwords << 4);
+
+	row = fontx_get_char(glyph->font,glyph->code);
+
+	for (i = 0; i < height; i++, row += glyph->font->rowsize)
+	{
+
+		prev = 0;
+
+		for (j = 0; j < width; j++)
+		{
+
+			bit = (j < glyph->width) ? (row[j >> 3] >> (7 - (j & 7))) & 1 : 0;
+
+			// Bold also sets the pixel right of a set one
+			if (bit || (glyph->font->bold && prev))
+				pixels[(i * atlas->cell_width + j) >> 1] |= (j & 1) ? 0x10 : 0x01;
+
+			prev = bit;
+
+		}
+
+	}
+
+	q += qwords;
+
+	atlas->uploads++;
+
+	return q;
+
+}
+
+int fontatlas_init(fontatlas_t *atlas, int address, int width, int height, int clut_address, int cell_width, int cell_height)
+{
+
+	int buckets = 1;
+
+	memset(atlas,0,sizeof(fontatlas_t));
+
+	atlas->address = address;
+	atlas->width = width;
+	atlas->height = height;
+	atlas->clut_address = clut_address;
+
+	// 4-bit transfers must be whole qwords, so cells are multiples of 8x4
+	atlas->cell_width = (cell_width + 7) & ~7;
+	atlas->cell_height = (cell_height + 3) & ~3;
+
+	atlas->columns = width / atlas->cell_width;
+	atlas->cells = atlas->columns * (height / atlas->cell_height);
+
+	if (atlas->cells <= 0)
+	{
+
+		printf("Atlas too small for %dx%d cells.\n", atlas->cell_width, atlas->cell_height);
+		return -1;
+
+	}
+
+	while (buckets < atlas->cells)
+		buckets <<= 1;
+
+	atlas->bucket_mask = buckets - 1;
+
+	atlas->cell = (struct fontatlas_cell*)malloc(atlas->cells * sizeof(struct fontatlas_cell));
+	atlas->buckets = (int*)malloc(buckets * sizeof(int));
+
+	if (atlas->cell == NULL || atlas->buckets == NULL)
+	{
+
+		printf("Error allocating memory for %d cells.\n", atlas->cells);
+		fontatlas_free(atlas);
+
+		return -1;
+
+	}
+
+	fontatlas_invalidate(atlas);
+
+	return 0;
+
+}
+
+void fontatlas_free(fontatlas_t *atlas)
+{
+
+	if (atlas->cell != NULL)
+		free(atlas->cell);
+
+	if (atlas->buckets != NULL)
+		free(atlas->buckets);
+
+	atlas->cell = NULL;
+	atlas->buckets = NULL;
+
+	fontx_layout_free(&atlas->scratch);
+
+}
+
+void fontatlas_invalidate(fontatlas_t *atlas)
+{
+
+	int i;
+
+	for (i = 0; i <= atlas->bucket_mask; i++)
+		atlas->buckets[i] = -1;
+
+	// All cells free, in one LRU list from cell 0 at the tail
+	for (i = 0; i < atlas->cells; i++)
+	{
+
+		atlas->cell[i].font = NULL;
+		atlas->cell[i].next = -1;
+		atlas->cell[i].prev = i - 1;
+		atlas->cell[i].newer = (i + 1 < atlas->cells) ? i + 1 : -1;
+		atlas->cell[i].stamp = 0;
+
+	}
+
+	atlas->lru_tail = 0;
+	atlas->lru_head = atlas->cells - 1;
+
+	atlas->stamp = 0;
+	atlas->clut_dirty = 1;
+
+}
+
+int fontatlas_qwords(fontatlas_t *atlas, int glyphs)
+{
+
+	int upload = UPLOAD_QWORDS + ((atlas->cell_width * atlas->cell_height) >> 5);
+
+	// A new batch starts when the page is full of the current batch's glyphs
+	int batches = glyphs / atlas->cells + glyphs / MAX_BATCH + 1;
+
+	return CLUT_QWORDS + batches * BATCH_QWORDS + glyphs * (upload + 2);
+
+}
+
+qword_t *fontatlas_print_layout(qword_t *q, int context, const fontx_layout_t *layout, const vertex_t *v0, color_t *c0, fontatlas_t *atlas)
+{
+
+	int i, j;
+	int start;
+	int cell;
+	int uploads;
+	int width, height;
+	int x, y, u, v;
+
+	const fontx_glyph_t *glyph;
+
+	if (atlas->clut_dirty)
+		q = fontatlas_upload_clut(q,atlas);
+
+	i = 0;
+
+	while (i < layout->count)
+	{
+
+		// Make the glyphs of the batch resident, it ends when the page is full of them
+		atlas->stamp++;
+		start = i;
+		uploads = 0;
+
+		for (; i < layout->count && i - start < MAX_BATCH; i++)
+		{
+
+			glyph = &layout->glyphs[i];
+
+			cell = fontatlas_find(atlas,glyph->font,glyph->code);
+
+			if (cell < 0)
+			{
+
+				cell = fontatlas_replace(atlas,glyph->font,glyph->code);
+
+				if (cell < 0)
+					break;
+
+				q = fontatlas_upload(q,atlas,cell,glyph);
+				uploads++;
+
+			}
+			else if (atlas->cell[cell].stamp != atlas->stamp)
+			{
+
+				atlas->hits++;
+
+			}
+
+			fontatlas_touch(atlas,cell);
+
+		}
+
+		PACK_GIFTAG(q,GIF_SET_TAG(4,0,0,0,GIF_FLG_PACKED,1),GIF_REG_AD);
+		q++;
+		PACK_GIFTAG(q,uploads ? 1 : 0,uploads ? GS_REG_TEXFLUSH : GS_REG_NOP);
+		q++;
+		PACK_GIFTAG(q,GS_SET_TEX0(atlas->address>>6,atlas->width>>6,GS_PSM_4,draw_log2(atlas->width),draw_log2(atlas->height),
+								  TEXTURE_COMPONENTS_RGBA,TEXTURE_FUNCTION_MODULATE,atlas->clut_address>>6,GS_PSM_32,CLUT_STORAGE_MODE1,0,CLUT_LOAD),GS_REG_TEX0 + context);
+		q++;
+		PACK_GIFTAG(q,GS_SET_TEX1(0,0,0,0,0,0,0),GS_REG_TEX1 + context);
+		q++;
+		PACK_GIFTAG(q,c0->rgbaq,GS_REG_RGBAQ);
+		q++;
+
+		// One sprite per glyph, UV and XYZ2 of both corners
+		PACK_GIFTAG(q,GIF_SET_TAG(i - start,0,1,GIF_SET_PRIM(PRIM_SPRITE,0,DRAW_ENABLE,0,DRAW_ENABLE,0,PRIM_MAP_UV,context,0),GIF_FLG_REGLIST,4),
+					GIF_REG_UV | (GIF_REG_XYZ2 << 4) | (GIF_REG_UV << 8) | (GIF_REG_XYZ2 << 12));
+		q++;
+
+		for (j = start; j < i; j++)
+		{
+
+			glyph = &layout->glyphs[j];
+			cell = fontatlas_find(atlas,glyph->font,glyph->code);
+
+			width = glyph->width + (glyph->font->bold ? 1 : 0);
+			height = glyph->height;
+
+			if (width > atlas->cell_width)
+				width = atlas->cell_width;
+
+			if (height > atlas->cell_height)
+				height = atlas->cell_height;
+
+			x = ftoi4(v0->x + glyph->x) + 32768;
+			y = ftoi4(v0->y + glyph->y) + 32768;
+			u = (cell % atlas->columns) * atlas->cell_width;
+			v = (cell / atlas->columns) * atlas->cell_height;
+
+			q->dw[0] = GIF_SET_UV(u << 4,v << 4);
+			q->dw[1] = GIF_SET_XYZ(x,y,v0->z);
+			q++;
+
+			q->dw[0] = GIF_SET_UV((u + width) << 4,(v + height) << 4);
+			q->dw[1] = GIF_SET_XYZ(x + (width << 4),y + (height << 4),v0->z);
+			q++;
+
+		}
+
+	}
+
+	return q;
+
+}
+
+qword_t *fontatlas_print_ascii(qword_t *q, int context, const unsigned char *str, int alignment, const vertex_t *v0, color_t *c0, fontx_t *fontx, fontatlas_t *atlas)
+{
+
+	if (fontx_layout_ascii(&atlas->scratch,str,alignment,fontx) < 0)
+		return q;
+
+	return fontatlas_print_layout(q,context,&atlas->scratch,v0,c0,atlas);
+
+}
+
+qword_t *fontatlas_print_sjis(qword_t *q, int context, const unsigned char *str, int alignment, const vertex_t *v0, color_t *c0, fontx_t *ascii, fontx_t *kanji, fontatlas_t *atlas)
+{
+
+	if (fontx_layout_sjis(&atlas->scratch,str,alignment,ascii,kanji) < 0)
+		return q;
+
+	return fontatlas_print_layout(q,context,&atlas->scratch,v0,c0,atlas);
+
+}
@@ -958,3 +958,202 @@ qword_t *fontx_print_sjis(qword_t *q, int context, const unsigned char *str, int
 	return q;
 
 }
+
+static int fontx_layout_add(fontx_layout_t *layout, fontx_t *fontx, unsigned short c, float x, float y)
+{
+
+	int i;
+	char *char_offset;
+	fontx_glyph_t *glyph;
+	fontx_hdr *fontx_header = (fontx_hdr*)fontx->font;
+
+	char_offset = fontx_get_char(fontx,c);
+
+	if (!char_offset)
+	{
+
+		return 0;
+
+	}
+
+	// Blank characters need no sprite
+	for (i = 0; i < fontx->charsize; i++)
+	{
+
+		if (char_offset[i])
+			break;
+
+	}
+
+	if (i == fontx->charsize)
+	{
+
+		return 0;
+
+	}
+
+	if (layout->count == layout->size)
+	{
+		int size = layout->size ? layout->size * 2 : 32;
+
+		glyph = (fontx_glyph_t*)realloc(layout->glyphs, size * sizeof(fontx_glyph_t));
+
+		if (glyph == NULL)
+		{
+
+			printf("Error allocating %d glyphs.\n", size);
+			return -1;
+
+		}
+
+		layout->glyphs = glyph;
+		layout->size = size;
+
+	}
+
+	glyph = &layout->glyphs[layout->count++];
+
+	glyph->font = fontx;
+	glyph->code = c;
+	glyph->width = fontx_header->width;
+	glyph->height = fontx_header->height;
+	glyph->x = x;
+	glyph->y = y;
+
+	return 0;
+
+}
+
+// Moves the glyphs of a finished line by its alignment
+static void fontx_layout_align(fontx_layout_t *layout, int start, float width, int alignment)
+{
+
+	float offset;
+	int i;
+
+	switch (alignment)
+	{
+		case RIGHT_ALIGN:
+		{
+			offset = -width;
+			break;
+		}
+		case CENTER_ALIGN:
+		{
+			offset = -width / 2.0f;
+			break;
+		}
+		default:
+		{
+			return;
+		}
+	}
+
+	for (i = start; i < layout->count; i++)
+	{
+
+		layout->glyphs[i].x += offset;
+
+	}
+
+}
+
+// kanji is NULL for ascii strings
+static int fontx_layout(fontx_layout_t *layout, const unsigned char *str, int alignment, fontx_t *ascii, fontx_t *kanji)
+{
+
+	int i;
+	int ret = 0;
+	int line_start = 0;
+
+	fontx_t *line_font = kanji ? kanji : ascii;
+
+	fontx_hdr *ascii_header = (fontx_hdr*)ascii->font;
+	fontx_hdr *line_header = (fontx_hdr*)line_font->font;
+
+	float hw = ascii_header->width;
+	float fw = line_header->width;
+	float h = line_header->height;
+
+	float wm = line_font->w_margin;
+	float hm = line_font->h_margin;
+
+	float x = 0.0f;
+	float y = 0.0f;
+
+	layout->count = 0;
+
+	for (i = 0; str[i] != '\0' && ret == 0; i++)
+	{
+
+		if (str[i] == '\n')
+		{
+			fontx_layout_align(layout,line_start,x,alignment);
+			line_start = layout->count;
+			x = 0.0f;
+			y += h + hm;
+		}
+		else if (str[i] == '\t')
+		{
+			x += hw * 5.0f;
+		}
+		else if (str[i] < 0x80 || (str[i] >= 0xA1 && str[i] <= 0xDF))
+		{
+			ret = fontx_layout_add(layout,ascii,str[i],x,y);
+			x += hw + wm;
+		}
+		else if (kanji && str[i+1] != '\0' && ((str[i] >= 0x81 && str[i] <= 0x9F) || (str[i] >= 0xE0 && str[i] <= 0xEF)))
+		{
+			ret = fontx_layout_add(layout,kanji,(str[i] << 8) | str[i+1],x,y);
+			x += fw + wm;
+			i++;
+		}
+		else
+		{
+			x += fw + wm;
+		}
+
+	}
+
+	if (ret < 0)
+	{
+
+		return -1;
+
+	}
+
+	fontx_layout_align(layout,line_start,x,alignment);
+
+	return layout->count;
+
+}
+
+int fontx_layout_ascii(fontx_layout_t *layout, const unsigned char *str, int alignment, fontx_t *fontx)
+{
+
+	return fontx_layout(layout,str,alignment,fontx,NULL);
+
+}
+
+int fontx_layout_sjis(fontx_layout_t *layout, const unsigned char *str, int alignment, fontx_t *ascii, fontx_t *kanji)
+{
+
+	return fontx_layout(layout,str,alignment,ascii,kanji);
+
+}
+
+void fontx_layout_free(fontx_layout_t *layout)
+{
+
+	if (layout->glyphs != NULL)
+	{
+
+		free(layout->glyphs);
+
+	}
+
+	layout->glyphs = NULL;
+	layout->count = 0;
+	layout->size = 0;
+
+}
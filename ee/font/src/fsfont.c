@@ -642,3 +642,185 @@ qword_t *fontstudio_print_string(qword_t *q, int context, const unsigned char *s
 	return q;
 }
 
+
+static int fontstudio_layout_add(fsfont_layout_t *layout, unsigned short index, float x, float y)
+{
+
+	fsfont_glyph_t *glyph;
+
+	if (layout->count == layout->size)
+	{
+		int size = layout->size ? layout->size * 2 : 32;
+
+		glyph = (fsfont_glyph_t*)realloc(layout->glyphs, size * sizeof(fsfont_glyph_t));
+
+		if (glyph == NULL)
+		{
+
+			printf("Error allocating %d glyphs.\n", size);
+			return -1;
+
+		}
+
+		layout->glyphs = glyph;
+		layout->size = size;
+
+	}
+
+	glyph = &layout->glyphs[layout->count++];
+
+	glyph->index = index;
+	glyph->x = x;
+	glyph->y = y;
+
+	return 0;
+
+}
+
+// Moves the glyphs of a finished line by its alignment
+static void fontstudio_layout_align(fsfont_layout_t *layout, int start, float width, int alignment)
+{
+
+	float offset;
+	int i;
+
+	switch (alignment)
+	{
+		case RIGHT_ALIGN:
+		{
+			offset = -width;
+			break;
+		}
+		case CENTER_ALIGN:
+		{
+			offset = -width / 2.0f;
+			break;
+		}
+		default:
+		{
+			return;
+		}
+	}
+
+	for (i = start; i < layout->count; i++)
+	{
+
+		layout->glyphs[i].x += offset;
+
+	}
+
+}
+
+int fontstudio_layout_string(fsfont_layout_t *layout, const unsigned char *str, int alignment, fsfont_t *font)
+{
+
+	int i;
+	int ret = 0;
+	int line_start = 0;
+	int length;
+	unsigned short index;
+
+	float x = 0.0f;
+	float y = 0.0f;
+
+	unsigned short utf8[2048];
+
+	memset(utf8,0,sizeof(short)*2048);
+
+	// Decoding and the charmap search are done once here, instead of per frame
+	length = decode_unicode(str, utf8);
+
+	layout->count = 0;
+
+	for (i = 0; i < length && ret == 0; i++)
+	{
+
+		if (utf8[i] == NEWLINE)
+		{
+			fontstudio_layout_align(layout,line_start,x,alignment);
+			line_start = layout->count;
+			x = 0.0f;
+			y += font->height*font->scale;
+		}
+		else if (utf8[i] == TAB)
+		{
+			x += font->spacewidth*font->scale * 4.0f;
+		}
+		else if (utf8[i] == SPACE)
+		{
+			x += font->spacewidth*font->scale;
+		}
+		else
+		{
+			// Characters missing from the charmap have no chardata to draw
+			index = get_char(utf8[i],font);
+			if (index >= font->totalchars)
+				continue;
+
+			x += font->chardata[index].A*font->scale;
+			ret = fontstudio_layout_add(layout,index,x,y);
+			x += (font->chardata[index].B*font->scale) + (font->chardata[index].C*font->scale);
+		}
+
+	}
+
+	if (ret < 0)
+	{
+
+		return -1;
+
+	}
+
+	fontstudio_layout_align(layout,line_start,x,alignment);
+
+	return layout->count;
+
+}
+
+void fontstudio_layout_free(fsfont_layout_t *layout)
+{
+
+	if (layout->glyphs != NULL)
+	{
+
+		free(layout->glyphs);
+
+	}
+
+	layout->glyphs = NULL;
+	layout->count = 0;
+	layout->size = 0;
+
+}
+
+qword_t *fontstudio_print_layout(qword_t *q, int context, const fsfont_layout_t *layout, const vertex_t *v0, color_t *c0, fsfont_t *font)
+{
+
+	int i;
+
+	vertex_t v_pos = *v0;
+
+	if (!layout->count)
+	{
+
+		return q;
+
+	}
+
+	q = draw_prim_start(q,context,&charprim,c0);
+
+	for (i = 0; i < layout->count; i++)
+	{
+
+		v_pos.x = v0->x + layout->glyphs[i].x;
+		v_pos.y = v0->y + layout->glyphs[i].y;
+
+		q = draw_fontstudio_char(q,layout->glyphs[i].index,&v_pos,font);
+
+	}
+
+	q = draw_prim_end(q,2,DRAW_UV_REGLIST);
+
+	return q;
+
+}
@@ -2292,6 +2292,30 @@ typedef struct
 	GS_GIF_PACKET	*packets;
 }GS_PACKET_TABLE;
 
+/** Packet table that sends itself when full. Two sets of packets are used in turn,
+    so one is filled while the GIF DMA sends the other. */
+typedef struct
+{
+	/** Table being filled */
+	GS_PACKET_TABLE	table;
+	/** Packets of the table being sent, filled next */
+	GS_GIF_PACKET	*spare_packets;
+	/** Send the table once it holds this many qwords, 0 to only send full tables */
+	u32	kick_qwords;
+	/** Tables sent before GsGifAutoKickExecute(), because they were full */
+	u32	kicks;
+	/** Tables sent before GsGifAutoKickExecute(), because they reached kick_qwords */
+	u32	early_kicks;
+	/** Tables sent by GsGifAutoKickExecute() */
+	u32	flushes;
+	/** Sends that had to wait for the previous table to finish transferring */
+	u32	waits;
+	/** Largest table sent, in qwords */
+	u32	peak_qwords;
+	/** Qwords sent in total */
+	u32	total_qwords;
+}GS_AUTOKICK_TABLE;
+
 typedef struct
 {
 	/** X Offset in Vram Address */
@@ -2379,6 +2403,19 @@ extern QWORD *GsGifPacketsAlloc(GS_PACKET_TABLE *table, u32  num_qwords);
 extern void GsGifPacketsClear(GS_PACKET_TABLE *table);
 extern int GsGifPacketsExecute(GS_PACKET_TABLE *table, u16 wait);
 
+/* Auto-kick gif packet tables.
+   Other libgs functions that send on the GIF channel must not be used while a table is transferring:
+   call GsGifAutoKickExecute() with wait set to 1, or GsDrawSync(), first. */
+/** Set up an auto-kick table with 2 x packet_count packets, packet_count for each set */
+extern void GsGifAutoKickInit(GS_AUTOKICK_TABLE *table, GS_GIF_PACKET *packets, u32 packet_count, u32 kick_qwords);
+/** Allocate like GsGifPacketsAlloc(), sending the table and continuing in the other set when it fills up.
+    Returns NULL only if num_qwords does not fit in a single packet. */
+extern QWORD *GsGifAutoKickAlloc(GS_AUTOKICK_TABLE *table, u32 num_qwords);
+/** Send what is left in the table, at the end of a frame */
+extern int GsGifAutoKickExecute(GS_AUTOKICK_TABLE *table, u16 wait);
+/** Clear the fill-level statistics */
+extern void GsGifAutoKickResetStats(GS_AUTOKICK_TABLE *table);
+
 /* Texture/Image Funtions*/
 extern int GsLoadImage(const void *source_addr, GS_IMAGE *dest);
 
@@ -47,39 +47,40 @@ const static GS_RGBAQ randcolor[10] ={	{28 ,200,200,0x80,0.0f},
 
 static short int ScreenOffsetX, ScreenOffsetY;
 
-#define GIF_PACKET_MAX		10
+// One packet per set is enough, the table is sent whenever it fills up.
+#define GIF_PACKET_MAX		1
+// Start sending after this many qwords, so the GIF draws while the rest is built.
+#define GIF_KICK_QWORDS		1000
 
 static GS_DRAWENV		draw_env;
 static GS_DISPENV		disp_env;
 
-static GS_GIF_PACKET		packets[GIF_PACKET_MAX];
-static GS_PACKET_TABLE		giftable;
+static GS_GIF_PACKET		packets[2][GIF_PACKET_MAX]; //the table is filled in one set while the other is sent
+static GS_AUTOKICK_TABLE	giftable;
 
 static int InitGraphics(void);
 static int InitSprites(void);
 static int MoveSprites(void);
-static int DrawSprites(GS_PACKET_TABLE *table);
+static int DrawSprites(GS_AUTOKICK_TABLE *table);
 
 int main(int argc, char *argv[])
 {
 	InitGraphics();
 
-	giftable.packet_count	= GIF_PACKET_MAX;
-	giftable.packets	= packets;
+	GsGifAutoKickInit(&giftable, &packets[0][0], GIF_PACKET_MAX, GIF_KICK_QWORDS);
 
 	InitSprites();
 
 	while(1)
 	{
-		GsGifPacketsClear(&giftable);		// clear the area that we are going to put the sprites/triangles/....
-
 		MoveSprites();
-		DrawSprites(&giftable);			//add stuff to the packet area
 
 		GsDrawSync(0);
 		GsVSync(0);
 		GsClearDrawEnv1(&draw_env);		// clear the draw environment before we draw stuff on it
-		GsGifPacketsExecute(&giftable, 1);	// set to '1' becuse we want to wait for drawing to finish. if we dont wait we will write on packets that is currently writing to the gif
+
+		DrawSprites(&giftable);			//add stuff to the packet area, it is sent as it fills up
+		GsGifAutoKickExecute(&giftable, 1);	// send the rest. set to '1' becuse GsClearDrawEnv1() must not send while the GIF DMA is busy
 	}
 
 	return 0;
@@ -210,7 +211,7 @@ static int MoveSprites(void)
 	return 0;
 }
 
-static int DrawSprites(GS_PACKET_TABLE *table)
+static int DrawSprites(GS_AUTOKICK_TABLE *table)
 {
 	int i;
 	QWORD *p;
@@ -218,7 +219,7 @@ static int DrawSprites(GS_PACKET_TABLE *table)
 	for(i=0;i<MAX_SPRITES;i++)
 	{
 		//Use the uncached segment, to avoid needing to flush the data cache.
-		p = (QWORD*)UNCACHED_SEG(GsGifPacketsAlloc(table, 5)); //Allocate 5 qword for 1 untextured strite
+		p = (QWORD*)UNCACHED_SEG(GsGifAutoKickAlloc(table, 5)); //Allocate 5 qword for 1 untextured strite
 
 		/*	For this GIF packet, the EOP flag is set to 1.
 			Rightfully, it should only be set for only the final packet so that the GIF knows when it can safely switch paths,
@@ -160,3 +160,8 @@ void GsDmaWait(void)
 	while(*((vu32 *)(0x1000a000)) & ((u32)1<<8));
 	asm("":::"memory");
 }
+
+int GsDmaIsBusy(void)
+{
+	return (*((vu32 *)(gif_chcr)) & ((u32)1<<8)) != 0;
+}
@@ -100,3 +100,97 @@ int GsGifPacketsExecute(GS_PACKET_TABLE *table, u16 wait)
 
 	return 0;
 }
+
+void GsGifAutoKickInit(GS_AUTOKICK_TABLE *table, GS_GIF_PACKET *packets, u32 packet_count, u32 kick_qwords)
+{
+	table->table.packet_count	= packet_count;
+	table->table.packets		= packets;
+	table->spare_packets		= packets + packet_count;
+	table->kick_qwords			= kick_qwords;
+
+	GsGifPacketsClear(&table->table);
+	GsGifAutoKickResetStats(table);
+}
+
+static u32 GsGifAutoKickFill(GS_AUTOKICK_TABLE *table)
+{
+	return table->table.packet_offset * GS_PACKET_DATA_QWORD_MAX + table->table.qword_offset;
+}
+
+//sends the table, then swaps to the other set of packets. That set was sent by the previous kick, which is waited for first
+static void GsGifAutoKickSend(GS_AUTOKICK_TABLE *table, u16 wait)
+{
+	GS_GIF_PACKET *packets;
+	u32 fill = GsGifAutoKickFill(table);
+
+	if(GsDmaIsBusy())
+	{
+		table->waits++;
+		GsDmaWait();
+	}
+
+	if(fill > table->peak_qwords)
+		table->peak_qwords = fill;
+	table->total_qwords += fill;
+
+	GsGifPacketsExecute(&table->table, wait);
+
+	packets = table->table.packets;
+	table->table.packets = table->spare_packets;
+	table->spare_packets = packets;
+
+	GsGifPacketsClear(&table->table);
+}
+
+QWORD *GsGifAutoKickAlloc(GS_AUTOKICK_TABLE *table, u32 num_qwords)
+{
+	QWORD *pointer;
+	u32 fill = GsGifAutoKickFill(table);
+
+	//send early, so the GIF starts while the rest is built
+	if(table->kick_qwords != 0 && fill != 0 && fill + num_qwords > table->kick_qwords)
+	{
+		GsGifAutoKickSend(table, 0);
+		table->early_kicks++;
+	}
+
+	pointer = GsGifPacketsAlloc(&table->table, num_qwords);
+
+	if(pointer == NULL && GsGifAutoKickFill(table) != 0)
+	{
+		GsGifAutoKickSend(table, 0);
+		table->kicks++;
+
+		pointer = GsGifPacketsAlloc(&table->table, num_qwords);
+	}
+
+	return pointer;
+}
+
+int GsGifAutoKickExecute(GS_AUTOKICK_TABLE *table, u16 wait)
+{
+	if(table->table.packets == NULL)
+		return -1;
+
+	if(GsGifAutoKickFill(table) != 0)
+	{
+		GsGifAutoKickSend(table, wait);
+		table->flushes++;
+	}
+	else if(wait)
+	{
+		GsDmaWait();
+	}
+
+	return 0;
+}
+
+void GsGifAutoKickResetStats(GS_AUTOKICK_TABLE *table)
+{
+	table->kicks		= 0;
+	table->early_kicks	= 0;
+	table->flushes		= 0;
+	table->waits		= 0;
+	table->peak_qwords	= 0;
+	table->total_qwords	= 0;
+}
@@ -141,9 +141,16 @@ extern void  Vu0TransMatrixXYZ(VU_MATRIX *m,float x, float y, float z);
 extern void  Vu0ScaleMatrix(VU_MATRIX *m, VU_VECTOR *s);
 extern void  Vu0ScaleMatrixXYZ(VU_MATRIX *m, float x, float y, float z);
 extern void  Vu0MulMatrix(VU_MATRIX *m0, VU_MATRIX *m1, VU_MATRIX *out);
-//extern void Vu0InverseMatrix(VU_MATRIX *in, VU_MATRIX *out);
+/** general inverse, gauss-jordan with partial pivoting. in may be out */
+extern void  Vu0InverseMatrix(VU_MATRIX *in, VU_MATRIX *out);
 extern void  Vu0ApplyMatrix(VU_MATRIX *m, VU_VECTOR *v0, VU_VECTOR *out);
 extern void  Vu0ApplyRotMatrix(VU_MATRIX *m, VU_VECTOR *v0, VU_VECTOR *out);
+/** apply m to num vectors, loading the matrix once. v0 may be out */
+extern void  Vu0ApplyMatrixN(VU_MATRIX *m, VU_VECTOR *v0, VU_VECTOR *out, unsigned int num);
+extern void  Vu0ApplyRotMatrixN(VU_MATRIX *m, VU_VECTOR *v0, VU_VECTOR *out, unsigned int num);
+/** same as Vu0ApplyMatrixN, with a VU0 micro program. overwrites VU0 micro and data memory.
+    worth it for large batches, the EE copies the next batch while VU0 transforms */
+extern void  Vu0MicroApplyMatrixN(VU_MATRIX *m, VU_VECTOR *v0, VU_VECTOR *out, unsigned int num);
 extern void  Vu0CopyMatrix(VU_MATRIX *dest, VU_MATRIX *src);
 extern float Vu0DotProduct(VU_VECTOR *v0, VU_VECTOR *v1);
 
@@ -164,6 +171,8 @@ extern void  VuxInverseMatrix(VU_MATRIX *in, VU_MATRIX *mat);
 extern void  VuxCopyMatrix(VU_MATRIX *dest, VU_MATRIX *src);
 extern void  VuxApplyMatrix(VU_MATRIX *m, VU_VECTOR *v0, VU_VECTOR *out);
 extern void  VuxApplyRotMatrix(VU_MATRIX *m, VU_VECTOR *v0, VU_VECTOR *out);
+extern void  VuxApplyMatrixN(VU_MATRIX *m, VU_VECTOR *v0, VU_VECTOR *out, unsigned int num);
+extern void  VuxApplyRotMatrixN(VU_MATRIX *m, VU_VECTOR *v0, VU_VECTOR *out, unsigned int num);
 extern float VuxDotProduct(VU_VECTOR *v0, VU_VECTOR *v1);
 extern VU_VECTOR  VuxCrossProduct(VU_VECTOR *v0, VU_VECTOR *v1);
 extern void  VuxCrossProduct0(VU_VECTOR *v0, VU_VECTOR *v1, VU_VECTOR *out);
@@ -0,0 +1,40 @@
+/*
+# _____     ___ ____     ___ ____
+#  ____|   |    ____|   |        | |____|
+# |     ___|   |____ ___|    ____| |    \    PS2DEV Open Source Project.
+#-----------------------------------------------------------------------
+# Copyright 2001-2005, ps2dev - http://www.ps2dev.org
+# Licenced under Academic Free License version 2.0
+# Review ps2sdk README & LICENSE files for further details.
+#
+# libvux testsuite runner
+*/
+
+#include <stdio.h>
+#include <unistd.h>
+#include "testsuite.h"
+
+extern int vux_add_tests(test_suite *p);
+
+int main(int argc, char *argv[])
+{
+    test_suite suite;
+
+    /* initialize test suite */
+    init_testsuite(&suite);
+
+    /* add all tests to this suite */
+    vux_add_tests(&suite);
+
+    /* run all tests */
+    run_testsuite(&suite);
+
+    /* do some stuff or ps2client will freeze */
+    while (1)
+    {
+        sleep(10);
+        printf("I am alive\n");
+    };
+
+    return 0;
+}
@@ -0,0 +1,286 @@
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include <libvux.h>
+
+#include "testsuite.h"
+
+/* the micro version works in batches of 126 vectors, so 126, 127 and 253
+ * cover one full batch, one batch plus one and both buffers plus one.
+ */
+#define MAX_VECTORS 253
+
+/* VU0 rounds towards zero, so results are compared with a tolerance.
+ * Matrix elements are within [-2, 2] and vector elements within [-100, 100].
+ */
+#define APPLY_EPSILON   2e-3f
+#define INVERSE_EPSILON 1e-4f
+
+typedef void (*applyfunc_t)(VU_MATRIX *m, VU_VECTOR *v0, VU_VECTOR *out, unsigned int num);
+
+typedef struct apply_case_t
+{
+    applyfunc_t func;
+    applyfunc_t ref;
+    unsigned int num;
+    int in_place;
+} apply_case_t;
+
+static VU_VECTOR vectors[MAX_VECTORS + 1];
+static VU_VECTOR results[MAX_VECTORS + 1];
+static VU_VECTOR expected[MAX_VECTORS];
+
+static unsigned int seed = 1;
+
+static float random_float(float range)
+{
+    seed = seed * 1103515245 + 12345;
+    return ((float)((seed >> 8) & 0xFFFF) / 32768.0f - 1.0f) * range;
+}
+
+static void random_matrix(VU_MATRIX *m)
+{
+    int i, j;
+
+    for (i = 0; i < 4; i++)
+    {
+        for (j = 0; j < 4; j++)
+        {
+            m->m[i][j] = random_float(2.0f);
+        }
+    }
+}
+
+static int vector_equal(const VU_VECTOR *a, const VU_VECTOR *b, float epsilon)
+{
+    return fabsf(a->x - b->x) <= epsilon && fabsf(a->y - b->y) <= epsilon &&
+           fabsf(a->z - b->z) <= epsilon && fabsf(a->w - b->w) <= epsilon;
+}
+
+static const char *test_apply(void *arg)
+{
+    const apply_case_t *c = (const apply_case_t *)arg;
+    VU_MATRIX m;
+    VU_VECTOR sentinel;
+    VU_VECTOR *out;
+    unsigned int i;
+
+    random_matrix(&m);
+
+    for (i = 0; i < MAX_VECTORS; i++)
+    {
+        vectors[i].x = random_float(100.0f);
+        vectors[i].y = random_float(100.0f);
+        vectors[i].z = random_float(100.0f);
+        vectors[i].w = random_float(100.0f);
+    }
+
+    c->ref(&m, vectors, expected, c->num);
+
+    sentinel.x = 12345.0f;
+    sentinel.y = -12345.0f;
+    sentinel.z = 0.5f;
+    sentinel.w = -0.5f;
+
+    if (c->in_place)
+    {
+        out = vectors;
+    }
+    else
+    {
+        memset(results, 0, sizeof(results));
+        out = results;
+    }
+    out[c->num] = sentinel;
+
+    c->func(&m, vectors, out, c->num);
+
+    for (i = 0; i < c->num; i++)
+    {
+        if (!vector_equal(&out[i], &expected[i], APPLY_EPSILON))
+        {
+            printf("\nvector %u: (%f %f %f %f), expected (%f %f %f %f)", i,
+                   out[i].x, out[i].y, out[i].z, out[i].w,
+                   expected[i].x, expected[i].y, expected[i].z, expected[i].w);
+            return "transformed vector differs from the Vux version";
+        }
+    }
+
+    if (memcmp(&out[c->num], &sentinel, sizeof(sentinel)) != 0)
+    {
+        return "wrote past the last vector";
+    }
+
+    printf("\nSUCCESS: all checks passed\n");
+    return NULL;
+}
+
+static const char *check_inverse(VU_MATRIX *m)
+{
+    VU_MATRIX inv, product, identity;
+    int i;
+
+    VuxIdMatrix(&identity);
+    Vu0InverseMatrix(m, &inv);
+
+    VuxMulMatrix(m, &inv, &product);
+    for (i = 0; i < 4; i++)
+    {
+        if (!vector_equal((VU_VECTOR *)product.m[i], (VU_VECTOR *)identity.m[i], INVERSE_EPSILON))
+        {
+            return "matrix times inverse is not identity";
+        }
+    }
+
+    VuxMulMatrix(&inv, m, &product);
+    for (i = 0; i < 4; i++)
+    {
+        if (!vector_equal((VU_VECTOR *)product.m[i], (VU_VECTOR *)identity.m[i], INVERSE_EPSILON))
+        {
+            return "inverse times matrix is not identity";
+        }
+    }
+
+    /* in may be out */
+    product = *m;
+    Vu0InverseMatrix(&product, &product);
+    for (i = 0; i < 4; i++)
+    {
+        if (!vector_equal((VU_VECTOR *)product.m[i], (VU_VECTOR *)inv.m[i], INVERSE_EPSILON))
+        {
+            return "in place inverse differs";
+        }
+    }
+
+    return NULL;
+}
+
+static const char *test_inverse(void *arg)
+{
+    VU_MATRIX m = *(VU_MATRIX *)arg;
+    const char *error;
+
+    error = check_inverse(&m);
+    if (error == NULL)
+    {
+        printf("\nSUCCESS: all checks passed\n");
+    }
+
+    return error;
+}
+
+static const char *test_inverse_affine(void *arg)
+{
+    VU_MATRIX m;
+    const char *error;
+
+    VuxRotMatrixXYZ(&m, 0.3f, -1.2f, 2.5f);
+    VuxTransMatrixXYZ(&m, 10.0f, -20.0f, 30.0f);
+
+    error = check_inverse(&m);
+    if (error == NULL)
+    {
+        printf("\nSUCCESS: all checks passed\n");
+    }
+
+    return error;
+}
+
+static apply_case_t apply_cases[] = {
+    {Vu0ApplyMatrixN, VuxApplyMatrixN, 0, 0},
+    {Vu0ApplyMatrixN, VuxApplyMatrixN, 1, 0},
+    {Vu0ApplyMatrixN, VuxApplyMatrixN, 126, 0},
+    {Vu0ApplyMatrixN, VuxApplyMatrixN, 127, 0},
+    {Vu0ApplyMatrixN, VuxApplyMatrixN, 253, 0},
+    {Vu0ApplyMatrixN, VuxApplyMatrixN, 253, 1},
+    {Vu0ApplyRotMatrixN, VuxApplyRotMatrixN, 0, 0},
+    {Vu0ApplyRotMatrixN, VuxApplyRotMatrixN, 1, 0},
+    {Vu0ApplyRotMatrixN, VuxApplyRotMatrixN, 126, 0},
+    {Vu0ApplyRotMatrixN, VuxApplyRotMatrixN, 127, 0},
+    {Vu0ApplyRotMatrixN, VuxApplyRotMatrixN, 253, 0},
+    {Vu0ApplyRotMatrixN, VuxApplyRotMatrixN, 253, 1},
+    {Vu0MicroApplyMatrixN, VuxApplyMatrixN, 0, 0},
+    {Vu0MicroApplyMatrixN, VuxApplyMatrixN, 1, 0},
+    {Vu0MicroApplyMatrixN, VuxApplyMatrixN, 126, 0},
+    {Vu0MicroApplyMatrixN, VuxApplyMatrixN, 127, 0},
+    {Vu0MicroApplyMatrixN, VuxApplyMatrixN, 253, 0},
+    {Vu0MicroApplyMatrixN, VuxApplyMatrixN, 253, 1},
+};
+
+static const char *apply_names[] = {
+    "Vu0ApplyMatrixN num=0",
+    "Vu0ApplyMatrixN num=1",
+    "Vu0ApplyMatrixN num=126",
+    "Vu0ApplyMatrixN num=127",
+    "Vu0ApplyMatrixN num=253",
+    "Vu0ApplyMatrixN num=253 in place",
+    "Vu0ApplyRotMatrixN num=0",
+    "Vu0ApplyRotMatrixN num=1",
+    "Vu0ApplyRotMatrixN num=126",
+    "Vu0ApplyRotMatrixN num=127",
+    "Vu0ApplyRotMatrixN num=253",
+    "Vu0ApplyRotMatrixN num=253 in place",
+    "Vu0MicroApplyMatrixN num=0",
+    "Vu0MicroApplyMatrixN num=1",
+    "Vu0MicroApplyMatrixN num=126",
+    "Vu0MicroApplyMatrixN num=127",
+    "Vu0MicroApplyMatrixN num=253",
+    "Vu0MicroApplyMatrixN num=253 in place",
+};
+
+static VU_MATRIX identity_matrix = {{
+    {1.0f, 0.0f, 0.0f, 0.0f},
+    {0.0f, 1.0f, 0.0f, 0.0f},
+    {0.0f, 0.0f, 1.0f, 0.0f},
+    {0.0f, 0.0f, 0.0f, 1.0f},
+}};
+
+/* 90 degrees around z, the first pivot is zero */
+static VU_MATRIX rot90_matrix = {{
+    {0.0f, 1.0f, 0.0f, 0.0f},
+    {-1.0f, 0.0f, 0.0f, 0.0f},
+    {0.0f, 0.0f, 1.0f, 0.0f},
+    {5.0f, -3.0f, 2.0f, 1.0f},
+}};
+
+/* every pivot needs a row swap */
+static VU_MATRIX reversed_matrix = {{
+    {0.0f, 0.0f, 0.0f, 2.0f},
+    {0.0f, 0.0f, -4.0f, 0.0f},
+    {0.0f, 0.5f, 0.0f, 0.0f},
+    {1.0f, 0.0f, 0.0f, 0.0f},
+}};
+
+/* the first pivot is small but not zero */
+static VU_MATRIX small_pivot_matrix = {{
+    {0.001f, 2.0f, 1.0f, 0.0f},
+    {1.0f, 1.0f, 0.0f, 0.0f},
+    {0.0f, 1.0f, 3.0f, 1.0f},
+    {2.0f, 0.0f, 1.0f, 1.0f},
+}};
+
+/* a projection, w depends on z */
+static VU_MATRIX projection_matrix = {{
+    {1.5f, 0.0f, 0.0f, 0.0f},
+    {0.0f, 2.0f, 0.0f, 0.0f},
+    {0.0f, 0.0f, 1.1f, 1.0f},
+    {0.0f, 0.0f, -2.0f, 0.0f},
+}};
+
+int vux_add_tests(test_suite *p)
+{
+    unsigned int i;
+
+    for (i = 0; i < sizeof(apply_cases) / sizeof(apply_cases[0]); i++)
+    {
+        add_test(p, apply_names[i], test_apply, &apply_cases[i]);
+    }
+
+    add_test(p, "Vu0InverseMatrix identity", test_inverse, &identity_matrix);
+    add_test(p, "Vu0InverseMatrix rotation 90", test_inverse, &rot90_matrix);
+    add_test(p, "Vu0InverseMatrix reversed rows", test_inverse, &reversed_matrix);
+    add_test(p, "Vu0InverseMatrix small pivot", test_inverse, &small_pivot_matrix);
+    add_test(p, "Vu0InverseMatrix projection", test_inverse, &projection_matrix);
+    add_test(p, "Vu0InverseMatrix rotation and translation", test_inverse_affine, NULL);
+    return 0;
+}
@@ -8,8 +8,11 @@
 # Review ps2sdk README & LICENSE files for further details.
 */
 
+#include <tamtypes.h>
 #include <libvux.h>
 
+#include <math.h>
+
 void Vu0IdMatrix(VU_MATRIX *m)
 {
 	Vu0ResetMatrix(m);
@@ -212,10 +215,109 @@ void Vu0MulMatrix(VU_MATRIX *m0, VU_MATRIX *m1, VU_MATRIX *out)
   );
 }
 
+/*
+	one gauss-jordan step: scale the pivot row so its 'f' field is 1,
+	then subtract it from the three other rows. the rows of 'in' are
+	reduced to identity while the same operations turn 'out' into the inverse.
+*/
+#if __GNUC__ > 3
+#define VU0_INVERSE_ROW(f, row) \
+	"lqc2		$vf2, " row "(%0)	\n" \
+	"lqc2		$vf6, " row "(%1)	\n" \
+	"vmul" f ".xyzw	$vf9, $vf1, $vf2" f "	\n" \
+	"vmul" f ".xyzw	$vf10, $vf5, $vf2" f "	\n" \
+	"vsub.xyzw	$vf2, $vf2, $vf9	\n" \
+	"vsub.xyzw	$vf6, $vf6, $vf10	\n" \
+	"sqc2		$vf2, " row "(%0)	\n" \
+	"sqc2		$vf6, " row "(%1)	\n"
+
+#define VU0_INVERSE_STEP(m, inv, f, pivot, row0, row1, row2) \
+	asm __volatile__ ( \
+	"lqc2		$vf1, " pivot "(%0)	\n" \
+	"lqc2		$vf5, " pivot "(%1)	\n" \
+	"vdiv		$Q, $vf0w, $vf1" f "	\n" \
+	"vwaitq				\n" \
+	"vmulq.xyzw	$vf1, $vf1, $Q	\n" \
+	"vmulq.xyzw	$vf5, $vf5, $Q	\n" \
+	"sqc2		$vf1, " pivot "(%0)	\n" \
+	"sqc2		$vf5, " pivot "(%1)	\n" \
+	VU0_INVERSE_ROW(f, row0) \
+	VU0_INVERSE_ROW(f, row1) \
+	VU0_INVERSE_ROW(f, row2) \
+	: : "r" (m), "r" (inv) : "memory" \
+	)
+#else
+#define VU0_INVERSE_ROW(f, row) \
+	"lqc2		vf2, " row "(%0)	\n" \
+	"lqc2		vf6, " row "(%1)	\n" \
+	"vmul" f ".xyzw	vf9, vf1, vf2" f "	\n" \
+	"vmul" f ".xyzw	vf10, vf5, vf2" f "	\n" \
+	"vsub.xyzw	vf2, vf2, vf9	\n" \
+	"vsub.xyzw	vf6, vf6, vf10	\n" \
+	"sqc2		vf2, " row "(%0)	\n" \
+	"sqc2		vf6, " row "(%1)	\n"
+
+#define VU0_INVERSE_STEP(m, inv, f, pivot, row0, row1, row2) \
+	asm __volatile__ ( \
+	"lqc2		vf1, " pivot "(%0)	\n" \
+	"lqc2		vf5, " pivot "(%1)	\n" \
+	"vdiv		Q, vf0w, vf1" f "	\n" \
+	"vwaitq				\n" \
+	"vmulq.xyzw	vf1, vf1, Q	\n" \
+	"vmulq.xyzw	vf5, vf5, Q	\n" \
+	"sqc2		vf1, " pivot "(%0)	\n" \
+	"sqc2		vf5, " pivot "(%1)	\n" \
+	VU0_INVERSE_ROW(f, row0) \
+	VU0_INVERSE_ROW(f, row1) \
+	VU0_INVERSE_ROW(f, row2) \
+	: : "r" (m), "r" (inv) : "memory" \
+	)
+#endif
+
+static void Vu0InversePivot(VU_MATRIX *m, VU_MATRIX *inv, int col)
+{
+	VU_VECTOR	*rows = (VU_VECTOR *)m->m;
+	VU_VECTOR	*inv_rows = (VU_VECTOR *)inv->m;
+	VU_VECTOR	t;
+	float		a, max;
+	int			i, pivot;
+
+	/* partial pivoting, so rotations by 90 degrees and the like don't divide by 0 */
+	pivot = col;
+	max = fabsf(m->m[col][col]);
+	for(i=col+1;i<4;i++)
+	{
+		a = fabsf(m->m[i][col]);
+		if(a > max)
+		{
+			max = a;
+			pivot = i;
+		}
+	}
+
+	if(pivot != col)
+	{
+		t = rows[col];		rows[col] = rows[pivot];			rows[pivot] = t;
+		t = inv_rows[col];	inv_rows[col] = inv_rows[pivot];	inv_rows[pivot] = t;
+	}
+}
+
 void Vu0InverseMatrix(VU_MATRIX *in, VU_MATRIX *out)
 {
-  (void)in;
-  (void)out;
+	VU_MATRIX	m;
+
+	/* in may be out */
+	m = *in;
+	VuxResetMatrix(out);
+
+	Vu0InversePivot(&m, out, 0);
+	VU0_INVERSE_STEP(&m, out, "x", "0x00", "0x10", "0x20", "0x30");
+	Vu0InversePivot(&m, out, 1);
+	VU0_INVERSE_STEP(&m, out, "y", "0x10", "0x00", "0x20", "0x30");
+	Vu0InversePivot(&m, out, 2);
+	VU0_INVERSE_STEP(&m, out, "z", "0x20", "0x00", "0x10", "0x30");
+	Vu0InversePivot(&m, out, 3);
+	VU0_INVERSE_STEP(&m, out, "w", "0x30", "0x00", "0x10", "0x20");
 }
 
 void Vu0ApplyMatrix(VU_MATRIX *m, VU_VECTOR *v0, VU_VECTOR *out)
@@ -291,6 +393,211 @@ void Vu0ApplyRotMatrix(VU_MATRIX *m, VU_VECTOR *v0, VU_VECTOR *out)
 
 }
 
+void Vu0ApplyMatrixN(VU_MATRIX *m, VU_VECTOR *v0, VU_VECTOR *out, unsigned int num)
+{
+	/* same as Vu0ApplyMatrix, the matrix stays in vf16-vf19 for all vectors */
+
+	if(num == 0)
+		return;
+
+	asm __volatile__(
+#if __GNUC__ > 3
+        "lqc2            $vf16,  0x00(%3)  \n"
+        "lqc2            $vf17,  0x10(%3)  \n"
+        "lqc2            $vf18,  0x20(%3)  \n"
+        "lqc2            $vf19,  0x30(%3)  \n"
+        "1:                                \n"
+        "lqc2            $vf20,  0x00(%0)  \n"
+        "addiu           %0, %0, 0x10      \n"
+        "vmulax.xyzw     $ACC,   $vf16,$vf20 \n"
+        "vmadday.xyzw    $ACC,   $vf17,$vf20 \n"
+        "vmaddaz.xyzw    $ACC,   $vf18,$vf20 \n"
+        "vmaddw.xyzw     $vf20,  $vf19,$vf20 \n"
+        "addiu           %2, %2, -1        \n"
+        "sqc2            $vf20,  0x00(%1)  \n"
+        "addiu           %1, %1, 0x10      \n"
+        "bne             $0, %2, 1b        \n"
+        "nop                               \n"
+#else
+        "lqc2            vf16,  0x00(%3)	\n"
+        "lqc2            vf17,  0x10(%3)	\n"
+        "lqc2            vf18,  0x20(%3)	\n"
+        "lqc2            vf19,  0x30(%3)	\n"
+        "1:					\n"
+        "lqc2            vf20,  0x00(%0)	\n"
+        "addiu           %0, %0, 0x10		\n"
+        "vmulax.xyzw     ACC,   vf16,vf20	\n"
+        "vmadday.xyzw    ACC,   vf17,vf20	\n"
+        "vmaddaz.xyzw    ACC,   vf18,vf20	\n"
+        "vmaddw.xyzw     vf20,  vf19,vf20	\n"
+        "addiu           %2, %2, -1		\n"
+        "sqc2            vf20,  0x00(%1)	\n"
+        "addiu           %1, %1, 0x10		\n"
+        "bne             $0, %2, 1b		\n"
+        "nop					\n"
+#endif
+        : "+r"(v0), "+r"(out), "+r"(num) : "r"(m) : "memory"
+    );
+
+}
+
+void Vu0ApplyRotMatrixN(VU_MATRIX *m, VU_VECTOR *v0, VU_VECTOR *out, unsigned int num)
+{
+	/* same as Vu0ApplyRotMatrix, the matrix stays in vf16-vf18 for all vectors */
+
+	if(num == 0)
+		return;
+
+	asm __volatile__(
+#if __GNUC__ > 3
+        "lqc2            $vf16,  0x00(%3)  \n"
+        "lqc2            $vf17,  0x10(%3)  \n"
+        "lqc2            $vf18,  0x20(%3)  \n"
+        "1:                                \n"
+        "lqc2            $vf20,  0x00(%0)  \n"
+        "addiu           %0, %0, 0x10      \n"
+        "vmulax.xyz      $ACC,   $vf16,$vf20 \n"
+        "vmadday.xyz     $ACC,   $vf17,$vf20 \n"
+        "vmaddz.xyz      $vf20,  $vf18,$vf20 \n"
+        "vmulw.w         $vf20,  $vf0, $vf0  \n" // out->w = 1.0f
+        "addiu           %2, %2, -1        \n"
+        "sqc2            $vf20,  0x00(%1)  \n"
+        "addiu           %1, %1, 0x10      \n"
+        "bne             $0, %2, 1b        \n"
+        "nop                               \n"
+#else
+        "lqc2            vf16,  0x00(%3)	\n"
+        "lqc2            vf17,  0x10(%3)	\n"
+        "lqc2            vf18,  0x20(%3)	\n"
+        "1:					\n"
+        "lqc2            vf20,  0x00(%0)	\n"
+        "addiu           %0, %0, 0x10		\n"
+        "vmulax.xyz      ACC,   vf16,vf20	\n"
+        "vmadday.xyz     ACC,   vf17,vf20	\n"
+        "vmaddz.xyz      vf20,  vf18,vf20	\n"
+        "vmulw.w         vf20,  vf0, vf0	\n"	// out->w = 1.0f
+        "addiu           %2, %2, -1		\n"
+        "sqc2            vf20,  0x00(%1)	\n"
+        "addiu           %1, %1, 0x10		\n"
+        "bne             $0, %2, 1b		\n"
+        "nop					\n"
+#endif
+        : "+r"(v0), "+r"(out), "+r"(num) : "r"(m) : "memory"
+    );
+
+}
+
+/*
+	VU0 micro mode. the EE copies a batch into one half of VU0 data memory
+	and copies the next one into the other half while vu0_apply.vsm runs.
+*/
+
+#define VU0_MICRO_MEM		0x11000000
+#define VU0_DATA_MEM		0x11004000
+/* qwords 0-3 hold the matrix, the rest is split in two buffers */
+#define VU0_MICRO_BATCH		126
+
+extern unsigned int Vu0Apply_CodeStart __attribute__((section(".vudata")));
+extern unsigned int Vu0Apply_CodeEnd __attribute__((section(".vudata")));
+
+static void Vu0MicroWait(void)
+{
+	unsigned int stat;
+
+	/* VPU-STAT bit 0, VU0 running */
+	asm __volatile__(
+#if __GNUC__ > 3
+        "1:                                \n"
+        "cfc2            %0, $vi29         \n"
+        "andi            %0, %0, 1         \n"
+        "bne             $0, %0, 1b        \n"
+        "nop                               \n"
+#else
+        "1:					\n"
+        "cfc2            %0, vi29		\n"
+        "andi            %0, %0, 1		\n"
+        "bne             $0, %0, 1b		\n"
+        "nop					\n"
+#endif
+        : "=r"(stat) : : "memory"
+    );
+}
+
+static void Vu0MicroStart(unsigned int addr, unsigned int num)
+{
+	asm __volatile__(
+#if __GNUC__ > 3
+        "sync.l                            \n"
+        "ctc2            %0, $vi1          \n"
+        "ctc2            %1, $vi2          \n"
+        "vcallms         0                 \n"
+#else
+        "sync.l					\n"
+        "ctc2            %0, vi1		\n"
+        "ctc2            %1, vi2		\n"
+        "vcallms         0			\n"
+#endif
+        : : "r"(num), "r"(addr) : "memory"
+    );
+}
+
+static void Vu0MicroCopy(volatile u128 *dest, const u128 *src, unsigned int qwords)
+{
+	unsigned int i;
+
+	for(i=0;i<qwords;i++)
+		dest[i] = src[i];
+}
+
+static void Vu0MicroCopyBack(u128 *dest, volatile const u128 *src, unsigned int qwords)
+{
+	unsigned int i;
+
+	for(i=0;i<qwords;i++)
+		dest[i] = src[i];
+}
+
+void Vu0MicroApplyMatrixN(VU_MATRIX *m, VU_VECTOR *v0, VU_VECTOR *out, unsigned int num)
+{
+	volatile u128	*mem = (volatile u128 *)VU0_DATA_MEM;
+	unsigned int	addr[2] = { 4, 4 + VU0_MICRO_BATCH };
+	unsigned int	cur, n, next_n, done;
+
+	if(num == 0)
+		return;
+
+	Vu0MicroWait();
+	Vu0MicroCopy((volatile u128 *)VU0_MICRO_MEM, (const u128 *)&Vu0Apply_CodeStart,
+		(&Vu0Apply_CodeEnd - &Vu0Apply_CodeStart) / 4);
+	Vu0MicroCopy(mem, (const u128 *)m, 4);
+
+	cur		= 0;
+	done	= 0;
+	n		= num < VU0_MICRO_BATCH ? num : VU0_MICRO_BATCH;
+	Vu0MicroCopy(mem + addr[cur], (const u128 *)v0, n);
+	Vu0MicroStart(addr[cur], n);
+
+	while(done + n < num)
+	{
+		/* fill the other buffer while VU0 works on this one */
+		next_n = num - done - n;
+		if(next_n > VU0_MICRO_BATCH)
+			next_n = VU0_MICRO_BATCH;
+		Vu0MicroCopy(mem + addr[cur ^ 1], (const u128 *)(v0 + done + n), next_n);
+
+		Vu0MicroWait();
+		Vu0MicroStart(addr[cur ^ 1], next_n);
+		Vu0MicroCopyBack((u128 *)(out + done), mem + addr[cur], n);
+
+		done	+= n;
+		n		= next_n;
+		cur		^= 1;
+	}
+
+	Vu0MicroWait();
+	Vu0MicroCopyBack((u128 *)(out + done), mem + addr[cur], n);
+}
+
 void Vu0CopyMatrix(VU_MATRIX *dest, VU_MATRIX *src)
 {
 
@@ -406,6 +406,37 @@ void VuxApplyRotMatrix(VU_MATRIX *m, VU_VECTOR *v0, VU_VECTOR *out)
 
 
 
+void VuxApplyMatrixN(VU_MATRIX *m, VU_VECTOR *v0, VU_VECTOR *out, unsigned int num)
+{
+	VU_VECTOR	v;
+	unsigned int i;
+
+	for(i=0;i<num;i++)
+	{
+		v = v0[i];		// v0 may be out
+		VuxApplyMatrix(m, &v, &out[i]);
+	}
+}
+
+
+
+
+void VuxApplyRotMatrixN(VU_MATRIX *m, VU_VECTOR *v0, VU_VECTOR *out, unsigned int num)
+{
+	VU_VECTOR	v;
+	unsigned int i;
+
+	for(i=0;i<num;i++)
+	{
+		v = v0[i];
+		VuxApplyRotMatrix(m, &v, &out[i]);
+	}
+}
+
+
+
+
+
 float VuxDotProduct(VU_VECTOR *v0, VU_VECTOR *v1)
 {
 
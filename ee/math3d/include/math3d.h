@@ -128,6 +128,43 @@ extern void calculate_colours(VECTOR *output, int count, VECTOR *colours, VECTOR
 /** Calculate vertex values by applying the specific local_screen matrix. */
 extern void calculate_vertices(VECTOR *output, int count, VECTOR *vertices, MATRIX local_screen);
 
+/* BATCH FUNCTIONS */
+
+/* The batch functions process a whole array in one VU0 loop and write
+ * GS register values (the u64 of xyz_t, color_t and texel_t from draw)
+ * every stride u64s. Use a stride of 1 for plain arrays, or the number
+ * of registers in the reglist to write straight into a packet after
+ * draw_prim_start(). */
+
+/** Clip flags, as set by vclipw. */
+#define CLIP_POS_X 0x01
+#define CLIP_NEG_X 0x02
+#define CLIP_POS_Y 0x04
+#define CLIP_NEG_Y 0x08
+#define CLIP_POS_Z 0x10
+#define CLIP_NEG_Z 0x20
+
+/** Transform vertices by local_screen, divide by w and convert to XYZ2 register values.
+ * Does the work of calculate_vertices() followed by draw_convert_xyz() in one pass.
+ * q receives 1/w of each vertex for calculate_colours_rgbaq() and calculate_st(), clip
+ * receives the CLIP_ flags of each vertex. Both may be NULL.
+ * Returns the number of vertices with any clip flag set.
+ */
+extern int calculate_vertices_xyz(u64 *xyz, int stride, float *q, u8 *clip, int count, VECTOR *vertices, MATRIX local_screen, float x, float y, int z);
+
+/** Light vertex colours and convert them to RGBAQ register values.
+ * Does the work of calculate_normals(), calculate_lights(), calculate_colours()
+ * and draw_convert_rgbq() in one pass. local_light must only rotate.
+ * q may be NULL, for a Q of 1.0f.
+ * Returns 0, or -1 if there are more than 3 directional lights.
+ */
+extern int calculate_colours_rgbaq(u64 *rgbaq, int stride, float *q, int count, VECTOR *normals, VECTOR *colours, MATRIX local_light, VECTOR *light_directions, VECTOR *light_colours, const int *light_types, int light_count, unsigned char alpha);
+
+/** Convert texture coordinates to ST register values, applying the perspective with q.
+ * q may be NULL, for a Q of 1.0f.
+ */
+extern void calculate_st(u64 *st, int stride, float *q, int count, VECTOR *coordinates);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,122 @@
+/*
+# _____     ___ ____     ___ ____
+#  ____|   |    ____|   |        | |____|
+# |     ___|   |____ ___|    ____| |    \    PS2DEV Open Source Project.
+#-----------------------------------------------------------------------
+# Copyright 2001-2004, ps2dev - http://www.ps2dev.org
+# Licenced under Academic Free License version 2.0
+# Review ps2sdk README & LICENSE files for further details.
+*/
+
+/**
+ * @file
+ * Frustum culling functions.
+ *
+ * Bounding volumes are tested four at a time on VU0, stored as one
+ * VECTOR per component so each lane holds a different object. A
+ * bounding volume hierarchy built from the same 4-wide groups lets large
+ * static scenes reject whole regions with one test, and produces the
+ * list of visible objects to build the frame's packets from.
+ */
+
+#ifndef __MATH3D_CULL_H__
+#define __MATH3D_CULL_H__
+
+#include <tamtypes.h>
+#include <math3d.h>
+
+/** Frustum planes (a, b, c, d), normalized, a point is inside when a*x + b*y + c*z + d >= 0. */
+typedef struct {
+ VECTOR planes[6];
+ /** (|a|, |b|, |c|, 0) of each plane, for boxes. */
+ VECTOR abs_planes[6];
+} frustum_t;
+
+/** Four spheres, one per lane. */
+typedef struct {
+ VECTOR x, y, z;
+ VECTOR radius;
+} cull_spheres4_t;
+
+/** Four axis aligned boxes, one per lane, as centre and half extents. */
+typedef struct {
+ VECTOR x, y, z;
+ VECTOR ex, ey, ez;
+} cull_boxes4_t;
+
+/** Child that is an object rather than a node, see cull_bvh_node_t. */
+#define CULL_BVH_OBJECT(index) (-2 - (index))
+/** Unused child slot. */
+#define CULL_BVH_EMPTY (-1)
+
+typedef struct {
+ /** Bounds of the four children. */
+ cull_boxes4_t boxes;
+ /** Node index, CULL_BVH_OBJECT() of an object index, or CULL_BVH_EMPTY. */
+ s32 children[4];
+} cull_bvh_node_t;
+
+typedef struct {
+ /** Node 0 is the root. */
+ cull_bvh_node_t *nodes;
+ int node_count;
+ int object_count;
+} cull_bvh_t;
+
+/** Lane i of a 4-wide test touches or is inside the frustum. */
+#define CULL_VISIBLE(i) (0x01 << (i))
+/** Lane i of a 4-wide test is completely inside the frustum, so needs no clipping. */
+#define CULL_INSIDE(i)  (0x10 << (i))
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Create the frustum planes of a world_screen matrix, such as world_view times view_screen.
+ * The planes are in the space the matrix transforms from, so a local_screen matrix gives
+ * planes in that object's local space.
+ */
+extern void create_frustum(frustum_t *frustum, MATRIX world_screen);
+
+/** Set lane i of a group of spheres. Unused lanes need a radius that no distance can make up for,
+ * such as -1e30f: a small negative radius still passes for a centre deep inside the frustum.
+ */
+extern void cull_spheres4_set(cull_spheres4_t *spheres, int i, VECTOR centre, float radius);
+
+/** Set lane i of a group of boxes from its corners. Unused lanes need min and max swapped by a
+ * huge amount, such as min 1e30f and max -1e30f, for the same reason as with spheres.
+ */
+extern void cull_boxes4_set(cull_boxes4_t *boxes, int i, VECTOR min, VECTOR max);
+
+/** Test four spheres against the frustum. Returns CULL_VISIBLE() and CULL_INSIDE() bits. */
+extern int cull_spheres4(frustum_t *frustum, cull_spheres4_t *spheres);
+
+/** Test four boxes against the frustum. Returns CULL_VISIBLE() and CULL_INSIDE() bits. */
+extern int cull_boxes4(frustum_t *frustum, cull_boxes4_t *boxes);
+
+/** Test count spheres, stored in (count + 3) / 4 groups, and write the indices of the visible ones.
+ * Returns the number of visible spheres.
+ */
+extern int cull_spheres(int *visible, frustum_t *frustum, cull_spheres4_t *spheres, int count);
+
+/** Build a bounding volume hierarchy over count static objects, given the corners of their boxes.
+ * Each node holds four children so a node is tested with a single cull_boxes4().
+ * Returns NULL if memory allocation fails.
+ */
+extern cull_bvh_t *cull_bvh_create(VECTOR *mins, VECTOR *maxs, int count);
+
+/** Free a bounding volume hierarchy. */
+extern void cull_bvh_free(cull_bvh_t *bvh);
+
+/** Write the indices of the objects that are visible in the frustum.
+ * Subtrees completely inside are taken without testing their objects.
+ * inside receives, per visible object, 1 if it needs no clipping. It may be NULL.
+ * visible and inside must have room for every object. Returns the number of visible objects.
+ */
+extern int cull_bvh_visible(cull_bvh_t *bvh, frustum_t *frustum, int *visible, u8 *inside);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __MATH3D_CULL_H__ */
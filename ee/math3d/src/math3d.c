@@ -650,3 +650,319 @@ void vector_triangle_normal(VECTOR output, VECTOR a, VECTOR b, VECTOR c) {
    : "$10", "memory"
   );
  }
+
+ /* BATCH FUNCTIONS */
+
+ int calculate_vertices_xyz(u64 *xyz, int stride, float *q, u8 *clip, int count, VECTOR *vertices, MATRIX local_screen, float x, float y, int z) {
+  VECTOR scale;
+  float q_unused;
+  u8 clip_unused;
+  int q_stride = sizeof(float), clip_stride = sizeof(u8);
+  int clipped = 0;
+
+  // A 32-bit z does not fit the signed result of vftoi0, so it is halved and shifted back.
+  int z_shift = (z > 31) ? 1 : 0;
+
+  if (count <= 0) { return 0; }
+
+  // The same conversion as draw_convert_xyz().
+  scale[0] = (float)(int)(x * 16.0f);
+  scale[1] = -(float)(int)(y * 16.0f);
+  scale[2] = (float)((1u << (z - 1)) >> z_shift);
+  scale[3] = 0.00f;
+
+  if (q == NULL) { q = &q_unused; q_stride = 0; }
+  if (clip == NULL) { clip = &clip_unused; clip_stride = 0; }
+
+  stride *= sizeof(u64);
+
+  asm __volatile__ (
+#if __GNUC__ > 3
+   "lqc2		$vf1, 0x00(%6)	\n"
+   "lqc2		$vf2, 0x10(%6)	\n"
+   "lqc2		$vf3, 0x20(%6)	\n"
+   "lqc2		$vf4, 0x30(%6)	\n"
+   "lqc2		$vf5, 0x00(%7)	\n"
+   "lqc2		$vf6, 0x00(%3)	\n"
+   "vmulaw		$ACC, $vf4, $vf0\n"
+   "vmaddax		$ACC, $vf1, $vf6\n"
+   "vmadday		$ACC, $vf2, $vf6\n"
+   "vmaddz		$vf8, $vf3, $vf6\n"
+   "1:					\n"
+   "vclipw.xyz		$vf8, $vf8	\n"
+   "vdiv		$Q, $vf0w, $vf8w\n"
+   "addiu		%4, %4, -1	\n" // Transform the next vertex while dividing.
+   "addiu		$8, %3, 0x10	\n" // The last one is loaded twice.
+   "movn		%3, $8, %4	\n"
+   "lqc2		$vf6, 0x00(%3)	\n"
+   "vmulaw		$ACC, $vf4, $vf0\n"
+   "vmaddax		$ACC, $vf1, $vf6\n"
+   "vmadday		$ACC, $vf2, $vf6\n"
+   "vmaddz		$vf7, $vf3, $vf6\n"
+   "vmulaw.xyz		$ACC, $vf5, $vf0\n"
+   "vwaitq				\n"
+   "vmulq.xyz		$vf9, $vf8, $Q	\n"
+   "vmulq.w		$vf9, $vf0, $Q	\n"
+   "vmadd.xyz		$vf9, $vf9, $vf5\n" // (v / w + 1) * scale
+   "vftoi0.xyz		$vf9, $vf9	\n"
+   "vmove.xyzw		$vf8, $vf7	\n"
+   "cfc2		$9, $18		\n" // Clip flags of this vertex.
+   "andi		$9, $9, 0x3f	\n"
+   "sb			$9, 0x00(%2)	\n"
+   "sltu		$9, $0, $9	\n"
+   "addu		%5, %5, $9	\n"
+   "addu		%2, %2, %10	\n"
+   "qmfc2		$10, $vf9	\n"
+   "pcpyud		$11, $10, $10	\n"
+   "dsrl32		$12, $11, 0	\n"
+   "sllv		$11, $11, %11	\n"
+   "ppach		$10, $0, $10	\n" // x and y to 16 bits...
+   "pextlw		$10, $11, $10	\n" // ...and z above them.
+   "sd			$10, 0x00(%0)	\n"
+   "sw			$12, 0x00(%1)	\n"
+   "addu		%0, %0, %8	\n"
+   "addu		%1, %1, %9	\n"
+   "bne			$0, %4, 1b	\n"
+   "nop					\n"
+#else
+   "lqc2		vf1, 0x00(%6)	\n"
+   "lqc2		vf2, 0x10(%6)	\n"
+   "lqc2		vf3, 0x20(%6)	\n"
+   "lqc2		vf4, 0x30(%6)	\n"
+   "lqc2		vf5, 0x00(%7)	\n"
+   "lqc2		vf6, 0x00(%3)	\n"
+   "vmulaw		ACC, vf4, vf0\n"
+   "vmaddax		ACC, vf1, vf6\n"
+   "vmadday		ACC, vf2, vf6\n"
+   "vmaddz		vf8, vf3, vf6\n"
+   "1:					\n"
+   "vclipw.xyz		vf8, vf8	\n"
+   "vdiv		Q, vf0w, vf8w\n"
+   "addiu		%4, %4, -1	\n" // Transform the next vertex while dividing.
+   "addiu		$8, %3, 0x10	\n" // The last one is loaded twice.
+   "movn		%3, $8, %4	\n"
+   "lqc2		vf6, 0x00(%3)	\n"
+   "vmulaw		ACC, vf4, vf0\n"
+   "vmaddax		ACC, vf1, vf6\n"
+   "vmadday		ACC, vf2, vf6\n"
+   "vmaddz		vf7, vf3, vf6\n"
+   "vmulaw.xyz		ACC, vf5, vf0\n"
+   "vwaitq				\n"
+   "vmulq.xyz		vf9, vf8, Q	\n"
+   "vmulq.w		vf9, vf0, Q	\n"
+   "vmadd.xyz		vf9, vf9, vf5\n" // (v / w + 1) * scale
+   "vftoi0.xyz		vf9, vf9	\n"
+   "vmove.xyzw		vf8, vf7	\n"
+   "cfc2		$9, $18		\n" // Clip flags of this vertex.
+   "andi		$9, $9, 0x3f	\n"
+   "sb			$9, 0x00(%2)	\n"
+   "sltu		$9, $0, $9	\n"
+   "addu		%5, %5, $9	\n"
+   "addu		%2, %2, %10	\n"
+   "qmfc2		$10, vf9	\n"
+   "pcpyud		$11, $10, $10	\n"
+   "dsrl32		$12, $11, 0	\n"
+   "sllv		$11, $11, %11	\n"
+   "ppach		$10, $0, $10	\n" // x and y to 16 bits...
+   "pextlw		$10, $11, $10	\n" // ...and z above them.
+   "sd			$10, 0x00(%0)	\n"
+   "sw			$12, 0x00(%1)	\n"
+   "addu		%0, %0, %8	\n"
+   "addu		%1, %1, %9	\n"
+   "bne			$0, %4, 1b	\n"
+   "nop					\n"
+#endif
+   : "+r" (xyz), "+r" (q), "+r" (clip), "+r" (vertices), "+r" (count), "+r" (clipped)
+   : "r" (local_screen), "r" (scale), "r" (stride), "r" (q_stride), "r" (clip_stride), "r" (z_shift)
+   : "$8", "$9", "$10", "$11", "$12", "memory"
+  );
+
+  return clipped;
+
+ }
+
+ int calculate_colours_rgbaq(u64 *rgbaq, int stride, float *q, int count, VECTOR *normals, VECTOR *colours, MATRIX local_light, VECTOR *light_direction, VECTOR *light_colour, const int *light_type, int light_count, unsigned char alpha) {
+  VECTOR work[9];
+  float q_one = 1.00f;
+  int q_stride = sizeof(float);
+  int loop0, loop1, directional = 0;
+
+  if (count <= 0) { return 0; }
+
+  // Rows 0-3: local_light folded into the directions, one light per component.
+  // Rows 4-6: light colours. Row 7: sum of ambient lights. Row 8: clamp values and alpha.
+  memset(work, 0, sizeof(work));
+
+  for (loop0=0;loop0<light_count;loop0++) {
+
+   if (light_type[loop0] == LIGHT_AMBIENT) {
+
+    for (loop1=0;loop1<3;loop1++) { work[7][loop1] += light_colour[loop0][loop1] * 128.00f; }
+
+   } else if (light_type[loop0] == LIGHT_DIRECTIONAL) {
+
+    // Only three directional lights fit the matrix.
+    if (directional == 3) { return -1; }
+
+    // The intensity is the negated inner product, as in calculate_lights().
+    for (loop1=0;loop1<4;loop1++) {
+     work[loop1][directional] = -((local_light[(loop1 * 4) + 0] * light_direction[loop0][0]) +
+                                  (local_light[(loop1 * 4) + 1] * light_direction[loop0][1]) +
+                                  (local_light[(loop1 * 4) + 2] * light_direction[loop0][2])) / light_direction[loop0][3];
+    }
+
+    for (loop1=0;loop1<3;loop1++) { work[4 + directional][loop1] = light_colour[loop0][loop1] * 128.00f; }
+
+    directional++;
+
+   }
+
+  }
+
+  // The same clamp as calculate_colours().
+  work[8][0] = work[8][1] = work[8][2] = 1.99f * 128.00f;
+  work[8][3] = alpha;
+
+  if (q == NULL) { q = &q_one; q_stride = 0; }
+
+  stride *= sizeof(u64);
+
+  asm __volatile__ (
+#if __GNUC__ > 3
+   "lqc2		$vf1, 0x00(%5)	\n"
+   "lqc2		$vf2, 0x10(%5)	\n"
+   "lqc2		$vf3, 0x20(%5)	\n"
+   "lqc2		$vf4, 0x30(%5)	\n"
+   "lqc2		$vf5, 0x40(%5)	\n"
+   "lqc2		$vf6, 0x50(%5)	\n"
+   "lqc2		$vf7, 0x60(%5)	\n"
+   "lqc2		$vf8, 0x70(%5)	\n"
+   "lqc2		$vf9, 0x80(%5)	\n"
+   "1:					\n"
+   "lqc2		$vf10, 0x00(%2)	\n"
+   "lqc2		$vf11, 0x00(%3)	\n"
+   "vmulaw.xyz		$ACC, $vf4, $vf0\n" // Directional light intensities.
+   "vmaddax.xyz		$ACC, $vf1, $vf10\n"
+   "vmadday.xyz		$ACC, $vf2, $vf10\n"
+   "vmaddz.xyz		$vf12, $vf3, $vf10\n"
+   "lw			$9, 0x00(%1)	\n"
+   "addu		%1, %1, %7	\n"
+   "addiu		%2, %2, 0x10	\n"
+   "addiu		%3, %3, 0x10	\n"
+   "vmax.xyz		$vf12, $vf12, $vf0\n"
+   "vmulaw.xyz		$ACC, $vf8, $vf0\n" // Ambient plus light colours.
+   "vmaddax.xyz		$ACC, $vf5, $vf12\n"
+   "vmadday.xyz		$ACC, $vf6, $vf12\n"
+   "vmaddz.xyz		$vf13, $vf7, $vf12\n"
+   "dsll32		$9, $9, 0	\n"
+   "addiu		%4, %4, -1	\n"
+   "vmul.xyz		$vf13, $vf13, $vf11\n"
+   "vmini.xyz		$vf13, $vf13, $vf9\n"
+   "vmax.xyz		$vf13, $vf13, $vf0\n"
+   "vmove.w		$vf13, $vf9	\n"
+   "vftoi0.xyzw		$vf13, $vf13	\n"
+   "qmfc2		$8, $vf13	\n"
+   "ppach		$8, $0, $8	\n"
+   "ppacb		$8, $0, $8	\n"
+   "or			$8, $8, $9	\n"
+   "sd			$8, 0x00(%0)	\n"
+   "addu		%0, %0, %6	\n"
+   "bne			$0, %4, 1b	\n"
+   "nop					\n"
+#else
+   "lqc2		vf1, 0x00(%5)	\n"
+   "lqc2		vf2, 0x10(%5)	\n"
+   "lqc2		vf3, 0x20(%5)	\n"
+   "lqc2		vf4, 0x30(%5)	\n"
+   "lqc2		vf5, 0x40(%5)	\n"
+   "lqc2		vf6, 0x50(%5)	\n"
+   "lqc2		vf7, 0x60(%5)	\n"
+   "lqc2		vf8, 0x70(%5)	\n"
+   "lqc2		vf9, 0x80(%5)	\n"
+   "1:					\n"
+   "lqc2		vf10, 0x00(%2)	\n"
+   "lqc2		vf11, 0x00(%3)	\n"
+   "vmulaw.xyz		ACC, vf4, vf0\n" // Directional light intensities.
+   "vmaddax.xyz		ACC, vf1, vf10\n"
+   "vmadday.xyz		ACC, vf2, vf10\n"
+   "vmaddz.xyz		vf12, vf3, vf10\n"
+   "lw			$9, 0x00(%1)	\n"
+   "addu		%1, %1, %7	\n"
+   "addiu		%2, %2, 0x10	\n"
+   "addiu		%3, %3, 0x10	\n"
+   "vmax.xyz		vf12, vf12, vf0\n"
+   "vmulaw.xyz		ACC, vf8, vf0\n" // Ambient plus light colours.
+   "vmaddax.xyz		ACC, vf5, vf12\n"
+   "vmadday.xyz		ACC, vf6, vf12\n"
+   "vmaddz.xyz		vf13, vf7, vf12\n"
+   "dsll32		$9, $9, 0	\n"
+   "addiu		%4, %4, -1	\n"
+   "vmul.xyz		vf13, vf13, vf11\n"
+   "vmini.xyz		vf13, vf13, vf9\n"
+   "vmax.xyz		vf13, vf13, vf0\n"
+   "vmove.w		vf13, vf9	\n"
+   "vftoi0.xyzw		vf13, vf13	\n"
+   "qmfc2		$8, vf13	\n"
+   "ppach		$8, $0, $8	\n"
+   "ppacb		$8, $0, $8	\n"
+   "or			$8, $8, $9	\n"
+   "sd			$8, 0x00(%0)	\n"
+   "addu		%0, %0, %6	\n"
+   "bne			$0, %4, 1b	\n"
+   "nop					\n"
+#endif
+   : "+r" (rgbaq), "+r" (q), "+r" (normals), "+r" (colours), "+r" (count)
+   : "r" (work), "r" (stride), "r" (q_stride)
+   : "$8", "$9", "memory"
+  );
+
+  return 0;
+
+ }
+
+ void calculate_st(u64 *st, int stride, float *q, int count, VECTOR *coordinates) {
+  float q_one = 1.00f;
+  int q_stride = sizeof(float);
+
+  if (count <= 0) { return; }
+
+  if (q == NULL) { q = &q_one; q_stride = 0; }
+
+  stride *= sizeof(u64);
+
+  asm __volatile__ (
+#if __GNUC__ > 3
+   "1:					\n"
+   "lqc2		$vf1, 0x00(%2)	\n"
+   "lw			$9, 0x00(%1)	\n"
+   "addiu		%2, %2, 0x10	\n"
+   "addu		%1, %1, %5	\n"
+   "qmtc2		$9, $vf2	\n"
+   "addiu		%3, %3, -1	\n"
+   "vmulx.xy		$vf3, $vf1, $vf2x\n" // Apply the perspective to S and T.
+   "qmfc2		$8, $vf3	\n"
+   "sd			$8, 0x00(%0)	\n"
+   "addu		%0, %0, %4	\n"
+   "bne			$0, %3, 1b	\n"
+   "nop					\n"
+#else
+   "1:					\n"
+   "lqc2		vf1, 0x00(%2)	\n"
+   "lw			$9, 0x00(%1)	\n"
+   "addiu		%2, %2, 0x10	\n"
+   "addu		%1, %1, %5	\n"
+   "qmtc2		$9, vf2		\n"
+   "addiu		%3, %3, -1	\n"
+   "vmulx.xy		vf3, vf1, vf2x	\n" // Apply the perspective to S and T.
+   "qmfc2		$8, vf3		\n"
+   "sd			$8, 0x00(%0)	\n"
+   "addu		%0, %0, %4	\n"
+   "bne			$0, %3, 1b	\n"
+   "nop					\n"
+#endif
+   : "+r" (st), "+r" (q), "+r" (coordinates), "+r" (count)
+   : "r" (stride), "r" (q_stride)
+   : "$8", "$9", "memory"
+  );
+
+ }
@@ -0,0 +1,415 @@
+/*
+# _____     ___ ____     ___ ____
+#  ____|   |    ____|   |        | |____|
+# |     ___|   |____ ___|    ____| |    \    PS2DEV Open Source Project.
+#-----------------------------------------------------------------------
+# Copyright 2001-2004, ps2dev - http://www.ps2dev.org
+# Licenced under Academic Free License version 2.0
+# Review ps2sdk README & LICENSE files for further details.
+*/
+
+ #include <tamtypes.h>
+
+ #include <math3d.h>
+ #include <math3d_cull.h>
+ #include <malloc.h>
+ #include <stdlib.h>
+ #include <math.h>
+
+ // Start of the running minimums, and the extent of unused box lanes.
+ #define CULL_HUGE 1.0e30f
+
+ static VECTOR cull_huge = { CULL_HUGE, CULL_HUGE, CULL_HUGE, CULL_HUGE };
+
+ /* FRUSTUM FUNCTIONS */
+
+ void create_frustum(frustum_t *frustum, MATRIX world_screen) {
+  int loop0, loop1;
+  float length;
+
+  // A point is inside when -w <= x, y, z <= w, so each plane is column w plus or minus column x, y or z.
+  for (loop0=0;loop0<6;loop0++) {
+   float sign = (loop0 & 1) ? -1.00f : 1.00f;
+   int axis = loop0 >> 1;
+
+   for (loop1=0;loop1<4;loop1++) {
+    frustum->planes[loop0][loop1] = world_screen[(loop1 << 2) + 3] + sign * world_screen[(loop1 << 2) + axis];
+   }
+
+   // Normalize, so distances are in the same units as radii and extents.
+   length = sqrtf(frustum->planes[loop0][0] * frustum->planes[loop0][0] +
+                  frustum->planes[loop0][1] * frustum->planes[loop0][1] +
+                  frustum->planes[loop0][2] * frustum->planes[loop0][2]);
+   if (length > 0.00f) {
+    for (loop1=0;loop1<4;loop1++) { frustum->planes[loop0][loop1] /= length; }
+   }
+
+   frustum->abs_planes[loop0][0] = fabsf(frustum->planes[loop0][0]);
+   frustum->abs_planes[loop0][1] = fabsf(frustum->planes[loop0][1]);
+   frustum->abs_planes[loop0][2] = fabsf(frustum->planes[loop0][2]);
+   frustum->abs_planes[loop0][3] = 0.00f;
+  }
+
+ }
+
+ /* 4-WIDE TESTS */
+
+ void cull_spheres4_set(cull_spheres4_t *spheres, int i, VECTOR centre, float radius) {
+  spheres->x[i] = centre[0];
+  spheres->y[i] = centre[1];
+  spheres->z[i] = centre[2];
+  spheres->radius[i] = radius;
+ }
+
+ void cull_boxes4_set(cull_boxes4_t *boxes, int i, VECTOR min, VECTOR max) {
+  boxes->x[i] = (min[0] + max[0]) * 0.50f;
+  boxes->y[i] = (min[1] + max[1]) * 0.50f;
+  boxes->z[i] = (min[2] + max[2]) * 0.50f;
+  boxes->ex[i] = (max[0] - min[0]) * 0.50f;
+  boxes->ey[i] = (max[1] - min[1]) * 0.50f;
+  boxes->ez[i] = (max[2] - min[2]) * 0.50f;
+ }
+
+ // work[0] holds the smallest distance plus radius over the planes, work[1] the smallest distance minus radius.
+ static int cull_mask(VECTOR *work) {
+  int loop0, mask = 0;
+
+  for (loop0=0;loop0<4;loop0++) {
+   if (work[0][loop0] >= 0.00f) { mask |= CULL_VISIBLE(loop0); }
+   if (work[1][loop0] >= 0.00f) { mask |= CULL_INSIDE(loop0); }
+  }
+
+  return mask;
+ }
+
+ int cull_spheres4(frustum_t *frustum, cull_spheres4_t *spheres) {
+  VECTOR work[2];
+  VECTOR *planes = frustum->planes;
+  int count = 6;
+
+  asm __volatile__ (
+#if __GNUC__ > 3
+   "lqc2		$vf1, 0x00(%2)	\n"
+   "lqc2		$vf2, 0x10(%2)	\n"
+   "lqc2		$vf3, 0x20(%2)	\n"
+   "lqc2		$vf4, 0x30(%2)	\n"
+   "lqc2		$vf6, 0x00(%4)	\n"
+   "vmaxw.xyzw		$vf5, $vf0, $vf0\n" // (1, 1, 1, 1), to add d.
+   "vmove.xyzw		$vf7, $vf6	\n"
+   "1:					\n"
+   "lqc2		$vf9, 0x00(%0)	\n"
+   "vmulax.xyzw		$ACC, $vf1, $vf9\n" // Distances of the four centres.
+   "vmadday.xyzw	$ACC, $vf2, $vf9\n"
+   "vmaddaz.xyzw	$ACC, $vf3, $vf9\n"
+   "vmaddw.xyzw		$vf10, $vf5, $vf9\n"
+   "addiu		%1, %1, -1	\n"
+   "addiu		%0, %0, 0x10	\n"
+   "vadd.xyzw		$vf11, $vf10, $vf4\n"
+   "vsub.xyzw		$vf12, $vf10, $vf4\n"
+   "vmini.xyzw		$vf6, $vf6, $vf11\n"
+   "vmini.xyzw		$vf7, $vf7, $vf12\n"
+   "bne			$0, %1, 1b	\n"
+   "nop					\n"
+   "sqc2		$vf6, 0x00(%3)	\n"
+   "sqc2		$vf7, 0x10(%3)	\n"
+#else
+   "lqc2		vf1, 0x00(%2)	\n"
+   "lqc2		vf2, 0x10(%2)	\n"
+   "lqc2		vf3, 0x20(%2)	\n"
+   "lqc2		vf4, 0x30(%2)	\n"
+   "lqc2		vf6, 0x00(%4)	\n"
+   "vmaxw.xyzw		vf5, vf0, vf0	\n" // (1, 1, 1, 1), to add d.
+   "vmove.xyzw		vf7, vf6	\n"
+   "1:					\n"
+   "lqc2		vf9, 0x00(%0)	\n"
+   "vmulax.xyzw		ACC, vf1, vf9	\n" // Distances of the four centres.
+   "vmadday.xyzw	ACC, vf2, vf9	\n"
+   "vmaddaz.xyzw	ACC, vf3, vf9	\n"
+   "vmaddw.xyzw		vf10, vf5, vf9	\n"
+   "addiu		%1, %1, -1	\n"
+   "addiu		%0, %0, 0x10	\n"
+   "vadd.xyzw		vf11, vf10, vf4	\n"
+   "vsub.xyzw		vf12, vf10, vf4	\n"
+   "vmini.xyzw		vf6, vf6, vf11	\n"
+   "vmini.xyzw		vf7, vf7, vf12	\n"
+   "bne			$0, %1, 1b	\n"
+   "nop					\n"
+   "sqc2		vf6, 0x00(%3)	\n"
+   "sqc2		vf7, 0x10(%3)	\n"
+#endif
+   : "+r" (planes), "+r" (count)
+   : "r" (spheres), "r" (work), "r" (cull_huge)
+   : "memory"
+  );
+
+  return cull_mask(work);
+ }
+
+ int cull_boxes4(frustum_t *frustum, cull_boxes4_t *boxes) {
+  VECTOR work[2];
+  VECTOR *planes = frustum->planes;
+  int count = 6;
+
+  // abs_planes follows planes, 0x60 bytes further.
+  asm __volatile__ (
+#if __GNUC__ > 3
+   "lqc2		$vf1, 0x00(%2)	\n"
+   "lqc2		$vf2, 0x10(%2)	\n"
+   "lqc2		$vf3, 0x20(%2)	\n"
+   "lqc2		$vf13, 0x30(%2)	\n"
+   "lqc2		$vf14, 0x40(%2)	\n"
+   "lqc2		$vf15, 0x50(%2)	\n"
+   "lqc2		$vf6, 0x00(%4)	\n"
+   "vmaxw.xyzw		$vf5, $vf0, $vf0\n" // (1, 1, 1, 1), to add d.
+   "vmove.xyzw		$vf7, $vf6	\n"
+   "1:					\n"
+   "lqc2		$vf9, 0x00(%0)	\n"
+   "lqc2		$vf16, 0x60(%0)	\n"
+   "vmulax.xyzw		$ACC, $vf1, $vf9\n" // Distances of the four centres.
+   "vmadday.xyzw	$ACC, $vf2, $vf9\n"
+   "vmaddaz.xyzw	$ACC, $vf3, $vf9\n"
+   "vmaddw.xyzw		$vf10, $vf5, $vf9\n"
+   "vmulax.xyzw		$ACC, $vf13, $vf16\n" // Extents projected on the plane normal.
+   "vmadday.xyzw	$ACC, $vf14, $vf16\n"
+   "vmaddz.xyzw		$vf4, $vf15, $vf16\n"
+   "addiu		%1, %1, -1	\n"
+   "addiu		%0, %0, 0x10	\n"
+   "vadd.xyzw		$vf11, $vf10, $vf4\n"
+   "vsub.xyzw		$vf12, $vf10, $vf4\n"
+   "vmini.xyzw		$vf6, $vf6, $vf11\n"
+   "vmini.xyzw		$vf7, $vf7, $vf12\n"
+   "bne			$0, %1, 1b	\n"
+   "nop					\n"
+   "sqc2		$vf6, 0x00(%3)	\n"
+   "sqc2		$vf7, 0x10(%3)	\n"
+#else
+   "lqc2		vf1, 0x00(%2)	\n"
+   "lqc2		vf2, 0x10(%2)	\n"
+   "lqc2		vf3, 0x20(%2)	\n"
+   "lqc2		vf13, 0x30(%2)	\n"
+   "lqc2		vf14, 0x40(%2)	\n"
+   "lqc2		vf15, 0x50(%2)	\n"
+   "lqc2		vf6, 0x00(%4)	\n"
+   "vmaxw.xyzw		vf5, vf0, vf0	\n" // (1, 1, 1, 1), to add d.
+   "vmove.xyzw		vf7, vf6	\n"
+   "1:					\n"
+   "lqc2		vf9, 0x00(%0)	\n"
+   "lqc2		vf16, 0x60(%0)	\n"
+   "vmulax.xyzw		ACC, vf1, vf9	\n" // Distances of the four centres.
+   "vmadday.xyzw	ACC, vf2, vf9	\n"
+   "vmaddaz.xyzw	ACC, vf3, vf9	\n"
+   "vmaddw.xyzw		vf10, vf5, vf9	\n"
+   "vmulax.xyzw		ACC, vf13, vf16	\n" // Extents projected on the plane normal.
+   "vmadday.xyzw	ACC, vf14, vf16	\n"
+   "vmaddz.xyzw		vf4, vf15, vf16	\n"
+   "addiu		%1, %1, -1	\n"
+   "addiu		%0, %0, 0x10	\n"
+   "vadd.xyzw		vf11, vf10, vf4	\n"
+   "vsub.xyzw		vf12, vf10, vf4	\n"
+   "vmini.xyzw		vf6, vf6, vf11	\n"
+   "vmini.xyzw		vf7, vf7, vf12	\n"
+   "bne			$0, %1, 1b	\n"
+   "nop					\n"
+   "sqc2		vf6, 0x00(%3)	\n"
+   "sqc2		vf7, 0x10(%3)	\n"
+#endif
+   : "+r" (planes), "+r" (count)
+   : "r" (boxes), "r" (work), "r" (cull_huge)
+   : "memory"
+  );
+
+  return cull_mask(work);
+ }
+
+ int cull_spheres(int *visible, frustum_t *frustum, cull_spheres4_t *spheres, int count) {
+  int loop0, loop1, mask;
+  int output = 0;
+
+  for (loop0=0;loop0<count;loop0+=4) {
+   mask = cull_spheres4(frustum, &spheres[loop0 >> 2]);
+   for (loop1=0;loop1<4 && loop0+loop1<count;loop1++) {
+    if (mask & CULL_VISIBLE(loop1)) { visible[output++] = loop0 + loop1; }
+   }
+  }
+
+  return output;
+ }
+
+ /* BOUNDING VOLUME HIERARCHY */
+
+ // Used by the qsort() comparison while building.
+ static VECTOR *sort_mins, *sort_maxs;
+ static int sort_axis;
+
+ static int cull_bvh_compare(const void *a, const void *b) {
+  int i = *(const int *)a, j = *(const int *)b;
+  float ci = sort_mins[i][sort_axis] + sort_maxs[i][sort_axis];
+  float cj = sort_mins[j][sort_axis] + sort_maxs[j][sort_axis];
+
+  return (ci < cj) ? -1 : (ci > cj) ? 1 : 0;
+ }
+
+ // Sorts the objects along the axis their centres spread the most on.
+ static void cull_bvh_sort(int *indices, int count, VECTOR *mins, VECTOR *maxs) {
+  VECTOR low = { CULL_HUGE, CULL_HUGE, CULL_HUGE, 0.00f };
+  VECTOR high = { -CULL_HUGE, -CULL_HUGE, -CULL_HUGE, 0.00f };
+  int loop0, loop1;
+  float centre;
+
+  for (loop0=0;loop0<count;loop0++) {
+   for (loop1=0;loop1<3;loop1++) {
+    centre = mins[indices[loop0]][loop1] + maxs[indices[loop0]][loop1];
+    if (centre < low[loop1]) { low[loop1] = centre; }
+    if (centre > high[loop1]) { high[loop1] = centre; }
+   }
+  }
+
+  sort_axis = 0;
+  for (loop1=1;loop1<3;loop1++) {
+   if (high[loop1] - low[loop1] > high[sort_axis] - low[sort_axis]) { sort_axis = loop1; }
+  }
+
+  sort_mins = mins;
+  sort_maxs = maxs;
+  qsort(indices, count, sizeof(int), cull_bvh_compare);
+ }
+
+ static int cull_bvh_build(cull_bvh_t *bvh, int *indices, int count, VECTOR *mins, VECTOR *maxs) {
+  int node = bvh->node_count++;
+  int starts[5];
+  int loop0, loop1;
+
+  // Up to four objects become the children directly, more are split in two, then in two again.
+  if (count <= 4) {
+   for (loop0=0;loop0<=4;loop0++) { starts[loop0] = (loop0 < count) ? loop0 : count; }
+  } else {
+   int half = count >> 1;
+
+   cull_bvh_sort(indices, count, mins, maxs);
+   cull_bvh_sort(indices, half, mins, maxs);
+   cull_bvh_sort(indices + half, count - half, mins, maxs);
+
+   starts[0] = 0;
+   starts[1] = half >> 1;
+   starts[2] = half;
+   starts[3] = half + ((count - half) >> 1);
+   starts[4] = count;
+  }
+
+  for (loop0=0;loop0<4;loop0++) {
+   VECTOR low = { CULL_HUGE, CULL_HUGE, CULL_HUGE, 0.00f };
+   VECTOR high = { -CULL_HUGE, -CULL_HUGE, -CULL_HUGE, 0.00f };
+   int size = starts[loop0 + 1] - starts[loop0];
+   int child;
+
+   if (size == 0) {
+    bvh->nodes[node].children[loop0] = CULL_BVH_EMPTY;
+    cull_boxes4_set(&bvh->nodes[node].boxes, loop0, low, high);
+    continue;
+   }
+
+   for (loop1=starts[loop0];loop1<starts[loop0 + 1];loop1++) {
+    int object = indices[loop1];
+    int axis;
+    for (axis=0;axis<3;axis++) {
+     if (mins[object][axis] < low[axis]) { low[axis] = mins[object][axis]; }
+     if (maxs[object][axis] > high[axis]) { high[axis] = maxs[object][axis]; }
+    }
+   }
+
+   if (size == 1) {
+    child = CULL_BVH_OBJECT(indices[starts[loop0]]);
+   } else {
+    child = cull_bvh_build(bvh, indices + starts[loop0], size, mins, maxs);
+   }
+
+   bvh->nodes[node].children[loop0] = child;
+   cull_boxes4_set(&bvh->nodes[node].boxes, loop0, low, high);
+  }
+
+  return node;
+ }
+
+ cull_bvh_t *cull_bvh_create(VECTOR *mins, VECTOR *maxs, int count) {
+  cull_bvh_t *bvh;
+  int *indices;
+  int loop0;
+
+  if ((bvh = malloc(sizeof(cull_bvh_t))) == NULL) { return NULL; }
+
+  // Every node but the root has two or more children, so there are fewer nodes than objects.
+  bvh->nodes = memalign(16, sizeof(cull_bvh_node_t) * ((count > 1) ? count - 1 : 1));
+  indices = malloc(sizeof(int) * ((count > 0) ? count : 1));
+
+  if (bvh->nodes == NULL || indices == NULL) {
+   free(indices);
+   free(bvh->nodes);
+   free(bvh);
+   return NULL;
+  }
+
+  for (loop0=0;loop0<count;loop0++) { indices[loop0] = loop0; }
+
+  bvh->node_count = 0;
+  bvh->object_count = count;
+  cull_bvh_build(bvh, indices, count, mins, maxs);
+
+  free(indices);
+
+  return bvh;
+ }
+
+ void cull_bvh_free(cull_bvh_t *bvh) {
+  if (bvh == NULL) { return; }
+
+  free(bvh->nodes);
+  free(bvh);
+ }
+
+ // Takes every object under a child without testing.
+ static int cull_bvh_add_all(cull_bvh_t *bvh, int child, int *visible, u8 *inside, int output) {
+  int loop0;
+
+  if (child == CULL_BVH_EMPTY) { return output; }
+
+  if (child < CULL_BVH_EMPTY) {
+   visible[output] = CULL_BVH_OBJECT(child);
+   if (inside != NULL) { inside[output] = 1; }
+   return output + 1;
+  }
+
+  for (loop0=0;loop0<4;loop0++) {
+   output = cull_bvh_add_all(bvh, bvh->nodes[child].children[loop0], visible, inside, output);
+  }
+
+  return output;
+ }
+
+ static int cull_bvh_visit(cull_bvh_t *bvh, int node, frustum_t *frustum, int *visible, u8 *inside, int output) {
+  int mask = cull_boxes4(frustum, &bvh->nodes[node].boxes);
+  int loop0, child;
+
+  for (loop0=0;loop0<4;loop0++) {
+   child = bvh->nodes[node].children[loop0];
+
+   if (child == CULL_BVH_EMPTY || !(mask & CULL_VISIBLE(loop0))) { continue; }
+
+   if (mask & CULL_INSIDE(loop0)) {
+    output = cull_bvh_add_all(bvh, child, visible, inside, output);
+   } else if (child < CULL_BVH_EMPTY) {
+    visible[output] = CULL_BVH_OBJECT(child);
+    if (inside != NULL) { inside[output] = 0; }
+    output++;
+   } else {
+    output = cull_bvh_visit(bvh, child, frustum, visible, inside, output);
+   }
+  }
+
+  return output;
+ }
+
+ int cull_bvh_visible(cull_bvh_t *bvh, frustum_t *frustum, int *visible, u8 *inside) {
+  if (bvh->object_count == 0) { return 0; }
+
+  return cull_bvh_visit(bvh, 0, frustum, visible, inside, 0);
+ }
@@ -41,6 +41,16 @@
 #define MPEG_VIDEO_FORMAT_MAC       4
 #define MPEG_VIDEO_FORMAT_UNSPEC    5
 
+/* colorspace conversion output, see MPEG_SetOutputFormat */
+#define MPEG_CSC_RGBA32 0
+#define MPEG_CSC_RGBA16 1
+#define MPEG_CSC_DITHER 2
+
+#define MPEG_FRAME_FREE  0
+#define MPEG_FRAME_CSC   1
+#define MPEG_FRAME_READY 2
+#define MPEG_FRAME_SHOWN 3
+
 typedef struct MPEGSequenceInfo {
 	int m_Width;
 	int m_Height;
@@ -53,6 +63,13 @@ typedef struct MPEGSequenceInfo {
 	int m_MSPerFrame;
 } MPEGSequenceInfo;
 
+/* slot of the decoded frame queue, see MPEG_SetFrameQueue */
+typedef struct MPEGFrame {
+	void* m_pData;
+	s64   m_PTS;
+	int   m_State;
+} MPEGFrame;
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -61,6 +78,32 @@ extern void MPEG_Initialize (  int ( * ) ( void* ), void*, void* ( * ) ( void*,
 extern void MPEG_Destroy    ( void );
 extern int  ( *MPEG_Picture ) ( void*, s64* );
 
+/* pixel format of decoded pictures, MPEG_CSC_RGBA32 (GS_PSM_32, default)  */
+/* or MPEG_CSC_RGBA16 (GS_PSM_16), optionally with MPEG_CSC_DITHER         */
+extern void       MPEG_SetOutputFormat ( int                       );
+/* size of one decoded picture in the current output format, in bytes      */
+extern int        MPEG_FrameSize       ( const MPEGSequenceInfo*   );
+
+/* pipelined mode: decoded pictures go to a ring of <aCount> frames (at    */
+/* least 2) whose m_pData each hold MPEG_FrameSize bytes. It's usually set */
+/* up from the sequence init callback. MPEG_DecodeFrame decodes the next   */
+/* picture and starts its colorspace conversion without waiting for it,    */
+/* the conversion runs on the IPU and DMAC while the caller does other     */
+/* work (audio, GS uploads) and is finished at the next decoder call.      */
+/* Returns 1 if a picture was queued, 0 at the end of the stream (as       */
+/* MPEG_Picture) and -1 if the ring is full, in which case frames must be  */
+/* released first. MPEG_Picture must not be called in this mode.          */
+extern void       MPEG_SetFrameQueue   ( MPEGFrame*, int           );
+extern int        MPEG_DecodeFrame     ( void                      );
+/* returns the latest converted frame with m_PTS <= <aClock> (any clock    */
+/* below zero takes the oldest one) or NULL if none is due. Older frames   */
+/* that were never returned are dropped. The frame stays MPEG_FRAME_SHOWN  */
+/* until MPEG_ReleaseFrame, frames are reused in order                     */
+extern MPEGFrame* MPEG_GetFrame        ( s64                       );
+extern void       MPEG_ReleaseFrame    ( MPEGFrame*                );
+/* number of frames dropped by MPEG_GetFrame so far */
+extern int        MPEG_DroppedFrames   ( void                      );
+
 #ifdef __cplusplus
 }
 #endif
@@ -20,6 +20,15 @@
 static _MPEGContext s_MPEG12Ctx;
 static s64*        s_pCurPTS;
 
+static int        s_OutFmt;
+static MPEGFrame* s_pFrames;
+static int        s_nFrames;
+static int        s_FrameHead;
+static int        s_FrameTail;
+static int        s_nDropped;
+static MPEGFrame* s_pCSCFrame;
+static int        s_fQueue;
+
 static void ( *LumaOp[ 8 ] ) ( u8* arg1, u16* arg2, int arg3, int arg4, int var1, int ta ) = {
  _MPEG_put_luma, _MPEG_put_luma_X, _MPEG_put_luma_Y, _MPEG_put_luma_XY,
  _MPEG_avg_luma, _MPEG_avg_luma_X, _MPEG_avg_luma_Y, _MPEG_avg_luma_XY
@@ -71,6 +80,9 @@ static void _ext_pic_tsc ( void );
 static void _xtra_bitinf ( void );
 
 static int _get_next_picture  ( void*, s64* );
+
+static int  _queue_csc    ( void*, s64 );
+static void _queue_update ( void       );
 static int _get_first_picture ( void*, s64* );
 
 int ( *MPEG_Picture ) ( void*, s64* );
@@ -110,12 +122,19 @@ void MPEG_Initialize (
  s_MPEG12Ctx.m_MC[ 1 ].m_pSPRRes = ( void* )0x70002100;
  s_MPEG12Ctx.m_MC[ 1 ].m_pSPRMC  = ( void* )0x70002400;
 
+ s_pFrames  = NULL;
+ s_nFrames  = 0;
+ s_nDropped = 0;
+ s_pCSCFrame = NULL;
+ MPEG_SetOutputFormat ( MPEG_CSC_RGBA32 );
+
  MPEG_Picture = _get_first_picture;
 
 }  /* end MPEG_Initialize */
 
 void MPEG_Destroy ( void ) {
 
+ _MPEG_CSCSync ();
  _destroy_seq  ();
  _MPEG_Destroy ();
 
@@ -171,6 +190,121 @@ static void* _init_seq ( void ) {
 
 }  /* end _init_seq */
 
+void MPEG_SetOutputFormat ( int aFormat ) {
+
+ s_OutFmt = aFormat;
+ _MPEG_SetCSCFormat ( aFormat );
+
+}  /* end MPEG_SetOutputFormat */
+
+int MPEG_FrameSize ( const MPEGSequenceInfo* apInfo ) {
+
+ return apInfo -> m_Width * apInfo -> m_Height * (  ( s_OutFmt & MPEG_CSC_RGBA16 ) ? 2 : 4  );
+
+}  /* end MPEG_FrameSize */
+
+void MPEG_SetFrameQueue ( MPEGFrame* apFrames, int aCount ) {
+
+ int i;
+
+ _MPEG_CSCSync ();
+
+ for ( i = 0; i < aCount; ++i ) apFrames[ i ].m_State = MPEG_FRAME_FREE;
+
+ s_pFrames   = apFrames;
+ s_nFrames   = aCount;
+ s_FrameHead =
+ s_FrameTail = 0;
+ s_pCSCFrame = NULL;
+
+}  /* end MPEG_SetFrameQueue */
+
+static int _queue_csc ( void* apSrc, s64 aPTS ) {
+
+ MPEGFrame* lpFrame = &s_pFrames[ s_FrameHead ];
+
+ lpFrame -> m_PTS   = aPTS;
+ lpFrame -> m_State = MPEG_FRAME_CSC;
+ s_pCSCFrame        = lpFrame;
+
+ if ( ++s_FrameHead == s_nFrames ) s_FrameHead = 0;
+
+ return _MPEG_CSCImageAsync ( apSrc, lpFrame -> m_pData, s_MPEG12Ctx.m_MBCount );
+
+}  /* end _queue_csc */
+
+static void _queue_update ( void ) {
+
+ if ( s_pCSCFrame && !_MPEG_CSCBusy () ) {
+  s_pCSCFrame -> m_State = MPEG_FRAME_READY;
+  s_pCSCFrame = NULL;
+ }  /* end if */
+
+}  /* end _queue_update */
+
+int MPEG_DecodeFrame ( void ) {
+
+ int retVal;
+ s64 lPTS;
+/* the IPU is needed back, and the conversion must not read a reference */
+/* frame that is decoded into next                                      */
+ _MPEG_CSCSync ();
+ _queue_update ();
+
+ if ( s_pFrames && s_pFrames[ s_FrameHead ].m_State != MPEG_FRAME_FREE ) return -1;
+
+ s_fQueue = 1;
+ retVal   = MPEG_Picture ( NULL, &lPTS );
+ s_fQueue = 0;
+
+ return retVal;
+
+}  /* end MPEG_DecodeFrame */
+
+MPEGFrame* MPEG_GetFrame ( s64 aClock ) {
+
+ MPEGFrame* retVal = NULL;
+
+ _queue_update ();
+
+/* frames from the tail on are queued in display order, up to the head */
+ while ( s_pFrames ) {
+
+  MPEGFrame* lpFrame = &s_pFrames[ s_FrameTail ];
+
+  if ( lpFrame -> m_State != MPEG_FRAME_READY ) break;
+  if ( aClock >= 0 && lpFrame -> m_PTS > aClock ) break;
+
+  if ( retVal ) {
+   retVal -> m_State = MPEG_FRAME_FREE;
+   ++s_nDropped;
+  }  /* end if */
+
+  retVal = lpFrame;
+  if ( ++s_FrameTail == s_nFrames ) s_FrameTail = 0;
+
+  if ( aClock < 0 ) break;
+
+ }  /* end while */
+
+ if ( retVal ) retVal -> m_State = MPEG_FRAME_SHOWN;
+
+ return retVal;
+
+}  /* end MPEG_GetFrame */
+
+void MPEG_ReleaseFrame ( MPEGFrame* apFrame ) {
+
+ apFrame -> m_State = MPEG_FRAME_FREE;
+
+}  /* end MPEG_ReleaseFrame */
+
+int MPEG_DroppedFrames ( void ) {
+
+ return s_nDropped;
+
+}  /* end MPEG_DroppedFrames */
+
 static void _destroy_seq ( void ) {
 
  MPEG_Picture = _get_first_picture;
@@ -616,7 +750,9 @@ static int _get_next_picture ( void* apData, s64* apPTS ) {
      *apPTS = s_MPEG12Ctx.m_FwdPTS;
     }  /* end else */
 
-    lfPic = _MPEG_CSCImage ( lpData, apData, s_MPEG12Ctx.m_MBCount );
+    if ( s_fQueue && s_pFrames )
+     lfPic = _queue_csc ( lpData, *apPTS );
+    else lfPic = _MPEG_CSCImage ( lpData, apData, s_MPEG12Ctx.m_MBCount );
 
    }  /* end if */
 
@@ -26,9 +26,14 @@ static void * s_SetDMA_arg;
 static u32 s_IPUState[8];
 static int* s_pEOF;
 static int s_Sema;
-static u32 s_CSCParam[3];
+// source, destination, macroblocks left, destination qwords per macroblock, CSC command
+static u32 s_CSCParam[5];
 static int s_CSCID;
-static u8 s_CSCFlag;
+static volatile u8 s_CSCFlag;
+// a CSC was started and the IPU is still suspended for it
+static u8 s_CSCPending;
+static u32 s_CSCCmd = 0x70000000;
+static u32 s_CSCQWC = 0x40;
 
 extern s32 _mpeg_dmac_handler( s32 channel, void *arg, void *addr );
 
@@ -61,7 +66,7 @@ void _MPEG_Initialize ( _MPEGContext* arg0, int ( * arg1) ( void* ), void* arg2,
 
 void _MPEG_Destroy ( void )
 {
-	while (s_CSCFlag != 0);
+	_MPEG_CSCSync();
 	RemoveDmacHandler(3, s_CSCID);
 	DeleteSema(s_Sema);
 }
@@ -104,7 +109,7 @@ void _ipu_suspend ( void )
 
 void _MPEG_Suspend ( void )
 {
-	while (s_CSCFlag != 0);
+	_MPEG_CSCSync();
 	return _ipu_suspend();
 }
 
@@ -156,17 +161,33 @@ s32 _mpeg_dmac_handler( s32 channel, void *arg, void *addr )
 	*R_EE_D3_MADR = carg[1];
 	*R_EE_D4_MADR = carg[0];
 	carg[0] += var2 * 0x180;
-	carg[1] += var2 * 0x400;
+	carg[1] += var2 * carg[3] * 0x10;
 	carg[2] = var1 - var2;
-	*R_EE_D3_QWC = var2 * 0x400 >> 4;
+	*R_EE_D3_QWC = var2 * carg[3];
 	*R_EE_D4_QWC = var2 * 0x180 >> 4;
 	*R_EE_D4_CHCR = 0x101;
-	*R_EE_IPU_CMD = var2 | 0x70000000;
+	*R_EE_IPU_CMD = var2 | carg[4];
 	*R_EE_D3_CHCR = 0x100;
 	return ~0;
 }
 
-int _MPEG_CSCImage ( void* arg0, void* arg1, int arg2 )
+void _MPEG_SetCSCFormat ( int arg0 )
+{
+	// CSC command, OFM selects RGB16 and DTE dithers it
+	s_CSCCmd = 0x70000000;
+	s_CSCQWC = 0x40;
+	if ((arg0 & MPEG_CSC_RGBA16) != 0)
+	{
+		s_CSCCmd |= 0x08000000;
+		s_CSCQWC = 0x20;
+		if ((arg0 & MPEG_CSC_DITHER) != 0)
+		{
+			s_CSCCmd |= 0x04000000;
+		}
+	}
+}
+
+int _MPEG_CSCImageAsync ( void* arg0, void* arg1, int arg2 )
 {
 	_ipu_suspend();
 	*R_EE_IPU_CMD = 0;
@@ -177,20 +198,45 @@ int _MPEG_CSCImage ( void* arg0, void* arg1, int arg2 )
 		var1 = 0x3ff;
 	}
 	s_CSCParam[2] = arg2 - var1;
+	s_CSCParam[3] = s_CSCQWC;
+	s_CSCParam[4] = s_CSCCmd;
 	*R_EE_D3_MADR = (u32)arg1;
 	*R_EE_D4_MADR = (u32)arg0;
 	s_CSCParam[0] = (int)arg0 + var1 * 0x180;
-	s_CSCParam[1] = (int)arg1 + var1 * 0x400;
-	*R_EE_D4_QWC = var1 * 0x180;
-	*R_EE_D3_QWC = var1 * 0x400;
+	s_CSCParam[1] = (int)arg1 + var1 * s_CSCQWC * 0x10;
+	*R_EE_D4_QWC = var1 * 0x180 >> 4;
+	*R_EE_D3_QWC = var1 * s_CSCQWC;
+	// set before the first interrupt can clear it
+	s_CSCFlag = 68; // TODO: validate this
+	s_CSCPending = 1;
 	EnableDmac(3);
-	var1 |= 0x70000000;
+	var1 |= s_CSCCmd;
 	*R_EE_D4_CHCR = 0x101;
 	*R_EE_IPU_CMD = var1;
 	*R_EE_D3_CHCR = 0x100;
-	s_CSCFlag = 68; // TODO: validate this
+	return var1;
+}
+
+int _MPEG_CSCBusy ( void )
+{
+	return s_CSCFlag != 0;
+}
+
+void _MPEG_CSCSync ( void )
+{
+	if (s_CSCPending == 0)
+	{
+		return;
+	}
 	WaitSema(s_Sema);
+	s_CSCPending = 0;
 	_ipu_resume();
+}
+
+int _MPEG_CSCImage ( void* arg0, void* arg1, int arg2 )
+{
+	int var1 = _MPEG_CSCImageAsync(arg0, arg1, arg2);
+	_MPEG_CSCSync();
 	return var1;
 }
 
@@ -576,2106 +622,3 @@ void _MPEG_dma_ref_image ( _MPEGMacroBlock8* arg0, _MPEGMotion* arg1, s64 arg2,
 		*R_EE_D9_CHCR = 0x105;
 	}
 }
-
-void _MPEG_put_block_fr(_MPEGMotions *a1)
-{
-	u8 *m_pMBDstY;
-	u8 *m_pSrc;
-	int count;
-	u128 reg1, reg2, reg3, reg4, reg5, reg6, reg7, reg8, reg9;
-
-	__asm__
-	(
-		"pnor    %[reg1], $zero, $zero\n"
-		: [reg1] "=r"(reg1)
-	);
-	m_pMBDstY = a1->m_pMBDstY;
-	m_pSrc = a1->m_pSrc;
-	count = 6;
-	__asm__
-	(
-		"psrlh   %[reg1],  %[reg1], 8\n"
-		: [reg1] "+r"(reg1)
-	);
-	do
-	{
-		reg2 = ((u128 *)m_pSrc)[0];
-		reg9 = ((u128 *)m_pSrc)[1];
-		reg8 = ((u128 *)m_pSrc)[2];
-		reg7 = ((u128 *)m_pSrc)[3];
-		count -= 1;
-		reg3 = ((u128 *)m_pSrc)[4];
-		reg4 = ((u128 *)m_pSrc)[5];
-		reg5 = ((u128 *)m_pSrc)[6];
-		reg6 = ((u128 *)m_pSrc)[7];
-		m_pSrc += 128;
-		__asm__
-		(
-			"pmaxh   %[reg2], $zero, %[reg2]\n"
-			"pmaxh   %[reg9], $zero, %[reg9]\n"
-			"pmaxh   %[reg8], $zero, %[reg8]\n"
-			"pmaxh   %[reg7], $zero, %[reg7]\n"
-			"pmaxh   %[reg3], $zero, %[reg3]\n"
-			"pmaxh   %[reg4], $zero, %[reg4]\n"
-			"pmaxh   %[reg5], $zero, %[reg5]\n"
-			"pmaxh   %[reg6], $zero, %[reg6]\n"
-			"pminh   %[reg2], %[reg1], %[reg2]\n"
-			"pminh   %[reg9], %[reg1], %[reg9]\n"
-			"pminh   %[reg8], %[reg1], %[reg8]\n"
-			"pminh   %[reg7], %[reg1], %[reg7]\n"
-			"pminh   %[reg3], %[reg1], %[reg3]\n"
-			"pminh   %[reg4], %[reg1], %[reg4]\n"
-			"pminh   %[reg5], %[reg1], %[reg5]\n"
-			"pminh   %[reg6], %[reg1], %[reg6]\n"
-			"ppacb   %[reg2], %[reg9], %[reg2]\n"
-			"ppacb   %[reg8], %[reg7], %[reg8]\n"
-			"ppacb   %[reg3], %[reg4], %[reg3]\n"
-			"ppacb   %[reg5], %[reg6], %[reg5]\n"
-			: [reg2] "+r"(reg2), [reg3] "+r"(reg3), [reg4] "+r"(reg4), [reg5] "+r"(reg5), [reg6] "+r"(reg6), [reg7] "+r"(reg7), [reg8] "+r"(reg8), [reg9] "+r"(reg9)
-			: [reg1] "r"(reg1)
-		);
-		((u128 *)m_pMBDstY)[0] = reg2;
-		((u128 *)m_pMBDstY)[1] = reg8;
-		((u128 *)m_pMBDstY)[2] = reg3;
-		((u128 *)m_pMBDstY)[3] = reg5;
-		m_pMBDstY += 64;
-	}
-	while ( count > 0 );
-}
-
-void _MPEG_put_block_fl(_MPEGMotions *a1)
-{
-	u8 *m_pMBDstY;
-	u8 *m_pSrc;
-	int count;
-	u128 reg1, reg2, reg3, reg4, reg5, reg6, reg7, reg8, reg9;
-
-	__asm__
-	(
-		"pnor    %[reg1], $zero, $zero\n"
-		: [reg1] "=r"(reg1)
-	);
-	m_pMBDstY = a1->m_pMBDstY;
-	m_pSrc = a1->m_pSrc;
-	count = 4;
-	__asm__
-	(
-		"psrlh   %[reg1], %[reg1], 8\n"
-		: [reg1] "+r"(reg1)
-	);
-	do
-	{
-		reg2 = ((u128 *)m_pSrc)[0x00];
-		reg9 = ((u128 *)m_pSrc)[0x01];
-		reg8 = ((u128 *)m_pSrc)[0x02];
-		reg7 = ((u128 *)m_pSrc)[0x03];
-		count -= 1;
-		reg3 = ((u128 *)m_pSrc)[0x10];
-		reg4 = ((u128 *)m_pSrc)[0x11];
-		reg5 = ((u128 *)m_pSrc)[0x12];
-		reg6 = ((u128 *)m_pSrc)[0x13];
-		m_pSrc += 64;
-		__asm__
-		(
-			"pmaxh   %[reg2], $zero, %[reg2]\n"
-			"pmaxh   %[reg9], $zero, %[reg9]\n"
-			"pmaxh   %[reg8], $zero, %[reg8]\n"
-			"pmaxh   %[reg7], $zero, %[reg7]\n"
-			"pmaxh   %[reg3], $zero, %[reg3]\n"
-			"pmaxh   %[reg4], $zero, %[reg4]\n"
-			"pmaxh   %[reg5], $zero, %[reg5]\n"
-			"pmaxh   %[reg6], $zero, %[reg6]\n"
-			"pminh   %[reg2], %[reg1], %[reg2]\n"
-			"pminh   %[reg9], %[reg1], %[reg9]\n"
-			"pminh   %[reg8], %[reg1], %[reg8]\n"
-			"pminh   %[reg7], %[reg1], %[reg7]\n"
-			"pminh   %[reg3], %[reg1], %[reg3]\n"
-			"pminh   %[reg4], %[reg1], %[reg4]\n"
-			"pminh   %[reg5], %[reg1], %[reg5]\n"
-			"pminh   %[reg6], %[reg1], %[reg6]\n"
-			"ppacb   %[reg2], %[reg9], %[reg2]\n"
-			"ppacb   %[reg8], %[reg7], %[reg8]\n"
-			"ppacb   %[reg3], %[reg4], %[reg3]\n"
-			"ppacb   %[reg5], %[reg6], %[reg5]\n"
-			: [reg2] "+r"(reg2), [reg3] "+r"(reg3), [reg4] "+r"(reg4), [reg5] "+r"(reg5), [reg6] "+r"(reg6), [reg7] "+r"(reg7), [reg8] "+r"(reg8), [reg9] "+r"(reg9)
-			: [reg1] "r"(reg1)
-		);
-		((u128 *)m_pMBDstY)[0] = reg2;
-		((u128 *)m_pMBDstY)[1] = reg3;
-		((u128 *)m_pMBDstY)[2] = reg8;
-		((u128 *)m_pMBDstY)[3] = reg5;
-		m_pMBDstY += 64;
-	}
-	while ( count > 0 );
-	count += 2;
-	do
-	{
-		reg2 = ((u128 *)m_pSrc)[0x10];
-		reg9 = ((u128 *)m_pSrc)[0x11];
-		reg8 = ((u128 *)m_pSrc)[0x12];
-		reg7 = ((u128 *)m_pSrc)[0x13];
-		count -= 1;
-		reg3 = ((u128 *)m_pSrc)[0x14];
-		reg4 = ((u128 *)m_pSrc)[0x15];
-		reg5 = ((u128 *)m_pSrc)[0x16];
-		reg6 = ((u128 *)m_pSrc)[0x17];
-		m_pSrc += 128;
-		__asm__
-		(
-			"pmaxh   %[reg2], $zero, %[reg2]\n"
-			"pmaxh   %[reg9], $zero, %[reg9]\n"
-			"pmaxh   %[reg8], $zero, %[reg8]\n"
-			"pmaxh   %[reg7], $zero, %[reg7]\n"
-			"pmaxh   %[reg3], $zero, %[reg3]\n"
-			"pmaxh   %[reg4], $zero, %[reg4]\n"
-			"pmaxh   %[reg5], $zero, %[reg5]\n"
-			"pmaxh   %[reg6], $zero, %[reg6]\n"
-			"pminh   %[reg2], %[reg1], %[reg2]\n"
-			"pminh   %[reg9], %[reg1], %[reg9]\n"
-			"pminh   %[reg8], %[reg1], %[reg8]\n"
-			"pminh   %[reg7], %[reg1], %[reg7]\n"
-			"pminh   %[reg3], %[reg1], %[reg3]\n"
-			"pminh   %[reg4], %[reg1], %[reg4]\n"
-			"pminh   %[reg5], %[reg1], %[reg5]\n"
-			"pminh   %[reg6], %[reg1], %[reg6]\n"
-			"ppacb   %[reg2], %[reg9], %[reg2]\n"
-			"ppacb   %[reg8], %[reg7], %[reg8]\n"
-			"ppacb   %[reg3], %[reg4], %[reg3]\n"
-			"ppacb   %[reg5], %[reg6], %[reg5]\n"
-			: [reg2] "+r"(reg2), [reg3] "+r"(reg3), [reg4] "+r"(reg4), [reg5] "+r"(reg5), [reg6] "+r"(reg6), [reg7] "+r"(reg7), [reg8] "+r"(reg8), [reg9] "+r"(reg9)
-			: [reg1] "r"(reg1)
-		);
-		((u128 *)m_pMBDstY)[0] = reg2;
-		((u128 *)m_pMBDstY)[1] = reg8;
-		((u128 *)m_pMBDstY)[2] = reg3;
-		((u128 *)m_pMBDstY)[3] = reg5;
-		m_pMBDstY += 64;
-	}
-	while ( count > 0 );
-}
-
-void _MPEG_put_block_il(_MPEGMotions *a1)
-{
-	u8 *m_pMBDstY;
-	u8 *m_pSrc;
-	int count;
-	u8 *m_pMBDstCbCr;
-	u8 *v28;
-	u128 reg1, reg2, reg3, reg4, reg5, reg6, reg7, reg8, reg9;
-
-	__asm__
-	(
-		"pnor    %[reg1], $zero, $zero\n"
-		: [reg1] "=r"(reg1)
-	);
-	m_pMBDstY = a1->m_pMBDstY;
-	m_pSrc = a1->m_pSrc;
-	count = 4;
-	v28 = &m_pMBDstY[a1->m_Stride];
-	__asm__
-	(
-		"psrlh   %[reg1], %[reg1], 8\n"
-		: [reg1] "+r"(reg1)
-	);
-	do
-	{
-		reg2 = ((u128 *)m_pSrc)[0x00];
-		reg9 = ((u128 *)m_pSrc)[0x01];
-		reg8 = ((u128 *)m_pSrc)[0x02];
-		reg7 = ((u128 *)m_pSrc)[0x03];
-		count -= 1;
-		reg3 = ((u128 *)m_pSrc)[0x10];
-		reg4 = ((u128 *)m_pSrc)[0x11];
-		reg5 = ((u128 *)m_pSrc)[0x12];
-		reg6 = ((u128 *)m_pSrc)[0x13];
-		m_pSrc += 64;
-		__asm__
-		(
-			"pmaxh   %[reg2], $zero, %[reg2]\n"
-			"pmaxh   %[reg9], $zero, %[reg9]\n"
-			"pmaxh   %[reg8], $zero, %[reg8]\n"
-			"pmaxh   %[reg7], $zero, %[reg7]\n"
-			"pmaxh   %[reg3], $zero, %[reg3]\n"
-			"pmaxh   %[reg4], $zero, %[reg4]\n"
-			"pmaxh   %[reg5], $zero, %[reg5]\n"
-			"pmaxh   %[reg6], $zero, %[reg6]\n"
-			"pminh   %[reg2], %[reg1], %[reg2]\n"
-			"pminh   %[reg9], %[reg1], %[reg9]\n"
-			"pminh   %[reg8], %[reg1], %[reg8]\n"
-			"pminh   %[reg7], %[reg1], %[reg7]\n"
-			"pminh   %[reg3], %[reg1], %[reg3]\n"
-			"pminh   %[reg4], %[reg1], %[reg4]\n"
-			"pminh   %[reg5], %[reg1], %[reg5]\n"
-			"pminh   %[reg6], %[reg1], %[reg6]\n"
-			"ppacb   %[reg2], %[reg9], %[reg2]\n"
-			"ppacb   %[reg8], %[reg7], %[reg8]\n"
-			"ppacb   %[reg3], %[reg4], %[reg3]\n"
-			"ppacb   %[reg5], %[reg6], %[reg5]\n"
-			: [reg2] "+r"(reg2), [reg3] "+r"(reg3), [reg4] "+r"(reg4), [reg5] "+r"(reg5), [reg6] "+r"(reg6), [reg7] "+r"(reg7), [reg8] "+r"(reg8), [reg9] "+r"(reg9)
-			: [reg1] "r"(reg1)
-		);
-		((u128 *)m_pMBDstY)[0x00] = reg2;
-		((u128 *)m_pMBDstY)[0x02] = reg8;
-		m_pMBDstY += 64;
-		((u128 *)v28)[0x00] = reg3;
-		((u128 *)v28)[0x02] = reg5;
-		v28 += 64;
-	}
-	while ( count > 0 );
-	m_pMBDstCbCr = a1->m_pMBDstCbCr;
-	count = 2;
-	v28 = &m_pMBDstCbCr[a1->m_Stride];
-	do
-	{
-		reg2 = ((u128 *)m_pSrc)[0x10];
-		reg9 = ((u128 *)m_pSrc)[0x11];
-		reg8 = ((u128 *)m_pSrc)[0x12];
-		reg7 = ((u128 *)m_pSrc)[0x13];
-		count -= 1;
-		reg3 = ((u128 *)m_pSrc)[0x14];
-		reg4 = ((u128 *)m_pSrc)[0x15];
-		reg5 = ((u128 *)m_pSrc)[0x16];
-		reg6 = ((u128 *)m_pSrc)[0x17];
-		m_pSrc += 128;
-		__asm__
-		(
-			"pmaxh   %[reg2], $zero, %[reg2]\n"
-			"pmaxh   %[reg9], $zero, %[reg9]\n"
-			"pmaxh   %[reg8], $zero, %[reg8]\n"
-			"pmaxh   %[reg7], $zero, %[reg7]\n"
-			"pmaxh   %[reg3], $zero, %[reg3]\n"
-			"pmaxh   %[reg4], $zero, %[reg4]\n"
-			"pmaxh   %[reg5], $zero, %[reg5]\n"
-			"pmaxh   %[reg6], $zero, %[reg6]\n"
-			"pminh   %[reg2], %[reg1], %[reg2]\n"
-			"pminh   %[reg9], %[reg1], %[reg9]\n"
-			"pminh   %[reg8], %[reg1], %[reg8]\n"
-			"pminh   %[reg7], %[reg1], %[reg7]\n"
-			"pminh   %[reg3], %[reg1], %[reg3]\n"
-			"pminh   %[reg4], %[reg1], %[reg4]\n"
-			"pminh   %[reg5], %[reg1], %[reg5]\n"
-			"pminh   %[reg6], %[reg1], %[reg6]\n"
-			"ppacb   %[reg2], $zero, %[reg2]\n"
-			"ppacb   %[reg9], $zero, %[reg9]\n"
-			"ppacb   %[reg8], $zero, %[reg8]\n"
-			"ppacb   %[reg7], $zero, %[reg7]\n"
-			"ppacb   %[reg3], $zero, %[reg3]\n"
-			"ppacb   %[reg4], $zero, %[reg4]\n"
-			"ppacb   %[reg5], $zero, %[reg5]\n"
-			"ppacb   %[reg6], $zero, %[reg6]\n"
-			: [reg2] "+r"(reg2), [reg3] "+r"(reg3), [reg4] "+r"(reg4), [reg5] "+r"(reg5), [reg6] "+r"(reg6), [reg7] "+r"(reg7), [reg8] "+r"(reg8), [reg9] "+r"(reg9)
-			: [reg1] "r"(reg1)
-		);
-		((u64 *)m_pMBDstCbCr)[0x00] = reg2;
-		((u64 *)m_pMBDstCbCr)[0x02] = reg9;
-		((u64 *)m_pMBDstCbCr)[0x04] = reg8;
-		((u64 *)m_pMBDstCbCr)[0x06] = reg7;
-		((u64 *)v28)[0x00] = reg3;
-		((u64 *)v28)[0x02] = reg4;
-		((u64 *)v28)[0x04] = reg5;
-		((u64 *)v28)[0x06] = reg6;
-		m_pMBDstCbCr += 64;
-		v28 += 64;
-	}
-	while ( count > 0 );
-}
-
-void _MPEG_add_block_frfr(_MPEGMotions *a1)
-{
-	u8 *m_pMBDstY;
-	u8 *m_pSPRBlk;
-	u8 *m_pSPRRes;
-	int count;
-	u128 reg1, reg2, reg3, reg4, reg5, reg6, reg7, reg8, reg9;
-
-	__asm__
-	(
-		"pnor    %[reg1], $zero, $zero\n"
-		: [reg1] "=r"(reg1)
-	);
-	m_pMBDstY = a1->m_pMBDstY;
-	m_pSPRBlk = a1->m_pSPRBlk;
-	m_pSPRRes = a1->m_pSPRRes;
-	count = 6;
-	__asm__
-	(
-		"psrlh   %[reg1], %[reg1], 8\n"
-		: [reg1] "+r"(reg1)
-	);
-	do
-	{
-		reg2 = ((u128 *)m_pSPRBlk)[0x00];
-		reg9 = ((u128 *)m_pSPRBlk)[0x01];
-		reg8 = ((u128 *)m_pSPRBlk)[0x02];
-		reg7 = ((u128 *)m_pSPRBlk)[0x03];
-		count -= 1;
-		reg3 = ((u128 *)m_pSPRRes)[0x00];
-		reg4 = ((u128 *)m_pSPRRes)[0x01];
-		reg5 = ((u128 *)m_pSPRRes)[0x02];
-		reg6 = ((u128 *)m_pSPRRes)[0x03];
-		__asm__
-		(
-			"paddh   %[reg2], %[reg2], %[reg3]\n"
-			"paddh   %[reg9], %[reg9], %[reg4]\n"
-			"paddh   %[reg8], %[reg8], %[reg5]\n"
-			"paddh   %[reg7], %[reg7], %[reg6]\n"
-			"pmaxh   %[reg2], $zero, %[reg2]\n"
-			"pmaxh   %[reg9], $zero, %[reg9]\n"
-			"pmaxh   %[reg8], $zero, %[reg8]\n"
-			"pmaxh   %[reg7], $zero, %[reg7]\n"
-			"pminh   %[reg2], %[reg1], %[reg2]\n"
-			"pminh   %[reg9], %[reg1], %[reg9]\n"
-			"pminh   %[reg8], %[reg1], %[reg8]\n"
-			"pminh   %[reg7], %[reg1], %[reg7]\n"
-			"ppacb   %[reg2], %[reg9], %[reg2]\n"
-			"ppacb   %[reg8], %[reg7], %[reg8]\n"
-			: [reg2] "+r"(reg2), [reg3] "+r"(reg3), [reg4] "+r"(reg4), [reg5] "+r"(reg5), [reg6] "+r"(reg6), [reg7] "+r"(reg7), [reg8] "+r"(reg8), [reg9] "+r"(reg9)
-			: [reg1] "r"(reg1)
-		);
-		((u128 *)m_pMBDstY)[0x00] = reg2;
-		((u128 *)m_pMBDstY)[0x01] = reg8;
-		reg3 = ((u128 *)m_pSPRBlk)[0x04];
-		reg4 = ((u128 *)m_pSPRBlk)[0x05];
-		reg5 = ((u128 *)m_pSPRBlk)[0x06];
-		reg6 = ((u128 *)m_pSPRBlk)[0x07];
-		m_pSPRBlk += 128;
-		reg2 = ((u128 *)m_pSPRRes)[0x04];
-		reg9 = ((u128 *)m_pSPRRes)[0x05];
-		reg8 = ((u128 *)m_pSPRRes)[0x06];
-		reg7 = ((u128 *)m_pSPRRes)[0x07];
-		m_pSPRRes += 128;
-		__asm__
-		(
-			"paddh   %[reg3], %[reg3], %[reg2]\n"
-			"paddh   %[reg4], %[reg4], %[reg9]\n"
-			"paddh   %[reg5], %[reg5], %[reg8]\n"
-			"paddh   %[reg6], %[reg6], %[reg7]\n"
-			"pmaxh   %[reg3], $zero, %[reg3]\n"
-			"pmaxh   %[reg4], $zero, %[reg4]\n"
-			"pmaxh   %[reg5], $zero, %[reg5]\n"
-			"pmaxh   %[reg6], $zero, %[reg6]\n"
-			"pminh   %[reg3], %[reg1], %[reg3]\n"
-			"pminh   %[reg4], %[reg1], %[reg4]\n"
-			"pminh   %[reg5], %[reg1], %[reg5]\n"
-			"pminh   %[reg6], %[reg1], %[reg6]\n"
-			"ppacb   %[reg3], %[reg4], %[reg3]\n"
-			"ppacb   %[reg5], %[reg6], %[reg5]\n"
-			: [reg2] "+r"(reg2), [reg3] "+r"(reg3), [reg4] "+r"(reg4), [reg5] "+r"(reg5), [reg6] "+r"(reg6), [reg7] "+r"(reg7), [reg8] "+r"(reg8), [reg9] "+r"(reg9)
-			: [reg1] "r"(reg1)
-		);
-		((u128 *)m_pMBDstY)[0x02] = reg3;
-		((u128 *)m_pMBDstY)[0x03] = reg5;
-		m_pMBDstY += 64;
-	}
-	while ( count > 0 );
-}
-
-void _MPEG_add_block_ilfl(_MPEGMotions *a1)
-{
-	u8 *m_pMBDstY;
-	u8 *m_pSPRBlk;
-	u8 *m_pSPRRes;
-	int count;
-	u8 *v6;
-	u8 *m_pMBDstCbCr;
-	u128 reg1, reg2, reg3, reg4, reg5, reg6, reg7, reg8, reg9;
-
-	__asm__
-	(
-		"pnor    %[reg1], $zero, $zero\n"
-		: [reg1] "=r"(reg1)
-	);
-	m_pMBDstY = a1->m_pMBDstY;
-	m_pSPRBlk = a1->m_pSPRBlk;
-	m_pSPRRes = a1->m_pSPRRes;
-	count = 4;
-	__asm__
-	(
-		"psrlh   %[reg1], %[reg1], 8\n"
-		: [reg1] "+r"(reg1)
-	);
-	v6 = &m_pMBDstY[a1->m_Stride];
-	do
-	{
-		reg2 = ((u128 *)m_pSPRBlk)[0x00];
-		reg9 = ((u128 *)m_pSPRBlk)[0x01];
-		reg8 = ((u128 *)m_pSPRBlk)[0x02];
-		reg7 = ((u128 *)m_pSPRBlk)[0x03];
-		count -= 1;
-		reg3 = ((u128 *)m_pSPRRes)[0x00];
-		reg4 = ((u128 *)m_pSPRRes)[0x01];
-		reg5 = ((u128 *)m_pSPRRes)[0x02];
-		reg6 = ((u128 *)m_pSPRRes)[0x03];
-		__asm__
-		(
-			"paddh   %[reg2], %[reg2], %[reg3]\n"
-			"paddh   %[reg9], %[reg9], %[reg4]\n"
-			"paddh   %[reg8], %[reg8], %[reg5]\n"
-			"paddh   %[reg7], %[reg7], %[reg6]\n"
-			"pmaxh   %[reg2], $zero, %[reg2]\n"
-			"pmaxh   %[reg9], $zero, %[reg9]\n"
-			"pmaxh   %[reg8], $zero, %[reg8]\n"
-			"pmaxh   %[reg7], $zero, %[reg7]\n"
-			"pminh   %[reg2], %[reg1], %[reg2]\n"
-			"pminh   %[reg9], %[reg1], %[reg9]\n"
-			"pminh   %[reg8], %[reg1], %[reg8]\n"
-			"pminh   %[reg7], %[reg1], %[reg7]\n"
-			"ppacb   %[reg2], %[reg9], %[reg2]\n"
-			"ppacb   %[reg8], %[reg7], %[reg8]\n"
-			: [reg2] "+r"(reg2), [reg3] "+r"(reg3), [reg4] "+r"(reg4), [reg5] "+r"(reg5), [reg6] "+r"(reg6), [reg7] "+r"(reg7), [reg8] "+r"(reg8), [reg9] "+r"(reg9)
-			: [reg1] "r"(reg1)
-		);
-		((u128 *)m_pMBDstY)[0] = reg2;
-		((u128 *)m_pMBDstY)[2] = reg8;
-		reg3 = ((u128 *)m_pSPRBlk)[0x10];
-		reg4 = ((u128 *)m_pSPRBlk)[0x11];
-		reg5 = ((u128 *)m_pSPRBlk)[0x12];
-		reg6 = ((u128 *)m_pSPRBlk)[0x13];
-		m_pSPRBlk += 64;
-		reg2 = ((u128 *)m_pSPRRes)[0x10];
-		reg9 = ((u128 *)m_pSPRRes)[0x11];
-		reg8 = ((u128 *)m_pSPRRes)[0x12];
-		reg7 = ((u128 *)m_pSPRRes)[0x13];
-		__asm__
-		(
-			"paddh   %[reg3], %[reg3], %[reg2]\n"
-			"paddh   %[reg4], %[reg4], %[reg9]\n"
-			"paddh   %[reg5], %[reg5], %[reg8]\n"
-			"paddh   %[reg6], %[reg6], %[reg7]\n"
-			"pmaxh   %[reg3], $zero, %[reg3]\n"
-			"pmaxh   %[reg4], $zero, %[reg4]\n"
-			"pmaxh   %[reg5], $zero, %[reg5]\n"
-			"pmaxh   %[reg6], $zero, %[reg6]\n"
-			"pminh   %[reg3], %[reg1], %[reg3]\n"
-			"pminh   %[reg4], %[reg1], %[reg4]\n"
-			"pminh   %[reg5], %[reg1], %[reg5]\n"
-			"pminh   %[reg6], %[reg1], %[reg6]\n"
-			"ppacb   %[reg3], %[reg4], %[reg3]\n"
-			"ppacb   %[reg5], %[reg6], %[reg5]\n"
-			: [reg2] "+r"(reg2), [reg3] "+r"(reg3), [reg4] "+r"(reg4), [reg5] "+r"(reg5), [reg6] "+r"(reg6), [reg7] "+r"(reg7), [reg8] "+r"(reg8), [reg9] "+r"(reg9)
-			: [reg1] "r"(reg1)
-		);
-		((u128 *)v6)[0x00] = reg3;
-		((u128 *)v6)[0x02] = reg5;
-		v6 += 64;
-		m_pSPRRes += 64;
-	}
-	while ( count > 0 );
-	m_pMBDstCbCr = a1->m_pMBDstCbCr;
-	count = 2;
-	v6 = &m_pMBDstCbCr[a1->m_Stride];
-	do
-	{
-		reg2 = ((u128 *)m_pSPRBlk)[0x10];
-		reg9 = ((u128 *)m_pSPRBlk)[0x11];
-		reg8 = ((u128 *)m_pSPRBlk)[0x12];
-		reg7 = ((u128 *)m_pSPRBlk)[0x13];
-		count -= 1;
-		reg3 = ((u128 *)m_pSPRRes)[0x10];
-		reg4 = ((u128 *)m_pSPRRes)[0x11];
-		reg5 = ((u128 *)m_pSPRRes)[0x12];
-		reg6 = ((u128 *)m_pSPRRes)[0x13];
-		__asm__
-		(
-			"paddh   %[reg2], %[reg2], %[reg3]\n"
-			"paddh   %[reg9], %[reg9], %[reg4]\n"
-			"paddh   %[reg8], %[reg8], %[reg5]\n"
-			"paddh   %[reg7], %[reg7], %[reg6]\n"
-			"pmaxh   %[reg2], $zero, %[reg2]\n"
-			"pmaxh   %[reg9], $zero, %[reg9]\n"
-			"pmaxh   %[reg8], $zero, %[reg8]\n"
-			"pmaxh   %[reg7], $zero, %[reg7]\n"
-			"pminh   %[reg2], %[reg1], %[reg2]\n"
-			"pminh   %[reg9], %[reg1], %[reg9]\n"
-			"pminh   %[reg8], %[reg1], %[reg8]\n"
-			"pminh   %[reg7], %[reg1], %[reg7]\n"
-			"ppacb   %[reg2], $zero, %[reg2]\n"
-			"ppacb   %[reg9], $zero, %[reg9]\n"
-			"ppacb   %[reg8], $zero, %[reg8]\n"
-			"ppacb   %[reg7], $zero, %[reg7]\n"
-			: [reg2] "+r"(reg2), [reg3] "+r"(reg3), [reg4] "+r"(reg4), [reg5] "+r"(reg5), [reg6] "+r"(reg6), [reg7] "+r"(reg7), [reg8] "+r"(reg8), [reg9] "+r"(reg9)
-			: [reg1] "r"(reg1)
-		);
-		((u64 *)m_pMBDstCbCr)[0] = reg2;
-		((u64 *)m_pMBDstCbCr)[2] = reg9;
-		((u64 *)m_pMBDstCbCr)[4] = reg8;
-		((u64 *)m_pMBDstCbCr)[6] = reg7;
-		reg3 = ((u128 *)m_pSPRBlk)[0x14];
-		reg4 = ((u128 *)m_pSPRBlk)[0x15];
-		reg5 = ((u128 *)m_pSPRBlk)[0x16];
-		reg6 = ((u128 *)m_pSPRBlk)[0x17];
-		m_pSPRBlk += 128;
-		reg2 = ((u128 *)m_pSPRRes)[0x14];
-		reg9 = ((u128 *)m_pSPRRes)[0x15];
-		reg8 = ((u128 *)m_pSPRRes)[0x16];
-		reg7 = ((u128 *)m_pSPRRes)[0x17];
-		__asm__
-		(
-			"paddh   %[reg3], %[reg3], %[reg2]\n"
-			"paddh   %[reg4], %[reg4], %[reg9]\n"
-			"paddh   %[reg5], %[reg5], %[reg8]\n"
-			"paddh   %[reg6], %[reg6], %[reg7]\n"
-			"pmaxh   %[reg3], $zero, %[reg3]\n"
-			"pmaxh   %[reg4], $zero, %[reg4]\n"
-			"pmaxh   %[reg5], $zero, %[reg5]\n"
-			"pmaxh   %[reg6], $zero, %[reg6]\n"
-			"pminh   %[reg3], %[reg1], %[reg3]\n"
-			"pminh   %[reg4], %[reg1], %[reg4]\n"
-			"pminh   %[reg5], %[reg1], %[reg5]\n"
-			"pminh   %[reg6], %[reg1], %[reg6]\n"
-			"ppacb   %[reg3], $zero, %[reg3]\n"
-			"ppacb   %[reg4], $zero, %[reg4]\n"
-			"ppacb   %[reg5], $zero, %[reg5]\n"
-			"ppacb   %[reg6], $zero, %[reg6]\n"
-			: [reg2] "+r"(reg2), [reg3] "+r"(reg3), [reg4] "+r"(reg4), [reg5] "+r"(reg5), [reg6] "+r"(reg6), [reg7] "+r"(reg7), [reg8] "+r"(reg8), [reg9] "+r"(reg9)
-			: [reg1] "r"(reg1)
-		);
-		((u64 *)v6)[0x00] = reg3;
-		((u64 *)v6)[0x02] = reg4;
-		((u64 *)v6)[0x04] = reg5;
-		((u64 *)v6)[0x06] = reg6;
-		m_pMBDstCbCr += 64;
-		v6 += 64;
-	}
-	while ( count > 0 );
-}
-
-void _MPEG_add_block_frfl(_MPEGMotions *a1)
-{
-	u8 *m_pSPRBlk;
-	u8 *m_pSPRRes;
-	int count;
-	u8 *m_pMBDstCbCr;
-	u8 *m_pMBDstY;
-	u128 reg1, reg2, reg3, reg4, reg5, reg6, reg7, reg8, reg9;
-
-	__asm__
-	(
-		"pnor    %[reg1], $zero, $zero\n"
-		: [reg1] "=r"(reg1)
-	);
-	m_pSPRBlk = a1->m_pSPRBlk;
-	m_pSPRRes = a1->m_pSPRRes;
-	m_pMBDstY = a1->m_pMBDstY;
-	count = 4;
-	__asm__
-	(
-		"psrlh   %[reg1], %[reg1], 8\n"
-		: [reg1] "+r"(reg1)
-	);
-	do
-	{
-		reg2 = ((u128 *)m_pSPRBlk)[0x00];
-		reg9 = ((u128 *)m_pSPRBlk)[0x01];
-		reg8 = ((u128 *)m_pSPRBlk)[0x02];
-		reg7 = ((u128 *)m_pSPRBlk)[0x03];
-		count -= 1;
-		reg3 = ((u128 *)m_pSPRRes)[0x00];
-		reg4 = ((u128 *)m_pSPRRes)[0x01];
-		reg5 = ((u128 *)m_pSPRRes)[0x10];
-		reg6 = ((u128 *)m_pSPRRes)[0x11];
-		__asm__
-		(
-			"paddh   %[reg2], %[reg2], %[reg3]\n"
-			"paddh   %[reg9], %[reg9], %[reg4]\n"
-			"paddh   %[reg8], %[reg8], %[reg5]\n"
-			"paddh   %[reg7], %[reg7], %[reg6]\n"
-			"pmaxh   %[reg2], $zero, %[reg2]\n"
-			"pmaxh   %[reg9], $zero, %[reg9]\n"
-			"pmaxh   %[reg8], $zero, %[reg8]\n"
-			"pmaxh   %[reg7], $zero, %[reg7]\n"
-			"pminh   %[reg2], %[reg1], %[reg2]\n"
-			"pminh   %[reg9], %[reg1], %[reg9]\n"
-			"pminh   %[reg8], %[reg1], %[reg8]\n"
-			"pminh   %[reg7], %[reg1], %[reg7]\n"
-			"ppacb   %[reg2], %[reg9], %[reg2]\n"
-			"ppacb   %[reg8], %[reg7], %[reg8]\n"
-			: [reg2] "+r"(reg2), [reg3] "+r"(reg3), [reg4] "+r"(reg4), [reg5] "+r"(reg5), [reg6] "+r"(reg6), [reg7] "+r"(reg7), [reg8] "+r"(reg8), [reg9] "+r"(reg9)
-			: [reg1] "r"(reg1)
-		);
-		((u128 *)m_pMBDstY)[0x00] = reg2;
-		((u128 *)m_pMBDstY)[0x01] = reg8;
-		reg3 = ((u128 *)m_pSPRBlk)[0x04];
-		reg4 = ((u128 *)m_pSPRBlk)[0x05];
-		reg5 = ((u128 *)m_pSPRBlk)[0x06];
-		reg6 = ((u128 *)m_pSPRBlk)[0x07];
-		m_pSPRBlk += 128;
-		reg2 = ((u128 *)m_pSPRRes)[0x02];
-		reg9 = ((u128 *)m_pSPRRes)[0x03];
-		reg8 = ((u128 *)m_pSPRRes)[0x12];
-		reg7 = ((u128 *)m_pSPRRes)[0x13];
-		__asm__
-		(
-			"paddh   %[reg3], %[reg3], %[reg2]\n"
-			"paddh   %[reg4], %[reg4], %[reg9]\n"
-			"paddh   %[reg5], %[reg5], %[reg8]\n"
-			"paddh   %[reg6], %[reg6], %[reg7]\n"
-			"pmaxh   %[reg3], $zero, %[reg3]\n"
-			"pmaxh   %[reg4], $zero, %[reg4]\n"
-			"pmaxh   %[reg5], $zero, %[reg5]\n"
-			"pmaxh   %[reg6], $zero, %[reg6]\n"
-			"pminh   %[reg3], %[reg1], %[reg3]\n"
-			"pminh   %[reg4], %[reg1], %[reg4]\n"
-			"pminh   %[reg5], %[reg1], %[reg5]\n"
-			"pminh   %[reg6], %[reg1], %[reg6]\n"
-			"ppacb   %[reg3], %[reg4], %[reg3]\n"
-			"ppacb   %[reg5], %[reg6], %[reg5]\n"
-			: [reg2] "+r"(reg2), [reg3] "+r"(reg3), [reg4] "+r"(reg4), [reg5] "+r"(reg5), [reg6] "+r"(reg6), [reg7] "+r"(reg7), [reg8] "+r"(reg8), [reg9] "+r"(reg9)
-			: [reg1] "r"(reg1)
-		);
-		((u128 *)m_pMBDstY)[0x02] = reg3;
-		((u128 *)m_pMBDstY)[0x03] = reg5;
-		m_pSPRRes += 64;
-		m_pMBDstY += 64;
-	}
-	while ( count > 0 );
-	m_pMBDstCbCr = a1->m_pMBDstCbCr;
-	count = 2;
-	do
-	{
-		reg2 = ((u128 *)m_pSPRBlk)[0x00];
-		reg9 = ((u128 *)m_pSPRBlk)[0x01];
-		reg8 = ((u128 *)m_pSPRBlk)[0x02];
-		reg7 = ((u128 *)m_pSPRBlk)[0x03];
-		count -= 1;
-		reg3 = ((u128 *)m_pSPRRes)[0x10];
-		reg4 = ((u128 *)m_pSPRRes)[0x14];
-		reg5 = ((u128 *)m_pSPRRes)[0x11];
-		reg6 = ((u128 *)m_pSPRRes)[0x15];
-		__asm__
-		(
-			"paddh   %[reg2], %[reg2], %[reg3]\n"
-			"paddh   %[reg9], %[reg9], %[reg4]\n"
-			"paddh   %[reg8], %[reg8], %[reg5]\n"
-			"paddh   %[reg7], %[reg7], %[reg6]\n"
-			"pmaxh   %[reg2], $zero, %[reg2]\n"
-			"pmaxh   %[reg9], $zero, %[reg9]\n"
-			"pmaxh   %[reg8], $zero, %[reg8]\n"
-			"pmaxh   %[reg7], $zero, %[reg7]\n"
-			"pminh   %[reg2], %[reg1], %[reg2]\n"
-			"pminh   %[reg9], %[reg1], %[reg9]\n"
-			"pminh   %[reg8], %[reg1], %[reg8]\n"
-			"pminh   %[reg7], %[reg1], %[reg7]\n"
-			"ppacb   %[reg2], %[reg9], %[reg2]\n"
-			"ppacb   %[reg8], %[reg7], %[reg8]\n"
-			: [reg2] "+r"(reg2), [reg3] "+r"(reg3), [reg4] "+r"(reg4), [reg5] "+r"(reg5), [reg6] "+r"(reg6), [reg7] "+r"(reg7), [reg8] "+r"(reg8), [reg9] "+r"(reg9)
-			: [reg1] "r"(reg1)
-		);
-		((u128 *)m_pMBDstCbCr)[0x00] = reg2;
-		((u128 *)m_pMBDstCbCr)[0x01] = reg8;
-		reg3 = ((u128 *)m_pSPRBlk)[0x04];
-		reg4 = ((u128 *)m_pSPRBlk)[0x05];
-		reg5 = ((u128 *)m_pSPRBlk)[0x06];
-		reg6 = ((u128 *)m_pSPRBlk)[0x07];
-		m_pSPRBlk += 128;
-		reg2 = ((u128 *)m_pSPRRes)[0x12];
-		reg9 = ((u128 *)m_pSPRRes)[0x16];
-		reg8 = ((u128 *)m_pSPRRes)[0x13];
-		reg7 = ((u128 *)m_pSPRRes)[0x17];
-		__asm__
-		(
-			"paddh   %[reg3], %[reg3], %[reg2]\n"
-			"paddh   %[reg4], %[reg4], %[reg9]\n"
-			"paddh   %[reg5], %[reg5], %[reg8]\n"
-			"paddh   %[reg6], %[reg6], %[reg7]\n"
-			"pmaxh   %[reg3], $zero, %[reg3]\n"
-			"pmaxh   %[reg4], $zero, %[reg4]\n"
-			"pmaxh   %[reg5], $zero, %[reg5]\n"
-			"pmaxh   %[reg6], $zero, %[reg6]\n"
-			"pminh   %[reg3], %[reg1], %[reg3]\n"
-			"pminh   %[reg4], %[reg1], %[reg4]\n"
-			"pminh   %[reg5], %[reg1], %[reg5]\n"
-			"pminh   %[reg6], %[reg1], %[reg6]\n"
-			"ppacb   %[reg3], %[reg4], %[reg3]\n"
-			"ppacb   %[reg5], %[reg6], %[reg5]\n"
-			: [reg2] "+r"(reg2), [reg3] "+r"(reg3), [reg4] "+r"(reg4), [reg5] "+r"(reg5), [reg6] "+r"(reg6), [reg7] "+r"(reg7), [reg8] "+r"(reg8), [reg9] "+r"(reg9)
-			: [reg1] "r"(reg1)
-		);
-		((u128 *)m_pMBDstCbCr)[0x02] = reg3;
-		((u128 *)m_pMBDstCbCr)[0x03] = reg5;
-		m_pMBDstCbCr += 64;
-		m_pSPRRes += 128;
-	}
-	while ( count > 0 );
-}
-
-// TODO: verify delay slots
-void _MPEG_do_mc ( _MPEGMotion* arg0 )
-{
-	int var0 = 16; // addiu   $v0, $zero, 16
-	u8* arg1 = arg0->m_pSrc; // lw      $a1,  0($a0)
-	// addiu   $sp, $sp, -16
-	u16* arg2 = (u16 *)arg0->m_pDstY; // lw      $a2,  4($a0)
-	int arg3 = arg0->m_X; // lw      $a3, 12($a0)
-	int tmp0 = arg0->m_Y; // lw      $t0, 16($a0)
-	int tmp1 = arg0->m_H; // lw      $t1, 20($a0)
-	int tmp2 = arg0->m_fInt; // lw      $t2, 24($a0)
-	int tmp4 = arg0->m_Field; // lw      $t4, 28($a0)
-	// lw      $t5, 32($a0) <-- MC_Luma
-	tmp0 -= tmp4; // subu    $t0, $t0, $t4
-	tmp4 <<= 4; // sll     $t4, $t4, 4
-	arg1 += tmp4; // addu    $a1, $a1, $t4
-	int var1 = var0 - tmp0; // subu    $v1, $v0, $t0
-	int tmp3 = var0 << tmp2; // sllv    $t3, $v0, $t2
-	var1 >>= tmp2; // srlv    $v1, $v1, $t2
-	int ta = tmp0 << 4; // sll     $at, $t0, 4
-	// sw      $ra, 0($sp)
-	arg1 += ta; // addu    $a1, $a1, $at
-	ta = tmp1 - var1; // subu    $at, $t1, $v1
-	arg0->MC_Luma(arg1, arg2, arg3, tmp3, var1, ta); // jalr    $t5
-	arg1 = arg0->m_pSrc; // lw      $a1,  0($a0)
-	arg2 = (u16 *)arg0->m_pDstCbCr; // lw      $a2,  8($a0)
-	// lw      $t5, 36($a0) <-- MC_Chroma
-	arg1 += 256; // addiu   $a1, $a1, 256
-	tmp4 >>= 1; // srl     $t4, $t4, 1
-	arg3 >>= 1; // srl     $a3, $a3, 1
-	tmp0 >>= 1; // srl     $t0, $t0, 1
-	tmp1 >>= 1; // srl     $t1, $t1, 1
-	// lw      $ra, 0($sp)
-	tmp0 >>= tmp2; // srlv    $t0, $t0, $t2
-	arg1 += tmp4; // addu    $a1, $a1, $t4
-	var0 = 8; // addiu   $v0, $zero, 8
-	tmp0 <<= tmp2; // sllv    $t0, $t0, $t2
-	var1 = var0 - tmp0; // subu    $v1, $v0, $t0
-	tmp3 = var0 << tmp2; // sllv    $t3, $v0, $t2
-	var1 >>= tmp2; // srlv    $v1, $v1, $t2
-	ta = tmp0 << 3; // sll     $at, $t0, 3
-	arg1 += ta; // addu    $a1, $a1, $at
-	ta = tmp1 - var1; // subu    $at, $t1, $v1
-	arg0->MC_Chroma(arg1, arg2, arg3, tmp3, var1, ta); // jr      $t5
-	// addiu   $sp, $sp, 16
-}
-
-
-static inline void set_mtsab_to_value(int value)
-{
-	if (value == 1)
-	{
-		// XXX: mtsab difference?
-#if 1
-		__asm__ volatile
-		(
-			"mtsab   $zero, 1\n"
-		);
-#else
-		int tmp;
-		__asm__ volatile
-		(
-			"addiu   %[tmp], $zero, 1\n"
-			"mtsab   %[tmp], 0\n"
-			: [tmp] "=r"(tmp)
-		);
-#endif
-	}
-	else
-	{
-		int tmp = value;
-		__asm__ volatile
-		(
-			"mtsab   %[tmp], 0\n"
-			:
-			: [tmp] "r"(tmp)
-		);
-	}
-}
-
-void _MPEG_put_luma(u8 *a1, u16 *a2, int a3, int a4, int var1, int ta)
-{
-	int count;
-	int count2;
-	u8 *m_pSrc;
-	u16 *m_pDstY;
-	u128 reg1, reg2;
-
-	count = var1;
-	count2 = ta;
-	m_pSrc = a1;
-	m_pDstY = a2;
-	set_mtsab_to_value(a3);
-	do
-	{
-		do
-		{
-			reg1 = ((u128 *)m_pSrc)[0x00];
-			reg2 = ((u128 *)m_pSrc)[0x18];
-			m_pSrc += a4;
-			count -= 1;
-			__asm__
-			(
-				"qfsrv   %[reg1], %[reg2], %[reg1]\n"
-				"pextlb  %[reg2], $zero, %[reg1]\n"
-				"pextub  %[reg1], $zero, %[reg1]\n"
-				: [reg1] "+r"(reg1), [reg2] "+r"(reg2)
-			);
-			((u128 *)m_pDstY)[0x00] = reg2;
-			((u128 *)m_pDstY)[0x01] = reg1;
-		}
-		while ( count > 0 );
-		m_pDstY += 16;
-		count = count2;
-		m_pSrc += 512;
-	}
-	while ( count2 > 0 );
-}
-
-void _MPEG_put_chroma(u8 *a1, u16 *a2, int a3, int a4, int var1, int ta)
-{
-	int count;
-	int count2;
-	u8 *m_pSrc;
-	u16 *m_pDstCbCr;
-	u128 reg1, reg2, reg3, reg4;
-
-	count = var1;
-	count2 = ta;
-	m_pSrc = a1;
-	m_pDstCbCr = a2;
-	set_mtsab_to_value(a3);
-	do
-	{
-		do
-		{
-			reg1 = ((u64 *)m_pSrc)[0x00];
-			reg2 = ((u64 *)m_pSrc)[0x01];
-			reg3 = ((u64 *)m_pSrc)[0x06];
-			reg4 = ((u64 *)m_pSrc)[0x07];
-			m_pSrc += a4;
-			count -= 1;
-			__asm__
-			(
-				"pcpyld  %[reg1], %[reg3], %[reg1]\n"
-				"pcpyld  %[reg2], %[reg4], %[reg2]\n"
-				"qfsrv   %[reg1], %[reg1], %[reg1]\n"
-				"qfsrv   %[reg2], %[reg2], %[reg2]\n"
-				"pextlb  %[reg1], $zero, %[reg1]\n"
-				"pextlb  %[reg2], $zero, %[reg2]\n"
-				: [reg1] "+r"(reg1), [reg2] "+r"(reg2)
-				: [reg3] "r"(reg3), [reg4] "r"(reg4)
-			);
-			((u128 *)m_pDstCbCr)[0x00] = reg1;
-			((u128 *)m_pDstCbCr)[0x08] = reg2;
-		}
-		while ( count > 0 );
-		m_pDstCbCr += 8;
-		count = count2;
-		m_pSrc += 704;
-	}
-	while ( count2 > 0 );
-}
-
-void _MPEG_put_luma_X(u8 *a1, u16 *a2, int a3, int a4, int var1, int ta)
-{
-	int count;
-	int count2;
-	u8 *m_pSrc;
-	u16 *m_pDstY;
-	u128 reg1, reg2, reg3, reg4, reg5;
-
-	count = var1;
-	count2 = ta;
-	m_pSrc = a1;
-	m_pDstY = a2;
-	__asm__
-	(
-		"pnor    %[reg1], $zero, $zero\n"
-		"psrlh   %[reg1], %[reg1], 0xF\n"
-		: [reg1] "=r"(reg1)
-	);
-	do
-	{
-		do
-		{
-			reg2 = ((u128 *)m_pSrc)[0x00];
-			reg3 = ((u128 *)m_pSrc)[0x18];
-			set_mtsab_to_value(a3);
-			__asm__
-			(
-				"qfsrv   %[reg4], %[reg3], %[reg2]\n"
-				"qfsrv   %[reg5], %[reg2], %[reg3]\n"
-				"pextlb  %[reg2], $zero, %[reg4]\n"
-				"pextub  %[reg3], $zero, %[reg4]\n"
-				: [reg2] "+r"(reg2), [reg3] "+r"(reg3), [reg4] "=r"(reg4), [reg5] "=r"(reg5)
-			);
-			m_pSrc += a4;
-			set_mtsab_to_value(1);
-			count -= 1;
-			__asm__
-			(
-				"qfsrv   %[reg5], %[reg5], %[reg4]\n"
-				"pextlb  %[reg4], $zero, %[reg5]\n"
-				"pextub  %[reg5], $zero, %[reg5]\n"
-				"paddh   %[reg2], %[reg2], %[reg4]\n"
-				"paddh   %[reg3], %[reg3], %[reg5]\n"
-				"paddh   %[reg2], %[reg2], %[reg1]\n"
-				"paddh   %[reg3], %[reg3], %[reg1]\n"
-				"psrlh   %[reg2], %[reg2], 1\n"
-				"psrlh   %[reg3], %[reg3], 1\n"
-				: [reg2] "+r"(reg2), [reg3] "+r"(reg3), [reg4] "+r"(reg4), [reg5] "+r"(reg5)
-				: [reg1] "r"(reg1)
-			);
-			((u128 *)m_pDstY)[0x00] = reg2;
-			((u128 *)m_pDstY)[0x01] = reg3;
-		}
-		while ( count > 0 );
-		m_pDstY += 16;
-		count = count2;
-		m_pSrc += 512;
-	}
-	while ( count2 > 0 );
-}
-
-void _MPEG_put_chroma_X(u8 *a1, u16 *a2, int a3, int a4, int var1, int ta)
-{
-	int count;
-	int count2;
-	u8 *m_pSrc;
-	u16 *m_pDstCbCr;
-	u128 reg1, reg2, reg3, reg4, reg5, reg6, reg7;
-
-	count = var1;
-	count2 = ta;
-	m_pSrc = a1;
-	m_pDstCbCr = a2;
-	__asm__
-	(
-		"pnor    %[reg1], $zero, $zero\n"
-		"psrlh   %[reg1], %[reg1], 0xF\n"
-		: [reg1] "=r"(reg1)
-	);
-	do
-	{
-		do
-		{
-			reg2 = ((u64 *)m_pSrc)[0x00];
-			reg3 = ((u64 *)m_pSrc)[0x01];
-			reg4 = ((u64 *)m_pSrc)[0x06];
-			reg5 = ((u64 *)m_pSrc)[0x07];
-			__asm__
-			(
-				"pcpyld  %[reg2], %[reg4], %[reg2]\n"
-				"pcpyld  %[reg3], %[reg5], %[reg3]\n"
-				: [reg2] "+r"(reg2), [reg3] "+r"(reg3), [reg4] "+r"(reg4), [reg5] "+r"(reg5)
-			);
-			set_mtsab_to_value(a3);
-			__asm__
-			(
-				"qfsrv   %[reg2], %[reg2], %[reg2]\n"
-				"qfsrv   %[reg3], %[reg3], %[reg3]\n"
-				: [reg2] "+r"(reg2), [reg3] "+r"(reg3)
-			);
-			m_pSrc += a4;
-			count -= 1;
-			set_mtsab_to_value(1);
-			__asm__
-			(
-				"qfsrv   %[reg7], %[reg2], %[reg2]\n"
-				"qfsrv   %[reg6], %[reg3], %[reg3]\n"
-				"pextlb  %[reg2], $zero, %[reg2]\n"
-				"pextlb  %[reg3], $zero, %[reg3]\n"
-				"pextlb  %[reg7], $zero, %[reg7]\n"
-				"pextlb  %[reg6], $zero, %[reg6]\n"
-				"paddh   %[reg2], %[reg2], %[reg7]\n"
-				"paddh   %[reg3], %[reg3], %[reg6]\n"
-				"paddh   %[reg2], %[reg2], %[reg1]\n"
-				"paddh   %[reg3], %[reg3], %[reg1]\n"
-				"psrlh   %[reg2], %[reg2], 1\n"
-				"psrlh   %[reg3], %[reg3], 1\n"
-				: [reg2] "+r"(reg2), [reg3] "+r"(reg3), [reg6] "=r"(reg6), [reg7] "=r"(reg7)
-				: [reg1] "r"(reg1)
-			);
-			((u128 *)m_pDstCbCr)[0x00] = reg2;
-			((u128 *)m_pDstCbCr)[0x08] = reg3;
-		}
-		while ( count > 0 );
-		m_pDstCbCr += 8;
-		count = count2;
-		m_pSrc += 704;
-	}
-	while ( count2 > 0 );
-}
-
-void _MPEG_put_luma_Y(u8 *a1, u16 *a2, int a3, int a4, int var1, int ta)
-{
-	int count;
-	int count2;
-	u8 *m_pSrc;
-	u16 *m_pDstY;
-	u128 reg1, reg2, reg3, reg4, reg5, reg6;
-
-	count = var1;
-	count2 = ta;
-	m_pSrc = a1;
-	m_pDstY = a2;
-	set_mtsab_to_value(a3);
-	reg5 = ((u128 *)m_pSrc)[0x00];
-	reg6 = ((u128 *)m_pSrc)[0x18];
-	m_pSrc = &m_pSrc[a4];
-	count -= 1;
-	__asm__
-	(
-		"qfsrv   %[reg5], %[reg6], %[reg5]\n"
-		"pextub  %[reg6], $zero, %[reg5]\n"
-		"pextlb  %[reg5], $zero, %[reg5]\n"
-		: [reg5] "+r"(reg5), [reg6] "+r"(reg6)
-	);
-	if ( !count )
-		goto LABEL_5;
-	count2 += 1;
-	do
-	{
-		do
-		{
-			reg3 = ((u128 *)m_pSrc)[0x00];
-			reg4 = ((u128 *)m_pSrc)[0x18];
-			m_pSrc += a4;
-			count -= 1;
-			__asm__
-			(
-				"qfsrv   %[reg3], %[reg4], %[reg3]\n"
-				"pextub  %[reg4], $zero, %[reg3]\n"
-				"pextlb  %[reg3], $zero, %[reg3]\n"
-				"paddh   %[reg2], %[reg4], %[reg6]\n"
-				"pnor    %[reg6], $zero, $zero\n"
-				"paddh   %[reg1], %[reg3], %[reg5]\n"
-				"psrlh   %[reg6], %[reg6], 0xF\n"
-				"por     %[reg5], $zero, %[reg3]\n"
-				"paddh   %[reg1], %[reg1], %[reg6]\n"
-				"paddh   %[reg2], %[reg2], %[reg6]\n"
-				"por     %[reg6], $zero, %[reg4]\n"
-				"psrlh   %[reg1], %[reg1], 1\n"
-				"psrlh   %[reg2], %[reg2], 1\n"
-				: [reg1] "=r"(reg1), [reg2] "=r"(reg2), [reg3] "+r"(reg3), [reg4] "+r"(reg4), [reg5] "+r"(reg5), [reg6] "+r"(reg6)
-			);
-			((u128 *)m_pDstY)[0x00] = reg1;
-			((u128 *)m_pDstY)[0x01] = reg2;
-		}
-		while ( count > 0 );
-		m_pDstY += 16;
-LABEL_5:
-		count = count2;
-		m_pSrc += 512;
-	}
-	while ( count2 > 0 );
-}
-
-void _MPEG_put_chroma_Y(u8 *a1, u16 *a2, int a3, int a4, int var1, int ta)
-{
-	int count;
-	int count2;
-	u8 *m_pSrc;
-	u16 *m_pDstCbCr;
-	u128 reg1, reg2, reg3, reg4, reg5, reg6, reg7, reg8, reg9, regA;
-
-	count = var1;
-	count2 = ta;
-	m_pSrc = a1;
-	m_pDstCbCr = a2;
-	set_mtsab_to_value(a3);
-	reg2 = ((u64 *)m_pSrc)[0x00];
-	reg3 = ((u64 *)m_pSrc)[0x01];
-	regA = ((u64 *)m_pSrc)[0x06];
-	reg9 = ((u64 *)m_pSrc)[0x07];
-	__asm__
-	(
-		"pnor    %[reg1], $zero, $zero\n"
-		: [reg1] "=r"(reg1)
-	);
-	m_pSrc = &m_pSrc[a4];
-	count -= 1;
-	__asm__
-	(
-		"psrlh   %[reg1], %[reg1], 0xF\n"
-		"pcpyld  %[reg2], %[regA], %[reg2]\n"
-		"pcpyld  %[reg3], %[reg9], %[reg3]\n"
-		"qfsrv   %[reg2], %[reg2], %[reg2]\n"
-		"qfsrv   %[reg3], %[reg3], %[reg3]\n"
-		"pextlb  %[reg2], $zero, %[reg2]\n"
-		"pextlb  %[reg3], $zero, %[reg3]\n"
-		: [reg1] "+r"(reg1), [reg2] "+r"(reg2), [reg3] "+r"(reg3), [reg9] "+r"(reg9), [regA] "+r"(regA)
-	);
-	if ( !count )
-		goto LABEL_5;
-	count2 += 1;
-	do
-	{
-		do
-		{
-			reg4 = ((u64 *)m_pSrc)[0x00];
-			reg5 = ((u64 *)m_pSrc)[0x01];
-			reg6 = ((u64 *)m_pSrc)[0x06];
-			reg7 = ((u64 *)m_pSrc)[0x07];
-			m_pSrc += a4;
-			count -= 1;
-			__asm__
-			(
-				"pcpyld  %[reg4], %[reg6], %[reg4]\n"
-				"pcpyld  %[reg5], %[reg7], %[reg5]\n"
-				"qfsrv   %[reg4], %[reg4], %[reg4]\n"
-				"qfsrv   %[reg5], %[reg5], %[reg5]\n"
-				"pextlb  %[reg4], $zero, %[reg4]\n"
-				"pextlb  %[reg5], $zero, %[reg5]\n"
-				"paddh   %[reg9], %[reg4], %[reg2]\n"
-				"paddh   %[reg8], %[reg5], %[reg3]\n"
-				"por     %[reg2], $zero, %[reg4]\n"
-				"por     %[reg3], $zero, %[reg5]\n"
-				"paddh   %[reg9], %[reg9], %[reg1]\n"
-				"paddh   %[reg8], %[reg8], %[reg1]\n"
-				"psrlh   %[reg9], %[reg9], 1\n"
-				"psrlh   %[reg8], %[reg8], 1\n"
-				: [reg2] "+r"(reg2), [reg3] "+r"(reg3), [reg4] "+r"(reg4), [reg5] "+r"(reg5), [reg8] "=r"(reg8), [reg9] "=r"(reg9)
-				: [reg1] "r"(reg1), [reg6] "r"(reg6), [reg7] "r"(reg7)
-			);
-			((u128 *)m_pDstCbCr)[0x00] = reg9;
-			((u128 *)m_pDstCbCr)[0x08] = reg8;
-		}
-		while ( count > 0 );
-		m_pDstCbCr += 8;
-LABEL_5:
-		count = count2;
-		m_pSrc += 704;
-	}
-	while ( count2 > 0 );
-}
-
-void _MPEG_put_luma_XY(u8 *a1, u16 *a2, int a3, int a4, int var1, int ta)
-{
-	int count;
-	int count2;
-	u8 *m_pSrc;
-	u16 *m_pDstY;
-	u128 reg1, reg2, reg3, reg4, reg5, reg6;
-
-	count = var1;
-	count2 = ta;
-	m_pSrc = a1;
-	m_pDstY = a2;
-	set_mtsab_to_value(a3);
-	reg2 = ((u128 *)m_pSrc)[0x00];
-	reg5 = ((u128 *)m_pSrc)[0x18];
-	m_pSrc = &m_pSrc[a4];
-	__asm__
-	(
-		"qfsrv   %[reg6], %[reg5], %[reg2]\n"
-		"qfsrv   %[reg1], %[reg2], %[reg5]\n"
-		: [reg1] "=r"(reg1), [reg6] "=r"(reg6)
-		: [reg2] "r"(reg2), [reg5] "r"(reg5)
-	);
-	count -= 1;
-	__asm__
-	(
-		"pextlb  %[reg2], $zero, %[reg6]\n"
-		"pextub  %[reg5], $zero, %[reg6]\n"
-		: [reg2] "+r"(reg2), [reg5] "+r"(reg5)
-		: [reg6] "r"(reg6)
-	);
-	set_mtsab_to_value(1);
-	__asm__
-	(
-		"qfsrv   %[reg1], %[reg1], %[reg6]\n"
-		"pextlb  %[reg6], $zero, %[reg1]\n"
-		"pextub  %[reg1], $zero, %[reg1]\n"
-		"paddh   %[reg2], %[reg2], %[reg6]\n"
-		"paddh   %[reg5], %[reg5], %[reg1]\n"
-		: [reg1] "+r"(reg1), [reg2] "+r"(reg2), [reg5] "+r"(reg5), [reg6] "+r"(reg6)
-	);
-	if ( !count )
-		goto LABEL_5;
-	count2 += 1;
-	do
-	{
-		do
-		{
-			reg3 = ((u128 *)m_pSrc)[0x00];
-			reg4 = ((u128 *)m_pSrc)[0x18];
-			set_mtsab_to_value(a3);
-			m_pSrc += a4;
-			__asm__
-			(
-				"qfsrv   %[reg6], %[reg4], %[reg3]\n"
-				"qfsrv   %[reg1], %[reg3], %[reg4]\n"
-				: [reg1] "+r"(reg1), [reg6] "+r"(reg6)
-				: [reg3] "r"(reg3), [reg4] "r"(reg4)
-			);
-			count -= 1;
-			__asm__
-			(
-				"pextlb  %[reg3], $zero, %[reg6]\n"
-				"pextub  %[reg4], $zero, %[reg6]\n"
-				: [reg3] "=r"(reg3), [reg4] "=r"(reg4)
-				: [reg6] "r"(reg6)
-			);
-			set_mtsab_to_value(1);
-			__asm__
-			(
-				"qfsrv   %[reg1], %[reg1], %[reg6]\n"
-				"pextlb  %[reg6], $zero, %[reg1]\n"
-				"pextub  %[reg1], $zero, %[reg1]\n"
-				"paddh   %[reg3], %[reg3], %[reg6]\n"
-				"paddh   %[reg4], %[reg4], %[reg1]\n"
-				"paddh   %[reg6], %[reg2], %[reg3]\n"
-				"paddh   %[reg1], %[reg5], %[reg4]\n"
-				"por     %[reg2], $zero, %[reg3]\n"
-				"pnor    %[reg3], $zero, $zero\n"
-				"por     %[reg5], $zero, %[reg4]\n"
-				"psrlh   %[reg3], %[reg3], 0xF\n"
-				"psllh   %[reg3], %[reg3], 1\n"
-				"paddh   %[reg6], %[reg6], %[reg3]\n"
-				"paddh   %[reg1], %[reg1], %[reg3]\n"
-				"psrlh   %[reg6], %[reg6], 2\n"
-				"psrlh   %[reg1], %[reg1], 2\n"
-				: [reg1] "+r"(reg1), [reg2] "+r"(reg2), [reg3] "+r"(reg3), [reg4] "+r"(reg4), [reg5] "+r"(reg5), [reg6] "+r"(reg6)
-			);
-			((u128 *)m_pDstY)[0x00] = reg6;
-			((u128 *)m_pDstY)[0x01] = reg1;
-		}
-		while ( count > 0 );
-		m_pDstY += 16;
-LABEL_5:
-		count = count2;
-		m_pSrc += 512;
-	}
-	while ( count2 > 0 );
-}
-
-void _MPEG_put_chroma_XY(u8 *a1, u16 *a2, int a3, int a4, int var1, int ta)
-{
-	int count;
-	int count2;
-	u8 *m_pSrc;
-	u16 *m_pDstCbCr;
-	u128 reg1, reg2, reg3, reg4, reg5, reg6, reg7, reg8, reg9;
-
-	count = var1;
-	count2 = ta;
-	m_pSrc = a1;
-	m_pDstCbCr = a2;
-	set_mtsab_to_value(a3);
-	__asm__
-	(
-		"pnor    %[reg1], $zero, $zero\n"
-		: [reg1] "=r"(reg1)
-	);
-	reg3 = ((u64 *)m_pSrc)[0x00];
-	reg2 = ((u64 *)m_pSrc)[0x01];
-	set_mtsab_to_value(1);
-	reg9 = ((u64 *)m_pSrc)[0x06];
-	reg8 = ((u64 *)m_pSrc)[0x07];
-	__asm__
-	(
-		"pcpyld  %[reg3], %[reg9], %[reg3]\n"
-		"pcpyld  %[reg2], %[reg8], %[reg2]\n"
-		"qfsrv   %[reg3], %[reg3], %[reg3]\n"
-		"qfsrv   %[reg2], %[reg2], %[reg2]\n"
-		"psrlh   %[reg1], %[reg1], 0xF\n"
-		"psllh   %[reg1], %[reg1], 1\n"
-		: [reg1] "+r"(reg1), [reg2] "+r"(reg2), [reg3] "+r"(reg3)
-		: [reg8] "r"(reg8), [reg9] "r"(reg9)
-	);
-	m_pSrc = &m_pSrc[a4];
-	count -= 1;
-	__asm__
-	(
-		"qfsrv   %[reg9], %[reg3], %[reg3]\n"
-		"qfsrv   %[reg8], %[reg2], %[reg2]\n"
-		"pextlb  %[reg3], $zero, %[reg3]\n"
-		"pextlb  %[reg2], $zero, %[reg2]\n"
-		"pextlb  %[reg9], $zero, %[reg9]\n"
-		"pextlb  %[reg8], $zero, %[reg8]\n"
-		"paddh   %[reg3], %[reg3], %[reg9]\n"
-		"paddh   %[reg9], %[reg2], %[reg8]\n"
-		: [reg2] "+r"(reg2), [reg3] "+r"(reg3), [reg8] "+r"(reg8), [reg9] "+r"(reg9)
-	);
-	if ( !count )
-		goto LABEL_5;
-	count2 += 1;
-	do
-	{
-		do
-		{
-			reg4 = ((u64 *)m_pSrc)[0x00];
-			reg6 = ((u64 *)m_pSrc)[0x01];
-			set_mtsab_to_value(a3);
-			reg5 = ((u64 *)m_pSrc)[0x06];
-			reg7 = ((u64 *)m_pSrc)[0x07];
-			__asm__
-			(
-				"pcpyld  %[reg4], %[reg5], %[reg4]\n"
-				"pcpyld  %[reg6], %[reg7], %[reg6]\n"
-				"qfsrv   %[reg4], %[reg4], %[reg4]\n"
-				"qfsrv   %[reg6], %[reg6], %[reg6]\n"
-				: [reg4] "+r"(reg4), [reg6] "+r"(reg6)
-				: [reg5] "r"(reg5), [reg7] "r"(reg7)
-			);
-			m_pSrc += a4;
-			count -= 1;
-			set_mtsab_to_value(1);
-			__asm__
-			(
-				"qfsrv   %[reg5], %[reg4], %[reg4]\n"
-				"qfsrv   %[reg7], %[reg6], %[reg6]\n"
-				"pextlb  %[reg4], $zero, %[reg4]\n"
-				"pextlb  %[reg6], $zero, %[reg6]\n"
-				"pextlb  %[reg5], $zero, %[reg5]\n"
-				"pextlb  %[reg7], $zero, %[reg7]\n"
-				"paddh   %[reg4], %[reg4], %[reg5]\n"
-				"paddh   %[reg5], %[reg6], %[reg7]\n"
-				"paddh   %[reg6], %[reg3], %[reg4]\n"
-				"paddh   %[reg7], %[reg9], %[reg5]\n"
-				"por     %[reg3], $zero, %[reg4]\n"
-				"por     %[reg9], $zero, %[reg5]\n"
-				"paddh   %[reg6], %[reg6], %[reg1]\n"
-				"paddh   %[reg7], %[reg7], %[reg1]\n"
-				"psrlh   %[reg6], %[reg6], 2\n"
-				"psrlh   %[reg7], %[reg7], 2\n"
-				: [reg3] "+r"(reg3), [reg4] "+r"(reg4), [reg5] "+r"(reg5), [reg6] "+r"(reg6), [reg7] "+r"(reg7), [reg9] "+r"(reg9)
-				: [reg1] "r"(reg1)
-			);
-			((u128 *)m_pDstCbCr)[0x00] = reg6;
-			((u128 *)m_pDstCbCr)[0x08] = reg7;
-		}
-		while ( count > 0 );
-		m_pDstCbCr += 8;
-LABEL_5:
-		count = count2;
-		m_pSrc += 704;
-	}
-	while ( count2 > 0 );
-}
-
-void _MPEG_avg_luma(u8 *a1, u16 *a2, int a3, int a4, int var1, int ta)
-{
-	int count;
-	int count2;
-	u8 *m_pSrc;
-	u16 *m_pDstY;
-	u128 reg1, reg2, reg3, reg4, reg5, reg6;
-
-	count = var1;
-	count2 = ta;
-	m_pSrc = a1;
-	m_pDstY = a2;
-	set_mtsab_to_value(a3);
-	do
-	{
-		do
-		{
-			reg3 = ((u128 *)m_pSrc)[0x00];
-			reg4 = ((u128 *)m_pSrc)[0x18];
-			m_pSrc += a4;
-			count -= 1;
-			__asm__
-			(
-				"qfsrv   %[reg3], %[reg4], %[reg3]\n"
-				"pextlb  %[reg4], $zero, %[reg3]\n"
-				"pextub  %[reg3], $zero, %[reg3]\n"
-				: [reg3] "+r"(reg3), [reg4] "+r"(reg4)
-			);
-			reg6 = ((u128 *)m_pDstY)[0x00];
-			reg1 = ((u128 *)m_pDstY)[0x01];
-			__asm__
-			(
-				"paddh   %[reg4], %[reg4], %[reg6]\n"
-				"paddh   %[reg3], %[reg3], %[reg1]\n"
-				"pcgth   %[reg6], %[reg4], $zero\n"
-				"pcgth   %[reg1], %[reg3], $zero\n"
-				"pceqh   %[reg2], %[reg4], $zero\n"
-				"pceqh   %[reg5], %[reg3], $zero\n"
-				"psrlh   %[reg6], %[reg6], 0xF\n"
-				"psrlh   %[reg1], %[reg1], 0xF\n"
-				"psrlh   %[reg2], %[reg2], 0xF\n"
-				"psrlh   %[reg5], %[reg5], 0xF\n"
-				"por     %[reg6], %[reg6], %[reg2]\n"
-				"por     %[reg1], %[reg1], %[reg5]\n"
-				"paddh   %[reg4], %[reg4], %[reg6]\n"
-				"paddh   %[reg3], %[reg3], %[reg1]\n"
-				"psrlh   %[reg4], %[reg4], 1\n"
-				"psrlh   %[reg3], %[reg3], 1\n"
-				: [reg1] "+r"(reg1), [reg2] "=r"(reg2), [reg3] "+r"(reg3), [reg4] "+r"(reg4), [reg5] "=r"(reg5), [reg6] "+r"(reg6)
-			);
-			((u128 *)m_pDstY)[0x00] = reg4;
-			((u128 *)m_pDstY)[0x01] = reg3;
-		}
-		while ( count > 0 );
-		m_pDstY += 16;
-		count = count2;
-		m_pSrc += 512;
-	}
-	while ( count2 > 0 );
-}
-
-void _MPEG_avg_chroma(u8 *a1, u16 *a2, int a3, int a4, int var1, int ta)
-{
-	int count;
-	int count2;
-	u8 *m_pSrc;
-	u16 *m_pDstCbCr;
-	u128 reg1, reg2, reg3, reg4, reg5, reg6, reg7, reg8;
-
-	count = var1;
-	count2 = ta;
-	m_pSrc = a1;
-	m_pDstCbCr = a2;
-	set_mtsab_to_value(a3);
-	do
-	{
-		do
-		{
-			reg3 = ((u64 *)m_pSrc)[0x00];
-			reg4 = ((u64 *)m_pSrc)[0x01];
-			count -= 1;
-			reg5 = ((u64 *)m_pSrc)[0x06];
-			reg6 = ((u64 *)m_pSrc)[0x07];
-			m_pSrc += a4;
-			__asm__
-			(
-				"pcpyld  %[reg3], %[reg5], %[reg3]\n"
-				"pcpyld  %[reg4], %[reg6], %[reg4]\n"
-				"qfsrv   %[reg3], %[reg3], %[reg3]\n"
-				"qfsrv   %[reg4], %[reg4], %[reg4]\n"
-				"pextlb  %[reg3], $zero, %[reg3]\n"
-				"pextlb  %[reg4], $zero, %[reg4]\n"
-				: [reg3] "+r"(reg3), [reg4] "+r"(reg4)
-				: [reg5] "r"(reg5), [reg6] "r"(reg6)
-			);
-			reg8 = ((u128 *)m_pDstCbCr)[0x00];
-			reg7 = ((u128 *)m_pDstCbCr)[0x08];
-			__asm__
-			(
-				"paddh   %[reg3], %[reg3], %[reg8]\n"
-				"paddh   %[reg4], %[reg4], %[reg7]\n"
-				"pcgth   %[reg8], %[reg3], $zero\n"
-				"pcgth   %[reg7], %[reg4], $zero\n"
-				"pceqh   %[reg2], %[reg3], $zero\n"
-				"pceqh   %[reg1], %[reg4], $zero\n"
-				"psrlh   %[reg8], %[reg8], 0xF\n"
-				"psrlh   %[reg7], %[reg7], 0xF\n"
-				"psrlh   %[reg2], %[reg2], 0xF\n"
-				"psrlh   %[reg1], %[reg1], 0xF\n"
-				"por     %[reg8], %[reg8], %[reg2]\n"
-				"por     %[reg7], %[reg7], %[reg1]\n"
-				"paddh   %[reg3], %[reg3], %[reg8]\n"
-				"paddh   %[reg4], %[reg4], %[reg7]\n"
-				"psrlh   %[reg3], %[reg3], 1\n"
-				"psrlh   %[reg4], %[reg4], 1\n"
-				: [reg1] "=r"(reg1), [reg2] "=r"(reg2), [reg3] "+r"(reg3), [reg4] "+r"(reg4), [reg7] "+r"(reg7), [reg8] "+r"(reg8)
-			);
-			((u128 *)m_pDstCbCr)[0x00] = reg4;
-			((u128 *)m_pDstCbCr)[0x08] = reg3;
-		}
-		while ( count > 0 );
-		m_pDstCbCr += 8;
-		count = count2;
-		m_pSrc += 704;
-	}
-	while ( count2 > 0 );
-}
-
-void _MPEG_avg_luma_X(u8 *a1, u16 *a2, int a3, int a4, int var1, int ta)
-{
-	int count;
-	int count2;
-	u8 *m_pSrc;
-	u16 *m_pDstY;
-	u128 reg1, reg2, reg3, reg4, reg5, reg6;
-
-	count = var1;
-	count2 = ta;
-	m_pSrc = a1;
-	m_pDstY = a2;
-	__asm__
-	(
-		"pnor    %[reg2], $zero, $zero\n"
-		"psrlh   %[reg2], %[reg2], 0xF\n"
-		: [reg2] "=r"(reg2)
-	);
-	do
-	{
-		do
-		{
-			reg3 = ((u128 *)m_pSrc)[0x00];
-			reg4 = ((u128 *)m_pSrc)[0x18];
-			set_mtsab_to_value(a3);
-			__asm__
-			(
-				"qfsrv   %[reg5], %[reg4], %[reg3]\n"
-				"qfsrv   %[reg6], %[reg3], %[reg4]\n"
-				"pextlb  %[reg3], $zero, %[reg5]\n"
-				"pextub  %[reg4], $zero, %[reg5]\n"
-				: [reg3] "+r"(reg3), [reg4] "+r"(reg4), [reg5] "=r"(reg5), [reg6] "=r"(reg6)
-			);
-			m_pSrc += a4;
-			set_mtsab_to_value(1);
-			count -= 1;
-			__asm__
-			(
-				"qfsrv   %[reg6], %[reg6], %[reg5]\n"
-				"pextlb  %[reg5], $zero, %[reg6]\n"
-				"pextub  %[reg6], $zero, %[reg6]\n"
-				"paddh   %[reg3], %[reg3], %[reg5]\n"
-				"paddh   %[reg4], %[reg4], %[reg6]\n"
-				"paddh   %[reg3], %[reg3], %[reg2]\n"
-				"paddh   %[reg4], %[reg4], %[reg2]\n"
-				"psrlh   %[reg3], %[reg3], 1\n"
-				"psrlh   %[reg4], %[reg4], 1\n"
-				: [reg3] "+r"(reg3), [reg4] "+r"(reg4), [reg5] "+r"(reg5), [reg6] "+r"(reg6)
-				: [reg2] "r"(reg2)
-			);
-			reg6 = ((u128 *)m_pDstY)[0x00];
-			reg1 = ((u128 *)m_pDstY)[0x01];
-			__asm__
-			(
-				"paddh   %[reg3], %[reg3], %[reg6]\n"
-				"paddh   %[reg4], %[reg4], %[reg1]\n"
-				"pcgth   %[reg6], %[reg3], $zero\n"
-				"pceqh   %[reg1], %[reg3], $zero\n"
-				"psrlh   %[reg6], %[reg6], 0xF\n"
-				"psrlh   %[reg1], %[reg1], 0xF\n"
-				"por     %[reg6], %[reg6], %[reg1]\n"
-				"paddh   %[reg3], %[reg3], %[reg6]\n"
-				"pcgth   %[reg6], %[reg4], $zero\n"
-				"pceqh   %[reg1], %[reg4], $zero\n"
-				"psrlh   %[reg6], %[reg6], 0xF\n"
-				"psrlh   %[reg1], %[reg1], 0xF\n"
-				"por     %[reg6], %[reg6], %[reg1]\n"
-				"paddh   %[reg4], %[reg4], %[reg6]\n"
-				"psrlh   %[reg3], %[reg3], 1\n"
-				"psrlh   %[reg4], %[reg4], 1\n"
-				: [reg1] "+r"(reg1), [reg3] "+r"(reg3), [reg4] "+r"(reg4), [reg6] "+r"(reg6)
-			);
-			((u128 *)m_pDstY)[0x00] = reg3;
-			((u128 *)m_pDstY)[0x01] = reg4;
-		}
-		while ( count > 0 );
-		m_pDstY += 16;
-		count = count2;
-		m_pSrc += 512;
-	}
-	while ( count2 > 0 );
-}
-
-void _MPEG_avg_chroma_X(u8 *a1, u16 *a2, int a3, int a4, int var1, int ta)
-{
-	int count;
-	int count2;
-	u8 *m_pSrc;
-	u16 *m_pDstCbCr;
-	u128 reg1, reg2, reg3, reg4, reg5, reg6, reg7, reg8, reg9;
-
-	count = var1;
-	count2 = ta;
-	m_pSrc = a1;
-	m_pDstCbCr = a2;
-	__asm__
-	(
-		"pnor    %[reg2], $zero, $zero\n"
-		"psrlh   %[reg2], %[reg2], 0xF\n"
-		: [reg2] "=r"(reg2)
-	);
-	do
-	{
-		do
-		{
-			reg4 = ((u64 *)m_pSrc)[0x00];
-			reg5 = ((u64 *)m_pSrc)[0x01];
-			set_mtsab_to_value(a3);
-			reg6 = ((u64 *)m_pSrc)[0x06];
-			reg7 = ((u64 *)m_pSrc)[0x07];
-			__asm__
-			(
-				"pcpyld  %[reg4], %[reg6], %[reg4]\n"
-				"pcpyld  %[reg5], %[reg7], %[reg5]\n"
-				"qfsrv   %[reg4], %[reg4], %[reg4]\n"
-				"qfsrv   %[reg5], %[reg5], %[reg5]\n"
-				: [reg4] "+r"(reg4), [reg5] "+r"(reg5)
-				: [reg6] "r"(reg6), [reg7] "r"(reg7)
-			);
-			m_pSrc += a4;
-			count -= 1;
-			set_mtsab_to_value(1);
-			__asm__
-			(
-				"qfsrv   %[reg9], %[reg4], %[reg4]\n"
-				"qfsrv   %[reg8], %[reg5], %[reg5]\n"
-				"pextlb  %[reg4], $zero, %[reg4]\n"
-				"pextlb  %[reg5], $zero, %[reg5]\n"
-				"pextlb  %[reg9], $zero, %[reg9]\n"
-				"pextlb  %[reg8], $zero, %[reg8]\n"
-				"paddh   %[reg4], %[reg4], %[reg9]\n"
-				"paddh   %[reg5], %[reg5], %[reg8]\n"
-				"paddh   %[reg4], %[reg4], %[reg2]\n"
-				"paddh   %[reg5], %[reg5], %[reg2]\n"
-				"psrlh   %[reg4], %[reg4], 1\n"
-				"psrlh   %[reg5], %[reg5], 1\n"
-				: [reg4] "+r"(reg4), [reg5] "+r"(reg5), [reg8] "=r"(reg8), [reg9] "=r"(reg9)
-				: [reg2] "r"(reg2)
-			);
-			reg9 = ((u128 *)m_pDstCbCr)[0x00];
-			reg8 = ((u128 *)m_pDstCbCr)[0x08];
-			__asm__
-			(
-				"paddh   %[reg4], %[reg4], %[reg9]\n"
-				"paddh   %[reg5], %[reg5], %[reg8]\n"
-				"pcgth   %[reg9], %[reg4], $zero\n"
-				"pcgth   %[reg8], %[reg5], $zero\n"
-				"pceqh   %[reg1], %[reg4], $zero\n"
-				"pceqh   %[reg3], %[reg5], $zero\n"
-				"psrlh   %[reg9], %[reg9], 0xF\n"
-				"psrlh   %[reg8], %[reg8], 0xF\n"
-				"psrlh   %[reg1], %[reg1], 0xF\n"
-				"psrlh   %[reg3], %[reg3], 0xF\n"
-				"por     %[reg9], %[reg9], %[reg1]\n"
-				"por     %[reg8], %[reg8], %[reg3]\n"
-				"paddh   %[reg4], %[reg4], %[reg9]\n"
-				"paddh   %[reg5], %[reg5], %[reg8]\n"
-				"psrlh   %[reg4], %[reg4], 1\n"
-				"psrlh   %[reg5], %[reg5], 1\n"
-				: [reg1] "=r"(reg1), [reg3] "=r"(reg3), [reg4] "+r"(reg4), [reg5] "+r"(reg5), [reg8] "+r"(reg8), [reg9] "+r"(reg9)
-			);
-			((u128 *)m_pDstCbCr)[0x00] = reg4;
-			((u128 *)m_pDstCbCr)[0x08] = reg5;
-		}
-		while ( count > 0 );
-		m_pDstCbCr += 8;
-		count = count2;
-		m_pSrc += 704;
-	}
-	while ( count2 > 0 );
-}
-
-void _MPEG_avg_luma_Y(u8 *a1, u16 *a2, int a3, int a4, int var1, int ta)
-{
-	int count;
-	int count2;
-	u8 *m_pSrc;
-	u16 *m_pDstY;
-	u128 reg1, reg2, reg3, reg4, reg5, reg6;
-
-	count = var1;
-	count2 = ta;
-	m_pSrc = a1;
-	m_pDstY = a2;
-	set_mtsab_to_value(a3);
-	reg5 = ((u128 *)m_pSrc)[0x00];
-	reg6 = ((u128 *)m_pSrc)[0x18];
-	m_pSrc = &m_pSrc[a4];
-	count -= 1;
-	__asm__
-	(
-		"qfsrv   %[reg5], %[reg6], %[reg5]\n"
-		"pextub  %[reg6], $zero, %[reg5]\n"
-		"pextlb  %[reg5], $zero, %[reg5]\n"
-		: [reg5] "+r"(reg5), [reg6] "+r"(reg6)
-	);
-	if ( !count )
-		goto LABEL_5;
-	count2 += 1;
-	do
-	{
-		do
-		{
-			reg3 = ((u128 *)m_pSrc)[0x00];
-			reg4 = ((u128 *)m_pSrc)[0x18];
-			m_pSrc += a4;
-			count -= 1;
-			__asm__
-			(
-				"qfsrv   %[reg3], %[reg4], %[reg3]\n"
-				"pextub  %[reg4], $zero, %[reg3]\n"
-				"pextlb  %[reg3], $zero, %[reg3]\n"
-				"paddh   %[reg2], %[reg4], %[reg6]\n"
-				"pnor    %[reg6], $zero, $zero\n"
-				"paddh   %[reg1], %[reg3], %[reg5]\n"
-				"psrlh   %[reg6], %[reg6], 0xF\n"
-				"por     %[reg5], $zero, %[reg3]\n"
-				"paddh   %[reg1], %[reg1], %[reg6]\n"
-				"paddh   %[reg2], %[reg2], %[reg6]\n"
-				"por     %[reg6], $zero, %[reg4]\n"
-				"psrlh   %[reg1], %[reg1], 1\n"
-				"psrlh   %[reg2], %[reg2], 1\n"
-				: [reg1] "=r"(reg1), [reg2] "=r"(reg2), [reg3] "+r"(reg3), [reg4] "+r"(reg4), [reg5] "+r"(reg5), [reg6] "+r"(reg6)
-			);
-			reg3 = ((u128 *)m_pDstY)[0x00];
-			reg4 = ((u128 *)m_pDstY)[0x01];
-			__asm__
-			(
-				"paddh   %[reg1], %[reg1], %[reg3]\n"
-				"paddh   %[reg2], %[reg2], %[reg4]\n"
-				"pcgth   %[reg3], %[reg1], $zero\n"
-				"pceqh   %[reg4], %[reg1], $zero\n"
-				"psrlh   %[reg3], %[reg3], 0xF\n"
-				"psrlh   %[reg4], %[reg4], 0xF\n"
-				"por     %[reg3], %[reg3], %[reg4]\n"
-				"paddh   %[reg1], %[reg1], %[reg3]\n"
-				"pcgth   %[reg3], %[reg2], $zero\n"
-				"pceqh   %[reg4], %[reg2], $zero\n"
-				"psrlh   %[reg3], %[reg3], 0xF\n"
-				"psrlh   %[reg4], %[reg4], 0xF\n"
-				"por     %[reg3], %[reg3], %[reg4]\n"
-				"paddh   %[reg2], %[reg2], %[reg3]\n"
-				"psrlh   %[reg1], %[reg1], 1\n"
-				"psrlh   %[reg2], %[reg2], 1\n"
-				: [reg1] "+r"(reg1), [reg2] "+r"(reg2), [reg3] "+r"(reg3), [reg4] "+r"(reg4)
-			);
-			((u128 *)m_pDstY)[0x00] = reg1;
-			((u128 *)m_pDstY)[0x01] = reg2;
-		}
-		while ( count > 0 );
-		m_pDstY += 16;
-LABEL_5:
-		count = count2;
-		m_pSrc += 512;
-	}
-	while ( count2 > 0 );
-}
-
-void _MPEG_avg_chroma_Y(u8 *a1, u16 *a2, int a3, int a4, int var1, int ta)
-{
-	int count;
-	int count2;
-	u8 *m_pSrc;
-	u16 *m_pDstCbCr;
-	u128 reg1, reg2, reg3, reg4, reg5, reg6, reg7, reg8, reg9, regA;
-
-	count = var1;
-	count2 = ta;
-	m_pSrc = a1;
-	m_pDstCbCr = a2;
-	set_mtsab_to_value(a3);
-	reg2 = ((u64 *)m_pSrc)[0x00];
-	reg3 = ((u64 *)m_pSrc)[0x01];
-	regA = ((u64 *)m_pSrc)[0x06];
-	reg9 = ((u64 *)m_pSrc)[0x07];
-	__asm__
-	(
-		"pnor    %[reg1], $zero, $zero\n"
-		: [reg1] "=r"(reg1)
-	);
-	m_pSrc = &m_pSrc[a4];
-	count -= 1;
-	__asm__
-	(
-		"psrlh   %[reg1], %[reg1], 0xF\n"
-		"pcpyld  %[reg2], %[regA], %[reg2]\n"
-		"pcpyld  %[reg3], %[reg9], %[reg3]\n"
-		"qfsrv   %[reg2], %[reg2], %[reg2]\n"
-		"qfsrv   %[reg3], %[reg3], %[reg3]\n"
-		"pextlb  %[reg2], $zero, %[reg2]\n"
-		"pextlb  %[reg3], $zero, %[reg3]\n"
-		: [reg1] "+r"(reg1), [reg2] "+r"(reg2), [reg3] "+r"(reg3)
-		: [reg9] "r"(reg9), [regA] "r"(regA)
-	);
-	if ( !count )
-		goto LABEL_5;
-	count2 += 1;
-	do
-	{
-		do
-		{
-			reg4 = ((u64 *)m_pSrc)[0x00];
-			reg5 = ((u64 *)m_pSrc)[0x01];
-			count -= 1;
-			reg6 = ((u64 *)m_pSrc)[0x06];
-			reg7 = ((u64 *)m_pSrc)[0x07];
-			m_pSrc += a4;
-			__asm__
-			(
-				"pcpyld  %[reg4], %[reg6], %[reg4]\n"
-				"pcpyld  %[reg5], %[reg7], %[reg5]\n"
-				"qfsrv   %[reg4], %[reg4], %[reg4]\n"
-				"qfsrv   %[reg5], %[reg5], %[reg5]\n"
-				"pextlb  %[reg4], $zero, %[reg4]\n"
-				"pextlb  %[reg5], $zero, %[reg5]\n"
-				"paddh   %[reg9], %[reg4], %[reg2]\n"
-				"paddh   %[reg8], %[reg5], %[reg3]\n"
-				"por     %[reg2], $zero, %[reg4]\n"
-				"por     %[reg3], $zero, %[reg5]\n"
-				"paddh   %[reg9], %[reg9], %[reg1]\n"
-				"paddh   %[reg8], %[reg8], %[reg1]\n"
-				"psrlh   %[reg9], %[reg9], 1\n"
-				"psrlh   %[reg8], %[reg8], 1\n"
-				: [reg2] "+r"(reg2), [reg3] "+r"(reg3), [reg4] "+r"(reg4), [reg5] "+r"(reg5), [reg8] "=r"(reg8), [reg9] "=r"(reg9)
-				: [reg1] "r"(reg1), [reg6] "r"(reg6), [reg7] "r"(reg7)
-			);
-			reg4 = ((u128 *)m_pDstCbCr)[0x00];
-			reg5 = ((u128 *)m_pDstCbCr)[0x80];
-			__asm__
-			(
-				"paddh   %[reg9], %[reg9], %[reg4]\n"
-				"paddh   %[reg8], %[reg8], %[reg5]\n"
-				"pcgth   %[reg4], %[reg9], $zero\n"
-				"pceqh   %[reg5], %[reg9], $zero\n"
-				"psrlh   %[reg4], %[reg4], 0xF\n"
-				"psrlh   %[reg5], %[reg5], 0xF\n"
-				"por     %[reg4], %[reg4], %[reg5]\n"
-				"paddh   %[reg9], %[reg9], %[reg4]\n"
-				"pcgth   %[reg4], %[reg8], $zero\n"
-				"pceqh   %[reg5], %[reg8], $zero\n"
-				"psrlh   %[reg4], %[reg4], 0xF\n"
-				"psrlh   %[reg5], %[reg5], 0xF\n"
-				"por     %[reg4], %[reg4], %[reg5]\n"
-				"paddh   %[reg8], %[reg8], %[reg4]\n"
-				"psrlh   %[reg9], %[reg9], 1\n"
-				"psrlh   %[reg8], %[reg8], 1\n"
-				: [reg4] "+r"(reg4), [reg5] "+r"(reg5), [reg8] "+r"(reg8), [reg9] "+r"(reg9)
-			);
-			((u128 *)m_pDstCbCr)[0x00] = reg9;
-			((u128 *)m_pDstCbCr)[0x08] = reg8;
-		}
-		while ( count > 0 );
-		m_pDstCbCr += 8;
-LABEL_5:
-		count = count2;
-		m_pSrc += 704;
-	}
-	while ( count2 > 0 );
-}
-
-void _MPEG_avg_luma_XY(u8 *a1, u16 *a2, int a3, int a4, int var1, int ta)
-{
-	int count;
-	int count2;
-	u8 *m_pSrc;
-	u16 *m_pDstY;
-	u128 reg1, reg2, reg3, reg4, reg5, reg6;
-
-	count = var1;
-	count2 = ta;
-	m_pSrc = a1;
-	m_pDstY = a2;
-	set_mtsab_to_value(a3);
-	reg2 = ((u128 *)m_pSrc)[0x00];
-	reg5 = ((u128 *)m_pSrc)[0x18];
-	m_pSrc = &m_pSrc[a4];
-	__asm__
-	(
-		"qfsrv   %[reg6], %[reg5], %[reg2]\n"
-		"qfsrv   %[reg1], %[reg2], %[reg5]\n"
-		: [reg1] "=r"(reg1), [reg6] "=r"(reg6)
-		: [reg2] "r"(reg2), [reg5] "r"(reg5)
-	);
-	count -= 1;
-	__asm__
-	(
-		"pextlb  %[reg2], $zero, %[reg6]\n"
-		"pextub  %[reg5], $zero, %[reg6]\n"
-		: [reg2] "+r"(reg2), [reg5] "+r"(reg5)
-		: [reg6] "r"(reg6)
-	);
-	set_mtsab_to_value(1);
-	__asm__
-	(
-		"qfsrv   %[reg1], %[reg1], %[reg6]\n"
-		"pextlb  %[reg6], $zero, %[reg1]\n"
-		"pextub  %[reg1], $zero, %[reg1]\n"
-		"paddh   %[reg2], %[reg2], %[reg6]\n"
-		"paddh   %[reg5], %[reg5], %[reg1]\n"
-		: [reg1] "+r"(reg1), [reg2] "+r"(reg2), [reg5] "+r"(reg5), [reg6] "+r"(reg6)
-	);
-	if ( !count )
-		goto LABEL_5;
-	count2 += 1;
-	do
-	{
-		do
-		{
-			reg3 = ((u128 *)m_pSrc)[0x00];
-			reg4 = ((u128 *)m_pSrc)[0x18];
-			set_mtsab_to_value(a3);
-			m_pSrc += a4;
-			__asm__
-			(
-				"qfsrv   %[reg6], %[reg4], %[reg3]\n"
-				"qfsrv   %[reg1], %[reg3], %[reg4]\n"
-				: [reg1] "=r"(reg1), [reg6] "=r"(reg6)
-				: [reg3] "r"(reg3), [reg4] "r"(reg4)
-			);
-			count -= 1;
-			__asm__
-			(
-				"pextlb  %[reg3], $zero, %[reg6]\n"
-				"pextub  %[reg4], $zero, %[reg6]\n"
-				: [reg3] "=r"(reg3), [reg4] "=r"(reg4)
-				: [reg6] "r"(reg6)
-			);
-			set_mtsab_to_value(1);
-			__asm__
-			(
-				"qfsrv   %[reg1], %[reg1], %[reg6]\n"
-				"pextlb  %[reg6], $zero, %[reg1]\n"
-				"pextub  %[reg1], $zero, %[reg1]\n"
-				"paddh   %[reg3], %[reg3], %[reg6]\n"
-				"paddh   %[reg4], %[reg4], %[reg1]\n"
-				"paddh   %[reg6], %[reg2], %[reg3]\n"
-				"paddh   %[reg1], %[reg5], %[reg4]\n"
-				"por     %[reg2], $zero, %[reg3]\n"
-				"pnor    %[reg3], $zero, $zero\n"
-				"por     %[reg5], $zero, %[reg4]\n"
-				"psrlh   %[reg3], %[reg3], 0xF\n"
-				"psllh   %[reg3], %[reg3], 1\n"
-				"paddh   %[reg6], %[reg6], %[reg3]\n"
-				"paddh   %[reg1], %[reg1], %[reg3]\n"
-				"psrlh   %[reg6], %[reg6], 2\n"
-				"psrlh   %[reg1], %[reg1], 2\n"
-				: [reg1] "+r"(reg1), [reg2] "+r"(reg2), [reg3] "+r"(reg3), [reg4] "+r"(reg4), [reg5] "+r"(reg5), [reg6] "+r"(reg6)
-			);
-			reg3 = ((u128 *)m_pDstY)[0x00];
-			reg4 = ((u128 *)m_pDstY)[0x01];
-			__asm__
-			(
-				"paddh   %[reg6], %[reg6], %[reg3]\n"
-				"paddh   %[reg1], %[reg1], %[reg4]\n"
-				"pcgth   %[reg3], %[reg6], $zero\n"
-				"pceqh   %[reg4], %[reg6], $zero\n"
-				"psrlh   %[reg3], %[reg3], 0xF\n"
-				"psrlh   %[reg4], %[reg4], 0xF\n"
-				"por     %[reg3], %[reg3], %[reg4]\n"
-				"paddh   %[reg6], %[reg6], %[reg3]\n"
-				"pcgth   %[reg3], %[reg1], $zero\n"
-				"pceqh   %[reg4], %[reg1], $zero\n"
-				"psrlh   %[reg3], %[reg3], 0xF\n"
-				"psrlh   %[reg4], %[reg4], 0xF\n"
-				"por     %[reg3], %[reg3], %[reg4]\n"
-				"paddh   %[reg1], %[reg1], %[reg3]\n"
-				"psrlh   %[reg6], %[reg6], 1\n"
-				"psrlh   %[reg1], %[reg1], 1\n"
-				: [reg1] "+r"(reg1), [reg3] "+r"(reg3), [reg4] "+r"(reg4), [reg6] "+r"(reg6)
-			);
-			((u128 *)m_pDstY)[0x00] = reg6;
-			((u128 *)m_pDstY)[0x01] = reg1;
-		}
-		while ( count > 0 );
-		m_pDstY += 16;
-LABEL_5:
-		count = count2;
-		m_pSrc += 512;
-	}
-	while ( count2 > 0 );
-}
-
-void _MPEG_avg_chroma_XY(u8 *a1, u16 *a2, int a3, int a4, int var1, int ta)
-{
-	int count;
-	int count2;
-	u8 *m_pSrc;
-	u16 *m_pDstCbCr;
-	u128 reg1, reg2, reg3, reg4, reg5, reg6, reg7, reg8, reg9;
-
-	count = var1;
-	count2 = ta;
-	m_pSrc = a1;
-	m_pDstCbCr = a2;
-	set_mtsab_to_value(a3);
-	__asm__
-	(
-		"pnor    %[reg1], $zero, $zero\n"
-		: [reg1] "=r"(reg1)
-	);
-	reg3 = ((u64 *)m_pSrc)[0x00];
-	reg2 = ((u64 *)m_pSrc)[0x01];
-	set_mtsab_to_value(1);
-	reg9 = ((u64 *)m_pSrc)[0x06];
-	reg8 = ((u64 *)m_pSrc)[0x07];
-	__asm__
-	(
-		"pcpyld  %[reg3], %[reg9], %[reg3]\n"
-		"pcpyld  %[reg2], %[reg8], %[reg2]\n"
-		"qfsrv   %[reg3], %[reg3], %[reg3]\n"
-		"qfsrv   %[reg2], %[reg2], %[reg2]\n"
-		"psrlh   %[reg1], %[reg1], 0xF\n"
-		"psllh   %[reg1], %[reg1], 1\n"
-		: [reg1] "+r"(reg1), [reg2] "+r"(reg2), [reg3] "+r"(reg3)
-		: [reg8] "r"(reg8), [reg9] "r"(reg9)
-	);
-	m_pSrc = &m_pSrc[a4];
-	count -= 1;
-	__asm__
-	(
-		"qfsrv   %[reg9], %[reg3], %[reg3]\n"
-		"qfsrv   %[reg8], %[reg2], %[reg2]\n"
-		"pextlb  %[reg3], $zero, %[reg3]\n"
-		"pextlb  %[reg2], $zero, %[reg2]\n"
-		"pextlb  %[reg9], $zero, %[reg9]\n"
-		"pextlb  %[reg8], $zero, %[reg8]\n"
-		"paddh   %[reg3], %[reg3], %[reg9]\n"
-		"paddh   %[reg9], %[reg2], %[reg8]\n"
-		: [reg2] "+r"(reg2), [reg3] "+r"(reg3), [reg8] "=r"(reg8), [reg9] "=r"(reg9)
-	);
-	if ( !count )
-		goto LABEL_5;
-	count2 += 1;
-	do
-	{
-		do
-		{
-			reg4 = ((u64 *)m_pSrc)[0x00];
-			reg6 = ((u64 *)m_pSrc)[0x01];
-			set_mtsab_to_value(a3);
-			reg5 = ((u64 *)m_pSrc)[0x06];
-			reg7 = ((u64 *)m_pSrc)[0x07];
-			__asm__
-			(
-				"pcpyld  %[reg4], %[reg5], %[reg4]\n"
-				"pcpyld  %[reg6], %[reg7], %[reg6]\n"
-				"qfsrv   %[reg4], %[reg4], %[reg4]\n"
-				"qfsrv   %[reg6], %[reg6], %[reg6]\n"
-				: [reg4] "+r"(reg4), [reg6] "+r"(reg6)
-				: [reg5] "r"(reg5), [reg7] "r"(reg7)
-			);
-			m_pSrc += a4;
-			count -= 1;
-			set_mtsab_to_value(1);
-			__asm__
-			(
-				"qfsrv   %[reg5], %[reg4], %[reg4]\n"
-				"qfsrv   %[reg7], %[reg6], %[reg6]\n"
-				"pextlb  %[reg4], $zero, %[reg4]\n"
-				"pextlb  %[reg6], $zero, %[reg6]\n"
-				"pextlb  %[reg5], $zero, %[reg5]\n"
-				"pextlb  %[reg7], $zero, %[reg7]\n"
-				"paddh   %[reg4], %[reg4], %[reg5]\n"
-				"paddh   %[reg5], %[reg6], %[reg7]\n"
-				"paddh   %[reg6], %[reg3], %[reg4]\n"
-				"paddh   %[reg7], %[reg9], %[reg5]\n"
-				"por     %[reg3], $zero, %[reg4]\n"
-				"por     %[reg9], $zero, %[reg5]\n"
-				"paddh   %[reg6], %[reg6], %[reg1]\n"
-				"paddh   %[reg7], %[reg7], %[reg1]\n"
-				"psrlh   %[reg6], %[reg6], 2\n"
-				"psrlh   %[reg7], %[reg7], 2\n"
-				: [reg3] "+r"(reg3), [reg4] "+r"(reg4), [reg5] "+r"(reg5), [reg6] "+r"(reg6), [reg7] "+r"(reg7), [reg9] "+r"(reg9)
-				: [reg1] "r"(reg1)
-			);
-			reg4 = ((u128 *)m_pDstCbCr)[0x00];
-			reg5 = ((u128 *)m_pDstCbCr)[0x08];
-			__asm__
-			(
-				"paddh   %[reg6], %[reg6], %[reg4]\n"
-				"paddh   %[reg7], %[reg7], %[reg5]\n"
-				"pcgth   %[reg4], %[reg6], $zero\n"
-				"pceqh   %[reg5], %[reg6], $zero\n"
-				"psrlh   %[reg4], %[reg4], 0xF\n"
-				"psrlh   %[reg5], %[reg5], 0xF\n"
-				"por     %[reg4], %[reg4], %[reg5]\n"
-				"paddh   %[reg6], %[reg6], %[reg4]\n"
-				"pcgth   %[reg4], %[reg7], $zero\n"
-				"pceqh   %[reg5], %[reg7], $zero\n"
-				"psrlh   %[reg4], %[reg4], 0xF\n"
-				"psrlh   %[reg5], %[reg5], 0xF\n"
-				"por     %[reg4], %[reg4], %[reg5]\n"
-				"paddh   %[reg7], %[reg7], %[reg4]\n"
-				"psrlh   %[reg6], %[reg6], 1\n"
-				"psrlh   %[reg7], %[reg7], 1\n"
-				: [reg4] "+r"(reg4), [reg5] "+r"(reg5), [reg6] "+r"(reg6), [reg7] "+r"(reg7)
-			);
-			((u128 *)m_pDstCbCr)[0x00] = reg6;
-			((u128 *)m_pDstCbCr)[0x08] = reg7;
-		}
-		while ( count > 0 );
-		m_pDstCbCr += 8;
-LABEL_5:
-		count = count2;
-		m_pSrc += 704;
-	}
-	while ( count2 > 0 );
-}
-
@@ -152,6 +152,10 @@ typedef struct _MPEGContext {
 extern void         _MPEG_Initialize     (  _MPEGContext*, int ( * ) ( void* ), void*, int*  );
 extern void         _MPEG_Destroy        ( void                                              );
 extern int          _MPEG_CSCImage       ( void*, void*, int                                 );
+extern int          _MPEG_CSCImageAsync  ( void*, void*, int                                 );
+extern int          _MPEG_CSCBusy        ( void                                              );
+extern void         _MPEG_CSCSync        ( void                                              );
+extern void         _MPEG_SetCSCFormat   ( int                                               );
 extern void         _MPEG_SetDefQM       ( int                                               );
 extern void         _MPEG_SetQM          ( int                                               );
 extern int          _MPEG_GetMBAI        ( void                                              );
@@ -0,0 +1,357 @@
+/*
+# _____     ___ ____     ___ ____
+#  ____|   |    ____|   |        | |____|
+# |     ___|   |____ ___|    ____| |    \    PS2DEV Open Source Project.
+#-----------------------------------------------------------------------
+# Copyright (c) 2006-2007 Eugene Plotnikov <e-plotnikov@operamail.com>
+# Licenced under Academic Free License version 2.0
+# Review ps2sdk README & LICENSE files for further details.
+# Based on refernce software of MSSG
+*/
+
+// Motion compensation and block kernels in plain C. They touch nothing but
+// the memory they are given, so this file also builds on the host, and
+// produces the same output as the MMI version in libmpeg_mc_mmi.S.
+//
+// The reference image on the scratchpad holds the 2x2 macroblocks the
+// prediction may cover, 384 bytes each: top left, top right, bottom left,
+// bottom right. Predictions are written as 16 bit samples.
+
+#include <string.h>
+
+#include "libmpeg.h"
+#include "libmpeg_internal.h"
+
+#define MC_HALF_X 1
+#define MC_HALF_Y 2
+#define MC_AVG    4
+
+// pixel i of a luma row, continuing into the macroblock on the right
+#define LUMA(p, i)   ((i) < 16 ? (p)[(i)] : (p)[384 + (i) - 16])
+#define CHROMA(p, i) ((i) < 8 ? (p)[(i)] : (p)[384 + (i) - 8])
+
+static inline u8 _clamp ( s16 v )
+{
+	return v < 0 ? 0 : v > 255 ? 255 : v;
+}
+
+// rows above the macroblock boundary are read first, then the source
+// skips to the macroblocks below
+static inline u8* _mc_row ( u8* src, int step, int rows, int skip, int row )
+{
+	return src + row * step + (row < rows ? 0 : skip);
+}
+
+static inline void _mc_fetch ( u16* out, u8* p, int x, int n, int mode )
+{
+	int i;
+	if (n == 16)
+	{
+		for (i = 0; i < 16; ++i)
+			out[i] = LUMA(p, x + i) + (mode & MC_HALF_X ? LUMA(p, x + i + 1) : 0);
+	}
+	else
+	{
+		for (i = 0; i < 8; ++i)
+			out[i] = CHROMA(p, x + i) + (mode & MC_HALF_X ? CHROMA(p, x + i + 1) : 0);
+	}
+}
+
+static inline void _mc_store ( u16* dst, u16* prev, u16* cur, int n, int mode )
+{
+	int i;
+	for (i = 0; i < n; ++i)
+	{
+		u16 v;
+		switch (mode & (MC_HALF_X | MC_HALF_Y))
+		{
+			case 0:                     v = cur[i]; break;
+			case MC_HALF_X:             v = (cur[i] + 1) >> 1; break;
+			case MC_HALF_Y:             v = (prev[i] + cur[i] + 1) >> 1; break;
+			default:                    v = (prev[i] + cur[i] + 2) >> 2; break;
+		}
+		dst[i] = mode & MC_AVG ? (v + dst[i] + 1) >> 1 : v;
+	}
+}
+
+// n is 16 for luma or 8 for chroma, where Cr follows Cb by 64 samples
+// in both the source and the destination
+static void _mc ( u8* src, u16* dst, int x, int step, int rows, int rowsBelow, int n, int mode )
+{
+	u16 prev[2][16], cur[2][16];
+	int skip = n == 16 ? 512 : 704;
+	int planes = n == 16 ? 1 : 2;
+	int nRows, row, i;
+
+	if (mode & MC_HALF_Y)
+	{
+		// interpolated rows need the one below the last as well
+		nRows = rows + (rowsBelow + 1 > 0 ? rowsBelow + 1 : 0);
+		for (i = 0; i < planes; ++i)
+			_mc_fetch(prev[i], src + i * 64, x, n, mode);
+		row = 1;
+	}
+	else
+	{
+		nRows = rows + (rowsBelow > 0 ? rowsBelow : 0);
+		row = 0;
+	}
+
+	for (; row < nRows; ++row)
+	{
+		u8* p = _mc_row(src, step, rows, skip, row);
+		for (i = 0; i < planes; ++i)
+		{
+			_mc_fetch(cur[i], p + i * 64, x, n, mode);
+			_mc_store(dst + i * 64, prev[i], cur[i], n, mode);
+			memcpy(prev[i], cur[i], sizeof(cur[i]));
+		}
+		dst += n;
+	}
+}
+
+void _MPEG_put_luma ( u8* a1, u16* a2, int a3, int a4, int var1, int ta )
+{
+	_mc(a1, a2, a3, a4, var1, ta, 16, 0);
+}
+
+void _MPEG_put_chroma ( u8* a1, u16* a2, int a3, int a4, int var1, int ta )
+{
+	_mc(a1, a2, a3, a4, var1, ta, 8, 0);
+}
+
+void _MPEG_put_luma_X ( u8* a1, u16* a2, int a3, int a4, int var1, int ta )
+{
+	_mc(a1, a2, a3, a4, var1, ta, 16, MC_HALF_X);
+}
+
+void _MPEG_put_chroma_X ( u8* a1, u16* a2, int a3, int a4, int var1, int ta )
+{
+	_mc(a1, a2, a3, a4, var1, ta, 8, MC_HALF_X);
+}
+
+void _MPEG_put_luma_Y ( u8* a1, u16* a2, int a3, int a4, int var1, int ta )
+{
+	_mc(a1, a2, a3, a4, var1, ta, 16, MC_HALF_Y);
+}
+
+void _MPEG_put_chroma_Y ( u8* a1, u16* a2, int a3, int a4, int var1, int ta )
+{
+	_mc(a1, a2, a3, a4, var1, ta, 8, MC_HALF_Y);
+}
+
+void _MPEG_put_luma_XY ( u8* a1, u16* a2, int a3, int a4, int var1, int ta )
+{
+	_mc(a1, a2, a3, a4, var1, ta, 16, MC_HALF_X | MC_HALF_Y);
+}
+
+void _MPEG_put_chroma_XY ( u8* a1, u16* a2, int a3, int a4, int var1, int ta )
+{
+	_mc(a1, a2, a3, a4, var1, ta, 8, MC_HALF_X | MC_HALF_Y);
+}
+
+void _MPEG_avg_luma ( u8* a1, u16* a2, int a3, int a4, int var1, int ta )
+{
+	_mc(a1, a2, a3, a4, var1, ta, 16, MC_AVG);
+}
+
+void _MPEG_avg_chroma ( u8* a1, u16* a2, int a3, int a4, int var1, int ta )
+{
+	_mc(a1, a2, a3, a4, var1, ta, 8, MC_AVG);
+}
+
+void _MPEG_avg_luma_X ( u8* a1, u16* a2, int a3, int a4, int var1, int ta )
+{
+	_mc(a1, a2, a3, a4, var1, ta, 16, MC_AVG | MC_HALF_X);
+}
+
+void _MPEG_avg_chroma_X ( u8* a1, u16* a2, int a3, int a4, int var1, int ta )
+{
+	_mc(a1, a2, a3, a4, var1, ta, 8, MC_AVG | MC_HALF_X);
+}
+
+void _MPEG_avg_luma_Y ( u8* a1, u16* a2, int a3, int a4, int var1, int ta )
+{
+	_mc(a1, a2, a3, a4, var1, ta, 16, MC_AVG | MC_HALF_Y);
+}
+
+void _MPEG_avg_chroma_Y ( u8* a1, u16* a2, int a3, int a4, int var1, int ta )
+{
+	_mc(a1, a2, a3, a4, var1, ta, 8, MC_AVG | MC_HALF_Y);
+}
+
+void _MPEG_avg_luma_XY ( u8* a1, u16* a2, int a3, int a4, int var1, int ta )
+{
+	_mc(a1, a2, a3, a4, var1, ta, 16, MC_AVG | MC_HALF_X | MC_HALF_Y);
+}
+
+void _MPEG_avg_chroma_XY ( u8* a1, u16* a2, int a3, int a4, int var1, int ta )
+{
+	_mc(a1, a2, a3, a4, var1, ta, 8, MC_AVG | MC_HALF_X | MC_HALF_Y);
+}
+
+void _MPEG_do_mc ( _MPEGMotion* arg0 )
+{
+	u8* src;
+	int y = arg0->m_Y - arg0->m_Field;
+	int rows;
+
+	// luma, field rows are every other row of the reference
+	src = arg0->m_pSrc + arg0->m_Field * 16 + y * 16;
+	rows = (16 - y) >> arg0->m_fInt;
+	arg0->MC_Luma(src, (u16*)arg0->m_pDstY, arg0->m_X, 16 << arg0->m_fInt, rows, arg0->m_H - rows);
+
+	// chroma, half the resolution in both directions
+	y = ((y >> 1) >> arg0->m_fInt) << arg0->m_fInt;
+	src = arg0->m_pSrc + 256 + arg0->m_Field * 8 + y * 8;
+	rows = (8 - y) >> arg0->m_fInt;
+	arg0->MC_Chroma(src, (u16*)arg0->m_pDstCbCr, arg0->m_X >> 1, 8 << arg0->m_fInt, rows, (arg0->m_H >> 1) - rows);
+}
+
+// the blocks come as 16 bit samples: 16 rows of luma, 8 of Cb, 8 of Cr
+
+void _MPEG_put_block_fr ( _MPEGMotions* a1 )
+{
+	s16* src = (s16*)a1->m_pSrc;
+	u8* dst = a1->m_pMBDstY;
+	int i;
+	for (i = 0; i < 384; ++i)
+		dst[i] = _clamp(src[i]);
+}
+
+// luma in field order, rows 0-7 are the top field and 8-15 the bottom one
+void _MPEG_put_block_fl ( _MPEGMotions* a1 )
+{
+	s16* src = (s16*)a1->m_pSrc;
+	u8* dst = a1->m_pMBDstY;
+	int i, j;
+	for (i = 0; i < 8; ++i)
+	{
+		for (j = 0; j < 16; ++j)
+		{
+			dst[(i * 2) * 16 + j] = _clamp(src[i * 16 + j]);
+			dst[(i * 2 + 1) * 16 + j] = _clamp(src[(i + 8) * 16 + j]);
+		}
+	}
+	for (i = 256; i < 384; ++i)
+		dst[i] = _clamp(src[i]);
+}
+
+// one field of an interlaced picture, the other field is m_Stride bytes away
+void _MPEG_put_block_il ( _MPEGMotions* a1 )
+{
+	s16* src = (s16*)a1->m_pSrc;
+	u8* dst = a1->m_pMBDstY;
+	int i, j, k;
+	for (i = 0; i < 8; ++i)
+	{
+		for (j = 0; j < 16; ++j)
+		{
+			dst[(i * 2) * 16 + j] = _clamp(src[i * 16 + j]);
+			dst[a1->m_Stride + (i * 2) * 16 + j] = _clamp(src[(i + 8) * 16 + j]);
+		}
+	}
+	dst = a1->m_pMBDstCbCr;
+	src += 256;
+	for (k = 0; k < 2; ++k)
+	{
+		for (i = 0; i < 4; ++i)
+		{
+			for (j = 0; j < 8; ++j)
+			{
+				dst[(i * 2) * 8 + j] = _clamp(src[i * 8 + j]);
+				dst[a1->m_Stride + (i * 2) * 8 + j] = _clamp(src[(i + 4) * 8 + j]);
+			}
+		}
+		dst += 64;
+		src += 64;
+	}
+}
+
+// prediction plus residual, paddh wraps around before the clamp
+#define ADD(blk, res) _clamp((s16)((blk) + (res)))
+
+void _MPEG_add_block_frfr ( _MPEGMotions* a1 )
+{
+	s16* blk = (s16*)a1->m_pSPRBlk;
+	s16* res = (s16*)a1->m_pSPRRes;
+	u8* dst = a1->m_pMBDstY;
+	int i;
+	for (i = 0; i < 384; ++i)
+		dst[i] = ADD(blk[i], res[i]);
+}
+
+void _MPEG_add_block_ilfl ( _MPEGMotions* a1 )
+{
+	s16* blk = (s16*)a1->m_pSPRBlk;
+	s16* res = (s16*)a1->m_pSPRRes;
+	u8* dst = a1->m_pMBDstY;
+	int i, j, k, l;
+	for (i = 0; i < 8; ++i)
+	{
+		for (j = 0; j < 16; ++j)
+		{
+			l = i * 16 + j;
+			dst[(i * 2) * 16 + j] = ADD(blk[l], res[l]);
+			l += 128;
+			dst[a1->m_Stride + (i * 2) * 16 + j] = ADD(blk[l], res[l]);
+		}
+	}
+	dst = a1->m_pMBDstCbCr;
+	blk += 256;
+	res += 256;
+	for (k = 0; k < 2; ++k)
+	{
+		for (i = 0; i < 4; ++i)
+		{
+			for (j = 0; j < 8; ++j)
+			{
+				l = i * 8 + j;
+				dst[(i * 2) * 8 + j] = ADD(blk[l], res[l]);
+				l += 32;
+				dst[a1->m_Stride + (i * 2) * 8 + j] = ADD(blk[l], res[l]);
+			}
+		}
+		dst += 64;
+		blk += 64;
+		res += 64;
+	}
+}
+
+// frame prediction, field residual
+void _MPEG_add_block_frfl ( _MPEGMotions* a1 )
+{
+	s16* blk = (s16*)a1->m_pSPRBlk;
+	s16* res = (s16*)a1->m_pSPRRes;
+	u8* dst = a1->m_pMBDstY;
+	int i, j, k, l;
+	for (i = 0; i < 8; ++i)
+	{
+		for (j = 0; j < 16; ++j)
+		{
+			l = (i * 2) * 16 + j;
+			dst[l] = ADD(blk[l], res[i * 16 + j]);
+			l += 16;
+			dst[l] = ADD(blk[l], res[(i + 8) * 16 + j]);
+		}
+	}
+	dst = a1->m_pMBDstCbCr;
+	blk += 256;
+	res += 256;
+	for (k = 0; k < 2; ++k)
+	{
+		for (i = 0; i < 4; ++i)
+		{
+			for (j = 0; j < 8; ++j)
+			{
+				l = (i * 2) * 8 + j;
+				dst[l] = ADD(blk[l], res[i * 8 + j]);
+				l += 8;
+				dst[l] = ADD(blk[l], res[(i + 4) * 8 + j]);
+			}
+		}
+		dst += 64;
+		blk += 64;
+		res += 64;
+	}
+}
@@ -0,0 +1,120 @@
+/* Times the motion compensation and block kernels. Build and run with
+ * make host-bench (C kernels, on the host) or make ee-bench (LIBMPEG_MC
+ * kernels, on the EE).
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include "libmpeg.h"
+#include "libmpeg_internal.h"
+
+#define ITERATIONS 20000
+
+typedef void (*mcfunc_t)(u8 *a1, u16 *a2, int a3, int a4, int var1, int ta);
+typedef void (*blockfunc_t)(_MPEGMotions *a1);
+
+static _MPEGMacroBlock8 spr[4] __attribute__((aligned(16)));
+static u16 dst_y[256] __attribute__((aligned(16)));
+static u16 dst_c[128] __attribute__((aligned(16)));
+
+static s16 blk_src[384] __attribute__((aligned(16)));
+static s16 blk_res[384] __attribute__((aligned(16)));
+static u8 blk_y[1024] __attribute__((aligned(16)));
+static u8 blk_c[1024] __attribute__((aligned(16)));
+
+static const struct
+{
+    const char *name;
+    mcfunc_t luma;
+    mcfunc_t chroma;
+} motions[] = {
+    {"put", _MPEG_put_luma, _MPEG_put_chroma},
+    {"put X", _MPEG_put_luma_X, _MPEG_put_chroma_X},
+    {"put Y", _MPEG_put_luma_Y, _MPEG_put_chroma_Y},
+    {"put XY", _MPEG_put_luma_XY, _MPEG_put_chroma_XY},
+    {"avg", _MPEG_avg_luma, _MPEG_avg_chroma},
+    {"avg X", _MPEG_avg_luma_X, _MPEG_avg_chroma_X},
+    {"avg Y", _MPEG_avg_luma_Y, _MPEG_avg_chroma_Y},
+    {"avg XY", _MPEG_avg_luma_XY, _MPEG_avg_chroma_XY},
+};
+
+static const struct
+{
+    const char *name;
+    blockfunc_t func;
+} blocks[] = {
+    {"put_block_fr", _MPEG_put_block_fr},
+    {"put_block_fl", _MPEG_put_block_fl},
+    {"put_block_il", _MPEG_put_block_il},
+    {"add_block_frfr", _MPEG_add_block_frfr},
+    {"add_block_ilfl", _MPEG_add_block_ilfl},
+    {"add_block_frfl", _MPEG_add_block_frfl},
+};
+
+static void report(const char *name, clock_t start)
+{
+    double us = (double)(clock() - start) * 1000000.0 / CLOCKS_PER_SEC / ITERATIONS;
+
+    printf("%-16s %8.3f us per macroblock\n", name, us);
+}
+
+int main(int argc, char *argv[])
+{
+    _MPEGMotion motion;
+    _MPEGMotions block;
+    clock_t start;
+    unsigned int i, j;
+
+    for (i = 0; i < sizeof(spr); i++)
+        ((u8 *)spr)[i] = i * 7;
+
+    for (i = 0; i < 384; i++)
+    {
+        blk_src[i] = (i * 13) & 0x1FF;
+        blk_res[i] = (int)((i * 29) & 0xFF) - 128;
+    }
+
+    memset(&motion, 0, sizeof(motion));
+    motion.m_pSrc     = (unsigned char *)spr;
+    motion.m_pDstY    = (short *)dst_y;
+    motion.m_pDstCbCr = (short *)dst_c;
+    motion.m_H        = 16;
+
+    for (i = 0; i < sizeof(motions) / sizeof(motions[0]); i++)
+    {
+        motion.MC_Luma   = motions[i].luma;
+        motion.MC_Chroma = motions[i].chroma;
+
+        start = clock();
+        for (j = 0; j < ITERATIONS; j++)
+        {
+            /* every offset, so the macroblock boundaries fall everywhere */
+            motion.m_X = j & 15;
+            motion.m_Y = (j >> 4) & 15;
+            _MPEG_do_mc(&motion);
+        }
+        report(motions[i].name, start);
+    }
+
+    memset(&block, 0, sizeof(block));
+    block.m_pMBDstY    = blk_y;
+    block.m_pMBDstCbCr = blk_c;
+    block.m_pSrc       = (unsigned char *)blk_src;
+    block.m_pSPRBlk    = (unsigned char *)blk_src;
+    block.m_pSPRRes    = (unsigned char *)blk_res;
+    block.m_Stride     = 512;
+
+    for (i = 0; i < sizeof(blocks) / sizeof(blocks[0]); i++)
+    {
+        start = clock();
+        for (j = 0; j < ITERATIONS; j++)
+            blocks[i].func(&block);
+        report(blocks[i].name, start);
+    }
+
+    printf("checksum %d\n", dst_y[17] + dst_c[9] + blk_y[33] + blk_c[65]);
+
+    return 0;
+}
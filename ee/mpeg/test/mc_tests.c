@@ -0,0 +1,445 @@
+/* Golden output tests of the motion compensation and block kernels.
+ *
+ * The expected output is computed from whole reference pictures, the way
+ * the MPEG spec describes prediction, and not from the scratchpad layout
+ * the kernels read. Build and run with make host-test (C kernels, on the
+ * host) or make ee-test (LIBMPEG_MC kernels, on the EE).
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "libmpeg.h"
+#include "libmpeg_internal.h"
+
+#include "testsuite.h"
+
+#define MC_HALF_X 1
+#define MC_HALF_Y 2
+#define MC_AVG    4
+
+/* initial destination contents, written samples never have it */
+#define UNTOUCHED 0xDEAD
+
+/* offset of the second field of the block ops' destination */
+#define STRIDE 512
+
+typedef void (*mcfunc_t)(u8 *a1, u16 *a2, int a3, int a4, int var1, int ta);
+typedef void (*blockfunc_t)(_MPEGMotions *a1);
+
+/* indexed like LumaOp and ChromaOp in libmpeg.c */
+static mcfunc_t luma_ops[8] = {
+    _MPEG_put_luma, _MPEG_put_luma_X, _MPEG_put_luma_Y, _MPEG_put_luma_XY,
+    _MPEG_avg_luma, _MPEG_avg_luma_X, _MPEG_avg_luma_Y, _MPEG_avg_luma_XY,
+};
+
+static mcfunc_t chroma_ops[8] = {
+    _MPEG_put_chroma, _MPEG_put_chroma_X, _MPEG_put_chroma_Y, _MPEG_put_chroma_XY,
+    _MPEG_avg_chroma, _MPEG_avg_chroma_X, _MPEG_avg_chroma_Y, _MPEG_avg_chroma_XY,
+};
+
+/* the 2x2 macroblocks a prediction may cover, as whole pictures */
+static u8 ref_y[32][32];
+static u8 ref_c[2][16][16];
+
+/* the same macroblocks in scratchpad order */
+static _MPEGMacroBlock8 spr[4] __attribute__((aligned(16)));
+
+static u16 dst_y[256] __attribute__((aligned(16)));
+static u16 dst_c[128] __attribute__((aligned(16)));
+static u16 old_y[256];
+static u16 old_c[128];
+static u16 exp_y[256];
+static u16 exp_c[128];
+
+static unsigned int seed = 1;
+
+static unsigned int random_u32(void)
+{
+    seed = seed * 1103515245 + 12345;
+    return seed >> 8;
+}
+
+static void init_reference(void)
+{
+    int mb, x, y, k;
+
+    for (y = 0; y < 32; y++)
+        for (x = 0; x < 32; x++)
+            ref_y[y][x] = random_u32();
+
+    for (k = 0; k < 2; k++)
+        for (y = 0; y < 16; y++)
+            for (x = 0; x < 16; x++)
+                ref_c[k][y][x] = random_u32();
+
+    /* top left, top right, bottom left, bottom right */
+    for (mb = 0; mb < 4; mb++)
+    {
+        int ox = (mb & 1) * 16, oy = (mb >> 1) * 16;
+
+        for (y = 0; y < 16; y++)
+            for (x = 0; x < 16; x++)
+                spr[mb].m_Y[y][x] = ref_y[oy + y][ox + x];
+
+        for (y = 0; y < 8; y++)
+        {
+            for (x = 0; x < 8; x++)
+            {
+                spr[mb].m_Cb[y][x] = ref_c[0][oy / 2 + y][ox / 2 + x];
+                spr[mb].m_Cr[y][x] = ref_c[1][oy / 2 + y][ox / 2 + x];
+            }
+        }
+    }
+}
+
+/* half sample prediction at (x, y), line is the distance to the next line
+ * of the same field, or of the frame
+ */
+static int predict(const u8 *p, int width, int x, int y, int line, int mode)
+{
+    int a = p[y * width + x];
+    int b = p[y * width + x + 1];
+    int c = p[(y + line) * width + x];
+    int d = p[(y + line) * width + x + 1];
+
+    switch (mode & (MC_HALF_X | MC_HALF_Y))
+    {
+        case 0:
+            return a;
+        case MC_HALF_X:
+            return (a + b + 1) >> 1;
+        case MC_HALF_Y:
+            return (a + c + 1) >> 1;
+        default:
+            return (a + b + c + d + 2) >> 2;
+    }
+}
+
+static void expect(u16 *out, const u16 *old, const u8 *p, int width, int x, int y, int line, int w, int h, int mode)
+{
+    int i, j;
+
+    for (i = 0; i < h; i++)
+    {
+        for (j = 0; j < w; j++)
+        {
+            int v = predict(p, width, x + j, y + i * line, line, mode);
+            out[i * w + j] = mode & MC_AVG ? (v + old[i * w + j] + 1) >> 1 : v;
+        }
+    }
+}
+
+static void random_dst(u16 *dst, u16 *old, int n, int mode)
+{
+    int i;
+
+    for (i = 0; i < n; i++)
+        dst[i] = mode & MC_AVG ? random_u32() & 0xFF : UNTOUCHED;
+    memcpy(old, dst, n * sizeof(u16));
+}
+
+static const char *compare(const char *what, const u16 *out, const u16 *expected, int n, int w, int x, int y, int field)
+{
+    int i;
+
+    for (i = 0; i < n; i++)
+    {
+        if (out[i] != expected[i])
+        {
+            printf("\n%s, x %d y %d field %d: sample %d, %d is %d, expected %d",
+                   what, x, y, field, i / w, i % w, out[i], expected[i]);
+            return "prediction differs from the reference picture";
+        }
+    }
+
+    return NULL;
+}
+
+/* predicts a macroblock from (x, y) of the reference, in half samples
+ * relative to the top left macroblock. field is -1 for frame prediction.
+ */
+static const char *check_motion(int mode, int x, int y, int field)
+{
+    _MPEGMotion motion;
+    const char *error;
+    int k, cy;
+
+    random_dst(dst_y, old_y, 256, mode);
+    random_dst(dst_c, old_c, 128, mode);
+    memcpy(exp_y, old_y, sizeof(exp_y));
+    memcpy(exp_c, old_c, sizeof(exp_c));
+
+    motion.m_pSrc      = (unsigned char *)spr;
+    motion.m_pDstY     = (short *)dst_y;
+    motion.m_pDstCbCr  = (short *)dst_c;
+    motion.m_X         = x;
+    motion.m_Y         = y;
+    motion.MC_Luma     = luma_ops[mode];
+    motion.MC_Chroma   = chroma_ops[mode];
+
+    if (field < 0)
+    {
+        motion.m_H     = 16;
+        motion.m_fInt  = 0;
+        motion.m_Field = 0;
+
+        expect(exp_y, old_y, ref_y[0], 32, x, y, 1, 16, 16, mode);
+        for (k = 0; k < 2; k++)
+            expect(exp_c + k * 64, old_c + k * 64, ref_c[k][0], 16, x / 2, y / 2, 1, 8, 8, mode);
+    }
+    else
+    {
+        /* 8 lines of one field, y is a frame line of that field */
+        motion.m_H     = 8;
+        motion.m_fInt  = 1;
+        motion.m_Field = field;
+
+        expect(exp_y, old_y, ref_y[0], 32, x, y, 2, 16, 8, mode);
+
+        /* the chroma field line is half the luma field line */
+        cy = (y - field) / 4 * 2 + field;
+        for (k = 0; k < 2; k++)
+            expect(exp_c + k * 64, old_c + k * 64, ref_c[k][0], 16, x / 2, cy, 2, 8, 4, mode);
+    }
+
+    _MPEG_do_mc(&motion);
+
+    error = compare("luma", dst_y, exp_y, 256, 16, x, y, field);
+    if (error == NULL)
+        error = compare("chroma", dst_c, exp_c, 128, 8, x, y, field);
+
+    return error;
+}
+
+static const char *test_motion(void *arg)
+{
+    int mode = (int)(long)arg;
+    const char *error;
+    int x, y, field;
+
+    init_reference();
+
+    /* every offset into the top left macroblock, so each X kernel
+     * shifts by every amount, odd chroma offsets included
+     */
+    for (y = 0; y < 16; y++)
+    {
+        for (x = 0; x < 16; x++)
+        {
+            error = check_motion(mode, x, y, -1);
+            if (error != NULL)
+                return error;
+
+            field = y & 1;
+            error = check_motion(mode, x, y, field);
+            if (error != NULL)
+                return error;
+        }
+    }
+
+    printf("\nSUCCESS: all checks passed\n");
+    return NULL;
+}
+
+/* block ops */
+
+static s16 blk_src[384] __attribute__((aligned(16)));
+static s16 blk_res[384] __attribute__((aligned(16)));
+static u8 blk_y[2 * STRIDE] __attribute__((aligned(16)));
+static u8 blk_c[2 * STRIDE] __attribute__((aligned(16)));
+static u8 blk_exp_y[2 * STRIDE];
+static u8 blk_exp_c[2 * STRIDE];
+
+static u8 clamp(int v)
+{
+    return v < 0 ? 0 : v > 255 ? 255 : v;
+}
+
+/* the sum wraps to 16 bits before the clamp, like paddh */
+static u8 add(int blk, int res)
+{
+    return clamp((s16)(blk + res));
+}
+
+/* row of a field ordered block (top field rows first) that holds frame row r */
+static int field_row(int r, int rows)
+{
+    return (r & 1) ? rows / 2 + r / 2 : r / 2;
+}
+
+/* destination of field ordered row r of an interlaced block, the second
+ * field is STRIDE bytes away
+ */
+static int il_offset(int r, int rows, int width)
+{
+    return (r < rows / 2 ? 0 : STRIDE) + (r % (rows / 2)) * 2 * width;
+}
+
+enum
+{
+    /* rows in frame order */
+    ORDER_FRAME,
+    /* luma rows in field order, chroma in frame order */
+    ORDER_FIELD_LUMA,
+    /* all rows in field order */
+    ORDER_FIELD,
+    /* field order, each field written to its own picture */
+    ORDER_INTERLACED,
+};
+
+typedef struct block_case_t
+{
+    blockfunc_t func;
+    int add;
+    /* row order of the input, of the residual when adding */
+    int order;
+    /* chroma goes to m_pMBDstCbCr, instead of following luma */
+    int chroma_apart;
+} block_case_t;
+
+static void expect_block(const block_case_t *c)
+{
+    static const int width[3] = {16, 8, 8};
+    static const int start[3] = {0, 256, 320};
+    int plane, r, j;
+
+    memset(blk_exp_y, 0xA5, sizeof(blk_exp_y));
+    memset(blk_exp_c, 0xA5, sizeof(blk_exp_c));
+
+    for (plane = 0; plane < 3; plane++)
+    {
+        int w = width[plane], h = width[plane];
+
+        for (r = 0; r < h; r++)
+        {
+            /* input row, frame row of the prediction and destination */
+            int row = r, blk_row = r, dst = r * w;
+
+            if (c->order == ORDER_INTERLACED)
+                dst = il_offset(r, h, w);
+            else if (c->order == ORDER_FIELD || (c->order == ORDER_FIELD_LUMA && plane == 0))
+                row = field_row(r, h);
+
+            for (j = 0; j < w; j++)
+            {
+                int s = start[plane] + row * w + j;
+                u8 v = c->add ? add(blk_src[start[plane] + blk_row * w + j], blk_res[s]) : clamp(blk_src[s]);
+
+                if (plane == 0)
+                    blk_exp_y[dst + j] = v;
+                else if (c->chroma_apart)
+                    blk_exp_c[(plane - 1) * 64 + dst + j] = v;
+                else
+                    blk_exp_y[start[plane] + dst + j] = v;
+            }
+        }
+    }
+}
+
+static const char *test_block(void *arg)
+{
+    const block_case_t *c = (const block_case_t *)arg;
+    _MPEGMotions motions;
+    int i, pass;
+
+    for (pass = 0; pass < 16; pass++)
+    {
+        for (i = 0; i < 384; i++)
+        {
+            if (c->add)
+            {
+                /* predictions are samples, residuals are signed */
+                blk_src[i] = random_u32() & 0xFF;
+                blk_res[i] = (int)(random_u32() & 0x7FF) - 1024;
+            }
+            else
+            {
+                blk_src[i] = (int)(random_u32() & 0x3FF) - 256;
+            }
+        }
+
+        /* residuals that wrap around */
+        blk_src[0] = 255;
+        blk_res[0] = 32767;
+        blk_src[1] = 0;
+        blk_res[1] = -32768;
+
+        memset(blk_y, 0xA5, sizeof(blk_y));
+        memset(blk_c, 0xA5, sizeof(blk_c));
+
+        memset(&motions, 0, sizeof(motions));
+        motions.m_pMBDstY    = blk_y;
+        motions.m_pMBDstCbCr = blk_c;
+        motions.m_pSrc       = (unsigned char *)blk_src;
+        motions.m_pSPRBlk    = (unsigned char *)blk_src;
+        motions.m_pSPRRes    = (unsigned char *)blk_res;
+        motions.m_Stride     = STRIDE;
+
+        expect_block(c);
+        c->func(&motions);
+
+        for (i = 0; i < 2 * STRIDE; i++)
+        {
+            if (blk_y[i] != blk_exp_y[i])
+            {
+                printf("\nm_pMBDstY[%d] is %d, expected %d", i, blk_y[i], blk_exp_y[i]);
+                return "block differs from the reference";
+            }
+            if (blk_c[i] != blk_exp_c[i])
+            {
+                printf("\nm_pMBDstCbCr[%d] is %d, expected %d", i, blk_c[i], blk_exp_c[i]);
+                return "block differs from the reference";
+            }
+        }
+    }
+
+    printf("\nSUCCESS: all checks passed\n");
+    return NULL;
+}
+
+static block_case_t block_cases[] = {
+    {_MPEG_put_block_fr, 0, ORDER_FRAME, 0},
+    {_MPEG_put_block_fl, 0, ORDER_FIELD_LUMA, 0},
+    {_MPEG_put_block_il, 0, ORDER_INTERLACED, 1},
+    {_MPEG_add_block_frfr, 1, ORDER_FRAME, 0},
+    {_MPEG_add_block_ilfl, 1, ORDER_INTERLACED, 1},
+    {_MPEG_add_block_frfl, 1, ORDER_FIELD, 1},
+};
+
+static const char *block_names[] = {
+    "_MPEG_put_block_fr",
+    "_MPEG_put_block_fl",
+    "_MPEG_put_block_il",
+    "_MPEG_add_block_frfr",
+    "_MPEG_add_block_ilfl",
+    "_MPEG_add_block_frfl",
+};
+
+static const char *motion_names[] = {
+    "_MPEG_put_luma, _MPEG_put_chroma",
+    "_MPEG_put_luma_X, _MPEG_put_chroma_X",
+    "_MPEG_put_luma_Y, _MPEG_put_chroma_Y",
+    "_MPEG_put_luma_XY, _MPEG_put_chroma_XY",
+    "_MPEG_avg_luma, _MPEG_avg_chroma",
+    "_MPEG_avg_luma_X, _MPEG_avg_chroma_X",
+    "_MPEG_avg_luma_Y, _MPEG_avg_chroma_Y",
+    "_MPEG_avg_luma_XY, _MPEG_avg_chroma_XY",
+};
+
+int mc_add_tests(test_suite *p)
+{
+    unsigned int i;
+
+    for (i = 0; i < 8; i++)
+    {
+        add_test(p, motion_names[i], test_motion, (void *)(long)i);
+    }
+
+    for (i = 0; i < sizeof(block_cases) / sizeof(block_cases[0]); i++)
+    {
+        add_test(p, block_names[i], test_block, &block_cases[i]);
+    }
+
+    return 0;
+}
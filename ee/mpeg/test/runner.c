@@ -0,0 +1,43 @@
+/*
+# _____     ___ ____     ___ ____
+#  ____|   |    ____|   |        | |____|
+# |     ___|   |____ ___|    ____| |    \    PS2DEV Open Source Project.
+#-----------------------------------------------------------------------
+# Copyright 2001-2005, ps2dev - http://www.ps2dev.org
+# Licenced under Academic Free License version 2.0
+# Review ps2sdk README & LICENSE files for further details.
+#
+# libmpeg motion compensation testsuite runner
+*/
+
+#include <stdio.h>
+#include <unistd.h>
+#include "testsuite.h"
+
+extern int mc_add_tests(test_suite *p);
+
+int main(int argc, char *argv[])
+{
+    test_suite suite;
+    int successful;
+
+    /* initialize test suite */
+    init_testsuite(&suite);
+
+    /* add all tests to this suite */
+    mc_add_tests(&suite);
+
+    /* run all tests */
+    successful = run_testsuite(&suite);
+
+#ifdef __mips__
+    /* do some stuff or ps2client will freeze */
+    while (1)
+    {
+        sleep(10);
+        printf("I am alive\n");
+    };
+#endif
+
+    return successful != suite.ntests;
+}
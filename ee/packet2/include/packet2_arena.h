@@ -0,0 +1,124 @@
+/*
+# _____     ___ ____     ___ ____
+#  ____|   |    ____|   |        | |____|
+# |     ___|   |____ ___|    ____| |    \    PS2DEV Open Source Project.
+#-----------------------------------------------------------------------
+# Copyright 2001-2004, ps2dev - http://www.ps2dev.org
+# Licenced under Academic Free License version 2.0
+# Review ps2sdk README & LICENSE files for further details.
+*/
+
+/**
+ * @file Per-frame packet arena.
+ * @defgroup packet2_arena Arena
+ * Packets that live for one frame, without heap allocation.
+ * An arena is one memory block split into 1-3 frames. Packets are
+ * handed out from the current frame with a bump pointer, and a frame
+ * is recycled as a whole once the DMA transfers that read it are done,
+ * so the CPU can fill one frame while DMA still reads the previous one.
+ * @ingroup packet2
+ * @{
+ */
+
+#ifndef __PACKET2_ARENA_H__
+#define __PACKET2_ARENA_H__
+
+#include <packet2_types.h>
+
+/** Maximum number of frames in an arena (triple buffering). */
+#define P2_ARENA_MAX_FRAMES 3
+
+typedef struct
+{
+    /** Data of all frames, cache line aligned. */
+    qword_t *base;
+    /** Packet headers of all frames. */
+    packet2_t *packets;
+    /** Data size of one frame, in qwords. */
+    u32 frame_qwords;
+    /** Data used in the current frame, in qwords. */
+    u32 used_qwords;
+    /** Highest data use of any frame so far, in qwords. Useful for sizing. */
+    u32 peak_qwords;
+    /** Packet headers of one frame. */
+    u16 max_packets;
+    /** Packet headers used in the current frame. */
+    u16 used_packets;
+    /** Number of frames. */
+    u8 frames;
+    /** Frame packets are currently handed out from. */
+    u8 current;
+    /** Cached packets were handed out from the frame since it was last recycled. */
+    u8 cached[P2_ARENA_MAX_FRAMES];
+    /** Cache lines of the frame may still be dirty from an earlier use. */
+    u8 writeback[P2_ARENA_MAX_FRAMES];
+    /** DMA channels (bit mask) that were sent packets of the frame. */
+    u32 fence[P2_ARENA_MAX_FRAMES];
+} packet2_arena_t;
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+    /**
+     * Allocate new arena.
+     * @param frame_qwords Data size of one frame in qwords (128bit).
+     * Rounded up to a whole number of cache lines.
+     * @param max_packets Maximum number of packets per frame.
+     * @param frames Number of frames, 1 to P2_ARENA_MAX_FRAMES.
+     * Use 2 or 3 to build a frame while the previous one is transferred.
+     * @returns Pointer to arena on success or NULL if memory allocation fail.
+     */
+    extern packet2_arena_t *packet2_arena_create(u32 frame_qwords, u16 max_packets, u8 frames);
+
+    /**
+     * Free arena memory, with all of its packets.
+     * DMA must not be reading any of them.
+     * @param arena Pointer to arena.
+     */
+    extern void packet2_arena_free(packet2_arena_t *arena);
+
+    /**
+     * Get packet from the current frame.
+     * Unlike packet2_create() the data is not cleared, and the cache
+     * is written back at most once per frame for uncached packets,
+     * instead of once per packet.
+     * The packet stays valid until its frame is recycled by
+     * packet2_arena_next_frame(). Never pass it to packet2_free().
+     * @param arena Pointer to arena.
+     * @param qwords Maximum data size in qwords (128bit).
+     * @param type Memory mapping type. P2_TYPE_SPRAM is not supported.
+     * @param mode Packet mode. Normal or chain.
+     * @param tte Tag transfer enable. See packet2_create().
+     * @returns Pointer to packet2 or NULL if the frame is full.
+     */
+    extern packet2_t *packet2_arena_alloc(packet2_arena_t *arena, u16 qwords, enum Packet2Type type, enum Packet2Mode mode, u8 tte);
+
+    /**
+     * Record that packets of the current frame were sent on a DMA channel.
+     * Call it after every dma_channel_send_packet2() of an arena packet.
+     * @param arena Pointer to arena.
+     * @param channel DMA channel, one of DMA_CHANNEL_x.
+     */
+    static inline void packet2_arena_fence(packet2_arena_t *arena, int channel)
+    {
+        arena->fence[arena->current] |= 1 << channel;
+    }
+
+    /**
+     * Finish the current frame and start the next one.
+     * Before the oldest frame is reused, waits with dma_channel_wait()
+     * on every channel it was sent on, unless a newer frame was sent on
+     * that channel since, which means that transfer already finished.
+     * @param arena Pointer to arena.
+     */
+    extern void packet2_arena_next_frame(packet2_arena_t *arena);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __PACKET2_ARENA_H__ */
+
+/** @} */ // end of packet2_arena subgroup
@@ -0,0 +1,103 @@
+/*
+# _____     ___ ____     ___ ____
+#  ____|   |    ____|   |        | |____|
+# |     ___|   |____ ___|    ____| |    \    PS2DEV Open Source Project.
+#-----------------------------------------------------------------------
+# Copyright 2001-2004, ps2dev - http://www.ps2dev.org
+# Licenced under Academic Free License version 2.0
+# Review ps2sdk README & LICENSE files for further details.
+*/
+
+/**
+ * @file Scratchpad packet streaming.
+ * @defgroup packet2_spr Scratchpad
+ * Build packets in scratchpad and stream them to GIF or VIF1.
+ * A region of the 16KB scratchpad is split into two halves. Data is
+ * written into one half while DMA sends the other one straight from
+ * scratchpad, so building never goes through the data cache and never
+ * waits on main memory write-back.
+ * Transfers use normal mode. A GIF packet or VIF code may be split
+ * between two transfers, since GIF and VIF keep their state across them.
+ * @ingroup packet2
+ * @{
+ */
+
+#ifndef __PACKET2_SPR_H__
+#define __PACKET2_SPR_H__
+
+#include <packet2.h>
+
+/** Size of the scratchpad in bytes. */
+#define P2_SPR_SIZE 0x4000
+
+typedef struct
+{
+    /**
+     * Current half, in P2_MODE_NORMAL.
+     * Fill it with packet2_add_*() or with libdraw functions
+     * followed by packet2_update().
+     */
+    packet2_t packet;
+    /** Scratchpad offset of the region in bytes. */
+    u32 offset;
+    /** Size of one half in qwords. */
+    u16 half_qwords;
+    /** Half being filled, 0 or 1. */
+    u8 half;
+    /** DMA channel the data is streamed to. */
+    u8 channel;
+    /** Number of transfers started. */
+    u32 kicks;
+    /** Number of qwords sent. */
+    u32 qwords_sent;
+} packet2_spr_t;
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+    /**
+     * Set up scratchpad streaming.
+     * @param spr Pointer to stream.
+     * @param channel DMA_CHANNEL_GIF or DMA_CHANNEL_VIF1.
+     * The channel must have been initialized.
+     * @param offset Start of the region in scratchpad, in bytes.
+     * Multiple of 16.
+     * @param size Size of the region in bytes, multiple of 32.
+     * 0 for the rest of scratchpad.
+     */
+    extern void packet2_spr_init(packet2_spr_t *spr, int channel, u32 offset, u32 size);
+
+    /**
+     * Send the current half, if it holds any data, and switch to
+     * the other one. Waits for the transfer of the other half first.
+     * @param spr Pointer to stream.
+     */
+    extern void packet2_spr_kick(packet2_spr_t *spr);
+
+    /**
+     * Send what is left and wait until the transfer is finished.
+     * @param spr Pointer to stream.
+     */
+    extern void packet2_spr_finish(packet2_spr_t *spr);
+
+    /**
+     * Make room for qwords in the current half, kicking it if needed.
+     * Call it before every add of up to half_qwords.
+     * @param spr Pointer to stream.
+     * @param qwords Number of qwords about to be added.
+     */
+    static inline void packet2_spr_reserve(packet2_spr_t *spr, u32 qwords)
+    {
+        if (packet2_get_qw_count(&spr->packet) + qwords > spr->half_qwords)
+            packet2_spr_kick(spr);
+    }
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __PACKET2_SPR_H__ */
+
+/** @} */ // end of packet2_spr subgroup
@@ -15,4 +15,5 @@
 char *erl_id = "libpacket2";
 char *erl_dependancies[] = {
     "libc",
+    "libdma",
     0};
@@ -0,0 +1,123 @@
+/*
+# _____     ___ ____     ___ ____
+#  ____|   |    ____|   |        | |____|
+# |     ___|   |____ ___|    ____| |    \    PS2DEV Open Source Project.
+#-----------------------------------------------------------------------
+# Copyright 2001-2004, ps2dev - http://www.ps2dev.org
+# Licenced under Academic Free License version 2.0
+# Review ps2sdk README & LICENSE files for further details.
+*/
+
+#include <malloc.h>
+#include <kernel.h>
+#include <assert.h>
+#include <dma.h>
+#include <packet2_arena.h>
+#include <string.h>
+
+#define P2_ALIGNMENT 64
+// Packets start on their own cache line, so no line is shared by two packets
+#define P2_ARENA_ROUND_QWORDS(QW) (((QW) + 3) & ~3)
+
+packet2_arena_t *packet2_arena_create(u32 frame_qwords, u16 max_packets, u8 frames)
+{
+    assert(frames >= 1 && frames <= P2_ARENA_MAX_FRAMES);
+
+    packet2_arena_t *arena = (packet2_arena_t *)calloc(1, sizeof(packet2_arena_t));
+    if (arena == NULL)
+        return NULL;
+
+    arena->frame_qwords = P2_ARENA_ROUND_QWORDS(frame_qwords);
+    arena->max_packets = max_packets;
+    arena->frames = frames;
+
+    arena->base = (qword_t *)memalign(P2_ALIGNMENT, (arena->frame_qwords << 4) * frames);
+    arena->packets = (packet2_t *)memalign(P2_ALIGNMENT, sizeof(packet2_t) * max_packets * frames);
+    if (arena->base == NULL || arena->packets == NULL)
+    {
+        free(arena->base);
+        free(arena->packets);
+        free(arena);
+        return NULL;
+    }
+
+    // The heap may have left dirty lines over the data
+    memset(arena->writeback, 1, sizeof(arena->writeback));
+
+    return arena;
+}
+
+void packet2_arena_free(packet2_arena_t *arena)
+{
+    free(arena->base);
+    free(arena->packets);
+    free(arena);
+}
+
+packet2_t *packet2_arena_alloc(packet2_arena_t *arena, u16 qwords, enum Packet2Type type, enum Packet2Mode mode, u8 tte)
+{
+    assert(type != P2_TYPE_SPRAM);
+
+    u32 size = P2_ARENA_ROUND_QWORDS(qwords);
+    u8 frame = arena->current;
+
+    if (arena->used_qwords + size > arena->frame_qwords || arena->used_packets >= arena->max_packets)
+        return NULL;
+
+    if (type == P2_TYPE_UNCACHED || type == P2_TYPE_UNCACHED_ACCL)
+    {
+        // Dirty lines from an earlier use of this frame must not be written back over uncached data later.
+        // One flush covers every frame.
+        if (arena->writeback[frame])
+        {
+            FlushCache(0);
+            memset(arena->writeback, 0, sizeof(arena->writeback));
+        }
+    }
+    else
+        arena->cached[frame] = 1;
+
+    packet2_t *packet2 = &arena->packets[frame * arena->max_packets + arena->used_packets];
+    qword_t *data = arena->base + frame * arena->frame_qwords + arena->used_qwords;
+
+    packet2->max_qwords_count = qwords;
+    packet2->type = type;
+    packet2->mode = mode;
+    packet2->tte = tte;
+    packet2->tag_opened_at = NULL;
+    packet2->vif_code_opened_at = NULL;
+    packet2->base = packet2->next = (qword_t *)((u32)data | type);
+
+    arena->used_packets++;
+    arena->used_qwords += size;
+    if (arena->used_qwords > arena->peak_qwords)
+        arena->peak_qwords = arena->used_qwords;
+
+    return packet2;
+}
+
+void packet2_arena_next_frame(packet2_arena_t *arena)
+{
+    u8 next = (arena->current + 1) % arena->frames;
+    u32 pending = arena->fence[next];
+    int i;
+
+    // Transfers on one channel run in order, so a newer one means this one is done
+    for (i = 1; i < arena->frames; i++)
+        pending &= ~arena->fence[(next + i) % arena->frames];
+
+    for (i = 0; pending != 0; i++, pending >>= 1)
+    {
+        if (pending & 1)
+            dma_channel_wait(i, 0);
+    }
+
+    if (arena->cached[next])
+        arena->writeback[next] = 1;
+    arena->cached[next] = 0;
+    arena->fence[next] = 0;
+
+    arena->current = next;
+    arena->used_qwords = 0;
+    arena->used_packets = 0;
+}
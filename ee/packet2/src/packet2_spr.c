@@ -0,0 +1,63 @@
+/*
+# _____     ___ ____     ___ ____
+#  ____|   |    ____|   |        | |____|
+# |     ___|   |____ ___|    ____| |    \    PS2DEV Open Source Project.
+#-----------------------------------------------------------------------
+# Copyright 2001-2004, ps2dev - http://www.ps2dev.org
+# Licenced under Academic Free License version 2.0
+# Review ps2sdk README & LICENSE files for further details.
+*/
+
+#include <assert.h>
+#include <dma.h>
+#include <packet2_spr.h>
+
+static void packet2_spr_set_half(packet2_spr_t *spr, u8 half)
+{
+    spr->half = half;
+    spr->packet.base = spr->packet.next = (qword_t *)(P2_TYPE_SPRAM + spr->offset + ((half * spr->half_qwords) << 4));
+    spr->packet.tag_opened_at = NULL;
+    spr->packet.vif_code_opened_at = NULL;
+}
+
+void packet2_spr_init(packet2_spr_t *spr, int channel, u32 offset, u32 size)
+{
+    if (size == 0)
+        size = P2_SPR_SIZE - offset;
+
+    assert(!(offset & 15) && !(size & 31) && size > 0 && offset + size <= P2_SPR_SIZE);
+
+    spr->offset = offset;
+    spr->half_qwords = size >> 5;
+    spr->channel = channel;
+    spr->kicks = 0;
+    spr->qwords_sent = 0;
+
+    spr->packet.max_qwords_count = spr->half_qwords;
+    spr->packet.type = P2_TYPE_SPRAM;
+    spr->packet.mode = P2_MODE_NORMAL;
+    spr->packet.tte = 0;
+    packet2_spr_set_half(spr, 0);
+}
+
+void packet2_spr_kick(packet2_spr_t *spr)
+{
+    u32 qwc = packet2_get_qw_count(&spr->packet);
+
+    if (qwc == 0)
+        return;
+
+    // The other half was the last one sent; once it is out it can be refilled
+    dma_channel_wait(spr->channel, 0);
+    dma_channel_send_normal(spr->channel, (void *)((u32)spr->packet.base & (P2_SPR_SIZE - 1)), qwc, 0, 1);
+
+    spr->kicks++;
+    spr->qwords_sent += qwc;
+    packet2_spr_set_half(spr, spr->half ^ 1);
+}
+
+void packet2_spr_finish(packet2_spr_t *spr)
+{
+    packet2_spr_kick(spr);
+    dma_channel_wait(spr->channel, 0);
+}
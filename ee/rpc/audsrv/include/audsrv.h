@@ -117,6 +117,45 @@ extern int audsrv_play_audio(const char *chunk, int bytes);
  */
 extern int audsrv_stop_audio();
 
+/** Switches audio playback to shared-ring streaming
+ * @returns error code
+ *
+ * In this mode audsrv_stream_audio() DMAs audio straight into audsrv's
+ * ring buffer on the IOP, and the IOP publishes its read position back
+ * into EE memory, so queueing audio costs no RPC round trip. The ring is
+ * reset; audsrv_play_audio() is rejected until audsrv_stream_stop().
+ * Changing the format with audsrv_set_format() keeps streaming active.
+ */
+extern int audsrv_stream_start();
+
+/** Leaves shared-ring streaming mode
+ * @returns error code
+ */
+extern int audsrv_stream_stop();
+
+/** Queues audio in streaming mode
+ * @param chunk   audio buffer, must be 16-byte aligned
+ * @param bytes   size of chunk in bytes
+ * @returns number of bytes queued, or negative error status
+ *
+ * Only whole quadwords that fit in the ring are queued; the return value
+ * may be less than bytes. The transfer is asynchronous: chunk must not be
+ * modified until the next call to audsrv_stream_audio() or
+ * audsrv_stream_sync(). Use audsrv_on_fillbuf() or
+ * audsrv_stream_available() to pace submission.
+ */
+extern int audsrv_stream_audio(const char *chunk, int bytes);
+
+/** Returns the number of bytes that can be queued in streaming mode
+ * @returns byte count, a multiple of 16
+ *
+ * Computed locally from the read position last published by the IOP.
+ */
+extern int audsrv_stream_available();
+
+/** Waits for the last audsrv_stream_audio() transfer to complete */
+extern void audsrv_stream_sync();
+
 /** Returns the last error audsrv raised
  * @returns error code
  */
@@ -45,6 +45,18 @@ static void *on_cdda_stop_arg = NULL;
 static audsrv_callback_t on_fillbuf = NULL;
 static void *on_fillbuf_arg = NULL;
 
+/* shared-ring streaming */
+static int stream_active = 0;
+static u32 stream_ring = 0;
+static int stream_ring_size = 0;
+static u32 stream_ctrl = 0;
+static int stream_writepos = 0;
+static int stream_dma_id = 0;
+/** write cursor, DMA'd into the IOP control block after each chunk */
+static unsigned int stream_cursor[4] __attribute__((aligned (64)));
+/** read cursor, DMA'd here by the IOP. Only accessed uncached. */
+static unsigned int stream_status[16] __attribute__((aligned (64)));
+
 static const unsigned short vol_values[26] =
 {
 	0x0000,
@@ -142,6 +154,9 @@ static int call_rpc_3(int func, int arg1, int arg2, int arg3)
 
 int audsrv_quit()
 {
+	audsrv_stream_sync();
+	stream_active = 0;
+
 	WaitSema(completion_sema);
 
 	sceSifCallRpc(&cd0, AUDSRV_QUIT, 0, sbuff, 1*4, sbuff, 4, NULL, NULL);
@@ -160,6 +175,9 @@ int audsrv_set_format(struct audsrv_fmt_t *fmt)
 {
 	int ret;
 
+	/* the IOP resets the ring, so let the last chunk land first */
+	audsrv_stream_sync();
+
 	WaitSema(completion_sema);
 
 	sbuff[0] = fmt->freq;
@@ -172,6 +190,12 @@ int audsrv_set_format(struct audsrv_fmt_t *fmt)
 
 	set_error(ret);
 
+	if (ret == AUDSRV_ERR_NOERROR && stream_active)
+	{
+		/* take over the new ring geometry */
+		ret = audsrv_stream_start();
+	}
+
 	return ret;
 }
 
@@ -289,6 +313,155 @@ int audsrv_play_audio(const char *chunk, int bytes)
 	return sent;
 }
 
+int audsrv_stream_start()
+{
+	volatile unsigned int *status;
+	int ret;
+
+	audsrv_stream_sync();
+
+	/* flush any dirty line, then only touch the cursor uncached */
+	SyncDCache(stream_status, (char *)stream_status + sizeof(stream_status));
+	status = UNCACHED_SEG(stream_status);
+
+	WaitSema(completion_sema);
+
+	sbuff[0] = (u32)stream_status;
+	sceSifCallRpc(&cd0, AUDSRV_STREAM_START, 0, sbuff, 1*4, sbuff, 6*4, NULL, NULL);
+
+	ret = sbuff[0];
+	if (ret == AUDSRV_ERR_NOERROR)
+	{
+		stream_ring = sbuff[1];
+		stream_ring_size = sbuff[2];
+		stream_ctrl = sbuff[3];
+		stream_writepos = sbuff[4];
+		status[0] = sbuff[5];
+		stream_active = 1;
+	}
+
+	SignalSema(completion_sema);
+
+	set_error(ret);
+
+	return ret;
+}
+
+int audsrv_stream_stop()
+{
+	audsrv_stream_sync();
+	stream_active = 0;
+
+	return call_rpc_1(AUDSRV_STREAM_STOP, 0);
+}
+
+int audsrv_stream_available()
+{
+	int readpos, available;
+
+	if (!stream_active)
+	{
+		return 0;
+	}
+
+	/* may lag behind the IOP, which only underestimates the free space */
+	readpos = *(volatile unsigned int *)UNCACHED_SEG(&stream_status[0]);
+	if (stream_writepos <= readpos)
+	{
+		available = readpos - stream_writepos;
+	}
+	else
+	{
+		available = stream_ring_size - (stream_writepos - readpos);
+	}
+
+	return available & ~15;
+}
+
+void audsrv_stream_sync()
+{
+	if (stream_dma_id != 0)
+	{
+		while (sceSifDmaStat(stream_dma_id) >= 0);
+		stream_dma_id = 0;
+	}
+}
+
+int audsrv_stream_audio(const char *chunk, int bytes)
+{
+	SifDmaTransfer_t dmat[3];
+	int available, copy, count, id;
+
+	if (!stream_active)
+	{
+		set_error(AUDSRV_ERR_NOT_INITIALIZED);
+		return -AUDSRV_ERR_NOT_INITIALIZED;
+	}
+
+	if (((u32)chunk & 15) != 0 || bytes < 0)
+	{
+		set_error(AUDSRV_ERR_ARGS);
+		return -AUDSRV_ERR_ARGS;
+	}
+
+	set_error(AUDSRV_ERR_NOERROR);
+
+	/* the previous chunk and the cursor buffer must be free again */
+	audsrv_stream_sync();
+
+	available = audsrv_stream_available();
+	bytes = bytes & ~15;
+	if (bytes > available)
+	{
+		bytes = available;
+	}
+
+	if (bytes == 0)
+	{
+		return 0;
+	}
+
+	SyncDCache((void *)chunk, (void *)(chunk + bytes));
+
+	/* split at the end of the ring */
+	count = 0;
+	copy = MIN(bytes, stream_ring_size - stream_writepos);
+	dmat[count].src = (void *)chunk;
+	dmat[count].dest = (void *)(stream_ring + stream_writepos);
+	dmat[count].size = copy;
+	dmat[count].attr = 0;
+	count++;
+
+	if (copy < bytes)
+	{
+		dmat[count].src = (void *)(chunk + copy);
+		dmat[count].dest = (void *)stream_ring;
+		dmat[count].size = bytes - copy;
+		dmat[count].attr = 0;
+		count++;
+	}
+
+	stream_writepos = stream_writepos + bytes;
+	if (stream_writepos >= stream_ring_size)
+	{
+		stream_writepos = stream_writepos - stream_ring_size;
+	}
+
+	/* publish the write cursor after the data, in the same DMA chain */
+	stream_cursor[0] = stream_writepos;
+	SyncDCache(stream_cursor, (char *)stream_cursor + sizeof(stream_cursor));
+	dmat[count].src = stream_cursor;
+	dmat[count].dest = (void *)stream_ctrl;
+	dmat[count].size = sizeof(stream_cursor);
+	dmat[count].attr = 0;
+	count++;
+
+	while ((id = sceSifSetDma(dmat, count)) == 0);
+	stream_dma_id = id;
+
+	return bytes;
+}
+
 int audsrv_stop_audio()
 {
 	int ret;
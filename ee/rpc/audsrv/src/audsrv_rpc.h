@@ -57,6 +57,10 @@
 #define AUDSRV_AVAILABLE            0x001a
 #define AUDSRV_QUEUED               0x001b
 
+/** shared-ring streaming functions */
+#define AUDSRV_STREAM_START         0x001e
+#define AUDSRV_STREAM_STOP          0x001f
+
 #define AUDSRV_FILLBUF_CALLBACK     0x0001
 #define AUDSRV_CDDA_CALLBACK        0x0002
 
@@ -0,0 +1,216 @@
+/*
+# _____     ___ ____     ___ ____
+#  ____|   |    ____|   |        | |____|
+# |     ___|   |____ ___|    ____| |    \    PS2DEV Open Source Project.
+#-----------------------------------------------------------------------
+# Copyright 2001-2004, ps2dev - http://www.ps2dev.org
+# Licenced under Academic Free License version 2.0
+# Review ps2sdk README & LICENSE files for further details.
+*/
+
+/**
+ * @file VU1 rendering pipeline.
+ * @defgroup vu1pipe VU1 pipeline
+ * Draws meshes with VU1 micro programs, streaming vertex data through VIF1.
+ * The pipeline keeps micro programs resident in VU1 micro memory and
+ * uploads them on demand, evicting the least recently used ones when
+ * memory runs out. Meshes are split into batches that fit one half of
+ * the double buffered VU1 data memory, so VIF1 unpacks the next batch
+ * while VU1 transforms the current one. Vertex arrays are sent with REF
+ * tags and never copied.
+ *
+ * Two standard programs are built in:
+ * - VU1PIPE_PROGRAM_TRANSFORM - transform, clip test, perspective divide,
+ *   with a constant colour.
+ * - VU1PIPE_PROGRAM_LIGHT - the same, with up to three directional lights
+ *   and an ambient light applied to per-vertex normals.
+ *
+ * Every batch is laid out in VU1 data memory as follows (qwords,
+ * relative to TOP):
+ * - 0: x = vertex count.
+ * - 1: GIF tag for the output (STQ, RGBAQ, XYZ2 reglist, EOP).
+ * - 2-5: local_screen matrix.
+ * - 6: Screen scale (x, y, z).
+ * - 7: Colour (r, g, b, a as u32, 0x80 = 1.0).
+ * - 8-11: Lights, intensities of up to three lights per normal axis,
+ *   and the colour clamp in 11.x.
+ * - 12-15: Light colours, ambient in 15.
+ * - 16-: Vertex streams: positions (x, y, z, 1), texture coordinates
+ *   (s, t, 1, 0), then normals for programs with 3 streams.
+ * - After the streams: the output, 1 GIF tag and 3 qwords per vertex.
+ * Custom programs added with vu1pipe_program_add() get the same layout.
+ * @{
+ */
+
+#ifndef __VU1PIPE_H__
+#define __VU1PIPE_H__
+
+#include <tamtypes.h>
+#include <math3d.h>
+#include <packet2.h>
+#include <draw_primitives.h>
+
+/** Transform, clip and constant colour. 2 streams. */
+#define VU1PIPE_PROGRAM_TRANSFORM 0
+/** Transform, clip and directional lighting. 3 streams. */
+#define VU1PIPE_PROGRAM_LIGHT 1
+
+/** Maximum number of programs, the standard ones included. */
+#define VU1PIPE_MAX_PROGRAMS 8
+/** Size of VU1 micro memory, in instructions. */
+#define VU1PIPE_MICRO_SIZE 2048
+/** Size of one data memory buffer, in qwords. VU1 data memory is split in two. */
+#define VU1PIPE_BUFFER_QWORDS 512
+/** Size of the batch header, in qwords. */
+#define VU1PIPE_HEADER_QWORDS 16
+/** Output qwords per vertex: STQ, RGBAQ, XYZ2. */
+#define VU1PIPE_OUT_QWORDS 3
+
+typedef struct
+{
+    u32 *start;
+    u32 *end;
+    /** Size in instructions. */
+    u16 size;
+    /** Address in micro memory, in instructions. -1 if not resident. */
+    s16 addr;
+    /** Number of vertex streams, 2 or 3. */
+    u8 streams;
+    /** Frame it was last used in, for eviction. */
+    u32 last_use;
+} vu1pipe_program_t;
+
+typedef struct
+{
+    /** Positions, (x, y, z, 1). */
+    VECTOR *positions;
+    /** Texture coordinates, (s, t, 1, 0). */
+    VECTOR *sts;
+    /** Normals, for programs with 3 streams. */
+    VECTOR *normals;
+    /** Number of vertices. */
+    u32 count;
+    /** Primitive. Lists and strips are supported, fans are not. */
+    prim_t *prim;
+    /** Drawing context. */
+    u8 context;
+    /** Program to draw with. */
+    u8 program;
+    /** Colour, (r, g, b, a), 0x80 = 1.0. */
+    u32 rgba[4];
+} vu1pipe_mesh_t;
+
+typedef struct
+{
+    /** Ping-pong chain packets. */
+    packet2_t *packets[2];
+    /** Packet being filled. */
+    packet2_t *packet;
+    u8 current;
+    /** Program VU1 ran last in this stream, -1 if unknown. MSCNT is used to run it again. */
+    s8 last_program;
+    /** BASE and OFFSET must be set at the start of the next packet. */
+    u8 set_buffers;
+    u8 program_count;
+    vu1pipe_program_t programs[VU1PIPE_MAX_PROGRAMS];
+    /** Scale to GS screen space. */
+    VECTOR scale;
+    /** Header qwords 8-15, set by vu1pipe_set_lights(). */
+    VECTOR lights[8];
+    u32 frame;
+    /** Statistics of the current frame. */
+    u32 batches;
+    u32 uploads;
+    u32 kicks;
+} vu1pipe_t;
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+    /**
+     * Create pipeline.
+     * VIF1 DMA channel must have been initialized.
+     * @param packet_qwords Size of each of the two packets, in qwords.
+     * A full packet is sent and the other one is filled while it transfers.
+     * @returns Pointer to pipeline or NULL if memory allocation fail.
+     */
+    extern vu1pipe_t *vu1pipe_create(u16 packet_qwords);
+
+    /**
+     * Free pipeline. VIF1 must not be sending its packets.
+     * @param pipe Pointer to pipeline.
+     */
+    extern void vu1pipe_free(vu1pipe_t *pipe);
+
+    /**
+     * Add custom micro program.
+     * It must follow the batch layout, end with [E], and branch back to
+     * its start right after the [E] delay slot, so MSCNT runs it again.
+     * @param pipe Pointer to pipeline.
+     * @param start Start of the code.
+     * @param end End of the code.
+     * @param streams Number of vertex streams, 2 or 3.
+     * @returns Program id, or -1 if there is no room for it.
+     */
+    extern int vu1pipe_program_add(vu1pipe_t *pipe, u32 *start, u32 *end, u8 streams);
+
+    /**
+     * Forget what VU1 holds, after other code used VU1.
+     * Programs are uploaded again and BASE/OFFSET set again.
+     * @param pipe Pointer to pipeline.
+     */
+    extern void vu1pipe_invalidate(vu1pipe_t *pipe);
+
+    /**
+     * Set scale to GS screen space, (2048, 2048, 0xFFFFFF / 32) by default.
+     * @param pipe Pointer to pipeline.
+     */
+    extern void vu1pipe_set_scale(vu1pipe_t *pipe, float x, float y, float z);
+
+    /**
+     * Set lights for VU1PIPE_PROGRAM_LIGHT, for the following draws.
+     * Takes the same lights as calculate_lights(). local_light must only rotate.
+     * @param pipe Pointer to pipeline.
+     * @returns 0, or -1 if there are more than 3 directional lights.
+     */
+    extern int vu1pipe_set_lights(vu1pipe_t *pipe, MATRIX local_light, VECTOR *light_directions, VECTOR *light_colours, const int *light_types, int light_count);
+
+    /**
+     * Start frame.
+     * @param pipe Pointer to pipeline.
+     */
+    extern void vu1pipe_begin(vu1pipe_t *pipe);
+
+    /**
+     * Draw mesh, split into as many batches as needed.
+     * The arrays must stay valid until the frame is sent and transferred.
+     * @param pipe Pointer to pipeline.
+     * @param mesh Pointer to mesh.
+     * @param local_screen Matrix to transform with.
+     * @returns Number of batches, or -1 on bad mesh.
+     */
+    extern int vu1pipe_draw(vu1pipe_t *pipe, const vu1pipe_mesh_t *mesh, MATRIX local_screen);
+
+    /**
+     * Send the rest of the frame on VIF1.
+     * @param pipe Pointer to pipeline.
+     */
+    extern void vu1pipe_end(vu1pipe_t *pipe);
+
+    /**
+     * Get the largest batch of a program, in vertices.
+     * @param pipe Pointer to pipeline.
+     * @param program Program id.
+     * @param align Vertices per primitive, the batch is a multiple of it.
+     */
+    extern u32 vu1pipe_batch_size(vu1pipe_t *pipe, int program, u32 align);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __VU1PIPE_H__ */
+
+/** @} */ // end of vu1pipe group
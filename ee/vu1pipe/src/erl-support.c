@@ -0,0 +1,20 @@
+/*
+# _____     ___ ____     ___ ____
+#  ____|   |    ____|   |        | |____|
+# |     ___|   |____ ___|    ____| |    \    PS2DEV Open Source Project.
+#-----------------------------------------------------------------------
+# Copyright 2001-2004, ps2dev - http://www.ps2dev.org
+# Licenced under Academic Free License version 2.0
+# Review ps2sdk README & LICENSE files for further details.
+#
+# The erl-tags support
+*/
+
+#include <erl.h>
+
+char *erl_id = "libvu1pipe";
+char *erl_dependancies[] = {
+    "libc",
+    "libdma",
+    "libpacket2",
+    0};
@@ -0,0 +1,366 @@
+/*
+# _____     ___ ____     ___ ____
+#  ____|   |    ____|   |        | |____|
+# |     ___|   |____ ___|    ____| |    \    PS2DEV Open Source Project.
+#-----------------------------------------------------------------------
+# Copyright 2001-2004, ps2dev - http://www.ps2dev.org
+# Licenced under Academic Free License version 2.0
+# Review ps2sdk README & LICENSE files for further details.
+*/
+
+#include <malloc.h>
+#include <string.h>
+#include <dma.h>
+#include <packet2.h>
+#include <packet2_utils.h>
+#include <vu1pipe.h>
+
+extern u32 VU1PipeTransform_CodeStart __attribute__((section(".vudata")));
+extern u32 VU1PipeTransform_CodeEnd __attribute__((section(".vudata")));
+extern u32 VU1PipeLight_CodeStart __attribute__((section(".vudata")));
+extern u32 VU1PipeLight_CodeEnd __attribute__((section(".vudata")));
+
+// Header CNT with 16 qwords, up to 3 stream REFs and the start CNT
+#define VU1PIPE_BATCH_PACKET_QWORDS (1 + VU1PIPE_HEADER_QWORDS + 3 + 1)
+
+// Header qwords 2-15 only need to be sent in the first two batches of a
+// mesh, one per buffer; later batches find them in place.
+#define VU1PIPE_CONSTANT_BATCHES 2
+
+vu1pipe_t *vu1pipe_create(u16 packet_qwords)
+{
+    vu1pipe_t *pipe = (vu1pipe_t *)memalign(64, sizeof(vu1pipe_t));
+    if (pipe == NULL)
+        return NULL;
+
+    memset(pipe, 0, sizeof(vu1pipe_t));
+
+    pipe->packets[0] = packet2_create(packet_qwords, P2_TYPE_NORMAL, P2_MODE_CHAIN, 1);
+    pipe->packets[1] = packet2_create(packet_qwords, P2_TYPE_NORMAL, P2_MODE_CHAIN, 1);
+    if (pipe->packets[0] == NULL || pipe->packets[1] == NULL)
+    {
+        vu1pipe_free(pipe);
+        return NULL;
+    }
+    pipe->packet = pipe->packets[0];
+
+    vu1pipe_program_add(pipe, &VU1PipeTransform_CodeStart, &VU1PipeTransform_CodeEnd, 2);
+    vu1pipe_program_add(pipe, &VU1PipeLight_CodeStart, &VU1PipeLight_CodeEnd, 3);
+
+    vu1pipe_set_scale(pipe, 2048.0f, 2048.0f, ((float)0xFFFFFF) / 32.0f);
+    vu1pipe_invalidate(pipe);
+
+    return pipe;
+}
+
+void vu1pipe_free(vu1pipe_t *pipe)
+{
+    if (pipe->packets[0] != NULL)
+        packet2_free(pipe->packets[0]);
+    if (pipe->packets[1] != NULL)
+        packet2_free(pipe->packets[1]);
+    free(pipe);
+}
+
+int vu1pipe_program_add(vu1pipe_t *pipe, u32 *start, u32 *end, u8 streams)
+{
+    vu1pipe_program_t *program;
+    u32 size = (end - start) / 2;
+
+    // MPG sends instruction pairs
+    if (size & 1)
+        size++;
+
+    if (pipe->program_count == VU1PIPE_MAX_PROGRAMS || size > VU1PIPE_MICRO_SIZE || streams < 2 || streams > 3)
+        return -1;
+
+    program = &pipe->programs[pipe->program_count];
+    program->start = start;
+    program->end = end;
+    program->size = size;
+    program->addr = -1;
+    program->streams = streams;
+    program->last_use = 0;
+
+    return pipe->program_count++;
+}
+
+void vu1pipe_invalidate(vu1pipe_t *pipe)
+{
+    int i;
+
+    for (i = 0; i < pipe->program_count; i++)
+        pipe->programs[i].addr = -1;
+
+    pipe->last_program = -1;
+    pipe->set_buffers = 1;
+}
+
+void vu1pipe_set_scale(vu1pipe_t *pipe, float x, float y, float z)
+{
+    pipe->scale[0] = x;
+    pipe->scale[1] = y;
+    pipe->scale[2] = z;
+    pipe->scale[3] = 0.0f;
+}
+
+int vu1pipe_set_lights(vu1pipe_t *pipe, MATRIX local_light, VECTOR *light_directions, VECTOR *light_colours, const int *light_types, int light_count)
+{
+    int i, j, directional = 0;
+
+    // 0-3: intensity of each light per normal axis, 4-7: light colours, ambient last
+    memset(pipe->lights, 0, sizeof(pipe->lights));
+
+    for (i = 0; i < light_count; i++)
+    {
+        if (light_types[i] == LIGHT_AMBIENT)
+        {
+            for (j = 0; j < 3; j++)
+                pipe->lights[7][j] += light_colours[i][j];
+        }
+        else if (light_types[i] == LIGHT_DIRECTIONAL)
+        {
+            if (directional == 3)
+                return -1;
+
+            // Negated, as in calculate_lights()
+            for (j = 0; j < 3; j++)
+                pipe->lights[j][directional] = -((local_light[(j * 4) + 0] * light_directions[i][0]) +
+                                                 (local_light[(j * 4) + 1] * light_directions[i][1]) +
+                                                 (local_light[(j * 4) + 2] * light_directions[i][2])) /
+                                               light_directions[i][3];
+
+            for (j = 0; j < 3; j++)
+                pipe->lights[4 + directional][j] = light_colours[i][j];
+
+            directional++;
+        }
+    }
+
+    // Colour clamp
+    pipe->lights[3][0] = 255.0f;
+
+    return 0;
+}
+
+static void vu1pipe_kick(vu1pipe_t *pipe)
+{
+    packet2_utils_vu_add_end_tag(pipe->packet);
+
+    dma_channel_wait(DMA_CHANNEL_VIF1, 0);
+    dma_channel_send_packet2(pipe->packet, DMA_CHANNEL_VIF1, 1);
+    pipe->kicks++;
+
+    // The other packet was sent before this one, so it is done by now
+    pipe->current ^= 1;
+    pipe->packet = pipe->packets[pipe->current];
+    packet2_reset(pipe->packet, 0);
+}
+
+static void vu1pipe_reserve(vu1pipe_t *pipe, u32 qwords)
+{
+    // + 1 for the END tag, + 1 for BASE/OFFSET
+    if (packet2_get_qw_count(pipe->packet) + qwords + 2 > pipe->packet->max_qwords_count)
+        vu1pipe_kick(pipe);
+
+    if (pipe->set_buffers)
+    {
+        packet2_utils_vu_add_double_buffer(pipe->packet, 0, VU1PIPE_BUFFER_QWORDS);
+        pipe->set_buffers = 0;
+    }
+}
+
+// Find room in micro memory, evicting the least recently used programs
+static int vu1pipe_place(vu1pipe_t *pipe, vu1pipe_program_t *program)
+{
+    int i, addr;
+
+    for (;;)
+    {
+        // First fit, trying the start of memory and the end of every resident program
+        for (i = -1; i < pipe->program_count; i++)
+        {
+            int j, fits = 1;
+
+            if (i >= 0 && pipe->programs[i].addr < 0)
+                continue;
+
+            addr = (i < 0) ? 0 : pipe->programs[i].addr + pipe->programs[i].size;
+            if (addr + program->size > VU1PIPE_MICRO_SIZE)
+                continue;
+
+            for (j = 0; j < pipe->program_count; j++)
+            {
+                vu1pipe_program_t *other = &pipe->programs[j];
+
+                if (other->addr >= 0 && other->addr < addr + program->size && addr < other->addr + other->size)
+                {
+                    fits = 0;
+                    break;
+                }
+            }
+
+            if (fits)
+                return addr;
+        }
+
+        // Evict
+        {
+            vu1pipe_program_t *lru = NULL;
+
+            for (i = 0; i < pipe->program_count; i++)
+            {
+                vu1pipe_program_t *other = &pipe->programs[i];
+
+                if (other->addr >= 0 && other != program && (lru == NULL || other->last_use < lru->last_use))
+                    lru = other;
+            }
+
+            if (lru == NULL)
+                return -1;
+
+            if (pipe->last_program == lru - pipe->programs)
+                pipe->last_program = -1;
+            lru->addr = -1;
+        }
+    }
+}
+
+static void vu1pipe_start(vu1pipe_t *pipe, int id)
+{
+    vu1pipe_program_t *program = &pipe->programs[id];
+
+    program->last_use = pipe->frame;
+
+    if (program->addr < 0)
+    {
+        // MPG waits for VU1 to end, so the program it replaces may still be running until then
+        program->addr = vu1pipe_place(pipe, program);
+        packet2_vif_add_micro_program(pipe->packet, program->addr, program->start, program->end);
+        pipe->uploads++;
+        pipe->last_program = -1;
+    }
+
+    // Programs branch back to their start after [E], so MSCNT runs the same one again
+    if (pipe->last_program == id)
+        packet2_utils_vu_add_continue_program(pipe->packet);
+    else
+        packet2_utils_vu_add_start_program(pipe->packet, program->addr);
+
+    pipe->last_program = id;
+}
+
+u32 vu1pipe_batch_size(vu1pipe_t *pipe, int program, u32 align)
+{
+    u32 per_vertex = pipe->programs[program].streams + VU1PIPE_OUT_QWORDS;
+    u32 count = (VU1PIPE_BUFFER_QWORDS - VU1PIPE_HEADER_QWORDS - 1) / per_vertex;
+
+    return count - (count % align);
+}
+
+void vu1pipe_begin(vu1pipe_t *pipe)
+{
+    pipe->frame++;
+    pipe->batches = 0;
+    pipe->uploads = 0;
+    pipe->kicks = 0;
+
+    packet2_reset(pipe->packet, 0);
+}
+
+int vu1pipe_draw(vu1pipe_t *pipe, const vu1pipe_mesh_t *mesh, MATRIX local_screen)
+{
+    vu1pipe_program_t *program;
+    u32 align, overlap, max, first, count;
+    int batch;
+
+    if (mesh->program >= pipe->program_count || mesh->count == 0)
+        return -1;
+
+    program = &pipe->programs[mesh->program];
+    if (program->streams == 3 && mesh->normals == NULL)
+        return -1;
+
+    // Lists split on primitive boundaries, strips restart with the vertices they share
+    switch (mesh->prim->type)
+    {
+        case PRIM_LINE:
+        case PRIM_SPRITE:
+            align = 2;
+            overlap = 0;
+            break;
+        case PRIM_TRIANGLE:
+            align = 3;
+            overlap = 0;
+            break;
+        case PRIM_LINE_STRIP:
+            align = 1;
+            overlap = 1;
+            break;
+        case PRIM_TRIANGLE_STRIP:
+            align = 1;
+            overlap = 2;
+            break;
+        case PRIM_POINT:
+            align = 1;
+            overlap = 0;
+            break;
+        default:
+            return -1;
+    }
+
+    max = vu1pipe_batch_size(pipe, mesh->program, align);
+
+    for (first = 0, batch = 0; first < mesh->count; first += count - overlap, batch++)
+    {
+        u32 addr = VU1PIPE_HEADER_QWORDS;
+
+        count = mesh->count - first;
+        if (count > max)
+            count = max;
+
+        vu1pipe_reserve(pipe, VU1PIPE_BATCH_PACKET_QWORDS + (program->addr < 0 ? packet2_utils_get_packet_size_for_program(program->start, program->end) : 0));
+
+        packet2_utils_vu_open_unpack(pipe->packet, 0, 1);
+        packet2_add_s32(pipe->packet, count);
+        packet2_add_s32(pipe->packet, 0);
+        packet2_add_s32(pipe->packet, 0);
+        packet2_add_s32(pipe->packet, 0);
+        packet2_utils_gs_add_prim_giftag(pipe->packet, mesh->prim, count, DRAW_STQ2_REGLIST, 3, mesh->context);
+        if (batch < VU1PIPE_CONSTANT_BATCHES)
+        {
+            packet2_add_data(pipe->packet, local_screen, 4);
+            packet2_add_data(pipe->packet, pipe->scale, 1);
+            packet2_add_u32(pipe->packet, mesh->rgba[0]);
+            packet2_add_u32(pipe->packet, mesh->rgba[1]);
+            packet2_add_u32(pipe->packet, mesh->rgba[2]);
+            packet2_add_u32(pipe->packet, mesh->rgba[3]);
+            packet2_add_data(pipe->packet, pipe->lights, 8);
+        }
+        packet2_utils_vu_close_unpack(pipe->packet);
+
+        packet2_utils_vu_add_unpack_data(pipe->packet, addr, mesh->positions + first, count, 1);
+        addr += count;
+        packet2_utils_vu_add_unpack_data(pipe->packet, addr, mesh->sts + first, count, 1);
+        addr += count;
+        if (program->streams == 3)
+            packet2_utils_vu_add_unpack_data(pipe->packet, addr, mesh->normals + first, count, 1);
+
+        vu1pipe_start(pipe, mesh->program);
+        pipe->batches++;
+
+        // A strip shorter than the overlap is done
+        if (first + count >= mesh->count)
+        {
+            batch++;
+            break;
+        }
+    }
+
+    return batch;
+}
+
+void vu1pipe_end(vu1pipe_t *pipe)
+{
+    vu1pipe_kick(pipe);
+}
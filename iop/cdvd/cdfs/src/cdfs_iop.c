@@ -10,6 +10,20 @@
 
 #define MAX_DIR_CACHE_SECTORS 32
 
+// Recently read directory extents, shared by all directories (LRU)
+#ifndef DIR_SECT_CACHE_ENTRIES
+#define DIR_SECT_CACHE_ENTRIES 8
+#endif
+#ifndef DIR_SECT_CACHE_SECTORS
+#define DIR_SECT_CACHE_SECTORS 2
+#endif
+
+// Recently resolved files (direct-mapped hash table, must be a power of 2)
+#ifndef PATH_CACHE_ENTRIES
+#define PATH_CACHE_ENTRIES 32
+#endif
+#define PATH_CACHE_MAX_PATH 128
+
 struct DirTocEntry
 {
     short length;
@@ -45,6 +59,21 @@ struct CacheInfoDir
     u8 *cache;  // The actual cached data
 };
 
+struct DirSectCache
+{
+    u32 lsn;      // The first sector of the cached extent
+    u32 sectors;  // The number of cached sectors (0 = unused)
+    u32 stamp;    // Last use, for LRU replacement
+    u8 *data;     // DIR_SECT_CACHE_SECTORS sectors of directory data
+};
+
+struct PathCache
+{
+    u32 hash;                         // Hash of the normalized path (0 = unused)
+    char path[PATH_CACHE_MAX_PATH];   // Normalized (lower case, '/' separated) path
+    struct TocEntry tocEntry;
+};
+
 struct RootDirTocHeader
 {
     u16 length;
@@ -121,6 +150,11 @@ enum PathMatch {
 
 static struct CacheInfoDir cacheInfoDir;
 static struct CDVolDesc cdVolDesc;
+static int cdVolDescValid = FALSE;
+static struct DirSectCache dirSectCache[DIR_SECT_CACHE_ENTRIES];
+static u8 *dirSectCachePool;
+static u32 dirSectCacheStamp;
+static struct PathCache pathCache[PATH_CACHE_ENTRIES];
 static sceCdRMode cdReadMode;
 static u8 dvdvBuffer[2064];
 
@@ -143,6 +177,111 @@ static int strcasecmp(const char *s1, const char *s2) {
     return tolower(*(unsigned char *)s1) - tolower(*(unsigned char *)s2);
 }
 
+/***********************************************
+* Drops everything cached from the current disc *
+***********************************************/
+static void invalidateCaches(void) {
+    int i;
+
+    cacheInfoDir.valid = FALSE;
+    cdVolDescValid = FALSE;
+
+    for (i = 0; i < DIR_SECT_CACHE_ENTRIES; i++) {
+        dirSectCache[i].sectors = 0;
+        dirSectCache[i].stamp = 0;
+    }
+    dirSectCacheStamp = 0;
+
+    for (i = 0; i < PATH_CACHE_ENTRIES; i++)
+        pathCache[i].hash = 0;
+}
+
+// Read directory sectors, through the LRU cache of recent directory extents
+static int readDirSect(u32 lsn, u32 sectors, u8 *buf) {
+    struct DirSectCache *victim;
+    int i;
+
+    if (dirSectCachePool == NULL || sectors > DIR_SECT_CACHE_SECTORS)
+        return cdfs_readSect(lsn, sectors, buf);
+
+    victim = &dirSectCache[0];
+    for (i = 0; i < DIR_SECT_CACHE_ENTRIES; i++) {
+        struct DirSectCache *entry = &dirSectCache[i];
+
+        if (entry->sectors != 0 && entry->lsn == lsn && entry->sectors >= sectors) {
+            DPRINTF("readDirSect: sector %u found in cache\n", lsn);
+            entry->stamp = ++dirSectCacheStamp;
+            memcpy(buf, entry->data, sectors * 2048);
+            return TRUE;
+        }
+
+        if (entry->stamp < victim->stamp)
+            victim = entry;
+    }
+
+    if (!cdfs_readSect(lsn, sectors, buf))
+        return FALSE;
+
+    victim->lsn = lsn;
+    victim->sectors = sectors;
+    victim->stamp = ++dirSectCacheStamp;
+    memcpy(victim->data, buf, sectors * 2048);
+
+    return TRUE;
+}
+
+// Lower-case the path and unify the separators, returns its hash (never 0)
+// or 0 if the path is too long to be cached
+static u32 normalizePath(const char *path, char *out) {
+    u32 hash = 2166136261u;  // FNV-1a
+    int i;
+
+    for (i = 0; path[i] != '\0'; i++) {
+        char c;
+
+        if (i >= PATH_CACHE_MAX_PATH - 1)
+            return 0;
+
+        c = (path[i] == '\\') ? '/' : tolower(path[i]);
+        out[i] = c;
+        hash = (hash ^ (u8)c) * 16777619u;
+    }
+    out[i] = '\0';
+
+    return (hash != 0) ? hash : 1;
+}
+
+static int pathCacheLookup(const char *path, struct TocEntry *tocEntry) {
+    char normalized[PATH_CACHE_MAX_PATH];
+    struct PathCache *entry;
+    u32 hash;
+
+    if ((hash = normalizePath(path, normalized)) == 0)
+        return FALSE;
+
+    entry = &pathCache[hash & (PATH_CACHE_ENTRIES - 1)];
+    if (entry->hash != hash || strncmp(entry->path, normalized, PATH_CACHE_MAX_PATH) != 0)
+        return FALSE;
+
+    DPRINTF("pathCacheLookup: %s found in cache\n", path);
+    memcpy(tocEntry, &entry->tocEntry, sizeof(struct TocEntry));
+    return TRUE;
+}
+
+static void pathCacheInsert(const char *path, const struct TocEntry *tocEntry) {
+    char normalized[PATH_CACHE_MAX_PATH];
+    struct PathCache *entry;
+    u32 hash;
+
+    if ((hash = normalizePath(path, normalized)) == 0)
+        return;
+
+    entry = &pathCache[hash & (PATH_CACHE_ENTRIES - 1)];
+    entry->hash = hash;
+    strcpy(entry->path, normalized);
+    memcpy(&entry->tocEntry, tocEntry, sizeof(struct TocEntry));
+}
+
 /***********************************************
 * Determines if there is a valid disc inserted *
 ***********************************************/
@@ -271,7 +410,7 @@ static int findPath(char *pathname) {
                     if (cacheInfoDir.cache_size > MAX_DIR_CACHE_SECTORS)
                         cacheInfoDir.cache_size = MAX_DIR_CACHE_SECTORS;
 
-                    if (!cdfs_readSect(cacheInfoDir.sector_start + cacheInfoDir.cache_offset, cacheInfoDir.cache_size, cacheInfoDir.cache)) {
+                    if (!readDirSect(cacheInfoDir.sector_start + cacheInfoDir.cache_offset, cacheInfoDir.cache_size, cacheInfoDir.cache)) {
                         DPRINTF("Couldn't Read from CD !\n\n");
                         cacheInfoDir.valid = FALSE;  // should we completely invalidate just because we couldnt read time?
                         return FALSE;
@@ -362,7 +501,7 @@ static int findPath(char *pathname) {
         if (cacheInfoDir.cache_size > MAX_DIR_CACHE_SECTORS)
             cacheInfoDir.cache_size = MAX_DIR_CACHE_SECTORS;
 
-        if (!cdfs_readSect(cacheInfoDir.sector_start + cacheInfoDir.cache_offset, cacheInfoDir.cache_size, cacheInfoDir.cache)) {
+        if (!readDirSect(cacheInfoDir.sector_start + cacheInfoDir.cache_offset, cacheInfoDir.cache_size, cacheInfoDir.cache)) {
             DPRINTF("Couldn't Read from CD, trying to read %u sectors, starting at sector %u !\n\n",
                    cacheInfoDir.cache_size, cacheInfoDir.sector_start + cacheInfoDir.cache_offset);
             cacheInfoDir.valid = FALSE;  // should we completely invalidate just because we couldnt read time?
@@ -382,6 +521,10 @@ static int cdfs_getVolumeDescriptor(void) {
     static struct CDVolDesc localVolDesc;
     DPRINTF("cdfs_getVolumeDescriptor called\n\n");
 
+    // Already read from this disc
+    if (cdVolDescValid)
+        return TRUE;
+
     for (volDescSector = 16; volDescSector < 20; volDescSector++) {
         cdfs_readSect(volDescSector, 1, (u8*)&localVolDesc);
 
@@ -409,6 +552,7 @@ static int cdfs_getVolumeDescriptor(void) {
     }
 #endif
     //	sceCdStop();
+    cdVolDescValid = TRUE;
     return TRUE;
 }
 
@@ -459,7 +603,7 @@ static int cdfs_cacheDir(const char *pathname, enum Cache_getMode getMode) {
 
     // Invalidate table of contents cache if disk changed
     if (cdfs_checkDiskChanged(CHANGED_TOC)) {
-        cacheInfoDir.valid = FALSE;
+        invalidateCaches();
     }
 
     // only take any notice of the existing cache, if it's valid
@@ -492,7 +636,7 @@ static int cdfs_cacheDir(const char *pathname, enum Cache_getMode getMode) {
                         cacheInfoDir.cache_size = MAX_DIR_CACHE_SECTORS;
 
                     // Now fill the cache with the specified sectors
-                    if (!cdfs_readSect(cacheInfoDir.sector_start + cacheInfoDir.cache_offset, cacheInfoDir.cache_size, cacheInfoDir.cache)) {
+                    if (!readDirSect(cacheInfoDir.sector_start + cacheInfoDir.cache_offset, cacheInfoDir.cache_size, cacheInfoDir.cache)) {
                         DPRINTF("Couldn't Read from CD !\n");
 
                         cacheInfoDir.valid = FALSE;  // should we completely invalidate just because we couldnt read first time?
@@ -512,7 +656,7 @@ static int cdfs_cacheDir(const char *pathname, enum Cache_getMode getMode) {
                     cacheInfoDir.cache_size = MAX_DIR_CACHE_SECTORS;
 
                 // Now fill the cache with the specified sectors
-                if (!cdfs_readSect(cacheInfoDir.sector_start + cacheInfoDir.cache_offset, cacheInfoDir.cache_size, cacheInfoDir.cache)) {
+                if (!readDirSect(cacheInfoDir.sector_start + cacheInfoDir.cache_offset, cacheInfoDir.cache_size, cacheInfoDir.cache)) {
                     DPRINTF("Couldn't Read from CD !\n");
 
                     cacheInfoDir.valid = FALSE;  // should we completely invalidate just because we couldnt read first time?
@@ -543,7 +687,7 @@ static int cdfs_cacheDir(const char *pathname, enum Cache_getMode getMode) {
                         cacheInfoDir.cache_size = MAX_DIR_CACHE_SECTORS;
 
                     // Now fill the cache with the specified sectors
-                    if (!cdfs_readSect(cacheInfoDir.sector_start + cacheInfoDir.cache_offset, cacheInfoDir.cache_size, cacheInfoDir.cache)) {
+                    if (!readDirSect(cacheInfoDir.sector_start + cacheInfoDir.cache_offset, cacheInfoDir.cache_size, cacheInfoDir.cache)) {
                         DPRINTF("Couldn't Read from CD !\n");
                         cacheInfoDir.valid = FALSE;  // should we completely invalidate just because we couldnt read time?
                         return FALSE;
@@ -597,7 +741,7 @@ static int cdfs_cacheDir(const char *pathname, enum Cache_getMode getMode) {
         cacheInfoDir.cache_size = MAX_DIR_CACHE_SECTORS;
 
     // Now fill the cache with the specified sectors
-    if (!cdfs_readSect(cacheInfoDir.sector_start + cacheInfoDir.cache_offset, cacheInfoDir.cache_size, cacheInfoDir.cache)) {
+    if (!readDirSect(cacheInfoDir.sector_start + cacheInfoDir.cache_offset, cacheInfoDir.cache_size, cacheInfoDir.cache)) {
         DPRINTF("Couldn't Read from CD !\n");
         cacheInfoDir.valid = FALSE;  // should we completely invalidate just because we couldnt read time?
         return FALSE;
@@ -662,6 +806,20 @@ int cdfs_prepare(void) {
     if (cacheInfoDir.cache == NULL)
         cacheInfoDir.cache = (u8 *)AllocSysMemory(0, MAX_DIR_CACHE_SECTORS * 2048, NULL);
 
+    // Initialise the directory sector and path caches
+    if (dirSectCachePool == NULL) {
+        dirSectCachePool = (u8 *)AllocSysMemory(0, DIR_SECT_CACHE_ENTRIES * DIR_SECT_CACHE_SECTORS * 2048, NULL);
+
+        if (dirSectCachePool != NULL) {
+            int i;
+
+            for (i = 0; i < DIR_SECT_CACHE_ENTRIES; i++)
+                dirSectCache[i].data = dirSectCachePool + (i * DIR_SECT_CACHE_SECTORS * 2048);
+        }
+    }
+
+    invalidateCaches();
+
      // setup the cdReadMode structure
     cdReadMode.trycount = 0;
     cdReadMode.spindlctrl = SCECdSpinStm;
@@ -677,26 +835,24 @@ int cdfs_start(void) {
 int cdfs_finish(void) {
     if (cacheInfoDir.cache)
         FreeSysMemory(cacheInfoDir.cache);
-    
+
+    if (dirSectCachePool) {
+        FreeSysMemory(dirSectCachePool);
+        dirSectCachePool = NULL;
+    }
+
     return 0;
 }
 
-int cdfs_findfile(const char *fname, struct TocEntry *tocEntry) {
+static int findFileInDir(const char *fname, struct TocEntry *tocEntry) {
     static char filename[128 + 1];
     static char pathname[1024 + 1];
 
     struct DirTocEntry *tocEntryPointer;
 
-    DPRINTF("cdfs_findfile called\n\n");
-
     splitPath(fname, pathname, filename);
     DPRINTF("Trying to find file: %s in directory: %s\n", filename, pathname);
 
-    // Invalidate table of contents cache if disk changed
-    if (cdfs_checkDiskChanged(CHANGED_TOC)) {
-        cacheInfoDir.valid = FALSE;
-    }
-
     if ((cacheInfoDir.valid) && (comparePath(pathname) == MATCH)) {
         // the directory is already cached, so check through the currently
         // cached chunk of the directory first
@@ -787,6 +943,25 @@ int cdfs_findfile(const char *fname, struct TocEntry *tocEntry) {
     return FALSE;
 }
 
+int cdfs_findfile(const char *fname, struct TocEntry *tocEntry) {
+    DPRINTF("cdfs_findfile called\n\n");
+
+    // Invalidate table of contents cache if disk changed
+    if (cdfs_checkDiskChanged(CHANGED_TOC)) {
+        invalidateCaches();
+    }
+
+    // Recently resolved files need no directory walk at all
+    if (pathCacheLookup(fname, tocEntry))
+        return TRUE;
+
+    if (!findFileInDir(fname, tocEntry))
+        return FALSE;
+
+    pathCacheInsert(fname, tocEntry);
+    return TRUE;
+}
+
 /********************
 * Optimised CD Read *
 ********************/
@@ -17,6 +17,7 @@
 
 #include <irx.h>
 #include <types.h>
+#include <bdm-common.h>
 
 struct block_device
 {
@@ -63,6 +64,9 @@ extern void bdm_connect_fs(struct file_system *fs);
 extern void bdm_disconnect_fs(struct file_system *fs);
 extern void bdm_get_bd(struct block_device **pbd, unsigned int count);
 extern void bdm_RegisterCallback(bdm_cb cb);
+/** Copies the statistics of up to count block devices (not partitions).
+ *  Returns the number of devices connected. */
+extern int bdm_get_stats(bdm_stats_t *stats, unsigned int count);
 
 #define bdm_IMPORTS_start DECLARE_IMPORT_TABLE(bdm, 1, 1)
 #define bdm_IMPORTS_end   END_IMPORT_TABLE
@@ -73,5 +77,6 @@ extern void bdm_RegisterCallback(bdm_cb cb);
 #define I_bdm_disconnect_fs    DECLARE_IMPORT(7, bdm_disconnect_fs)
 #define I_bdm_get_bd           DECLARE_IMPORT(8, bdm_get_bd)
 #define I_bdm_RegisterCallback DECLARE_IMPORT(9, bdm_RegisterCallback)
+#define I_bdm_get_stats        DECLARE_IMPORT(10, bdm_get_stats)
 
 #endif
@@ -1,5 +1,7 @@
 #include <bdm.h>
+#include <intrman.h>
 #include <stdio.h>
+#include <sysclib.h>
 #include <thbase.h>
 #include <thevent.h>
 
@@ -13,6 +15,8 @@ struct bdm_mounts
     struct block_device *bd; // real block device
     struct block_device *cbd; // cached block device
     struct file_system *fs;
+    struct block_device sbd; // statistics, between the cache and the real device
+    bdm_stats_t stats;
 };
 
 #define MAX_CONNECTIONS 20
@@ -47,6 +51,141 @@ void bdm_RegisterCallback(bdm_cb cb)
     }
 }
 
+/* Operation latency in us, from IOP bus clock ticks (36.864MHz) */
+static u32 bdm_stats_usec(const iop_sys_clock_t *start)
+{
+    iop_sys_clock_t end;
+    u32 ticks;
+
+    GetSystemTime(&end);
+    if (end.hi - start->hi > 1 || (end.hi != start->hi && end.lo >= start->lo))
+        return 0xffffffff;
+    ticks = end.lo - start->lo;
+
+    if (ticks < (1 << 25))
+        return (ticks * 125) / 4608;
+    return (ticks / 4608) * 125;
+}
+
+static void bdm_stats_add(struct bdm_mounts *mount, int write, const iop_sys_clock_t *start, int result)
+{
+    bdm_stats_t *st = &mount->stats;
+    u32 usec = bdm_stats_usec(start);
+    int bucket, state;
+
+    for (bucket = 0; bucket < BDM_STATS_LAT_BUCKETS - 1 && usec >= 2; bucket++)
+        usec >>= 1;
+
+    // Keep the counters consistent for bdm_get_stats()
+    CpuSuspendIntr(&state);
+    if (write) {
+        st->write_ops++;
+        if (result < 0)
+            st->write_errors++;
+        else
+            st->write_sectors += result;
+        st->write_lat[bucket]++;
+    } else {
+        st->read_ops++;
+        if (result < 0)
+            st->read_errors++;
+        else
+            st->read_sectors += result;
+        st->read_lat[bucket]++;
+    }
+    CpuResumeIntr(state);
+}
+
+static int bdm_stats_read(struct block_device *sbd, u64 sector, void *buffer, u16 count)
+{
+    struct bdm_mounts *mount = sbd->priv;
+    iop_sys_clock_t start;
+    int result;
+
+    GetSystemTime(&start);
+    result = mount->bd->read(mount->bd, sector, buffer, count);
+    bdm_stats_add(mount, 0, &start, result);
+    return result;
+}
+
+static int bdm_stats_write(struct block_device *sbd, u64 sector, const void *buffer, u16 count)
+{
+    struct bdm_mounts *mount = sbd->priv;
+    iop_sys_clock_t start;
+    int result;
+
+    GetSystemTime(&start);
+    result = mount->bd->write(mount->bd, sector, buffer, count);
+    bdm_stats_add(mount, 1, &start, result);
+    return result;
+}
+
+static void bdm_stats_flush(struct block_device *sbd)
+{
+    struct bdm_mounts *mount = sbd->priv;
+
+    mount->bd->flush(mount->bd);
+}
+
+static int bdm_stats_stop(struct block_device *sbd)
+{
+    struct bdm_mounts *mount = sbd->priv;
+
+    return mount->bd->stop(mount->bd);
+}
+
+static struct block_device *bdm_stats_create(struct bdm_mounts *mount)
+{
+    struct block_device *bd  = mount->bd;
+    struct block_device *sbd = &mount->sbd;
+
+    memset(&mount->stats, 0, sizeof(mount->stats));
+    strncpy(mount->stats.name, bd->name, BDM_STATS_NAME_LEN - 1);
+    mount->stats.devNr      = bd->devNr;
+    mount->stats.sectorSize = bd->sectorSize;
+
+    *sbd       = *bd;
+    sbd->priv  = mount;
+    sbd->read  = bdm_stats_read;
+    sbd->write = bdm_stats_write;
+    sbd->flush = bdm_stats_flush;
+    sbd->stop  = bdm_stats_stop;
+
+    return sbd;
+}
+
+int bdm_get_stats(bdm_stats_t *stats, unsigned int count)
+{
+    unsigned int found = 0;
+    int i;
+
+    M_DEBUG("%s\n", __func__);
+
+    for (i = 0; i < MAX_CONNECTIONS; ++i) {
+        struct bdm_mounts *mount = &g_mount[i];
+        bdm_stats_t *st;
+        int state;
+
+        if (mount->bd == NULL || mount->cbd == NULL)
+            continue;
+
+        if (found < count) {
+            st = &stats[found];
+
+            CpuSuspendIntr(&state);
+            memcpy(st, &mount->stats, sizeof(*st));
+            CpuResumeIntr(state);
+
+            st->read_bytes  = st->read_sectors * st->sectorSize;
+            st->write_bytes = st->write_sectors * st->sectorSize;
+            bd_cache_get_stats(mount->cbd, &st->cache_sectors_read, &st->cache_sectors_hit);
+        }
+        found++;
+    }
+
+    return found;
+}
+
 void bdm_connect_bd(struct block_device *bd)
 {
     int i;
@@ -56,8 +195,8 @@ void bdm_connect_bd(struct block_device *bd)
     for (i = 0; i < MAX_CONNECTIONS; ++i) {
         if (g_mount[i].bd == NULL) {
             g_mount[i].bd = bd;
-            // Create cache for entire device only (not for the partitions on it)
-            g_mount[i].cbd = (bd->parNr == 0) ? bd_cache_create(bd) : NULL;
+            // Create cache and statistics for entire device only (not for the partitions on it)
+            g_mount[i].cbd = (bd->parNr == 0) ? bd_cache_create(bdm_stats_create(&g_mount[i])) : NULL;
             // New block device, try to mount it to a filesystem
             SetEventFlag(bdm_event, BDM_EVENT_MOUNT);
             break;
@@ -17,6 +17,7 @@
 
 /* Please keep these in alphabetical order!  */
 #include <bdm.h>
+#include <intrman.h>
 #include <loadcore.h>
 #include <stdio.h>
 #include <sysclib.h>
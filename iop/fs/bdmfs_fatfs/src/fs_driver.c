@@ -770,6 +770,10 @@ static int fs_devctl(iop_file_t *fd, const char *name, int cmd, void *arg, unsig
             ret        = FR_OK;
             break;
         }
+        case USBMASS_DEVCTL_GET_BDM_STATS: {
+            ret = bdm_get_stats(buf, buflen / sizeof(bdm_stats_t));
+            break;
+        }
         default: {
             ret = -ENXIO;
             break;
@@ -25,6 +25,7 @@
 #include "sysclib.h"
 #include "sysmem.h"
 #include "thbase.h"
+#include "thsemap.h"
 #include "ioman_mod.h"
 
 #endif /* IOP_IRX_IMPORTS_H */
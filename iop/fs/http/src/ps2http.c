@@ -15,18 +15,20 @@
  * IO subsystem and provides access to HTTP.
  *
  * For each open request a file handle is allocated and any read request
- * is directed to the socket.  After close has been called the file
- * handle slot is free'd for the next request.
+ * is served from the body of a HTTP/1.1 response. After close has been
+ * called the file handle is free'd for the next request.
  *
  * No header information normally returned from a HTTP request is returned.
  * The client must know the content of the data stream and how to deal with it.
  *
- * lseek is currently only supported in order to get the size of a file. With
- * the current implimentation, it is not possible to seek to different positions
- * in a file.
+ * Files are fetched in ranges ("Range:" requests) that grow while the file is
+ * read sequentially, so lseek can move to any position in the file. Servers
+ * that do not support ranges are handled by reading the file again from the
+ * start. Small reads are served from a read-ahead buffer, whose size can be
+ * set with the "-r <bytes>" module argument (0 disables it).
  *
- * With the current implimentation, hostnames may only be specified as an IP
- * address. This will change once we get a DNS resolver up & running with lwip.
+ * Connections are kept alive and pooled per server, so that opening a file
+ * or requesting the next range does not cost a new TCP connection.
  */
 
 #include <types.h>
@@ -34,6 +36,7 @@
 #include <loadcore.h>
 #include <stdio.h>
 #include <thbase.h>
+#include <thsemap.h>
 #include <sysclib.h>
 #include <errno.h>
 #include <ioman_mod.h>
@@ -55,22 +58,54 @@
 
 #define MODNAME "ps2http"
 
-IRX_ID(MODNAME, 1, 1);
+IRX_ID(MODNAME, 1, 2);
+
+#define HTTP_RX_BUF_SIZE       2048
+#define HTTP_LINE_MAX          256
+#define HTTP_POOL_SIZE         4                 // Idle connections kept for reuse
+#define HTTP_RANGE_MIN         (64 * 1024)       // First range requested after opening or seeking
+#define HTTP_RANGE_MAX         (1024 * 1024)     // Ranges double up to this while reading sequentially
+#define HTTP_SKIP_MAX          (32 * 1024)       // Forward seeks up to this are read over, instead of making a new request
+#define HTTP_DRAIN_MAX         (16 * 1024)       // The rest of a response is read out to keep the connection, up to this
+#define HTTP_READAHEAD_DEFAULT (16 * 1024)
 
 typedef struct
 {
 	int sockFd;
-	int fileSize;
+	struct sockaddr_in server;
+	int rxPos;
+	int rxLen;
+	u8 rxBuf[HTTP_RX_BUF_SIZE];
+} t_httpConn;
+
+typedef struct
+{
+	t_httpConn *conn; // Connection of the response being read, NULL once it was read
+	struct sockaddr_in server;
+	int fileSize;  // -1 if unknown
 	int filePos;
+	int streamPos; // File position of the next byte of the response
+	int bodyLeft;  // Bytes left in the response (or in the current chunk), -1 if it ends when the connection is closed
+	int chunked;
+	int chunkFirst;
+	int keepAlive;
+	int rangeOK;
+	int rangeLen;
+	u8 *raBuf;
+	int raStart;
+	int raLen;
+	char hostAddr[100];
+	char path[];
 } t_fioPrivData;
 
+static int readAheadSize = HTTP_READAHEAD_DEFAULT;
 
-// example of basic HTTP 1.0 protocol request.
-char strTest[] = "GET /blah HTTP/1.0\n\n";
+static t_httpConn *connPool[HTTP_POOL_SIZE];
+static int connPoolSema;
 
 char HTTPGET[] = "GET ";
 char HTTPHOST[] = "Host: ";
-char HTTPGETEND[] = " HTTP/1.0\r\n";
+char HTTPGETEND[] = " HTTP/1.1\r\n";
 char HTTPUSERAGENT[] = "User-Agent: PS2IP HTTP Client\r\n";
 char HTTPENDHEADER[] = "\r\n";
 
@@ -91,120 +126,420 @@ int parseContentLength(char *mimeBuffer)
 }
 
 /**
- * This function will parse the initial response header line and return 0 for a "200 OK",
- * or return the error code in the event of an error (such as 404 - not found)
+ * Parses a "Content-Range: bytes <first>-<last>/<total>" header line. The total
+ * is -1 if the server does not know it.
+ */
+static int parseContentRange(char *mimeBuffer, int *first, int *total)
+{
+	char *line;
+
+	line = strstr(mimeBuffer, "CONTENT-RANGE:");
+	line += strlen("CONTENT-RANGE:");
+
+	while((*line == ' ') || (*line == '\t')) line++;
+
+	if(strncmp(line, "BYTES", 5) != 0)
+		return -1;
+	line += 5;
+	while((*line == ' ') || (*line == '\t')) line++;
+
+	// A 416 response has "*/<total>" instead of the range.
+	if(*line == '*')
+		*first = -1;
+	else
+		*first = (int)strtol(line, NULL, 10);
+
+	line = strstr(line, "/");
+	if(line == NULL)
+		return -1;
+	line++;
+
+	*total = (*line == '*') ? -1 : (int)strtol(line, NULL, 10);
+
+	return 0;
+}
+
+/**
+ * This function will parse the initial response header line and return the status code.
  */
-int isErrorHeader(char *mimeBuffer)
+static int parseStatus(char *mimeBuffer, int *minorVersion)
 {
 	char *line;
 	int i;
-	int code;
 
 	line = strstr(mimeBuffer, "HTTP/1.");
 	line += strlen("HTTP/1.");
 
-	// Advance past minor protocol version number
+	// Read the minor protocol version number
+	*minorVersion = *line - '0';
 	line++;
 
 	// Advance past any whitespace characters
 	while((*line == ' ') || (*line == '\t')) line++;
 
 	// Terminate string after status code
-	for(i = 0; ((line[i] != ' ') && (line[i] != '\t')); i++);
+	for(i = 0; ((line[i] != '\0') && (line[i] != ' ') && (line[i] != '\t')); i++);
 	line[i] = '\0';
 
-	code = (int)strtol(line,NULL, 10);
-	if( code == 200 )
-		return 0;
-	else
-		return code;
+	return (int)strtol(line,NULL, 10);
+}
+
+static void connFree(t_httpConn *conn)
+{
+	lwip_close(conn->sockFd);
+	FreeSysMemory(conn);
 }
 
 /**
- * When a request has been sent, we can expect mime headers to be
- * before the data.  We need to read exactly to the end of the headers
- * and no more data.  This readline reads a single char at a time.
+ * Returns an idle connection to the server, or makes a new one. reused is set
+ * if the connection was used before, as the server may have closed it since.
  */
-int readLine( int socket, char * buffer, int size )
+static t_httpConn *connGet(struct sockaddr_in *server, int *reused)
 {
-	char * ptr = buffer;
-	int count = 0;
+	t_httpConn *conn;
+	int i;
 
-	// Keep reading until we fill the buffer.
+	conn = NULL;
 
-	while ( count < size )
+	WaitSema(connPoolSema);
+	for(i = 0; i < HTTP_POOL_SIZE; i++)
 	{
-		int rc;
+		if((connPool[i] != NULL) && (connPool[i]->server.sin_addr.s_addr == server->sin_addr.s_addr) && (connPool[i]->server.sin_port == server->sin_port))
+		{
+			conn = connPool[i];
+			connPool[i] = NULL;
+			break;
+		}
+	}
+	SignalSema(connPoolSema);
+
+	if(conn != NULL)
+	{
+		*reused = 1;
+		return conn;
+	}
+
+	*reused = 0;
+
+	if((conn = AllocSysMemory(ALLOC_FIRST, sizeof(t_httpConn), NULL)) == NULL)
+		return NULL;
+
+	M_DEBUG( "create socket\n" );
+
+	if((conn->sockFd = socket( PF_INET, SOCK_STREAM, IPPROTO_TCP )) < 0)
+	{
+		M_PRINTF( "SOCKET FAILED\n" );
+		FreeSysMemory(conn);
+		return NULL;
+	}
+
+	M_DEBUG( "connect\n" );
+
+	if(connect( conn->sockFd, (struct sockaddr *) server, sizeof(*server)) < 0)
+	{
+		M_PRINTF( "CONNECT FAILED %i\n", conn->sockFd );
+		connFree(conn);
+		return NULL;
+	}
+
+	memcpy(&conn->server, server, sizeof(*server));
+	conn->rxPos = 0;
+	conn->rxLen = 0;
+
+	return conn;
+}
+
+/**
+ * Keeps a connection for the next request to the same server. The oldest idle
+ * connection is closed if the pool is full.
+ */
+static void connPut(t_httpConn *conn)
+{
+	t_httpConn *evicted;
+	int i;
+
+	// Anything still buffered would be taken for the next response.
+	if(conn->rxPos < conn->rxLen)
+	{
+		connFree(conn);
+		return;
+	}
+
+	WaitSema(connPoolSema);
+	evicted = connPool[0];
+	for(i = 0; i < HTTP_POOL_SIZE - 1; i++)
+		connPool[i] = connPool[i + 1];
+	connPool[HTTP_POOL_SIZE - 1] = conn;
+	SignalSema(connPoolSema);
 
-		rc = recv( socket, ptr, 1, 0 );
+	if(evicted != NULL)
+		connFree(evicted);
+}
+
+/**
+ * Reads from the connection through its receive buffer. Reads that are at
+ * least as large as the buffer go straight to the caller, once it is empty.
+ */
+static int connRecv(t_httpConn *conn, void *buffer, int size)
+{
+	int rc;
+
+	if(conn->rxPos >= conn->rxLen)
+	{
+		if(size >= HTTP_RX_BUF_SIZE)
+			return recv( conn->sockFd, buffer, size, 0 );
+
+		rc = recv( conn->sockFd, conn->rxBuf, HTTP_RX_BUF_SIZE, 0 );
+		if(rc <= 0) return rc;
+
+		conn->rxPos = 0;
+		conn->rxLen = rc;
+	}
+
+	if(size > conn->rxLen - conn->rxPos)
+		size = conn->rxLen - conn->rxPos;
+
+	memcpy(buffer, &conn->rxBuf[conn->rxPos], size);
+	conn->rxPos += size;
+
+	return size;
+}
+
+/**
+ * Reads a header line from the receive buffer, without its line ending.
+ * Characters that do not fit in the buffer are dropped. Returns the length
+ * of the line, or -1 if the connection was closed before its end.
+ */
+static int readLine( t_httpConn *conn, char * buffer, int size )
+{
+	int count = 0;
 
-		if ( rc <= 0 ) return rc;
+	while ( 1 )
+	{
+		char c;
 
-		if ( (*ptr == '\n') ) break;
+		if ( connRecv( conn, &c, 1 ) <= 0 ) return -1;
 
-		// increment after check for cr.  Don't want to count the cr.
-		count++;
-		ptr++;
+		if ( c == '\n' ) break;
+
+		if ( count < size - 1 ) buffer[count++] = c;
 	}
 
+	if ( (count > 0) && (buffer[count - 1] == '\r') ) count--;
+
 	// Terminate string
-	*ptr = '\0';
+	buffer[count] = '\0';
 
 	// return how many bytes read.
 	return count;
 }
 
+/**
+ * Reads the size line of the next chunk of a chunked response. At the last
+ * chunk, the trailer is read and the response ends.
+ */
+static int chunkNext( t_fioPrivData *pHandle )
+{
+	char mimeBuffer[HTTP_LINE_MAX];
+	int rc;
+
+	// Every chunk but the first is preceded by the line ending of the previous one.
+	if ( !pHandle->chunkFirst && (readLine( pHandle->conn, mimeBuffer, sizeof(mimeBuffer) ) != 0) ) return -EIO;
+	pHandle->chunkFirst = 0;
+
+	if ( readLine( pHandle->conn, mimeBuffer, sizeof(mimeBuffer) ) <= 0 ) return -EIO;
+
+	pHandle->bodyLeft = (int)strtol( mimeBuffer, NULL, 16 );
+	if ( pHandle->bodyLeft < 0 ) return -EIO;
+
+	if ( pHandle->bodyLeft == 0 )
+	{
+		while ( (rc = readLine( pHandle->conn, mimeBuffer, sizeof(mimeBuffer) )) > 0 );
+		if ( rc < 0 ) return -EIO;
+
+		pHandle->chunked = 0;
+
+		// The whole file was sent, so its size is now known.
+		if ( (pHandle->fileSize < 0) && !pHandle->rangeOK ) pHandle->fileSize = pHandle->streamPos;
+	}
+
+	return 0;
+}
+
+/**
+ * Hands the connection back once its response was read entirely.
+ */
+static void responseDone( t_fioPrivData *pHandle )
+{
+	if ( pHandle->keepAlive )
+		connPut( pHandle->conn );
+	else
+		connFree( pHandle->conn );
+
+	pHandle->conn = NULL;
+}
 
 /**
- * This is the main HTTP client connect work.  Makes the connection
- * and handles the protocol and reads the return headers.  Needs
- * to leave the stream at the start of the real data.
+ * Reads up to size bytes of the body of the current response. Returns 0 once
+ * the response has ended.
  */
-int httpConnect( struct sockaddr_in * server, char *hostAddr, const char * url, t_fioPrivData *pHandle )
+static int bodyRead( t_fioPrivData *pHandle, void *buffer, int size )
 {
-	int sockHandle;
-	int peerHandle;
 	int rc;
-	char mimeBuffer[100];
 
-	M_DEBUG( "create socket\n" );
+	if ( pHandle->conn == NULL ) return 0;
 
-	if((sockHandle = socket( PF_INET, SOCK_STREAM, IPPROTO_TCP )) < 0)
+	if ( (pHandle->bodyLeft == 0) && pHandle->chunked )
 	{
-		M_PRINTF( "SOCKET FAILED\n" );
-		return -1;
+		if ( (rc = chunkNext( pHandle )) < 0 )
+		{
+			connFree( pHandle->conn );
+			pHandle->conn = NULL;
+			return rc;
+		}
 	}
 
-	M_DEBUG( "connect\n" );
+	if ( pHandle->bodyLeft == 0 )
+	{
+		responseDone( pHandle );
+		return 0;
+	}
+
+	if ( (pHandle->bodyLeft > 0) && (size > pHandle->bodyLeft) ) size = pHandle->bodyLeft;
 
-	rc = connect( sockHandle, (struct sockaddr *) server, sizeof(*server));
-	if ( rc < 0 )
+	rc = connRecv( pHandle->conn, buffer, size );
+	if ( rc <= 0 )
 	{
-		M_PRINTF( "CONNECT FAILED %i\n", sockHandle );
-		return -1;
+		// Only a response without a length ends with the connection.
+		connFree( pHandle->conn );
+		pHandle->conn = NULL;
+		if ( (rc != 0) || (pHandle->bodyLeft >= 0) ) return -EIO;
+
+		if ( (pHandle->fileSize < 0) && !pHandle->rangeOK ) pHandle->fileSize = pHandle->streamPos;
+		return 0;
 	}
-	peerHandle = sockHandle;
+
+	pHandle->streamPos += rc;
+	if ( pHandle->bodyLeft > 0 ) pHandle->bodyLeft -= rc;
+
+	if ( (pHandle->bodyLeft == 0) && !pHandle->chunked ) responseDone( pHandle );
+
+	return rc;
+}
+
+/**
+ * Reads over count bytes of the body of the current response.
+ */
+static int bodySkip( t_fioPrivData *pHandle, int count )
+{
+	u8 scratch[256];
+
+	while ( (count > 0) && (pHandle->conn != NULL) )
+	{
+		int rc;
+
+		rc = bodyRead( pHandle, scratch, count > (int)sizeof(scratch) ? (int)sizeof(scratch) : count );
+		if ( rc < 0 ) return rc;
+
+		count -= rc;
+	}
+
+	return 0;
+}
+
+/**
+ * Stops reading the current response. The rest of a short response is read
+ * out, so that its connection can be reused. Otherwise it is closed.
+ */
+static void bodyAbort( t_fioPrivData *pHandle )
+{
+	if ( pHandle->conn == NULL ) return;
+
+	if ( pHandle->keepAlive && !pHandle->chunked && (pHandle->bodyLeft >= 0) && (pHandle->bodyLeft <= HTTP_DRAIN_MAX) )
+	{
+		bodySkip( pHandle, pHandle->bodyLeft );
+		if ( pHandle->conn == NULL ) return;
+	}
+
+	connFree( pHandle->conn );
+	pHandle->conn = NULL;
+}
+
+static int sendRequest( t_httpConn *conn, const char *hostAddr, const char *url, int first, int length )
+{
+	char request[256];
+	int rc;
 
 	M_DEBUG( "send\n" );
 
-	rc = send( peerHandle, HTTPGET,  sizeof( HTTPGET ) - 1, 0 );
-	if (rc < 0) goto fail_send;
-	rc = send( peerHandle, (void*) url, strlen( url ), 0 );
-	if (rc < 0) goto fail_send;
-	rc = send( peerHandle, HTTPGETEND, sizeof( HTTPGETEND ) - 1, 0 );
-	if (rc < 0) goto fail_send;
-
-	rc = send( peerHandle, HTTPHOST,  sizeof( HTTPHOST ) - 1, 0 );
-	if (rc < 0) goto fail_send;
-	rc = send( peerHandle, hostAddr, strlen( hostAddr ), 0 );
-	if (rc < 0) goto fail_send;
-	rc = send( peerHandle, HTTPENDHEADER, sizeof( HTTPENDHEADER ) - 1, 0 ); // "\r\n"
-	if (rc < 0) goto fail_send;
-
-	rc = send( peerHandle, HTTPUSERAGENT, sizeof( HTTPUSERAGENT ) - 1, 0 );
-	if (rc < 0) goto fail_send;
-	rc = send( peerHandle, HTTPENDHEADER, sizeof( HTTPENDHEADER ) - 1, 0 );
-	if (rc < 0) goto fail_send;
+	rc = send( conn->sockFd, HTTPGET,  sizeof( HTTPGET ) - 1, 0 );
+	if (rc < 0) return rc;
+	rc = send( conn->sockFd, (void*) url, strlen( url ), 0 );
+	if (rc < 0) return rc;
+
+	strcpy( request, HTTPGETEND );
+	strcat( request, HTTPHOST );
+	strncpy( &request[strlen( request )], hostAddr, 100 );
+	strcat( request, HTTPENDHEADER );
+	strcat( request, HTTPUSERAGENT );
+	if ( first >= 0 )
+		sprintf( &request[strlen( request )], "Range: bytes=%d-%d\r\n", first, first + length - 1 );
+	strcat( request, HTTPENDHEADER );
+
+	return send( conn->sockFd, request, strlen( request ), 0 );
+}
+
+/**
+ * This is the main HTTP client connect work. Sends a request for length bytes
+ * from first (the whole file if first is negative) over a pooled or new
+ * connection, and reads the response headers. Leaves the connection at the
+ * start of the body.
+ */
+int httpConnect( t_fioPrivData *pHandle, int first, int length )
+{
+	char mimeBuffer[HTTP_LINE_MAX];
+	int rc, attempt, reused, status, minorVersion, contentLength, rangeFirst, rangeTotal;
+
+	if ( (first >= 0) && (pHandle->fileSize >= 0) && (first + length > pHandle->fileSize) )
+		length = pHandle->fileSize - first;
+
+	for ( attempt = 0; ; attempt++ )
+	{
+		if ( (pHandle->conn = connGet( &pHandle->server, &reused )) == NULL ) return -1;
+
+		rc = sendRequest( pHandle->conn, pHandle->hostAddr, pHandle->path, first, length );
+		if ( rc >= 0 ) rc = readLine( pHandle->conn, mimeBuffer, sizeof(mimeBuffer) );
+
+		if ( rc > 0 ) break;
+
+		connFree( pHandle->conn );
+		pHandle->conn = NULL;
+
+		// An idle connection may have been closed by the server. Try once more with a new one.
+		if ( !reused || (attempt > 0) )
+		{
+			M_PRINTF( "HTTP: REQUEST FAILED\n" );
+			return -1;
+		}
+	}
+
+	M_DEBUG(">> %s\n", mimeBuffer);
+
+	// First line of header, contains status code.
+	for ( rc = 0; mimeBuffer[rc] != '\0'; rc++ )
+		mimeBuffer[rc] = toupper( mimeBuffer[rc] );
+	if ( strstr( mimeBuffer, "HTTP/1." ) == NULL )
+	{
+		bodyAbort( pHandle );
+		return -EIO;
+	}
+	status = parseStatus( mimeBuffer, &minorVersion );
+
+	pHandle->keepAlive = (minorVersion >= 1);
+	pHandle->chunked = 0;
+	contentLength = -1;
+	rangeFirst = -1;
+	rangeTotal = -1;
 
 	// We now need to read the header information
 	while ( 1 )
@@ -212,40 +547,171 @@ int httpConnect( struct sockaddr_in * server, char *hostAddr, const char * url,
 		int i;
 
 		// read a line from the header information.
-		rc = readLine( peerHandle, mimeBuffer, 100 );
+		rc = readLine( pHandle->conn, mimeBuffer, sizeof(mimeBuffer) );
 
-		M_DEBUG(">> %s", mimeBuffer);
+		M_DEBUG(">> %s\n", mimeBuffer);
 
-		if ( rc < 0 ) return rc;
+		if ( rc < 0 )
+		{
+			connFree( pHandle->conn );
+			pHandle->conn = NULL;
+			return -EIO;
+		}
 
 		// End of headers is a blank line.  exit.
 		if ( rc == 0 ) break;
-		if ( (rc == 1) && (mimeBuffer[0] == '\r') ) break;
 
 		// Convert mimeBuffer to upper case, so we can do string comps
-		for(i = 0; (unsigned int)i < strlen(mimeBuffer); i++)
+		for(i = 0; i < rc; i++)
 			mimeBuffer[i] = toupper(mimeBuffer[i]);
 
-		if(strstr(mimeBuffer, "HTTP/1.")) // First line of header, contains status code. Check for an error code
-			if((rc = isErrorHeader(mimeBuffer))) {
-				M_PRINTF("status code = %d!\n", rc);
-				return -rc;
-			}
-
-		if(strstr(mimeBuffer, "CONTENT-LENGTH:"))
+		if(strstr(mimeBuffer, "CONTENT-LENGTH:") == mimeBuffer)
+			contentLength = parseContentLength(mimeBuffer);
+		else if(strstr(mimeBuffer, "CONTENT-RANGE:") == mimeBuffer)
+			parseContentRange(mimeBuffer, &rangeFirst, &rangeTotal);
+		else if((strstr(mimeBuffer, "TRANSFER-ENCODING:") == mimeBuffer) && (strstr(mimeBuffer, "CHUNKED") != NULL))
+			pHandle->chunked = 1;
+		else if(strstr(mimeBuffer, "CONNECTION:") == mimeBuffer)
 		{
-			pHandle->fileSize = parseContentLength(mimeBuffer);
-			M_DEBUG("fileSize = %d\n", pHandle->fileSize);
+			if(strstr(mimeBuffer, "CLOSE") != NULL)
+				pHandle->keepAlive = 0;
+			else if(strstr(mimeBuffer, "KEEP-ALIVE") != NULL)
+				pHandle->keepAlive = 1;
 		}
+		else if((strstr(mimeBuffer, "ACCEPT-RANGES:") == mimeBuffer) && (strstr(mimeBuffer, "BYTES") != NULL))
+			pHandle->rangeOK = 1;
+	}
+
+	pHandle->bodyLeft = pHandle->chunked ? 0 : contentLength;
+	pHandle->chunkFirst = 1;
+
+	// A response without a length ends when the connection is closed.
+	if ( (pHandle->bodyLeft < 0) && !pHandle->chunked )
+		pHandle->keepAlive = 0;
+
+	switch ( status )
+	{
+		case 200:
+			pHandle->streamPos = 0;
+			if ( (pHandle->fileSize < 0) && !pHandle->chunked )
+				pHandle->fileSize = contentLength;
+			// The server ignored the range, unless it was for the whole file.
+			if ( (first > 0) || (length < pHandle->fileSize) )
+				pHandle->rangeOK = 0;
+			break;
+		case 206:
+			pHandle->rangeOK = 1;
+			pHandle->streamPos = rangeFirst;
+			if ( rangeTotal >= 0 )
+				pHandle->fileSize = rangeTotal;
+			if ( rangeFirst != first )
+			{
+				bodyAbort( pHandle );
+				return -EIO;
+			}
+			break;
+		case 416:
+			// Nothing to read at this position. The total size of the file may be given.
+			if ( rangeTotal >= 0 )
+				pHandle->fileSize = rangeTotal;
+			bodyAbort( pHandle );
+			pHandle->streamPos = -1;
+			return 0;
+		default:
+			M_PRINTF("status code = %d!\n", status);
+			bodyAbort( pHandle );
+			return -status;
 	}
 
-	// We've sent the request, and read the headers.  SockHandle is
+	if ( pHandle->chunked && ((rc = chunkNext( pHandle )) < 0) )
+	{
+		connFree( pHandle->conn );
+		pHandle->conn = NULL;
+		return rc;
+	}
+
+	// We've sent the request, and read the headers.  The connection is
 	// now at the start of the main data read for a file io read.
-	return peerHandle;
+	return 0;
+}
+
+/**
+ * Gets the body of a response to position pos. Returns 1 if data can be read
+ * there, 0 at the end of the file.
+ */
+static int streamSeek( t_fioPrivData *pHandle, int pos, int want )
+{
+	int rc, sequential;
+
+	if ( (pHandle->fileSize >= 0) && (pos >= pHandle->fileSize) ) return 0;
+
+	// Read over what lies between the response and pos, if that is cheaper than a new request.
+	if ( (pHandle->conn != NULL) && (pos >= pHandle->streamPos) && (!pHandle->rangeOK || (pos - pHandle->streamPos <= HTTP_SKIP_MAX)) )
+	{
+		if ( (rc = bodySkip( pHandle, pos - pHandle->streamPos )) < 0 ) return rc;
+		if ( (pHandle->conn != NULL) && (pHandle->streamPos == pos) ) return 1;
+	}
 
-fail_send:
-	printf( "HTTP: SEND FAILED %i\n", peerHandle );
-	return -1;
+	sequential = (pHandle->conn == NULL) && (pHandle->streamPos == pos);
+	bodyAbort( pHandle );
+
+	if ( pHandle->rangeOK )
+	{
+		if ( sequential )
+			pHandle->rangeLen = (pHandle->rangeLen * 2 > HTTP_RANGE_MAX) ? HTTP_RANGE_MAX : pHandle->rangeLen * 2;
+		else
+			pHandle->rangeLen = HTTP_RANGE_MIN;
+
+		rc = httpConnect( pHandle, pos, want > pHandle->rangeLen ? want : pHandle->rangeLen );
+	}
+	else
+	{
+		// The whole response was read.
+		if ( sequential ) return 0;
+
+		// The server does not support ranges: read the file again from the start.
+		rc = httpConnect( pHandle, -1, 0 );
+	}
+	if ( rc < 0 ) return rc;
+
+	if ( (pHandle->conn != NULL) && (pHandle->streamPos < pos) && ((rc = bodySkip( pHandle, pos - pHandle->streamPos )) < 0) ) return rc;
+
+	return ((pHandle->conn != NULL) && (pHandle->streamPos == pos)) ? 1 : 0;
+}
+
+/**
+ * Reads up to size bytes from position pos, making new requests as needed.
+ */
+static int streamRead( t_fioPrivData *pHandle, int pos, u8 *buffer, int size )
+{
+	int total = 0;
+	int progress = 1;
+
+	while ( total < size )
+	{
+		int rc;
+
+		rc = streamSeek( pHandle, pos + total, size - total );
+		if ( rc > 0 ) rc = bodyRead( pHandle, buffer + total, size - total );
+		if ( rc < 0 ) return (total > 0) ? total : rc;
+
+		// The response ended. Go on with the next range, unless the end of the file was reached
+		// or the last range was empty.
+		if ( rc == 0 )
+		{
+			if ( progress && pHandle->rangeOK && (pHandle->conn == NULL) && (pHandle->streamPos == pos + total) )
+			{
+				progress = 0;
+				continue;
+			}
+			break;
+		}
+
+		progress = 1;
+		total += rc;
+	}
+
+	return total;
 }
 
 char *strnchr(char *str, char ch, int max) {
@@ -351,15 +817,16 @@ const char *resolveAddress( struct sockaddr_in *server, const char * url, char *
 /**
  * Open has the most work to do in the file driver.  It must:
  *
- *  1. Find a free file Handle.
+ *  1. Allocate a file Handle.
  *  2. Check we have a valid IP address and URL.
- *  3. Try and connect to the remote server.
- *  4. Send a GET request to the server
- *  5. Parse the GET response header from the server
+ *  3. Send a request for the start of the file to the server, over a
+ *     pooled or new connection.
+ *  4. Parse the response header from the server, to learn the size of the
+ *     file and whether ranges are supported.
  */
 int httpOpen(iop_io_file_t *f, const char *name, int mode)
 {
-	int peerHandle = 0;
+	int rc;
 	struct sockaddr_in server;
 	const char *getName;
 	t_fioPrivData *privData;
@@ -369,33 +836,48 @@ int httpOpen(iop_io_file_t *f, const char *name, int mode)
 
 	M_DEBUG("httpOpen(-, %s, %d)\n", name, mode);
 
-	if((privData = AllocSysMemory(ALLOC_FIRST, sizeof(t_fioPrivData), NULL)) == NULL)
-		return -EPERM;
-
-	f->privdata = privData;
-
-	privData->fileSize = 0;
-	privData->filePos = 0;
-
 	memset(&server, 0, sizeof(server));
 	// Check valid IP address and URL
 	if((getName = resolveAddress( &server, name, hostAddr )) == NULL)
-	{
-		FreeSysMemory(privData);
 		return -ENOENT;
+
+	if((privData = AllocSysMemory(ALLOC_FIRST, sizeof(t_fioPrivData) + strlen(getName) + 1, NULL)) == NULL)
+		return -EPERM;
+
+	memset(privData, 0, sizeof(t_fioPrivData));
+	memcpy(&privData->server, &server, sizeof(server));
+	strcpy(privData->hostAddr, hostAddr);
+	strcpy(privData->path, getName);
+	privData->fileSize = -1;
+	privData->rangeLen = HTTP_RANGE_MIN;
+
+	if(readAheadSize > 0)
+	{
+		if((privData->raBuf = AllocSysMemory(ALLOC_FIRST, readAheadSize, NULL)) == NULL)
+		{
+			FreeSysMemory(privData);
+			return -EPERM;
+		}
 	}
 
 	// Now we connect and initiate the transfer by sending a
 	// request header to the server, and receiving the response header
-	if((peerHandle = httpConnect( &server, hostAddr, getName, privData )) < 0)
+	if((rc = httpConnect( privData, 0, HTTP_RANGE_MIN )) < 0)
 	{
-        M_PRINTF("failed to connect to '%s'!\n", hostAddr);
+		M_PRINTF("failed to connect to '%s'!\n", hostAddr);
+		if(privData->raBuf != NULL)
+			FreeSysMemory(privData->raBuf);
 		FreeSysMemory(privData);
-		return peerHandle;
+		return rc;
 	}
 
-	// http connect returns valid socket.  Save in handle list.
-	privData->sockFd = peerHandle;
+	// An empty file.
+	if((privData->conn == NULL) && (privData->fileSize < 0))
+		privData->fileSize = 0;
+
+	f->privdata = privData;
+
+	M_DEBUG("fileSize = %d\n", privData->fileSize);
 
 	// return success.  We got it all ready. :)
 	return 0;
@@ -403,39 +885,59 @@ int httpOpen(iop_io_file_t *f, const char *name, int mode)
 
 
 /**
- * Read is simple.  It simply needs to find the socket no
- * based on the file handle and call recv.
+ * Small reads are served from the read-ahead buffer, which is filled with one
+ * larger read. Larger reads go straight to the caller's buffer.
  */
 int httpRead(iop_io_file_t *f, void *buffer, int size)
 {
 	t_fioPrivData *privData = (t_fioPrivData *)f->privdata;
-	int left = size;
 	int totalRead = 0;
+	int rc = 0;
 
 	M_DEBUG("httpRead(-, 0x%X, %d)\n", (int)buffer, size);
 
-	// Read until: there is an error, we've read "size" bytes or the remote
-	//             side has closed the connection.
-	do {
-
-		int bytesRead = recv( privData->sockFd, (void *)((u8 *)buffer + totalRead), left, 0 );
+	if((privData->fileSize >= 0) && (size > privData->fileSize - privData->filePos))
+		size = privData->fileSize - privData->filePos;
 
-//		M_DEBUG("bytesRead = %d\n", bytesRead);
-
-		if(bytesRead <= 0) break;
+	while(size > 0)
+	{
+		if((privData->raLen > 0) && (privData->filePos >= privData->raStart) && (privData->filePos < privData->raStart + privData->raLen))
+		{
+			rc = privData->raStart + privData->raLen - privData->filePos;
+			if(rc > size)
+				rc = size;
+			memcpy((u8 *)buffer + totalRead, &privData->raBuf[privData->filePos - privData->raStart], rc);
+		}
+		else if((privData->raBuf == NULL) || (size >= readAheadSize))
+		{
+			rc = streamRead(privData, privData->filePos, (u8 *)buffer + totalRead, size);
+		}
+		else
+		{
+			privData->raLen = 0;
+			rc = streamRead(privData, privData->filePos, privData->raBuf, readAheadSize);
+			if(rc > 0)
+			{
+				privData->raStart = privData->filePos;
+				privData->raLen = rc;
+				continue;
+			}
+		}
 
-		left -= bytesRead;
-		totalRead += bytesRead;
+		if(rc <= 0) break;
 
-	} while(left);
+		totalRead += rc;
+		privData->filePos += rc;
+		size -= rc;
+	}
 
-	return totalRead;
+	return (totalRead > 0) ? totalRead : rc;
 }
 
 
 /**
- * Close finds the correct handle and
- * calls disconnect.
+ * Close returns the connection to the pool if
+ * that is cheap, and frees the handle.
  */
 int httpClose(iop_io_file_t *f)
 {
@@ -443,41 +945,51 @@ int httpClose(iop_io_file_t *f)
 
 	M_DEBUG("httpClose(-)\n");
 
-	lwip_close(privData->sockFd);
+	bodyAbort(privData);
+	if(privData->raBuf != NULL)
+		FreeSysMemory(privData->raBuf);
 	FreeSysMemory(privData);
 
 	return 0;
 }
 
 /**
- * lseek is only supported in order to get the size of a file. Allough the function
- * does modify the filePos member, this does not have any effect on the read position
- * of the file in the current implimentation.
+ * lseek only moves the file position. The next read requests the data at the
+ * new position, unless it can be reached cheaply in the current response.
  */
 int httpLseek(iop_io_file_t *f, int offset, int mode)
 {
 	t_fioPrivData *privData = (t_fioPrivData *)f->privdata;
+	int fileSize, pos;
 
 	M_DEBUG("httpLseek(-, %d, %d)\n", (int)offset, mode);
 
+	// The size of a file is unknown if the server did not tell.
+	fileSize = (privData->fileSize >= 0) ? privData->fileSize : 0;
+
 	switch(mode)
 	{
 		case SEEK_SET:
-			privData->filePos = offset;
+			pos = offset;
 			break;
 
 		case SEEK_CUR:
-			privData->filePos += offset;
+			pos = privData->filePos + offset;
 			break;
 
 		case SEEK_END:
-			privData->filePos = privData->fileSize + offset;
+			pos = fileSize + offset;
 			break;
 
 		default:
 			return -EPERM;
 	}
 
+	if(pos < 0)
+		return -EINVAL;
+
+	privData->filePos = pos;
+
 	return privData->filePos;
 }
 
@@ -518,11 +1030,33 @@ static iop_io_device_t ps2httpDev = {
  */
 int _start( int argc, char *argv[])
 {
-	(void)argc;
-	(void)argv;
+	argc--;
+	argv++;
+
+	// Parse arguments
+	while(argc > 0)
+	{
+		if(!strcmp(argv[0], "-r"))
+		{
+			if(--argc <= 0)
+				break;
+			argv++;
+
+			// Size of the read-ahead buffer of every file, 0 to disable it.
+			readAheadSize = (int)strtol(argv[0], NULL, 10);
+			if(readAheadSize < 0)
+				readAheadSize = 0;
+		}
+
+		argc--;
+		argv++;
+	}
 
 	M_PRINTF("Module Loaded\n");
 
+	if((connPoolSema = CreateMutex(IOP_MUTEX_UNLOCKED)) < 0)
+		return MODULE_NO_RESIDENT_END;
+
 	M_PRINTF("Adding 'http' driver into io system\n");
 	io_DelDrv( "http");
 	io_AddDrv(&ps2httpDev);
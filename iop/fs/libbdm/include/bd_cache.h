@@ -26,5 +26,8 @@ extern struct block_device *bd_cache_create(struct block_device *bd);
 /* Destroy a cached block device */
 extern void bd_cache_destroy(struct block_device *cbd);
 
+/* Sectors asked for by reads small enough to be cached, and how many of them were hits */
+extern void bd_cache_get_stats(struct block_device *cbd, u32 *sectors_read, u32 *sectors_hit);
+
 
 #endif
@@ -15,11 +15,9 @@ struct bd_cache
     int weight[BLOCK_COUNT];
     u64 sector[BLOCK_COUNT];
     u8 cache[BLOCK_COUNT][SECTORS_PER_BLOCK*512];
-#ifdef DEBUG
-    u32 sectors_read;
-    u32 sectors_cache;
+    u32 sectors_read;  // sectors asked for by cached (small) reads
+    u32 sectors_cache; // of those, sectors served from the cache
     u32 sectors_dev;
-#endif
 };
 
 /* cache overlaps with requested area ? */
@@ -64,16 +62,14 @@ static int _read(struct block_device *bd, u64 sector, void *buffer, u16 count)
         return c->bd->read(c->bd, sector, buffer, count);
     }
 
-#ifdef DEBUG
     c->sectors_read += count;
-#endif
 
     // Do a cached read
     int blkidx;
     for (blkidx = 0; blkidx < BLOCK_COUNT; blkidx++) {
         if (_contains(c->sector[blkidx], sector, count)) {
-#ifdef DEBUG
             c->sectors_cache += count;
+#ifdef DEBUG
             //M_DEBUG("- CACHE HIT[%d] [block %d] [devread %ds, hit-ratio %d%%]\n", sector, blkidx, c->sectors_dev, (c->sectors_cache * 100) / c->sectors_read);
 #endif
             // Minimum weight
@@ -109,7 +105,9 @@ static int _read(struct block_device *bd, u64 sector, void *buffer, u16 count)
     }
 #ifdef DEBUG
     printf(" devread: %*d, evict %*d [%*d], add [%*d]\n", 4, c->sectors_dev, 2, blkidx_best, 8, c->sector[blkidx_best], 8, sector);
+#endif
     c->sectors_dev += SECTORS_PER_BLOCK;
+#ifdef DEBUG
     //M_DEBUG("- CACHE READ[%d] -> [block %d] [devread %ds, hit-ratio %d%%]\n", sector, blkidx_best, c->sectors_dev, (c->sectors_cache * 100) / c->sectors_read);
 #endif
 
@@ -170,11 +168,9 @@ struct block_device *bd_cache_create(struct block_device *bd)
         c->weight[blkidx] = 0;
         c->sector[blkidx] = 0xffffffffffffffff;
     }
-#ifdef DEBUG
     c->sectors_read = 0;
     c->sectors_cache = 0;
     c->sectors_dev = 0;
-#endif
 
     // copy all parameters becouse we are the same blocks device
     // only difference is we are cached.
@@ -202,3 +198,11 @@ void bd_cache_destroy(struct block_device *cbd)
     FreeSysMemory(cbd->priv);
     FreeSysMemory(cbd);
 }
+
+void bd_cache_get_stats(struct block_device *cbd, u32 *sectors_read, u32 *sectors_hit)
+{
+    struct bd_cache *c = cbd->priv;
+
+    *sectors_read = c->sectors_read;
+    *sectors_hit  = c->sectors_cache;
+}
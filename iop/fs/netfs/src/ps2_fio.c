@@ -44,6 +44,11 @@ extern int fsysUnmount(void);
 static char ps2netfs_send_packet[PACKET_MAXSIZE] __attribute__((aligned(16)));
 static char ps2netfs_recv_packet[PACKET_MAXSIZE] __attribute__((aligned(16)));
 
+// incoming bytes not yet consumed, so pipelined requests share one recv()
+static char ps2netfs_rxbuf[PACKET_MAXSIZE] __attribute__((aligned(16)));
+static int ps2netfs_rxpos = 0;
+static int ps2netfs_rxlen = 0;
+
 static int ps2netfs_sock = -1;
 static int ps2netfs_active = 0;
 
@@ -51,7 +56,13 @@ static int ps2netfs_sema;
 static int ps2netfs_pid = 0;
 
 #define FIOTRAN_MAXSIZE 65535
-static char ps2netfs_fiobuffer[FIOTRAN_MAXSIZE+1];
+
+// Streamed transfers ping-pong between two halves of the fio buffer. Each
+// half keeps room in front of the data for the frame header, so header and
+// data go out in one send and the data stays aligned for the device.
+#define STREAM_HDRSPACE 16
+#define STREAM_BUFSIZE  (STREAM_HDRSPACE + PS2NETFS_READSTREAM_CHUNK)
+static char ps2netfs_fiobuffer[2 * STREAM_BUFSIZE] __attribute__((aligned(64)));
 
 //////////////////////////////////////////////////////////////////////////
 
@@ -176,6 +187,7 @@ int ps2netfs_close_socket(void)
   if (ret < 0)
     DPRINTF("disconnect returned error %d\n", ret);
   ps2netfs_sock = -1;
+  ps2netfs_rxpos = ps2netfs_rxlen = 0;
   return ret;
 }
 
@@ -215,7 +227,13 @@ static inline int ps2netfs_lwip_send(int sock, void *buf, int len, int flag)
   else return ret;
 }
 
-/** Do repetetive recv() calls until 'bytes' bytes are received or error returned */
+/** Receive 'bytes' bytes or return an error.
+ *
+ * Small reads are served from ps2netfs_rxbuf, which is filled by recv()
+ * calls as large as it is, so a client that pipelines requests gets
+ * several of them parsed per recv(). Reads at least as large as the
+ * buffer go straight into 'buf' once the buffered bytes are used up.
+ */
 int ps2netfs_recv_bytes(int sock, char *buf, int bytes)
 {
   int left;
@@ -225,7 +243,20 @@ int ps2netfs_recv_bytes(int sock, char *buf, int bytes)
   while (left > 0) {
     int len;
 
-    len = recv(sock, &buf[bytes - left], left, 0);
+    if (ps2netfs_rxpos < ps2netfs_rxlen)
+    {
+      len = ps2netfs_rxlen - ps2netfs_rxpos;
+      if (len > left) len = left;
+      memcpy(&buf[bytes - left], &ps2netfs_rxbuf[ps2netfs_rxpos], len);
+      ps2netfs_rxpos += len;
+      left -= len;
+      continue;
+    }
+
+    if (left >= PACKET_MAXSIZE)
+      len = recv(sock, &buf[bytes - left], left, 0);
+    else
+      len = recv(sock, ps2netfs_rxbuf, PACKET_MAXSIZE, 0);
     if (len < 0) {
       DPRINTF("ps2netfs: recv_bytes error!! (%d)\n",len);
       return -1;
@@ -235,7 +266,13 @@ int ps2netfs_recv_bytes(int sock, char *buf, int bytes)
       DPRINTF("ps2netfs: recv_bytes - disconnected\n");
       return -2;
     }
-    left -= len;
+    if (left >= PACKET_MAXSIZE)
+      left -= len;
+    else
+    {
+      ps2netfs_rxpos = 0;
+      ps2netfs_rxlen = len;
+    }
   }
   return bytes;
 }
@@ -296,6 +333,149 @@ int ps2netfs_accept_pktunknown(int sock, char *buf)
   return hlen;
 }
 
+/** Read from a client file through whichever device manager owns it.
+ * @ingroup ps2netfs
+ */
+static int ps2netfs_file_read(fd_table_t *fdptr, char *buf, int nbytes)
+{
+  if (fdptr->devtype == IOPMGR_DEVTYPE_IOMAN)
+    return io_read(fdptr->realfd, buf, nbytes);
+  if (fdptr->devtype == IOPMGR_DEVTYPE_IOMANX)
+    return read(fdptr->realfd, buf, nbytes);
+  return -1;
+}
+
+/** Write to a client file through whichever device manager owns it.
+ * @ingroup ps2netfs
+ */
+static int ps2netfs_file_write(fd_table_t *fdptr, char *buf, int nbytes)
+{
+  if (fdptr->devtype == IOPMGR_DEVTYPE_IOMAN)
+    return io_write(fdptr->realfd, buf, nbytes);
+  if (fdptr->devtype == IOPMGR_DEVTYPE_IOMANX)
+    return write(fdptr->realfd, buf, nbytes);
+  return -1;
+}
+
+/** Background transfers.
+ * @ingroup ps2netfs
+ *
+ * Streamed reads and writes hand one buffer half at a time to the transfer
+ * thread, which sends it to the client or writes it to the file while the
+ * server thread reads the file or receives into the other half. At most
+ * one transfer is outstanding. Without the thread, transfers run inline.
+ */
+#define XFER_SEND  1
+#define XFER_WRITE 2
+
+typedef struct {
+  int op;
+  fd_table_t *fdptr;
+  char *buf;
+  int len;
+  int result;
+} xfer_job_t;
+
+static xfer_job_t ps2netfs_xfer;
+static int ps2netfs_xfer_pending = 0;
+static int ps2netfs_xfer_req_sema = -1;
+static int ps2netfs_xfer_done_sema = -1;
+
+static void ps2netfs_xfer_run(void)
+{
+  if (ps2netfs_xfer.op == XFER_SEND)
+    ps2netfs_xfer.result = ps2netfs_lwip_send(ps2netfs_sock, ps2netfs_xfer.buf, ps2netfs_xfer.len, 0);
+  else
+    ps2netfs_xfer.result = ps2netfs_file_write(ps2netfs_xfer.fdptr, ps2netfs_xfer.buf, ps2netfs_xfer.len);
+}
+
+static void ps2netfs_xfer_thread(void *arg)
+{
+  (void)arg;
+
+  while (1)
+  {
+    WaitSema(ps2netfs_xfer_req_sema);
+    ps2netfs_xfer_run();
+    SignalSema(ps2netfs_xfer_done_sema);
+  }
+}
+
+/** Start a background transfer. The previous one must have been waited for. */
+static void ps2netfs_xfer_start(int op, fd_table_t *fdptr, char *buf, int len)
+{
+  ps2netfs_xfer.op = op;
+  ps2netfs_xfer.fdptr = fdptr;
+  ps2netfs_xfer.buf = buf;
+  ps2netfs_xfer.len = len;
+  ps2netfs_xfer_pending = 1;
+
+  if (ps2netfs_xfer_req_sema < 0)
+    ps2netfs_xfer_run();
+  else
+    SignalSema(ps2netfs_xfer_req_sema);
+}
+
+/** Wait for the outstanding background transfer.
+ *
+ * @return its send() or write() result, 0 if none was outstanding.
+ */
+static int ps2netfs_xfer_wait(void)
+{
+  if (!ps2netfs_xfer_pending)
+    return 0;
+  if (ps2netfs_xfer_req_sema >= 0)
+    WaitSema(ps2netfs_xfer_done_sema);
+  ps2netfs_xfer_pending = 0;
+  return ps2netfs_xfer.result;
+}
+
+/** Start the background transfer thread.
+ * @ingroup ps2netfs
+ *
+ * @return 0 on success, -1 if transfers will run inline.
+ */
+static int ps2netfs_xfer_init(void)
+{
+  iop_thread_t thread;
+  iop_sema_t sema;
+  int pid;
+
+  sema.attr = 0;
+  sema.option = 0;
+  sema.initial = 0;
+  sema.max = 1;
+  ps2netfs_xfer_req_sema = CreateSema(&sema);
+  ps2netfs_xfer_done_sema = CreateSema(&sema);
+  if (ps2netfs_xfer_req_sema < 0 || ps2netfs_xfer_done_sema < 0)
+  {
+    DPRINTF("ps2netfs: xfer CreateSema failed\n");
+    if (ps2netfs_xfer_req_sema >= 0)
+      DeleteSema(ps2netfs_xfer_req_sema);
+    if (ps2netfs_xfer_done_sema >= 0)
+      DeleteSema(ps2netfs_xfer_done_sema);
+    ps2netfs_xfer_req_sema = -1;
+    return -1;
+  }
+
+  thread.attr = 0x02000000;
+  thread.option = 0;
+  thread.thread = ps2netfs_xfer_thread;
+  thread.stacksize = 0x800;
+  thread.priority = 0x43; // same as the server thread
+
+  pid = CreateThread(&thread);
+  if (pid <= 0 || StartThread(pid, NULL) < 0)
+  {
+    DPRINTF("ps2netfs: xfer thread failed (%d)\n", pid);
+    DeleteSema(ps2netfs_xfer_req_sema);
+    DeleteSema(ps2netfs_xfer_done_sema);
+    ps2netfs_xfer_req_sema = -1;
+    return -1;
+  }
+  return 0;
+}
+
 /** Handles a PS2NETFS_INFO_CMD request.
  * @ingroup ps2netfs
  *
@@ -625,12 +805,7 @@ static int ps2netfs_op_read(char *buf, int len)
   // do the stuff here
   fdptr = fdh_get(ntohl(cmd->fd));
   if (fdptr != 0)
-  {
-    if (fdptr->devtype == IOPMGR_DEVTYPE_IOMAN)
-      retval = io_read(fdptr->realfd,ps2netfs_fiobuffer,nbytes);
-    else if (fdptr->devtype == IOPMGR_DEVTYPE_IOMANX)
-      retval = read(fdptr->realfd,ps2netfs_fiobuffer,nbytes);
-  }
+    retval = ps2netfs_file_read(fdptr,ps2netfs_fiobuffer,nbytes);
 
   // now build the response
   readrly = (ps2netfs_pkt_read_rly *)&ps2netfs_send_packet[0];
@@ -657,6 +832,99 @@ static int ps2netfs_op_read(char *buf, int len)
   return 0;
 }
 
+/** Handles a PS2NETFS_READSTREAM_CMD request.
+ * @ingroup ps2netfs
+ *
+ * @param buf Pointer to packet data.
+ * @param len Length of packet.
+ * @return Status.
+ *
+ * Reads the file in PS2NETFS_READSTREAM_CHUNK pieces, sending each one
+ * from the buffer it was read into while the next one is read.
+ *
+ * status returns:
+ *   0 if all request and response handled ok.
+ *  -X if error.
+ *
+ * return values for client (in the final frame):
+ *   >=0 if handled ok , bytes read.
+ *   -X if error before any data was read.
+ */
+static int ps2netfs_op_readstream(char *buf, int len)
+{
+  ps2netfs_pkt_read_req *cmd;
+  ps2netfs_pkt_read_rly *readrly;
+  fd_table_t *fdptr;
+  int retval = 0;
+  int total = 0;
+  int left;
+  int cur = 0;
+  cmd = (ps2netfs_pkt_read_req *)buf;
+
+  DPRINTF("ps2netfs: readstream\n");
+
+  if (len != sizeof(ps2netfs_pkt_read_req))
+  {
+    DPRINTF("ps2netfs: got a broken packet (%d)!\n", len);
+    return -1;
+  }
+
+  fdptr = fdh_get(ntohl(cmd->fd));
+  left = ntohl(cmd->nbytes);
+  while (left > 0)
+  {
+    char *chunk = &ps2netfs_fiobuffer[cur * STREAM_BUFSIZE];
+    int toread;
+
+    toread = left; if (toread > PS2NETFS_READSTREAM_CHUNK) toread = PS2NETFS_READSTREAM_CHUNK;
+    retval = ps2netfs_file_read(fdptr, chunk + STREAM_HDRSPACE, toread);
+
+    if (ps2netfs_xfer_wait() < 0)
+    {
+      DPRINTF("ps2netfs: error sending data!\n");
+      return -1;
+    }
+    if (retval <= 0)
+      break;
+
+    // frame header sits right in front of the data
+    readrly = (ps2netfs_pkt_read_rly *)(chunk + STREAM_HDRSPACE - sizeof(ps2netfs_pkt_read_rly));
+    readrly->cmd = htonl(PS2NETFS_READSTREAM_RLY);
+    readrly->len = htons((unsigned short)sizeof(ps2netfs_pkt_read_rly));
+    readrly->retval = htonl(retval);
+    readrly->nbytes = readrly->retval;
+    ps2netfs_xfer_start(XFER_SEND, NULL, (char *)readrly, sizeof(ps2netfs_pkt_read_rly) + retval);
+
+    total += retval;
+    left -= retval;
+    cur ^= 1;
+    if (retval < toread) // end of file
+      break;
+  }
+
+  if (ps2netfs_xfer_wait() < 0)
+  {
+    DPRINTF("ps2netfs: error sending data!\n");
+    return -1;
+  }
+
+  // now build the final frame
+  if (total > 0 || retval >= 0)
+    retval = total;
+  readrly = (ps2netfs_pkt_read_rly *)&ps2netfs_send_packet[0];
+  readrly->cmd = htonl(PS2NETFS_READSTREAM_RLY);
+  readrly->len = htons((unsigned short)sizeof(ps2netfs_pkt_read_rly));
+  readrly->retval = htonl(retval);
+  readrly->nbytes = 0;
+
+  if (ps2netfs_lwip_send(ps2netfs_sock, readrly, sizeof(ps2netfs_pkt_read_rly), 0) < 0)
+  {
+    DPRINTF("ps2netfs: error sending reply!\n");
+    return -1;
+  }
+  return 0;
+}
+
 /** Handles a PS2NETFS_WRITE_CMD request.
  * @ingroup ps2netfs
  *
@@ -664,6 +932,10 @@ static int ps2netfs_op_read(char *buf, int len)
  * @param len Length of packet.
  * @return Status.
  *
+ * The data is received in PS2NETFS_READSTREAM_CHUNK pieces, each written
+ * out while the next one is received. If a write fails the rest of the
+ * data is still received, so the following request is parsed correctly.
+ *
  * status returns:
  *   0 if all request and response handled ok.
  *  -X if error.
@@ -678,8 +950,13 @@ static int ps2netfs_op_write(char *buf, int len)
 {
   ps2netfs_pkt_write_req *cmd;
   ps2netfs_pkt_file_rly *writerly;
-  int retval = -1;
+  int retval = 0;
   fd_table_t *fdptr;
+  int left;
+  int written = 0;
+  int pending = 0;
+  int failed = 0;
+  int cur = 0;
   cmd = (ps2netfs_pkt_write_req *)buf;
 
   (void)len;
@@ -688,32 +965,43 @@ static int ps2netfs_op_write(char *buf, int len)
 
   // do the stuff here
   fdptr = fdh_get(ntohl(cmd->fd));
-  if (fdptr != 0)
+  left = ntohl(cmd->nbytes);
+  while ((left > 0) || (pending > 0))
   {
-    int left = ntohl(cmd->nbytes);
-    int written;
-    written = retval = 0;
-    while ((retval >= 0) && (left > 0))
-    {
-      int towrite;
+    char *chunk = &ps2netfs_fiobuffer[cur * STREAM_BUFSIZE];
+    int towrite = 0;
+    int ret;
 
-      towrite = left; if (towrite > FIOTRAN_MAXSIZE) towrite = FIOTRAN_MAXSIZE;
-      if (ps2netfs_recv_bytes(ps2netfs_sock, ps2netfs_fiobuffer, towrite) <=0 )
+    if (left > 0)
+    {
+      towrite = left; if (towrite > PS2NETFS_READSTREAM_CHUNK) towrite = PS2NETFS_READSTREAM_CHUNK;
+      if (ps2netfs_recv_bytes(ps2netfs_sock, chunk, towrite) <= 0)
       {
+        ps2netfs_xfer_wait();
         DPRINTF("ps2netfs: error reading data!\n");
         return -1;
       }
+      left -= towrite;
+    }
 
-      if (fdptr->devtype == IOPMGR_DEVTYPE_IOMAN)
-        retval = io_write(fdptr->realfd,ps2netfs_fiobuffer,towrite);
-      else if (fdptr->devtype == IOPMGR_DEVTYPE_IOMANX)
-        retval = write(fdptr->realfd,ps2netfs_fiobuffer,towrite);
+    ret = ps2netfs_xfer_wait();
+    if (pending > 0)
+    {
+      if (ret > 0) written += ret;
+      if (ret < 0) retval = ret;
+      if (ret != pending) failed = 1; // error or device full, drain the rest
+      pending = 0;
+    }
 
-      if (retval > 0) { written += retval; left -= retval; }
+    if ((towrite > 0) && !failed)
+    {
+      ps2netfs_xfer_start(XFER_WRITE, fdptr, chunk, towrite);
+      pending = towrite;
+      cur ^= 1;
     }
-    if (retval > 0)
-        retval = written;
   }
+  if (retval >= 0)
+    retval = written;
 
   // now build the response
   writerly = (ps2netfs_pkt_file_rly *)&ps2netfs_send_packet[0];
@@ -1931,6 +2219,9 @@ static void ps2netfs_Listener(int sock)
        case PS2NETFS_DEVLIST_CMD:
          retval = ps2netfs_op_devlist(ps2netfs_recv_packet, len);
          break;
+       case PS2NETFS_READSTREAM_CMD:
+         retval = ps2netfs_op_readstream(ps2netfs_recv_packet, len);
+         break;
 
        default:
          DPRINTF("ps2netfs: Unknown cmd received\n");
@@ -2041,9 +2332,14 @@ ps2netfs_serv(void *argv)
      continue;
    }
    ps2netfs_sock = client_sock;
+   ps2netfs_rxpos = ps2netfs_rxlen = 0;
 
    if (ps2netfs_sock > 0)
    {
+     int nodelay = 1;
+
+     // replies to pipelined requests are small, do not hold them back
+     setsockopt(ps2netfs_sock, IPPROTO_TCP, TCP_NODELAY, &nodelay, sizeof(nodelay));
      ps2netfs_Listener(ps2netfs_sock);
      ret = ps2netfs_close_socket();
      DPRINTF("ps2netfs: close2 ret %d\n", ret);
@@ -2074,6 +2370,9 @@ int ps2netfs_Init(void)
 
   DPRINTF("initializing ps2netfs\n");
 
+  // Streamed transfers fall back to running inline without it
+  ps2netfs_xfer_init();
+
   // Start socket server thread
 
   mythread.attr = 0x02000000; // attr
@@ -107,6 +107,9 @@
 //  devlist
 #define PS2NETFS_DEVLIST_CMD  0xbeef8F21
 #define PS2NETFS_DEVLIST_RLY  0xbeef8F22
+//  streamed read
+#define PS2NETFS_READSTREAM_CMD 0xbeef8F31
+#define PS2NETFS_READSTREAM_RLY 0xbeef8F32
 
 #define PS2NETFS_MAX_PATH   256
 
@@ -162,6 +165,16 @@ typedef struct
     int nbytes;
 } __attribute__((packed)) ps2netfs_pkt_write_req;
 
+/** PS2NETFS_READSTREAM_CMD takes a ps2netfs_pkt_read_req with no size limit.
+ *
+ * The reply is a run of ps2netfs_pkt_read_rly frames. Each frame with
+ * nbytes > 0 is followed by nbytes of file data. The last frame has
+ * nbytes = 0 and retval set to the total bytes read, or to the error if
+ * nothing could be read. Requests may be sent before earlier replies have
+ * arrived; they are handled and answered in order.
+ */
+#define PS2NETFS_READSTREAM_CHUNK 32768
+
 typedef struct
 {
     unsigned int cmd;
@@ -27,7 +27,7 @@
 #include "debug_printf.h"
 
 #define PS2NETFS_VERSION_HIGH 1
-#define PS2NETFS_VERSION_LOW  0
+#define PS2NETFS_VERSION_LOW  1
 
 IRX_ID(PS2NETFS_MODNAME, PS2NETFS_VERSION_HIGH, PS2NETFS_VERSION_LOW);
 
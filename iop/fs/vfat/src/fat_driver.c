@@ -45,7 +45,17 @@
 #ifdef BUILDING_USBHDFSD
 #define READ_SECTORS_RAW(d, a, c, b) mass_stor_readSector((d), a, b, c);
 #define INVALIDATE_SECTORS(d, s, c)  scache_invalidate((d)->cache, s, c)
+#define RAW_READ_ALIGNED(b)          1
 #endif /* BUILDING_USBHDFSD */
+#if !defined(BUILDING_IEEE1394_DISK) && !defined(BUILDING_USBHDFSD)
+#define READ_SECTORS_RAW(d, a, c, b) ((d)->bd->read((d)->bd, a, b, c) == (c) ? 0 : -EIO)
+#define RAW_READ_ALIGNED(b)          ((((unsigned int)(b)) & 3) == 0)
+#endif
+#ifndef BUILDING_IEEE1394_DISK
+#define FLUSH_SECTOR_RANGE(d, s, c) scache_flushRange((d)->cache, s, c)
+// Limit of the sector count of a single device read
+#define MAX_RAW_SECTORS 0xFFFF
+#endif /* BUILDING_IEEE1394_DISK */
 
 #define NUM_DRIVES 10
 static fat_driver *g_fatd[NUM_DRIVES];
@@ -631,6 +641,118 @@ void fat_setFatDirChain(fat_driver *fatd, fat_dir *fatDir)
     XPRINTF("read cluster chain  done!\n");
 }
 
+//---------------------------------------------------------------------------
+void fat_freeFileExtents(fat_dir *fatDir)
+{
+    if (fatDir->extents != NULL) {
+        free(fatDir->extents);
+        fatDir->extents = NULL;
+    }
+    fatDir->extentCount = 0;
+}
+
+//---------------------------------------------------------------------------
+/* Build the extent map of the file's cluster chain, if it was not built yet.
+   Returns the number of extents, or -1 if the file has no map. */
+static int fat_getFileExtents(fat_driver *fatd, fat_dir *fatDir)
+{
+    fat_dir_extent *extents, *ext;
+    unsigned int fileCluster, index;
+    int i, count, capacity, chainSize, clusterChainStart;
+    unsigned char nextChain;
+
+    if (fatDir->extentCount != 0) {
+        return fatDir->extentCount;
+    }
+
+    fatDir->extentCount = -1;
+    fileCluster         = fatDir->chain[0].cluster;
+    if (fileCluster < 2) {
+        return -1;
+    }
+
+    capacity = 16;
+    extents  = malloc(capacity * sizeof(fat_dir_extent));
+    if (extents == NULL) {
+        return -1;
+    }
+
+    ext               = NULL;
+    count             = 0;
+    index             = 0;
+    nextChain         = 1;
+    clusterChainStart = 0;
+
+    while (nextChain) {
+        if ((chainSize = fat_getClusterChain(fatd, fileCluster, fatd->cbuf, MAX_DIR_CLUSTER, 1)) < 0) {
+            XPRINTF("fat_getFileExtents(): fat_getClusterChain() failed: %d\n", chainSize);
+            free(extents);
+            return -1;
+        }
+
+        if (chainSize >= MAX_DIR_CLUSTER) { // the chain is full, but more chain parts exist
+            fileCluster = fatd->cbuf[MAX_DIR_CLUSTER - 1];
+        } else { // chain fits in the chain buffer completely - no next chain exist
+            nextChain = 0;
+        }
+
+        // process the cluster chain (fatd->cbuf), merging adjacent clusters into runs
+        for (i = clusterChainStart; i < chainSize; i++, index++) {
+            if (ext != NULL && fatd->cbuf[i] == ext->cluster + ext->count) {
+                ext->count++;
+                continue;
+            }
+
+            if (count == capacity) {
+                fat_dir_extent *grown;
+
+                // Too fragmented (or a looping chain): leave it to the chain walk.
+                if (capacity >= FAT_MAX_EXTENTS || (grown = malloc(capacity * 2 * sizeof(fat_dir_extent))) == NULL) {
+                    XPRINTF("fat_getFileExtents(): no map for more than %d extents\n", capacity);
+                    free(extents);
+                    return -1;
+                }
+                memcpy(grown, extents, count * sizeof(fat_dir_extent));
+                free(extents);
+                extents = grown;
+                capacity *= 2;
+            }
+
+            ext          = &extents[count++];
+            ext->index   = index;
+            ext->cluster = fatd->cbuf[i];
+            ext->count   = 1;
+        }
+        clusterChainStart = 1;
+    }
+
+    XPRINTF("fat_getFileExtents(): %u clusters in %d extents\n", index, count);
+
+    fatDir->extents     = extents;
+    fatDir->extentCount = count;
+    return count;
+}
+
+//---------------------------------------------------------------------------
+// Returns the last extent that starts at or before the given cluster index of the file.
+static int fat_findExtent(const fat_dir *fatDir, unsigned int index)
+{
+    int low, high;
+
+    low  = 0;
+    high = fatDir->extentCount - 1;
+    while (low < high) {
+        int mid = (low + high + 1) / 2;
+
+        if (fatDir->extents[mid].index <= index)
+            low = mid;
+        else
+            high = mid - 1;
+    }
+
+    return low;
+}
+
 //---------------------------------------------------------------------------
 /* Set base attributes of direntry */
 static void fat_setFatDir(fat_driver *fatd, fat_dir *fatDir, unsigned int parentDirCluster, fat_direntry_sfn *dsfn, fat_direntry_summary *dir, int getClusterInfo)
@@ -882,6 +1004,19 @@ void fat_getClusterAtFilePos(fat_driver *fatd, fat_dir *fatDir, unsigned int fil
 
     blockSize = fatd->partBpb.clusterSize * fatd->partBpb.sectorSize;
 
+    if (fatDir->extentCount > 0) {
+        const fat_dir_extent *ext;
+
+        i   = filePos / blockSize;
+        ext = &fatDir->extents[fat_findExtent(fatDir, i)];
+        // Clusters appended after the map was built are reached by walking on from its last one.
+        if (i >= ext->index + ext->count)
+            i = ext->index + ext->count - 1;
+        *cluster    = ext->cluster + (i - ext->index);
+        *clusterPos = i * blockSize;
+        return;
+    }
+
     for (i = 0, j = (DIR_CHAIN_SIZE - 1); i < (DIR_CHAIN_SIZE - 1); i++) {
         if (fatDir->chain[i].index * blockSize <= filePos &&
             fatDir->chain[i + 1].index * blockSize > filePos) {
@@ -912,6 +1047,77 @@ static int fat_readSingleSector(mass_dev *dev, unsigned int sector, void *buffer
 }
 #endif /* BUILDING_USBHDFSD */
 
+#ifndef BUILDING_IEEE1394_DISK
+/* Read through the extent map. Whole sectors within a run of contiguous clusters
+   are read straight into the buffer with a single device read, while partial
+   sectors at either end go through the cache. */
+static int fat_readFileExtents(fat_driver *fatd, fat_dir *fatDir, unsigned int filePos, unsigned char *buffer, unsigned int size)
+{
+    unsigned int sectorSize, clusterSize, bufferPos;
+    int e, ret;
+
+    sectorSize  = fatd->partBpb.sectorSize;
+    clusterSize = fatd->partBpb.clusterSize;
+    bufferPos   = 0;
+    e           = fat_findExtent(fatDir, filePos / (clusterSize * sectorSize));
+
+    while (size > 0 && e < fatDir->extentCount) {
+        const fat_dir_extent *ext = &fatDir->extents[e];
+        unsigned int runSector, runSectors, sector, dataSkip, n;
+
+        // positions are kept in sectors, as a run can span more than 4GB worth of clusters
+        runSector  = filePos / sectorSize - ext->index * clusterSize;
+        runSectors = ext->count * clusterSize;
+        if (runSector >= runSectors) {
+            e++;
+            continue;
+        }
+
+        sector   = fat_cluster2sector(&fatd->partBpb, ext->cluster) + runSector;
+        dataSkip = filePos % sectorSize;
+
+        if (dataSkip != 0 || size < sectorSize || !RAW_READ_ALIGNED(buffer + bufferPos)) {
+            unsigned char *sbuf = NULL; // sector buffer
+
+            ret = READ_SECTOR(DEV_ACCESSOR(fatd), sector, sbuf);
+            if (ret < 0) {
+                XPRINTF("Read sector failed ! sector=%u\n", sector);
+                break;
+            }
+
+            n = sectorSize - dataSkip;
+            if (n > size)
+                n = size;
+            memcpy(buffer + bufferPos, sbuf + dataSkip, n);
+        } else {
+            n = size / sectorSize;
+            if (n > runSectors - runSector)
+                n = runSectors - runSector;
+            if (n > MAX_RAW_SECTORS)
+                n = MAX_RAW_SECTORS;
+
+            // dirty cached sectors must reach the disk before they are read back from it
+            if (FLUSH_SECTOR_RANGE(DEV_ACCESSOR(fatd), sector, n) < 0) {
+                break;
+            }
+            ret = READ_SECTORS_RAW(DEV_ACCESSOR(fatd), sector, n, buffer + bufferPos);
+            if (ret != 0) {
+                XPRINTF("Read sectors failed ! sector=%u (%u)\n", sector, n);
+                break;
+            }
+
+            n *= sectorSize;
+        }
+
+        filePos += n;
+        size -= n;
+        bufferPos += n;
+    }
+
+    return bufferPos;
+}
+#endif /* BUILDING_IEEE1394_DISK */
+
 int fat_readFile(fat_driver *fatd, fat_dir *fatDir, unsigned int filePos, unsigned char *buffer, unsigned int size)
 {
     int ret;
@@ -932,6 +1138,15 @@ int fat_readFile(fat_driver *fatd, fat_dir *fatDir, unsigned int filePos, unsign
 
     M_DEBUG("%s\n", __func__);
 
+#ifdef BUILDING_IEEE1394_DISK
+    // Only used for seeking here, the sectors are read through the cache.
+    fat_getFileExtents(fatd, fatDir);
+#else
+    if (fat_getFileExtents(fatd, fatDir) > 0) {
+        return fat_readFileExtents(fatd, fatDir, filePos, buffer, size);
+    }
+#endif
+
     fat_getClusterAtFilePos(fatd, fatDir, filePos, &fileCluster, &clusterPos);
     sectorSkip  = (filePos - clusterPos) / fatd->partBpb.sectorSize;
     clusterSkip = sectorSkip / fatd->partBpb.clusterSize;
@@ -1218,6 +1433,61 @@ int fat_getFirstDirentry(fat_driver *fatd, const char *dirName, fat_dir_list *fa
     return fat_getNextDirentry(fatd, fatdlist, fatDir);
 }
 
+//---------------------------------------------------------------------------
+/*
+ Set up the free cluster summary of the FAT, which the allocator fills in as it
+ scans the FAT. Mounting does not read the FAT. Without a summary (FAT12, or out
+ of memory), the allocator simply scans every FAT sector.
+*/
+static void fat_initFreeMap(fat_driver *fatd)
+{
+    unsigned int sector, indexCount, shift, groups;
+
+    if (fatd->freeMap != NULL) {
+        free(fatd->freeMap);
+        fatd->freeMap = NULL;
+    }
+    fatd->freeMapGroups = 0;
+    fatd->freeMapShift  = 0;
+
+    // same as in fat_determineFatType()
+    sector = fat_cluster2sector(&fatd->partBpb, 0) - fatd->partBpb.partStart;
+    sector = fatd->partBpb.sectorCount - sector;
+    fatd->maxCluster = sector / fatd->partBpb.clusterSize + 1;
+
+    switch (fatd->partBpb.fatType) {
+        case FAT16:
+            indexCount = fatd->partBpb.sectorSize / 2;
+            break;
+        case FAT32:
+            indexCount = fatd->partBpb.sectorSize / 4;
+            break;
+        default:
+            return;
+    }
+
+    // the FAT may hold more records than there are clusters, never the other way around
+    if (fatd->maxCluster > fatd->partBpb.fatSize * indexCount - 1) {
+        fatd->maxCluster = fatd->partBpb.fatSize * indexCount - 1;
+    }
+
+    // one scache block per group at least, and no more groups than FAT_FREE_MAP_GROUPS
+    for (shift = 3; ((fatd->partBpb.fatSize + (1 << shift) - 1) >> shift) > FAT_FREE_MAP_GROUPS; shift++)
+        ;
+    groups = (fatd->partBpb.fatSize + (1 << shift) - 1) >> shift;
+
+    fatd->freeMap = malloc(groups * sizeof(unsigned short));
+    if (fatd->freeMap == NULL) {
+        M_PRINTF("Warning - no memory for the free cluster map\n");
+        return;
+    }
+    memset(fatd->freeMap, 0xFF, groups * sizeof(unsigned short)); // FAT_FREE_MAP_UNKNOWN
+    fatd->freeMapGroups = groups;
+    fatd->freeMapShift  = shift;
+
+    XPRINTF("free cluster map: %u groups of %u sectors, maxCluster=%u\n", groups, 1 << shift, fatd->maxCluster);
+}
+
 //---------------------------------------------------------------------------
 #if defined(BUILDING_USBHDFSD)
 int fat_mount(mass_dev *dev, unsigned int start, unsigned int count)
@@ -1255,6 +1525,7 @@ int fat_mount(struct block_device *bd)
 #else
                 g_fatd[i]->dev = NULL;
 #endif
+                g_fatd[i]->freeMap = NULL;
             }
             fatd = g_fatd[i];
         } else if (
@@ -1319,6 +1590,7 @@ int fat_mount(struct block_device *bd)
     fatd->clStackLast      = 0;
     fatd->lastChainCluster = 0xFFFFFFFF;
     fatd->lastChainResult  = -1;
+    fat_initFreeMap(fatd);
     return 0;
 }
 
@@ -1349,6 +1621,10 @@ void fat_forceUnmount(struct block_device *bd)
         if (g_fatd[i] != NULL && g_fatd[i]->dev == dev)
 #endif
         {
+            if (g_fatd[i]->freeMap != NULL) {
+                free(g_fatd[i]->freeMap);
+                g_fatd[i]->freeMap = NULL;
+            }
 #if !defined(BUILDING_IEEE1394_DISK) && !defined(BUILDING_USBHDFSD)
             scache_kill(g_fatd[i]->cache);
             free(g_fatd[i]);
@@ -108,7 +108,7 @@ static int fat_readEmptyClusters12(fat_driver *fatd)
     lastFatSector = -1;
     cluster       = fatd->clStackLast;
 
-    while (fatd->clStackIndex < MAX_CLUSTER_STACK) {
+    while (fatd->clStackIndex < MAX_CLUSTER_STACK && cluster <= fatd->maxCluster) {
         int recordOffset;
         int sectorSpan;
         int fatSector;
@@ -160,6 +160,50 @@ static int fat_readEmptyClusters12(fat_driver *fatd)
 }
 
 
+//---------------------------------------------------------------------------
+/*
+ Account the free clusters of a FAT sector that was scanned, in the free cluster map.
+ A group is only given a count once all of its sectors were scanned in one go.
+*/
+static void fat_freeMapScanned(fat_driver *fatd, unsigned int fatSector, unsigned int lastFatSector, int whole, unsigned int *groupFree, int *groupWhole)
+{
+    unsigned int groupMask;
+
+    groupMask = (1 << fatd->freeMapShift) - 1;
+
+    if (!whole) {
+        *groupWhole = 0;
+    }
+    if (*groupWhole && ((fatSector & groupMask) == groupMask || fatSector == lastFatSector)) {
+        fatd->freeMap[fatSector >> fatd->freeMapShift] = *groupFree;
+        *groupWhole                                    = 0;
+    }
+}
+
+//---------------------------------------------------------------------------
+/*
+ adjust the free cluster count of the group that holds the cluster record
+*/
+static void fat_freeMapUpdate(fat_driver *fatd, unsigned int cluster, int delta)
+{
+    unsigned int group;
+    unsigned int indexCount;
+
+    if (fatd->freeMap == NULL) {
+        return;
+    }
+
+    indexCount = fatd->partBpb.sectorSize / ((fatd->partBpb.fatType == FAT32) ? 4 : 2);
+    group      = (cluster / indexCount) >> fatd->freeMapShift;
+    if (group >= fatd->freeMapGroups || fatd->freeMap[group] == FAT_FREE_MAP_UNKNOWN) {
+        return;
+    }
+    if (delta < 0 && fatd->freeMap[group] == 0) {
+        return;
+    }
+    fatd->freeMap[group] += delta;
+}
+
 //---------------------------------------------------------------------------
 /*
  scan FAT32 for free clusters and store them to the cluster stack
@@ -169,8 +213,10 @@ static int fat_readEmptyClusters32(fat_driver *fatd)
     unsigned int i, j;
     unsigned int indexCount;
     unsigned int fatStartSector;
-    unsigned int cluster;
-    unsigned int clusterValue;
+    unsigned int lastFatSector;
+    unsigned int groupMask;
+    unsigned int groupFree;
+    int groupWhole;
     int oldClStackIndex;
     int sectorSkip;
     int recordSkip;
@@ -184,28 +230,46 @@ static int fat_readEmptyClusters32(fat_driver *fatd)
     recordSkip = fatd->clStackLast % indexCount;
 
     fatStartSector = fatd->partBpb.partStart + fatd->partBpb.resSectors;
+    lastFatSector  = fatd->maxCluster / indexCount; // the FAT may be larger than the volume
+    groupMask      = (1 << fatd->freeMapShift) - 1;
+    groupFree      = 0;
+    groupWhole     = 0;
 
-    for (i = sectorSkip; i < fatd->partBpb.fatSize && fatd->clStackIndex < MAX_CLUSTER_STACK; i++) {
+    for (i = sectorSkip; i <= lastFatSector && fatd->clStackIndex < MAX_CLUSTER_STACK; i++) {
         int ret;
+        unsigned int records;
 
         unsigned char *sbuf = NULL; // sector buffer
 
+        if (fatd->freeMap != NULL) {
+            if (fatd->freeMap[i >> fatd->freeMapShift] == 0) { // the group is full - skip it
+                i |= groupMask;
+                recordSkip = 0;
+                continue;
+            }
+            if ((i & groupMask) == 0 && recordSkip == 0) { // the whole group is about to be scanned
+                groupFree  = 0;
+                groupWhole = 1;
+            }
+        }
+
         ret = READ_SECTOR(DEV_ACCESSOR(fatd), fatStartSector + i, sbuf);
         if (ret < 0) {
             XPRINTF("Read fat32 sector failed! sector=%u! \n", fatStartSector + i);
             return -EIO;
         }
-        for (j = recordSkip; j < indexCount && fatd->clStackIndex < MAX_CLUSTER_STACK; j++) {
-            cluster = getUI32(sbuf + (j * 4));
-            if (cluster == 0) { // the cluster is free
-                clusterValue = (i * indexCount) + j;
-                if (clusterValue < 0xFFFFFF7) {
-                    fatd->clStackLast                 = clusterValue;
-                    fatd->clStack[fatd->clStackIndex] = clusterValue;
-                    fatd->clStackIndex++;
-                }
+        records = (i == lastFatSector) ? (fatd->maxCluster % indexCount) + 1 : indexCount;
+        for (j = recordSkip; j < records && fatd->clStackIndex < MAX_CLUSTER_STACK; j++) {
+            if ((getUI32(sbuf + (j * 4)) & 0x0FFFFFFF) == 0) { // the cluster is free
+                fatd->clStackLast                 = (i * indexCount) + j;
+                fatd->clStack[fatd->clStackIndex] = fatd->clStackLast;
+                fatd->clStackIndex++;
+                groupFree++;
             }
         }
+        if (fatd->freeMap != NULL) {
+            fat_freeMapScanned(fatd, i, lastFatSector, j == records, &groupFree, &groupWhole);
+        }
         recordSkip = 0;
     }
     // the stack operates as LIFO but we put in the clusters as FIFO
@@ -225,7 +289,10 @@ static int fat_readEmptyClusters16(fat_driver *fatd)
     unsigned int i, j;
     unsigned int indexCount;
     unsigned int fatStartSector;
-    unsigned int cluster;
+    unsigned int lastFatSector;
+    unsigned int groupMask;
+    unsigned int groupFree;
+    int groupWhole;
     int oldClStackIndex;
     int sectorSkip;
     int recordSkip;
@@ -241,26 +308,47 @@ static int fat_readEmptyClusters16(fat_driver *fatd)
     recordSkip = fatd->clStackLast % indexCount;
 
     fatStartSector = fatd->partBpb.partStart + fatd->partBpb.resSectors;
+    lastFatSector  = fatd->maxCluster / indexCount; // the FAT may be larger than the volume
+    groupMask      = (1 << fatd->freeMapShift) - 1;
+    groupFree      = 0;
+    groupWhole     = 0;
 
-    for (i = sectorSkip; i < fatd->partBpb.fatSize && fatd->clStackIndex < MAX_CLUSTER_STACK; i++) {
+    for (i = sectorSkip; i <= lastFatSector && fatd->clStackIndex < MAX_CLUSTER_STACK; i++) {
         int ret;
+        unsigned int records;
 
         unsigned char *sbuf = NULL; // sector buffer
 
+        if (fatd->freeMap != NULL) {
+            if (fatd->freeMap[i >> fatd->freeMapShift] == 0) { // the group is full - skip it
+                i |= groupMask;
+                recordSkip = 0;
+                continue;
+            }
+            if ((i & groupMask) == 0 && recordSkip == 0) { // the whole group is about to be scanned
+                groupFree  = 0;
+                groupWhole = 1;
+            }
+        }
+
         ret = READ_SECTOR(DEV_ACCESSOR(fatd), fatStartSector + i, sbuf);
         if (ret < 0) {
             XPRINTF("Read fat16 sector failed! sector=%u! \n", fatStartSector + i);
             return -EIO;
         }
-        for (j = recordSkip; j < indexCount && fatd->clStackIndex < MAX_CLUSTER_STACK; j++) {
-            cluster = getUI16(sbuf + (j * 2));
-            if (cluster == 0) { // the cluster is free
+        records = (i == lastFatSector) ? (fatd->maxCluster % indexCount) + 1 : indexCount;
+        for (j = recordSkip; j < records && fatd->clStackIndex < MAX_CLUSTER_STACK; j++) {
+            if (getUI16(sbuf + (j * 2)) == 0) { // the cluster is free
                 fatd->clStackLast                 = (i * indexCount) + j;
                 fatd->clStack[fatd->clStackIndex] = fatd->clStackLast;
                 XPRINTF("%u ", fatd->clStack[fatd->clStackIndex]);
                 fatd->clStackIndex++;
+                groupFree++;
             }
         }
+        if (fatd->freeMap != NULL) {
+            fat_freeMapScanned(fatd, i, lastFatSector, j == records, &groupFree, &groupWhole);
+        }
         recordSkip = 0;
     }
     XPRINTF("\n");
@@ -494,64 +582,6 @@ static int fat_saveClusterRecord32(fat_driver *fatd, unsigned int currentCluster
 }
 
 
-//---------------------------------------------------------------------------
-/*
-  Append (and write) cluster chain to the FAT table.
-
-  currentCluster - current end cluster record.
-  endCluster     - new end cluster record.
-
-  Note: there is no checking wether the currentCluster holds the EOF marker!
-
-  Example
-  current FAT:
-
-  index   09    10    11    12
-        +-----+-----+-----+-----+
-  value + 10  | EOF | 0   | 0   |
-        +-----+-----+-----+-----+
-
-
-  currentcluster = 10, endcluster = 12
-  updated FAT (after the function ends):
-
-  index   09    10    11    12
-        +-----+-----+-----+-----+
-  value + 10  | 12  | 0   | EOF |
-        +-----+-----+-----+-----+
-
-*/
-//---------------------------------------------------------------------------
-static int fat_appendClusterChain(fat_driver *fatd, unsigned int currentCluster, unsigned int endCluster)
-{
-    int ret;
-    ret = -1;
-    switch (fatd->partBpb.fatType) {
-        case FAT12:
-            ret = fat_saveClusterRecord12(fatd, currentCluster, endCluster);
-            if (ret < 0)
-                return ret;
-            ret = fat_saveClusterRecord12(fatd, endCluster, 0xFFF);
-            break;
-
-        case FAT16:
-            XPRINTF("I: appending cluster chain : current=%u end=%u \n", currentCluster, endCluster);
-            ret = fat_saveClusterRecord16(fatd, currentCluster, endCluster);
-            if (ret < 0)
-                return ret;
-            ret = fat_saveClusterRecord16(fatd, endCluster, 0xFFFF);
-            break;
-
-        case FAT32:
-            ret = fat_saveClusterRecord32(fatd, currentCluster, endCluster);
-            if (ret < 0)
-                return ret;
-            ret = fat_saveClusterRecord32(fatd, endCluster, 0xFFFFFFF);
-            break;
-    }
-    return ret;
-}
-
 //---------------------------------------------------------------------------
 /*
  create new cluster chain (of size 1 cluster) at the cluster index
@@ -616,6 +646,7 @@ static int fat_deleteClusterChain(fat_driver *fatd, unsigned int cluster)
             if (ret < 0) {
                 return ret;
             }
+            fat_freeMapUpdate(fatd, fatd->cbuf[i], 1);
         }
         // the cluster chain continues
         if (size == MAX_DIR_CLUSTER) {
@@ -626,6 +657,7 @@ static int fat_deleteClusterChain(fat_driver *fatd, unsigned int cluster)
             if (ret < 0) {
                 return ret;
             }
+            fat_freeMapUpdate(fatd, fatd->cbuf[end], 1);
             cont = 0;
         }
         fat_invalidateLastChainResult(fatd); // prevent to misuse current (now deleted) fatd->cbuf
@@ -633,6 +665,157 @@ static int fat_deleteClusterChain(fat_driver *fatd, unsigned int cluster)
     return 1;
 }
 
+//---------------------------------------------------------------------------
+/*
+  Write a new chain of count contiguous clusters starting at cluster, each record
+  pointing at the next cluster and the last one holding the EOF marker. Each FAT
+  sector is read and written once for the whole run rather than once per cluster.
+*/
+static int fat_createClusterRun(fat_driver *fatd, unsigned int cluster, unsigned int count)
+{
+    int ret;
+    unsigned int recordSize;
+    unsigned int indexCount;
+    unsigned int endOfChain;
+    int fatNumber;
+
+    if (fatd->partBpb.fatType == FAT12) { // records may span sectors - save them one by one
+        unsigned int i;
+
+        for (i = 0; i < count; i++) {
+            ret = fat_saveClusterRecord12(fatd, cluster + i, (i + 1 < count) ? cluster + i + 1 : 0xFFF);
+            if (ret < 0)
+                return ret;
+        }
+        return 1;
+    }
+
+    ret = -1;
+    if (fatd->partBpb.fatType == FAT32) {
+        recordSize = 4;
+        endOfChain = 0xFFFFFFF;
+    } else {
+        recordSize = 2;
+        endOfChain = 0xFFFF;
+    }
+    // indexCount is numer of cluster indices per sector
+    indexCount = fatd->partBpb.sectorSize / recordSize;
+
+    // save both fat tables
+    for (fatNumber = 0; fatNumber < fatd->partBpb.fatCount; fatNumber++) {
+        unsigned int current, end;
+
+        current = cluster;
+        end     = cluster + count;
+        while (current < end) {
+            unsigned int i;
+            unsigned int fatSector;
+
+            unsigned char *sbuf = NULL; // sector buffer
+
+            fatSector = fatd->partBpb.partStart + fatd->partBpb.resSectors + (fatNumber * fatd->partBpb.fatSize);
+            fatSector += current / indexCount;
+
+            ret = READ_SECTOR(DEV_ACCESSOR(fatd), fatSector, sbuf);
+            if (ret < 0) {
+                XPRINTF("Read fat sector failed! sector=%u! \n", fatSector);
+                return -EIO;
+            }
+            for (i = current % indexCount; i < indexCount && current < end; i++, current++) {
+                unsigned int value;
+                unsigned char *record;
+
+                value     = (current + 1 < end) ? current + 1 : endOfChain;
+                record    = sbuf + (i * recordSize);
+                record[0] = value & 0xFF;
+                record[1] = ((value & 0xFF00) >> 8);
+                if (recordSize == 4) {
+                    record[2] = ((value & 0xFF0000) >> 16);
+                    record[3] = (record[3] & 0xF0) + ((value >> 24) & 0x0F); // preserve the highest nibble intact
+                }
+            }
+            ret = WRITE_SECTOR(DEV_ACCESSOR(fatd), fatSector);
+            if (ret < 0) {
+                XPRINTF("Write fat sector failed! sector=%u! \n", fatSector);
+                return -EIO;
+            }
+        }
+    }
+    return ret;
+}
+
+//---------------------------------------------------------------------------
+/*
+  Refill the cluster stack. When nothing is left past the last free cluster found,
+  the scan starts over from the beginning of the FAT, to reuse the clusters freed
+  since. Returns the number of clusters on the stack.
+*/
+static int fat_fillClStack(fat_driver *fatd)
+{
+    int ret;
+
+    fatd->clStackIndex = 0;
+    ret                = fat_readEmptyClusters(fatd);
+    if (ret == 0 && fatd->clStackLast != 0) {
+        fatd->clStackLast = 0;
+        ret               = fat_readEmptyClusters(fatd);
+    }
+    if (ret < 0) {
+        fatd->clStackIndex = 0;
+    }
+    return ret;
+}
+
+//---------------------------------------------------------------------------
+/*
+  Get count empty clusters from the clusterStack (cS is small cache of free clusters)
+  and append them at the end of the fat chain, that ends with currentCluster (0 creates
+  a new chain). Adjacent free clusters are taken together and written as one run.
+  *lastCluster receives the new end of the chain. Returns the number of clusters
+  appended, which is less than count if the volume is full.
+*/
+static unsigned int fat_getFreeClusters(fat_driver *fatd, unsigned int currentCluster, unsigned int count, unsigned int *lastCluster)
+{
+    unsigned int done;
+
+    *lastCluster = currentCluster;
+    for (done = 0; done < count;) {
+        unsigned int start, run, i;
+        int ret;
+
+        // cluster stack is empty - find and fill the cS
+        if (fatd->clStackIndex <= 0 && fat_fillClStack(fatd) <= 0) {
+            break;
+        }
+
+        // pop from cluster stack, the lowest clusters are on top
+        fatd->clStackIndex--;
+        start = fatd->clStack[fatd->clStackIndex];
+        run   = 1;
+        while (done + run < count && fatd->clStackIndex > 0 && fatd->clStack[fatd->clStackIndex - 1] == start + run) {
+            fatd->clStackIndex--;
+            run++;
+        }
+
+        // write the new clusters before linking them, so that an interrupted update only loses them
+        ret = fat_createClusterRun(fatd, start, run);
+        if (ret >= 0 && *lastCluster != 0) {
+            ret = fat_modifyClusterChain(fatd, *lastCluster, start);
+        }
+        if (ret < 0) {
+            break;
+        }
+
+        for (i = 0; i < run; i++) {
+            fat_freeMapUpdate(fatd, start + i, -1);
+        }
+        *lastCluster = start + run - 1;
+        done += run;
+    }
+
+    return done;
+}
+
 //---------------------------------------------------------------------------
 /*
   Get single empty cluster from the clusterStack (cS is small cache of free clusters)
@@ -641,28 +824,9 @@ static int fat_deleteClusterChain(fat_driver *fatd, unsigned int cluster)
 */
 static unsigned int fat_getFreeCluster(fat_driver *fatd, unsigned int currentCluster)
 {
-
-    int ret;
     unsigned int result;
 
-    // cluster stack is empty - find and fill the cS
-    if (fatd->clStackIndex <= 0) {
-        fatd->clStackIndex = 0;
-        ret                = fat_readEmptyClusters(fatd);
-        if (ret <= 0)
-            return 0;
-        fatd->clStackIndex = ret;
-    }
-    // pop from cluster stack
-    fatd->clStackIndex--;
-    result = fatd->clStack[fatd->clStackIndex];
-    // append the cluster chain
-    if (currentCluster) {
-        ret = fat_appendClusterChain(fatd, currentCluster, result);
-    } else { // create new cluster chain
-        ret = fat_createClusterChain(fatd, result);
-    }
-    if (ret < 0)
+    if (fat_getFreeClusters(fatd, currentCluster, 1, &result) != 1)
         return 0;
     return result;
 }
@@ -2319,12 +2483,12 @@ int fat_writeFile(fat_driver *fatd, fat_dir *fatDir, int *updateClusterIndices,
 
         if (lastCluster == 0)
             return -ENOSPC; // no more free clusters or data invalid
-        for (i = 0; i < j; i++) {
-            lastCluster = fat_getFreeCluster(fatd, lastCluster);
-            if (lastCluster == 0)
-                return -ENOSPC; // no more free clusters
+        i                     = fat_getFreeClusters(fatd, lastCluster, j, &lastCluster);
+        fatDir->lastCluster   = lastCluster; // the chain was extended even if it fell short
+        if (i < j) {
+            fat_invalidateLastChainResult(fatd);
+            return -ENOSPC; // no more free clusters
         }
-        fatDir->lastCluster   = lastCluster;
         *updateClusterIndices = j;
         fat_invalidateLastChainResult(fatd); // prevent to misuse current (now deleted) fatd->cbuf
 
@@ -214,6 +214,9 @@ static void fs_reset(void)
     M_DEBUG("%s\n", __func__);
 
     for (i = 0; i < MAX_FILES; i++) {
+        if (fsRec[i].dirent.file_flag == FS_FILE_FLAG_FILE) {
+            fat_freeFileExtents(&fsRec[i].dirent.fatdir);
+        }
         fsRec[i].dirent.file_flag = -1;
     }
 #ifndef WIN32
@@ -377,6 +380,7 @@ static int fs_close(iop_file_t *fd)
 
     rec->dirent.file_flag = -1;
     fd->privdata          = NULL;
+    fat_freeFileExtents(&rec->dirent.fatdir);
 
     fatd = fat_getData(fd->unit);
     if (fatd == NULL) {
@@ -491,6 +495,7 @@ static int fs_write(iop_file_t *fd, void *buffer, int size)
             // if new clusters allocated - then update file cluster indices
             if (updateClusterIndices) {
                 fat_setFatDirChain(fatd, &rec->dirent.fatdir);
+                fat_freeFileExtents(&rec->dirent.fatdir);
             }
         }
     }
@@ -914,6 +919,11 @@ static int fs_devctl(iop_file_t *fd, const char *name, int cmd, void *arg, unsig
 #endif
             ret = 0;
             break;
+#ifndef BUILDING_USBHDFSD
+        case USBMASS_DEVCTL_GET_BDM_STATS:
+            ret = bdm_get_stats(buf, buflen / sizeof(bdm_stats_t));
+            break;
+#endif
         default:
             ret = -ENXIO;
     }
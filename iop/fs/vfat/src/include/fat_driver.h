@@ -71,6 +71,13 @@ typedef struct _fat_driver
     unsigned int clStack[MAX_CLUSTER_STACK]; // cluster allocation stack
     int clStackIndex;
     unsigned int clStackLast; // last free cluster of the fat table
+
+#define FAT_FREE_MAP_GROUPS  8192   // maximum number of groups in freeMap
+#define FAT_FREE_MAP_UNKNOWN 0xFFFF // the group was not scanned yet
+    unsigned short *freeMap;    // number of free clusters in each group of FAT sectors (NULL for FAT12)
+    unsigned int freeMapGroups; // number of groups
+    unsigned int freeMapShift;  // a group spans (1 << freeMapShift) FAT sectors
+    unsigned int maxCluster;    // highest cluster number of the volume
 } fat_driver;
 #endif /* BUILDING_USBHDFSD */
 
@@ -86,6 +93,17 @@ typedef struct _fat_dir_chain_record
     unsigned int index;
 } fat_dir_chain_record;
 
+// A run of clusters that are contiguous on the disk
+typedef struct _fat_dir_extent
+{
+    unsigned int index;   // index of the first cluster within the file
+    unsigned int cluster; // first cluster of the run
+    unsigned int count;   // number of clusters in the run
+} fat_dir_extent;
+
+// Extent maps are not built for files that are fragmented beyond this
+#define FAT_MAX_EXTENTS 512
+
 typedef struct _fat_dir
 {
     unsigned char attr; // attributes (bits:5-Archive 4-Directory 3-Volume Label 2-System 1-Hidden 0-Read Only)
@@ -102,6 +120,9 @@ typedef struct _fat_dir
     // Stuff here are used for caching and might not be filled.
     unsigned int lastCluster;
     fat_dir_chain_record chain[DIR_CHAIN_SIZE]; // cluser/offset cache - for seeking purpose
+    // Extent map of the cluster chain, built on the first read of an open file.
+    fat_dir_extent *extents;
+    int extentCount; // 0 = not built, -1 = not available
 } fat_dir;
 
 #ifdef BUILDING_IEEE1394_DISK
@@ -123,6 +144,7 @@ extern void fat_forceUnmount(struct block_device *bd);
 #endif
 
 extern void fat_setFatDirChain(fat_driver *fatd, fat_dir *fatDir);
+extern void fat_freeFileExtents(fat_dir *fatDir);
 extern int fat_readFile(fat_driver *fatd, fat_dir *fatDir, unsigned int filePos, unsigned char *buffer, unsigned int size);
 extern int fat_getFirstDirentry(fat_driver *fatd, const char *dirName, fat_dir_list *fatdlist, fat_dir *fatDir_host, fat_dir *fatDir);
 extern int fat_getNextDirentry(fat_driver *fatd, fat_dir_list *fatdlist, fat_dir *fatDir);
@@ -61,6 +61,9 @@ extern int scache_flushSectors(cache_set *cache);
 #ifdef BUILDING_USBHDFSD
 extern void scache_invalidate(cache_set *cache, unsigned int sector, int count);
 #endif /* BUILDING_USBHDFSD */
+#ifndef BUILDING_IEEE1394_DISK
+extern int scache_flushRange(cache_set *cache, unsigned int sector, unsigned int count);
+#endif /* BUILDING_IEEE1394_DISK */
 
 extern void scache_getStat(cache_set *cache, unsigned int *access, unsigned int *hits);
 
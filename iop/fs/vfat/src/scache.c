@@ -379,6 +379,33 @@ void scache_invalidate(cache_set *cache, unsigned int sector, int count)
 }
 #endif /* BUILDING_USBHDFSD */
 
+#ifndef BUILDING_IEEE1394_DISK
+/* Write back the dirty blocks that overlap the given sectors, so that they can be read
+   from the device directly. The blocks stay cached as their contents remain valid. */
+int scache_flushRange(cache_set *cache, unsigned int sector, unsigned int count)
+{
+    unsigned int i;
+
+    XPRINTF("cache: flushRange devId = %i sector = %u count = %u \n", DEVID_ACCESSOR(cache), sector, count);
+
+    for (i = 0; i < CACHE_SIZE; i++) {
+        if (cache->rec[i].writeDirty && cache->rec[i].sector < sector + count && cache->rec[i].sector + cache->indexLimit > sector) {
+            int ret;
+
+            ret = WRITE_SECTOR(DEV_ACCESSOR(cache), cache->rec[i].sector, cache->sectorBuf + (i * BLOCK_SIZE), BLOCK_SIZE / cache->sectorSize);
+            if (ret < 0) {
+                M_PRINTF("scache: ERROR writing sector to disk! sector=%u\n", cache->rec[i].sector);
+                return ret;
+            }
+
+            cache->rec[i].writeDirty = 0;
+        }
+    }
+
+    return 0;
+}
+#endif /* BUILDING_IEEE1394_DISK */
+
 //---------------------------------------------------------------------------
 #if defined(BUILDING_USBHDFSD)
 cache_set *scache_init(mass_dev *dev, int sectSize)
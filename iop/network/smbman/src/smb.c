@@ -28,6 +28,11 @@ static server_specs_t server_specs;
 #define CLIENT_MAX_BUFFER_SIZE USHRT_MAX // Allow up to 65535 bytes to be received.
 #define CLIENT_MAX_XFER_SIZE   USHRT_MAX // Allow up to 65535 bytes to be transferred.
 
+// smb_ReadFile() and smb_WriteFile() keep up to this many requests in flight, each with its own MID.
+#define CLIENT_MAX_MPX 4
+// Size of the requests of a pipelined transfer. Kept 4KB-aligned, so that the server's reads and writes stay aligned.
+#define CLIENT_IO_CHUNK_SIZE (CLIENT_MAX_XFER_SIZE & ~4095)
+
 static int main_socket = -1;
 
 static struct
@@ -59,6 +64,8 @@ static struct
         QueryPathInformationResponse_t queryPathInformationResponse;
         FindFirstNext2Request_t findFirstNext2Request;
         FindFirstNext2Response_t findFirstNext2Response;
+        FindClose2Request_t findClose2Request;
+        FindClose2Response_t findClose2Response;
         NTCreateAndXRequest_t ntCreateAndXRequest;
         NTCreateAndXResponse_t ntCreateAndXResponse;
         OpenAndXRequest_t openAndXRequest;
@@ -219,7 +226,26 @@ static int RecvData(int sock, char *buf, int size, int timeout_ms)
 }
 
 //-------------------------------------------------------------------------
-static int GetSMBServerReply(int shdrlen, void *spayload, int rhdrlen)
+// Discards the rest of a message that the caller does not want.
+static int SkipData(int sock, int size, int timeout_ms)
+{
+    while (size > 0) {
+        int result, chunk;
+
+        // The SMB buffer only holds headers at this point, so its payload area is free to use.
+        chunk  = size > MAX_SMB_BUF ? MAX_SMB_BUF : size;
+        result = RecvData(sock, (char *)&SMB_buf.smb.u8buff[MAX_SMB_BUF_HDR], chunk, timeout_ms);
+        if (result <= 0)
+            return result;
+
+        size -= result;
+    }
+
+    return 1;
+}
+
+//-------------------------------------------------------------------------
+static int SendSMBRequest(int shdrlen, void *spayload)
 {
     int rcv_size, totalpkt_size, size;
 
@@ -243,6 +269,14 @@ static int GetSMBServerReply(int shdrlen, void *spayload, int rhdrlen)
             return -1;
     }
 
+    return totalpkt_size;
+}
+
+//-------------------------------------------------------------------------
+static int RecvSMBReply(int rhdrlen)
+{
+    int rcv_size, totalpkt_size, size;
+
     // Read NetBIOS session message header. Drop NBSS Session Keep alive messages (type == 0x85, with no body), but process session messages (type == 0x00).
     do {
         rcv_size = RecvData(main_socket, (char *)&SMB_buf.sessionHeader, sizeof(SMB_buf.sessionHeader), 10000); // 10s before the packet is considered lost
@@ -253,7 +287,7 @@ static int GetSMBServerReply(int shdrlen, void *spayload, int rhdrlen)
     totalpkt_size = nb_GetSessionMessageLength();
 
     // If rhdrlen is not specified, retrieve the whole packet. Otherwise, retrieve only the headers (caller will retrieve the payload separately).
-    size     = (rhdrlen == 0) ? totalpkt_size : rhdrlen;
+    size     = (rhdrlen == 0 || rhdrlen > totalpkt_size) ? totalpkt_size : rhdrlen;
     rcv_size = RecvData(main_socket, (char *)&SMB_buf.smb, size, 3000); // 3s before the packet is considered lost
     if (rcv_size <= 0)
         return -2;
@@ -261,6 +295,15 @@ static int GetSMBServerReply(int shdrlen, void *spayload, int rhdrlen)
     return totalpkt_size;
 }
 
+//-------------------------------------------------------------------------
+static int GetSMBServerReply(int shdrlen, void *spayload, int rhdrlen)
+{
+    if (SendSMBRequest(shdrlen, spayload) <= 0)
+        return -1;
+
+    return RecvSMBReply(rhdrlen);
+}
+
 //-------------------------------------------------------------------------
 // These functions will process UTF-16 characters on a byte-level, so that they will be safe for use with byte-alignment.
 static int asciiToUtf16(char *out, const char *in)
@@ -488,7 +531,7 @@ lbl_session_setup:
     SSR->smbWordcount  = 13;
     SSR->smbAndxCmd    = SMB_COM_NONE; // no ANDX command
     SSR->MaxBufferSize = CLIENT_MAX_BUFFER_SIZE;
-    SSR->MaxMpxCount   = server_specs.MaxMpxCount >= 2 ? 2 : (u16)server_specs.MaxMpxCount;
+    SSR->MaxMpxCount   = server_specs.MaxMpxCount >= CLIENT_MAX_MPX ? CLIENT_MAX_MPX : (u16)server_specs.MaxMpxCount;
     SSR->VCNumber      = 1;
     SSR->SessionKey    = server_specs.SessionKey;
     SSR->Capabilities  = capabilities;
@@ -999,11 +1042,36 @@ int smb_OpenAndX(int UID, int TID, char *filename, s64 *filesize, int mode)
 }
 
 //-------------------------------------------------------------------------
-int smb_ReadAndX(int UID, int TID, int FID, s64 fileoffset, void *readbuf, int nbytes)
+// Number of requests that may be outstanding at once, as allowed by the server.
+static int GetMaxRequests(void)
 {
-    ReadAndXRequest_t *RR    = &SMB_buf.smb.readAndXRequest;
-    ReadAndXResponse_t *RRsp = &SMB_buf.smb.readAndXResponse;
-    int r, padding, DataLength;
+    if (server_specs.MaxMpxCount >= CLIENT_MAX_MPX)
+        return CLIENT_MAX_MPX;
+
+    return server_specs.MaxMpxCount > 1 ? server_specs.MaxMpxCount : 1;
+}
+
+// Size of the requests that a transfer of nbytes is split into, so that small transfers still use every slot.
+static int GetChunkSize(int nbytes, int slots)
+{
+    int chunk;
+
+    chunk = (((nbytes + slots - 1) / slots) + 4095) & ~4095;
+
+    return chunk > CLIENT_IO_CHUNK_SIZE ? CLIENT_IO_CHUNK_SIZE : chunk;
+}
+
+// The destination of an outstanding request of a pipelined transfer. The slot number + 1 is the MID of the request.
+typedef struct
+{
+    int index; // index of the chunk within the transfer
+    char *buf;
+    int len;
+} PipeSlot_t;
+
+static int SendReadAndX(int UID, int TID, int FID, s64 fileoffset, int nbytes, int MID)
+{
+    ReadAndXRequest_t *RR = &SMB_buf.smb.readAndXRequest;
 
     ZERO_PKT_ALIGNED(RR, sizeof(ReadAndXRequest_t));
 
@@ -1012,6 +1080,7 @@ int smb_ReadAndX(int UID, int TID, int FID, s64 fileoffset, void *readbuf, int n
     RR->smbH.Cmd     = SMB_COM_READ_ANDX;
     RR->smbH.UID     = (u16)UID;
     RR->smbH.TID     = (u16)TID;
+    RR->smbH.MID     = (u16)MID;
     RR->smbWordcount = 12;
     RR->smbAndxCmd   = SMB_COM_NONE; // no ANDX command
     RR->FID          = (u16)FID;
@@ -1021,71 +1090,159 @@ int smb_ReadAndX(int UID, int TID, int FID, s64 fileoffset, void *readbuf, int n
     RR->MaxCountHigh = (u16)(nbytes >> 16);
 
     nb_SetSessionMessage(sizeof(ReadAndXRequest_t));
-    r = GetSMBServerReply(0, NULL, sizeof(ReadAndXResponse_t));
-    if (r <= 0)
-        return -EIO;
+    return SendSMBRequest(0, NULL);
+}
+
+/*  Receives the response to one of the outstanding ReadAndX requests, straight into the buffer of its slot.
+    The whole message is always consumed, so the next response can be read even if this one failed.
+    Returns the number of bytes read, -EIO if the server failed the request, or -2 if the connection was lost. */
+static int RecvReadAndX(PipeSlot_t *slots, int nslots, int *slot)
+{
+    ReadAndXResponse_t *RRsp = &SMB_buf.smb.readAndXResponse;
+    int r, totalpkt_size, hdr_size, DataLength, padding, leftover;
+
+    totalpkt_size = RecvSMBReply(sizeof(ReadAndXResponse_t));
+    if (totalpkt_size <= 0)
+        return -2;
+    hdr_size = totalpkt_size < (int)sizeof(ReadAndXResponse_t) ? totalpkt_size : (int)sizeof(ReadAndXResponse_t);
+    leftover = totalpkt_size - hdr_size;
 
     // check sanity of SMB header
-    if (RRsp->smbH.Magic != SMB_MAGIC)
-        return -EIO;
+    *slot = RRsp->smbH.MID - 1;
+    if ((hdr_size < (int)sizeof(SMBHeader_t)) || (RRsp->smbH.Magic != SMB_MAGIC) || (*slot < 0) || (*slot >= nslots)) {
+        SkipData(main_socket, leftover, 3000);
+        return -2; // a response that cannot be matched to a request leaves the session in an unknown state
+    }
 
     // check there's no error
-    if ((RRsp->smbH.Eclass | (RRsp->smbH.Ecode << 16)) != STATUS_SUCCESS)
+    if ((hdr_size < (int)sizeof(ReadAndXResponse_t)) || ((RRsp->smbH.Eclass | (RRsp->smbH.Ecode << 16)) != STATUS_SUCCESS)) {
+        if (SkipData(main_socket, leftover, 3000) <= 0)
+            return -2;
         return -EIO;
+    }
 
     // Skip any padding bytes.
-    padding = RRsp->DataOffset - sizeof(ReadAndXResponse_t);
+    padding    = RRsp->DataOffset - sizeof(ReadAndXResponse_t);
+    DataLength = (int)(((u32)RRsp->DataLengthHigh << 16) | RRsp->DataLengthLow);
+    if ((padding < 0) || (padding + DataLength > leftover) || (DataLength > slots[*slot].len)) {
+        SkipData(main_socket, leftover, 3000);
+        return -EIO;
+    }
+
     if (padding > 0) {
-        r = RecvData(main_socket, (char *)(RRsp + 1), padding, 3000); // 3s before the packet is considered lost
+        r = SkipData(main_socket, padding, 3000); // 3s before the packet is considered lost
         if (r <= 0)
             return -2;
     }
 
-    DataLength = (int)(((u32)RRsp->DataLengthHigh << 16) | RRsp->DataLengthLow);
     if (DataLength > 0) {
-        r = RecvData(main_socket, readbuf, DataLength, 3000); // 3s before the packet is considered lost
+        r = RecvData(main_socket, slots[*slot].buf, DataLength, 3000); // 3s before the packet is considered lost
         if (r <= 0)
             return -2;
     }
 
-    r = DataLength;
+    if (SkipData(main_socket, leftover - padding - DataLength, 3000) <= 0)
+        return -2;
+
+    return DataLength;
+}
+
+//-------------------------------------------------------------------------
+/*  Called when a pipelined transfer can no longer tell which responses belong to its outstanding requests.
+    The connection is dropped, as the next request would otherwise receive a stale response.
+    The keepalive thread then fails to echo the server, and logs on again. */
+static int DropSession(int result)
+{
+    smb_Disconnect();
+
+    return result;
+}
+
+//-------------------------------------------------------------------------
+int smb_ReadAndX(int UID, int TID, int FID, s64 fileoffset, void *readbuf, int nbytes)
+{
+    PipeSlot_t slot;
+    int r, index;
+
+    slot.index = 0;
+    slot.buf   = readbuf;
+    slot.len   = nbytes;
+
+    if (SendReadAndX(UID, TID, FID, fileoffset, nbytes, 1) <= 0)
+        return -EIO;
+
+    r = RecvReadAndX(&slot, 1, &index);
 
     return r;
 }
 
+//-------------------------------------------------------------------------
+/*  Reads nbytes with up to CLIENT_MAX_MPX ReadAndX requests in flight, so that the latency of each request
+    is hidden behind the transfer of the others. The transfer stops at the first short read (end of file). */
 int smb_ReadFile(int UID, int TID, int FID, s64 fileoffset, void *readbuf, int nbytes)
 {
-    int remaining;
-    char *ptr;
-    s64 pos;
+    PipeSlot_t slots[CLIENT_MAX_MPX];
+    int nslots, chunk, chunks, issued, pending, i, result, error;
 
-    remaining = nbytes;
-    ptr       = readbuf;
-    pos       = fileoffset;
+    if (nbytes <= 0)
+        return 0;
 
-    while (remaining > 0) {
-        int result, toRead;
-        toRead = remaining > CLIENT_MAX_XFER_SIZE ? CLIENT_MAX_XFER_SIZE : remaining;
+    nslots  = GetMaxRequests();
+    chunk   = GetChunkSize(nbytes, nslots);
+    chunks  = (nbytes + chunk - 1) / chunk;
+    issued  = 0;
+    pending = 0;
+    result  = nbytes; // shortened by the first short read
+    error   = 0;
 
-        result = smb_ReadAndX(UID, TID, FID, pos, ptr, toRead);
-        if (result <= 0)
-            return result;
+    for (i = 0; i < nslots; i++)
+        slots[i].buf = NULL;
 
-        pos += result;
-        ptr += result;
-        remaining -= result;
+    while (issued < chunks || pending > 0) {
+        int slot, r;
+
+        // Keep the window full, unless the end of the file or an error was seen.
+        while (issued < chunks && pending < nslots && error == 0 && issued * chunk < result) {
+            for (slot = 0; slots[slot].buf != NULL; slot++)
+                ;
+
+            slots[slot].index = issued;
+            slots[slot].buf   = (char *)readbuf + issued * chunk;
+            slots[slot].len   = (nbytes - issued * chunk) > chunk ? chunk : (nbytes - issued * chunk);
+
+            if (SendReadAndX(UID, TID, FID, fileoffset + issued * chunk, slots[slot].len, slot + 1) <= 0)
+                return DropSession(-EIO);
+
+            issued++;
+            pending++;
+        }
+
+        if (pending == 0)
+            break;
+
+        r = RecvReadAndX(slots, nslots, &slot);
+        if (r == -2)
+            return DropSession(-2);
+
+        pending--;
+        if (r < 0) {
+            error = r;
+        } else if (r < slots[slot].len) {
+            // Only the data up to the first short read is contiguous.
+            if (slots[slot].index * chunk + r < result)
+                result = slots[slot].index * chunk + r;
+        }
+        slots[slot].buf = NULL;
     }
 
-    return nbytes;
+    return error != 0 ? error : result;
 }
 
 //-------------------------------------------------------------------------
-int smb_WriteAndX(int UID, int TID, int FID, s64 fileoffset, void *writebuf, int nbytes)
+static int SendWriteAndX(int UID, int TID, int FID, s64 fileoffset, void *writebuf, int nbytes, int MID)
 {
-    int r;
-    const int padding         = 1; // 1 padding byte, to keep the payload aligned for writing performance.
-    WriteAndXRequest_t *WR    = &SMB_buf.smb.writeAndXRequest;
-    WriteAndXResponse_t *WRsp = &SMB_buf.smb.writeAndXResponse;
+    const int padding      = 1; // 1 padding byte, to keep the payload aligned for writing performance.
+    WriteAndXRequest_t *WR = &SMB_buf.smb.writeAndXRequest;
 
     ZERO_PKT_ALIGNED(WR, sizeof(WriteAndXRequest_t) + padding);
 
@@ -1094,6 +1251,7 @@ int smb_WriteAndX(int UID, int TID, int FID, s64 fileoffset, void *writebuf, int
     WR->smbH.Cmd       = SMB_COM_WRITE_ANDX;
     WR->smbH.UID       = (u16)UID;
     WR->smbH.TID       = (u16)TID;
+    WR->smbH.MID       = (u16)MID;
     WR->smbWordcount   = 14;
     WR->smbAndxCmd     = SMB_COM_NONE; // no ANDX command
     WR->FID            = (u16)FID;
@@ -1107,46 +1265,70 @@ int smb_WriteAndX(int UID, int TID, int FID, s64 fileoffset, void *writebuf, int
     WR->ByteCount      = (u16)nbytes + padding;
 
     nb_SetSessionMessage(sizeof(WriteAndXRequest_t) + padding + nbytes);
-    r = GetSMBServerReply(sizeof(WriteAndXRequest_t) + padding, writebuf, 0);
-    if (r <= 0)
-        return -EIO;
-
-    // check sanity of SMB header
-    if (WRsp->smbH.Magic != SMB_MAGIC)
-        return -EIO;
-
-    // check there's no error
-    if ((WRsp->smbH.Eclass | (WRsp->smbH.Ecode << 16)) != STATUS_SUCCESS)
-        return -EIO;
-
-    return nbytes;
+    return SendSMBRequest(sizeof(WriteAndXRequest_t) + padding, writebuf);
 }
 
+//-------------------------------------------------------------------------
+/*  Writes nbytes with up to CLIENT_MAX_MPX WriteAndX requests in flight. The responses are small,
+    so the next requests can be sent while the server is still working on the earlier ones. */
 int smb_WriteFile(int UID, int TID, int FID, s64 fileoffset, void *writebuf, int nbytes)
 {
-    int remaining;
-    char *ptr;
-    s64 pos;
+    WriteAndXResponse_t *WRsp = &SMB_buf.smb.writeAndXResponse;
+    int lens[CLIENT_MAX_MPX];
+    int nslots, chunk, chunks, issued, pending, slot, error;
 
-    remaining = nbytes;
-    ptr       = writebuf;
-    pos       = fileoffset;
+    if (nbytes <= 0)
+        return 0;
 
-    while (remaining > 0) {
-        int result, toWrite;
+    nslots  = GetMaxRequests();
+    chunk   = GetChunkSize(nbytes, nslots);
+    chunks  = (nbytes + chunk - 1) / chunk;
+    issued  = 0;
+    pending = 0;
+    error   = 0;
 
-        toWrite = remaining > CLIENT_MAX_XFER_SIZE ? CLIENT_MAX_XFER_SIZE : remaining;
+    for (slot = 0; slot < nslots; slot++)
+        lens[slot] = 0;
 
-        result = smb_WriteAndX(UID, TID, FID, pos, ptr, toWrite);
-        if (result <= 0)
-            return result;
+    while (issued < chunks || pending > 0) {
+        int r, count;
 
-        pos += result;
-        ptr += result;
-        remaining -= result;
+        while (issued < chunks && pending < nslots && error == 0) {
+            for (slot = 0; lens[slot] != 0; slot++)
+                ;
+
+            lens[slot] = (nbytes - issued * chunk) > chunk ? chunk : (nbytes - issued * chunk);
+
+            if (SendWriteAndX(UID, TID, FID, fileoffset + issued * chunk, (char *)writebuf + issued * chunk, lens[slot], slot + 1) <= 0)
+                return DropSession(-EIO);
+
+            issued++;
+            pending++;
+        }
+
+        if (pending == 0)
+            break;
+
+        r = RecvSMBReply(0);
+        if (r <= 0)
+            return DropSession(-EIO);
+
+        // check sanity of SMB header
+        slot = WRsp->smbH.MID - 1;
+        if ((r < (int)sizeof(SMBHeader_t)) || (WRsp->smbH.Magic != SMB_MAGIC) || (slot < 0) || (slot >= nslots) || (lens[slot] == 0))
+            return DropSession(-EIO);
+
+        pending--;
+
+        // check there's no error, and that everything was written
+        count = (r < (int)sizeof(WriteAndXResponse_t)) ? -1 : (int)(((u32)WRsp->CountHigh << 16) | WRsp->Count);
+        if (((WRsp->smbH.Eclass | (WRsp->smbH.Ecode << 16)) != STATUS_SUCCESS) || (count != lens[slot]))
+            error = -EIO;
+
+        lens[slot] = 0;
     }
 
-    return nbytes;
+    return error != 0 ? error : nbytes;
 }
 
 //-------------------------------------------------------------------------
@@ -1337,9 +1519,11 @@ int smb_Rename(int UID, int TID, char *oldPath, char *newPath)
 }
 
 //-------------------------------------------------------------------------
-int smb_FindFirstNext2(int UID, int TID, char *Path, int cmd, SearchInfo_t *info)
+/*  Requests up to maxEntries directory entries at once. Each entry of the reply is stored into info in turn
+    and passed to callback, so the caller may keep what it needs. Returns the number of entries. */
+int smb_FindFirstNext2(int UID, int TID, char *Path, int cmd, SearchInfo_t *info, int maxEntries, smbFindEntryCallback_t callback, void *arg)
 {
-    int r, PathLen, offset;
+    int r, i, PathLen, offset, DataEnd;
     FindFirstNext2Request_t *FFNR    = &SMB_buf.smb.findFirstNext2Request;
     FindFirstNext2Response_t *FFNRsp = &SMB_buf.smb.findFirstNext2Response;
 
@@ -1369,7 +1553,7 @@ int smb_FindFirstNext2(int UID, int TID, char *Path, int cmd, SearchInfo_t *info
         FindFirst2RequestParam_t *FFRParam = (FindFirst2RequestParam_t *)&SMB_buf.smb.u8buff[FFNR->smbTrans.ParamOffset];
 
         FFRParam->SearchAttributes = ATTR_READONLY | ATTR_HIDDEN | ATTR_SYSTEM | ATTR_DIRECTORY | ATTR_ARCHIVE;
-        FFRParam->SearchCount      = 1;
+        FFRParam->SearchCount      = (u16)maxEntries;
         FFRParam->Flags            = CLOSE_SEARCH_IF_EOS | RESUME_SEARCH;
         FFRParam->LevelOfInterest  = SMB_FIND_FILE_BOTH_DIRECTORY_INFO;
         FFRParam->StorageType      = 0;
@@ -1382,7 +1566,7 @@ int smb_FindFirstNext2(int UID, int TID, char *Path, int cmd, SearchInfo_t *info
         FindNext2RequestParam_t *FNRParam = (FindNext2RequestParam_t *)&SMB_buf.smb.u8buff[FFNR->smbTrans.ParamOffset];
 
         FNRParam->SearchID        = (u16)info->SID;
-        FNRParam->SearchCount     = 1;
+        FNRParam->SearchCount     = (u16)maxEntries;
         FNRParam->LevelOfInterest = SMB_FIND_FILE_BOTH_DIRECTORY_INFO;
         FNRParam->ResumeKey       = 0;
         FNRParam->Flags           = CLOSE_SEARCH_IF_EOS | RESUME_SEARCH | CONTINUE_SEARCH;
@@ -1428,23 +1612,76 @@ int smb_FindFirstNext2(int UID, int TID, char *Path, int cmd, SearchInfo_t *info
     } else
         FFNRspParam = (FindFirstNext2ResponseParam_t *)&SMB_buf.smb.u8buff[FFNRsp->smbTrans.ParamOffset - 2];
 
-    FindFirst2ResponseData_t *FFRspData = (FindFirst2ResponseData_t *)&SMB_buf.smb.u8buff[FFNRsp->smbTrans.DataOffset];
-
     info->EOS = FFNRspParam->EndOfSearch;
 
     if (FFNRspParam->SearchCount == 0)
         return -EINVAL;
 
-    info->fileInfo.Created        = FFRspData->Created;
-    info->fileInfo.LastAccess     = FFRspData->LastAccess;
-    info->fileInfo.LastWrite      = FFRspData->LastWrite;
-    info->fileInfo.Change         = FFRspData->Change;
-    info->fileInfo.FileAttributes = FFRspData->FileAttributes;
-    if (FFRspData->FileAttributes & EXT_ATTR_DIRECTORY)
-        info->fileInfo.IsDirectory = 1;
-    info->fileInfo.AllocationSize = FFRspData->AllocationSize;
-    info->fileInfo.EndOfFile      = FFRspData->EndOfFile;
-    getStringField(info->FileName, FFRspData->FileName, FFRspData->FileNameLen);
+    offset  = FFNRsp->smbTrans.DataOffset;
+    DataEnd = offset + FFNRsp->smbTrans.DataCount;
+    if (DataEnd > (int)sizeof(SMB_buf.smb.u8buff))
+        DataEnd = sizeof(SMB_buf.smb.u8buff);
+
+    for (i = 0; i < FFNRspParam->SearchCount; i++) {
+        FindFirst2ResponseData_t *FFRspData = (FindFirst2ResponseData_t *)&SMB_buf.smb.u8buff[offset];
+
+        // Do not trust entries that do not fit in the reply.
+        if ((offset + (int)sizeof(FindFirst2ResponseData_t) > DataEnd) || (offset + (int)sizeof(FindFirst2ResponseData_t) + (int)FFRspData->FileNameLen > DataEnd))
+            break;
+
+        info->fileInfo.Created        = FFRspData->Created;
+        info->fileInfo.LastAccess     = FFRspData->LastAccess;
+        info->fileInfo.LastWrite      = FFRspData->LastWrite;
+        info->fileInfo.Change         = FFRspData->Change;
+        info->fileInfo.FileAttributes = FFRspData->FileAttributes;
+        info->fileInfo.IsDirectory    = (FFRspData->FileAttributes & EXT_ATTR_DIRECTORY) ? 1 : 0;
+        info->fileInfo.AllocationSize = FFRspData->AllocationSize;
+        info->fileInfo.EndOfFile      = FFRspData->EndOfFile;
+        getStringField(info->FileName, FFRspData->FileName, FFRspData->FileNameLen);
+
+        callback(info, arg);
+
+        if (FFRspData->NextEntryOffset == 0) {
+            i++;
+            break;
+        }
+        offset += FFRspData->NextEntryOffset;
+    }
+
+    return i > 0 ? i : -EINVAL;
+}
+
+//-------------------------------------------------------------------------
+// Closes a search that did not reach its end, which the server would otherwise keep open.
+int smb_FindClose2(int UID, int TID, int SID)
+{
+    int r;
+    FindClose2Request_t *FCR    = &SMB_buf.smb.findClose2Request;
+    FindClose2Response_t *FCRsp = &SMB_buf.smb.findClose2Response;
+
+    ZERO_PKT_ALIGNED(FCR, sizeof(FindClose2Request_t));
+
+    FCR->smbH.Magic   = SMB_MAGIC;
+    FCR->smbH.Cmd     = SMB_COM_FIND_CLOSE2;
+    FCR->smbH.Flags   = SMB_FLAGS_CANONICAL_PATHNAMES;
+    FCR->smbH.Flags2  = SMB_FLAGS2_KNOWS_LONG_NAMES | SMB_FLAGS2_32BIT_STATUS;
+    FCR->smbH.UID     = (u16)UID;
+    FCR->smbH.TID     = (u16)TID;
+    FCR->smbWordcount = 1;
+    FCR->SearchID     = (u16)SID;
+
+    nb_SetSessionMessage(sizeof(FindClose2Request_t));
+    r = GetSMBServerReply(0, NULL, 0);
+    if (r <= 0)
+        return -EIO;
+
+    // check sanity of SMB header
+    if (FCRsp->smbH.Magic != SMB_MAGIC)
+        return -EIO;
+
+    // check there's no error
+    if ((FCRsp->smbH.Eclass | (FCRsp->smbH.Ecode << 16)) != STATUS_SUCCESS)
+        return -EIO;
 
     return 0;
 }
@@ -309,6 +309,8 @@ typedef struct
     char FileName[];
 } SearchInfo_t;
 
+typedef void (*smbFindEntryCallback_t)(SearchInfo_t *info, void *arg);
+
 typedef struct
 {
     u32 Magic;
@@ -640,6 +642,21 @@ typedef struct
     u8 ByteField[];
 } __attribute__((packed)) FindFirstNext2Response_t;
 
+typedef struct
+{
+    SMBHeader_t smbH;
+    u8 smbWordcount;
+    u16 SearchID;
+    u16 ByteCount;
+} __attribute__((packed)) FindClose2Request_t;
+
+typedef struct
+{
+    SMBHeader_t smbH;
+    u8 smbWordcount;
+    u16 ByteCount;
+} __attribute__((packed)) FindClose2Response_t;
+
 typedef struct
 {
     SMBHeader_t smbH;
@@ -873,13 +890,13 @@ extern int smb_TreeDisconnect(int UID, int TID);
 extern int smb_NetShareEnum(int UID, int TID, ShareEntry_t *shareEntries, int index, int maxEntries);
 extern int smb_QueryInformationDisk(int UID, int TID, smbQueryDiskInfo_out_t *QueryInformationDisk);
 extern int smb_QueryPathInformation(int UID, int TID, PathInformation_t *Info, char *Path);
-extern int smb_FindFirstNext2(int UID, int TID, char *Path, int cmd, SearchInfo_t *info);
+extern int smb_FindFirstNext2(int UID, int TID, char *Path, int cmd, SearchInfo_t *info, int maxEntries, smbFindEntryCallback_t callback, void *arg);
+extern int smb_FindClose2(int UID, int TID, int SID);
 extern int smb_LogOffAndX(int UID);
 extern int smb_Echo(void *echo, int len);
 
 extern int smb_OpenAndX(int UID, int TID, char *filename, s64 *filesize, int mode);
 extern int smb_ReadAndX(int UID, int TID, int FID, s64 offset, void *readbuf, int nbytes);
-extern int smb_WriteAndX(int UID, int TID, int FID, s64 offset, void *writebuf, int nbytes);
 extern int smb_ReadFile(int UID, int TID, int FID, s64 fileoffset, void *readbuf, int nbytes);
 extern int smb_WriteFile(int UID, int TID, int FID, s64 fileoffset, void *writebuf, int nbytes);
 extern int smb_Close(int UID, int TID, int FID);
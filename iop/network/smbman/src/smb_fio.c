@@ -75,6 +75,10 @@ typedef struct
     s64 filesize;
     s64 position;
     u32 mode;
+    s64 ra_next;  // position at which the next sequential read is expected
+    int wb_error; // error of a deferred write, reported by the next write or close
+    int dir_fetched; // number of directory entries that the search has returned so far
+    int dir_eos;     // the search has returned its last entry
     char name[SMB_NAME_MAX];
 } FHANDLE;
 
@@ -99,6 +103,63 @@ static iop_sys_clock_t keepalive_sysclock;
 static int UID = -1;
 static int TID = -1;
 
+/*  Small sequential reads are served from a read-ahead buffer and small sequential writes are gathered
+    into a write-behind buffer, so that the server sees few large requests instead of many round trips.
+    Each buffer belongs to one file at a time. */
+#define SMB_IO_BUF_SIZE 32768
+
+typedef struct
+{
+    FHANDLE *fh;
+    s64 offset;
+    int len;
+    u8 data[SMB_IO_BUF_SIZE];
+} SMBIOBuf_t;
+
+static SMBIOBuf_t smb_readahead;
+static SMBIOBuf_t smb_writebehind;
+
+/*  Attributes returned by the server are kept for a while, to save a round trip for every getstat().
+    The entries of the last directory that was listed are kept as well: directories are listed in large
+    batches, and browsers that stat every entry of a listing are answered from it. */
+#define SMB_CACHE_TTL_DEFAULT  10000 // In milliseconds
+#define SMB_ATTR_CACHE_ENTRIES 32
+#define SMB_DIR_CACHE_SIZE     32768
+#define SMB_DIR_BATCH_ENTRIES  128 // The server returns as many of these as fit in a reply.
+
+typedef struct
+{
+    u32 stamp;
+    PathInformation_t info;
+    char path[SMB_NAME_MAX]; // Empty if unused
+} SMBAttrCacheEntry_t;
+
+typedef struct
+{
+    PathInformation_t info;
+    u16 size; // Of the whole record, including the name
+    char name[];
+} SMBDirCacheEntry_t;
+
+static struct
+{
+    char path[SMB_NAME_MAX + 2]; // Directory with a trailing backslash, empty if unused
+    FHANDLE *fh;             // Handle whose search is filling the cache
+    u32 stamp;
+    int valid;    // May be used to answer lookups
+    int complete; // Holds the whole directory
+    int first;    // Index of the first entry held
+    int count;
+    int used;
+    int hint_index; // Entry at which the last lookup ended, so that sequential lookups do not start over
+    int hint_offset;
+    u8 data[SMB_DIR_CACHE_SIZE];
+} smb_dircache;
+
+static SMBAttrCacheEntry_t smb_attrcache[SMB_ATTR_CACHE_ENTRIES];
+static int smb_attrcache_next;
+static u32 smb_cache_ttl = SMB_CACHE_TTL_DEFAULT;
+
 static smbLogOn_in_t glogon_info;
 static smbOpenShare_in_t gopenshare_info;
 
@@ -238,6 +299,313 @@ int smb_init(iop_device_t *dev)
     return 0;
 }
 
+//--------------------------------------------------------------
+// Writes out the write-behind buffer. Errors are kept for the file that the data belongs to.
+static int smb_flushWriteBehind(void)
+{
+    FHANDLE *fh = smb_writebehind.fh;
+    int r;
+
+    if (fh == NULL)
+        return 0;
+
+    smb_writebehind.fh = NULL;
+    if (smb_writebehind.len <= 0)
+        return 0;
+
+    r = smb_WriteFile(UID, TID, fh->smb_fid, smb_writebehind.offset, smb_writebehind.data, smb_writebehind.len);
+    if (r < 0) {
+        fh->wb_error = r;
+        return r;
+    }
+
+    return 0;
+}
+
+//--------------------------------------------------------------
+// Called before anything that may observe the contents of files on the server.
+static void smb_syncIOBufs(void)
+{
+    smb_flushWriteBehind();
+}
+
+//--------------------------------------------------------------
+static u32 smb_cacheTime(void)
+{
+    iop_sys_clock_t clock;
+    u32 sec, usec;
+
+    GetSystemTime(&clock);
+    SysClock2USec(&clock, &sec, &usec);
+
+    return sec * 1000 + usec / 1000;
+}
+
+//--------------------------------------------------------------
+static int smb_cacheIsFresh(u32 stamp)
+{
+    return (smb_cacheTime() - stamp) < smb_cache_ttl;
+}
+
+//--------------------------------------------------------------
+static void smb_cacheClear(void)
+{
+    int i;
+
+    for (i = 0; i < SMB_ATTR_CACHE_ENTRIES; i++)
+        smb_attrcache[i].path[0] = '\0';
+
+    smb_dircache.path[0]     = '\0';
+    smb_dircache.fh          = NULL;
+    smb_dircache.valid       = 0;
+    smb_dircache.complete    = 0;
+    smb_dircache.first       = 0;
+    smb_dircache.count       = 0;
+    smb_dircache.used        = 0;
+    smb_dircache.hint_index  = 0;
+    smb_dircache.hint_offset = 0;
+}
+
+//--------------------------------------------------------------
+// Returns the length of the parent directory of path, including its trailing backslash.
+static int smb_cacheParentLen(const char *path)
+{
+    int len;
+
+    len = strlen(path);
+    if ((len > 0) && (path[len - 1] == '\\'))
+        len--;
+    while ((len > 0) && (path[len - 1] != '\\'))
+        len--;
+
+    return len;
+}
+
+//--------------------------------------------------------------
+// Forgets what is known about path, about everything below it, and about the directory that contains it.
+static void smb_cacheInvalidate(const char *path)
+{
+    int i, len, parent_len;
+
+    len = strlen(path);
+    for (i = 0; i < SMB_ATTR_CACHE_ENTRIES; i++) {
+        if (!strncmp(smb_attrcache[i].path, path, len))
+            smb_attrcache[i].path[0] = '\0';
+    }
+
+    // The search that fills the directory cache may go on, but its contents are no longer current.
+    parent_len = smb_cacheParentLen(path);
+    if (((strlen(smb_dircache.path) == (unsigned int)parent_len) && !strncmp(smb_dircache.path, path, parent_len)) || !strncmp(smb_dircache.path, path, len)) {
+        smb_dircache.valid    = 0;
+        smb_dircache.complete = 0;
+    }
+}
+
+//--------------------------------------------------------------
+static void smb_cacheAddAttr(const char *path, const PathInformation_t *info)
+{
+    SMBAttrCacheEntry_t *entry;
+
+    if ((smb_cache_ttl == 0) || (strlen(path) >= SMB_NAME_MAX))
+        return;
+
+    entry = &smb_attrcache[smb_attrcache_next];
+    smb_attrcache_next = (smb_attrcache_next + 1) % SMB_ATTR_CACHE_ENTRIES;
+
+    entry->stamp = smb_cacheTime();
+    memcpy(&entry->info, info, sizeof(PathInformation_t));
+    strcpy(entry->path, path);
+}
+
+//--------------------------------------------------------------
+static int smb_cacheLookup(const char *path, PathInformation_t *info)
+{
+    int i, parent_len, name_len, offset;
+
+    if (smb_cache_ttl == 0)
+        return 0;
+
+    for (i = 0; i < SMB_ATTR_CACHE_ENTRIES; i++) {
+        if ((smb_attrcache[i].path[0] != '\0') && !strcmp(smb_attrcache[i].path, path)) {
+            if (!smb_cacheIsFresh(smb_attrcache[i].stamp)) {
+                smb_attrcache[i].path[0] = '\0';
+                break;
+            }
+            memcpy(info, &smb_attrcache[i].info, sizeof(PathInformation_t));
+            return 1;
+        }
+    }
+
+    // Look for the entry in the listing of its directory.
+    parent_len = smb_cacheParentLen(path);
+    if (!smb_dircache.valid || (strlen(smb_dircache.path) != (unsigned int)parent_len) || strncmp(smb_dircache.path, path, parent_len) || !smb_cacheIsFresh(smb_dircache.stamp))
+        return 0;
+
+    name_len = strlen(path) - parent_len;
+    if ((name_len > 0) && (path[parent_len + name_len - 1] == '\\'))
+        name_len--;
+
+    for (i = 0, offset = 0; i < smb_dircache.count; i++) {
+        SMBDirCacheEntry_t *entry = (SMBDirCacheEntry_t *)&smb_dircache.data[offset];
+
+        if (!strncmp(entry->name, &path[parent_len], name_len) && (entry->name[name_len] == '\0')) {
+            memcpy(info, &entry->info, sizeof(PathInformation_t));
+            return 1;
+        }
+        offset += entry->size;
+    }
+
+    return 0;
+}
+
+//--------------------------------------------------------------
+static int smb_queryPath(char *path, PathInformation_t *info)
+{
+    int r;
+
+    if (smb_cacheLookup(path, info))
+        return 0;
+
+    r = smb_QueryPathInformation(UID, TID, info, path);
+    if (r >= 0)
+        smb_cacheAddAttr(path, info);
+
+    return r;
+}
+
+//--------------------------------------------------------------
+// Receives the entries of a search batch into the directory cache.
+static void smb_dirCacheAdd(SearchInfo_t *info, void *arg)
+{
+    FHANDLE *fh = (FHANDLE *)arg;
+    SMBDirCacheEntry_t *entry;
+    int size;
+
+    fh->dir_fetched++;
+
+    // Room for a whole batch is made before every request, and a record is never larger than its entry in the reply.
+    size = (sizeof(SMBDirCacheEntry_t) + strlen(info->FileName) + 1 + 7) & ~7;
+    if ((smb_dircache.fh != fh) || (smb_dircache.used + size > SMB_DIR_CACHE_SIZE))
+        return;
+
+    entry = (SMBDirCacheEntry_t *)&smb_dircache.data[smb_dircache.used];
+    memcpy(&entry->info, &info->fileInfo, sizeof(PathInformation_t));
+    entry->size = (u16)size;
+    strcpy(entry->name, info->FileName);
+
+    smb_dircache.used += size;
+    smb_dircache.count++;
+}
+
+//--------------------------------------------------------------
+// Returns the entry of the directory cache with the given index, or NULL if the cache does not hold it.
+static SMBDirCacheEntry_t *smb_dirCacheGet(int index)
+{
+    int i, offset;
+
+    if ((index < smb_dircache.first) || (index >= smb_dircache.first + smb_dircache.count))
+        return NULL;
+
+    i      = smb_dircache.first;
+    offset = 0;
+    if ((smb_dircache.hint_index > i) && (smb_dircache.hint_index <= index)) {
+        i      = smb_dircache.hint_index;
+        offset = smb_dircache.hint_offset;
+    }
+
+    for (; i < index; i++)
+        offset += ((SMBDirCacheEntry_t *)&smb_dircache.data[offset])->size;
+
+    smb_dircache.hint_index  = index;
+    smb_dircache.hint_offset = offset;
+
+    return (SMBDirCacheEntry_t *)&smb_dircache.data[offset];
+}
+
+//--------------------------------------------------------------
+// Closes the search of fh. The server already closed it if it reached its end.
+static void smb_dirSearchClose(FHANDLE *fh)
+{
+    if ((fh->smb_fid != -1) && !fh->dir_eos)
+        smb_FindClose2(UID, TID, fh->smb_fid);
+    fh->smb_fid = -1;
+}
+
+//--------------------------------------------------------------
+// Starts the search of fh over, from its first entry.
+static void smb_dirSearchRestart(FHANDLE *fh)
+{
+    smb_dirSearchClose(fh);
+    fh->dir_fetched = 0;
+    fh->dir_eos     = 0;
+}
+
+//--------------------------------------------------------------
+// Requests up to count more entries of the search of fh. Each one goes through smb_dirCacheAdd().
+static int smb_dirSearch(FHANDLE *fh, int count)
+{
+    SearchInfo_t *info = (SearchInfo_t *)SearchBuf;
+    int r;
+
+    if (fh->smb_fid == -1) {
+        r = smb_FindFirstNext2(UID, TID, fh->name, TRANS2_FIND_FIRST2, info, count, &smb_dirCacheAdd, fh);
+        if (r < 0)
+            return r;
+        fh->smb_fid = info->SID;
+    } else {
+        info->SID = fh->smb_fid;
+        r         = smb_FindFirstNext2(UID, TID, NULL, TRANS2_FIND_NEXT2, info, count, &smb_dirCacheAdd, fh);
+        if (r < 0)
+            return r;
+    }
+
+    if (info->EOS)
+        fh->dir_eos = 1;
+
+    return 0;
+}
+
+//--------------------------------------------------------------
+// Fetches the next batch of entries of the search of fh into the directory cache.
+static int smb_dirCacheFill(FHANDLE *fh, const char *dir, int dir_len)
+{
+    int r;
+
+    // Entries that were returned but not read yet were dropped from the cache: start over.
+    if ((fh->smb_fid != -1) && (fh->position < fh->dir_fetched))
+        smb_dirSearchRestart(fh);
+
+    if ((smb_dircache.fh != fh) || (fh->smb_fid == -1)) {
+        smb_dircache.fh          = fh;
+        smb_dircache.stamp       = smb_cacheTime();
+        smb_dircache.valid       = 1;
+        smb_dircache.complete    = 0;
+        smb_dircache.first       = fh->dir_fetched;
+        smb_dircache.count       = 0;
+        smb_dircache.used        = 0;
+        smb_dircache.hint_index  = smb_dircache.first;
+        smb_dircache.hint_offset = 0;
+        strncpy(smb_dircache.path, dir, dir_len);
+        smb_dircache.path[dir_len] = '\0';
+    } else if (smb_dircache.used + MAX_SMB_BUF > SMB_DIR_CACHE_SIZE) {
+        // Make room for a whole batch. Everything held was read already.
+        smb_dircache.first += smb_dircache.count;
+        smb_dircache.count       = 0;
+        smb_dircache.used        = 0;
+        smb_dircache.hint_index  = smb_dircache.first;
+        smb_dircache.hint_offset = 0;
+    }
+
+    r = smb_dirSearch(fh, SMB_DIR_BATCH_ENTRIES);
+    if (r < 0)
+        return r;
+
+    if (fh->dir_eos && (smb_dircache.first == 0))
+        smb_dircache.complete = 1;
+
+    return 0;
+}
+
 //--------------------------------------------------------------
 int smb_initdev(void)
 {
@@ -344,6 +712,10 @@ int smb_open(iop_file_t *f, const char *filename, int flags, int mode)
 
     smb_io_lock();
 
+    // The file may be created or truncated.
+    if (flags & (O_CREAT | O_TRUNC))
+        smb_cacheInvalidate(path);
+
     fh = smbman_getfilefreeslot();
     if (fh) {
         r = smb_OpenAndX(UID, TID, path, &filesize, flags);
@@ -354,6 +726,8 @@ int smb_open(iop_file_t *f, const char *filename, int flags, int mode)
             fh->mode     = flags;
             fh->filesize = filesize;
             fh->position = 0;
+            fh->ra_next  = -1;
+            fh->wb_error = 0;
             if (fh->mode & O_TRUNC)
                 fh->filesize = 0;
             else if (fh->mode & O_APPEND)
@@ -382,14 +756,25 @@ int smb_close(iop_file_t *f)
 
     if (fh) {
         if (fh->mode != O_DIROPEN) {
+            int wb_error;
+
+            if (smb_writebehind.fh == fh)
+                smb_flushWriteBehind();
+            if (smb_readahead.fh == fh)
+                smb_readahead.fh = NULL;
+            wb_error = fh->wb_error;
+
             r = smb_Close(UID, TID, fh->smb_fid);
             if (r != 0) {
                 goto io_unlock;
             }
-        }
+            r = wb_error;
+        } else
+            smb_dirSearchClose(fh);
+        if (smb_dircache.fh == fh)
+            smb_dircache.fh = NULL;
         memset(fh, 0, sizeof(FHANDLE));
         fh->smb_fid = -1;
-        r           = 0;
     }
 
 io_unlock:
@@ -403,6 +788,10 @@ void smb_closeAll(void)
 {
     int i;
 
+    smb_flushWriteBehind();
+    smb_readahead.fh = NULL;
+    smb_cacheClear();
+
     for (i = 0; i < MAX_FDHANDLES; i++) {
         FHANDLE *fh;
 
@@ -430,11 +819,39 @@ int smb_read(iop_file_t *f, void *buf, int size)
     if ((fh->position + size) > fh->filesize)
         size = fh->filesize - fh->position;
 
+    if (size <= 0)
+        return 0;
+
     smb_io_lock();
 
-    r = smb_ReadFile(UID, TID, fh->smb_fid, fh->position, buf, size);
+    smb_syncIOBufs();
+
+    if ((smb_readahead.fh == fh) && (fh->position >= smb_readahead.offset) && (fh->position < smb_readahead.offset + smb_readahead.len)) {
+        // Serve what is available from the read-ahead buffer.
+        r = (int)(smb_readahead.offset + smb_readahead.len - fh->position);
+        if (r > size)
+            r = size;
+        memcpy(buf, &smb_readahead.data[fh->position - smb_readahead.offset], r);
+    } else if ((size < SMB_IO_BUF_SIZE) && (fh->position == fh->ra_next)) {
+        // The file is being read sequentially in small pieces: fetch a whole buffer with one pipelined read.
+        smb_readahead.fh = NULL;
+        r                = smb_ReadFile(UID, TID, fh->smb_fid, fh->position, smb_readahead.data, SMB_IO_BUF_SIZE);
+        if (r > 0) {
+            smb_readahead.fh     = fh;
+            smb_readahead.offset = fh->position;
+            smb_readahead.len    = r;
+            if (r > size)
+                r = size;
+            memcpy(buf, smb_readahead.data, r);
+        }
+    } else {
+        // Large or random reads go straight to the caller's buffer.
+        r = smb_ReadFile(UID, TID, fh->smb_fid, fh->position, buf, size);
+    }
+
     if (r > 0) {
         fh->position += r;
+        fh->ra_next = fh->position;
     }
 
     smb_io_unlock();
@@ -454,15 +871,60 @@ int smb_write(iop_file_t *f, void *buf, int size)
     if ((!(fh->mode & O_RDWR)) && (!(fh->mode & O_WRONLY)))
         return -EACCES;
 
+    if (size <= 0)
+        return 0;
+
     smb_io_lock();
 
-    r = smb_WriteFile(UID, TID, fh->smb_fid, fh->position, buf, size);
+    // Whichever file this is, the data that was read ahead may no longer be current.
+    smb_readahead.fh = NULL;
+    smb_cacheInvalidate(fh->name);
+
+    // Report the failure of an earlier deferred write first.
+    if (fh->wb_error != 0) {
+        r            = fh->wb_error;
+        fh->wb_error = 0;
+        goto io_unlock;
+    }
+
+    // Only writes that continue the buffered data can be gathered.
+    if ((smb_writebehind.fh != NULL) && ((smb_writebehind.fh != fh) || (smb_writebehind.offset + smb_writebehind.len != fh->position) || (smb_writebehind.len + size > SMB_IO_BUF_SIZE))) {
+        r = smb_flushWriteBehind();
+        if ((r < 0) && (fh->wb_error != 0)) {
+            fh->wb_error = 0;
+            goto io_unlock;
+        }
+    }
+
+    if (size < SMB_IO_BUF_SIZE) {
+        if (smb_writebehind.fh == NULL) {
+            smb_writebehind.fh     = fh;
+            smb_writebehind.offset = fh->position;
+            smb_writebehind.len    = 0;
+        }
+        memcpy(&smb_writebehind.data[smb_writebehind.len], buf, size);
+        smb_writebehind.len += size;
+        r = size;
+
+        if (smb_writebehind.len == SMB_IO_BUF_SIZE) {
+            int result = smb_flushWriteBehind();
+            if (result < 0) {
+                fh->wb_error = 0;
+                r            = result;
+                goto io_unlock;
+            }
+        }
+    } else {
+        r = smb_WriteFile(UID, TID, fh->smb_fid, fh->position, buf, size);
+    }
+
     if (r > 0) {
         fh->position += r;
         if (fh->position > fh->filesize)
             fh->filesize += fh->position - fh->filesize;
     }
 
+io_unlock:
     smb_io_unlock();
 
     return r;
@@ -487,6 +949,9 @@ int smb_remove(iop_file_t *f, const char *filename)
 
     DPRINTF("smb_remove: filename=%s\n", filename);
 
+    smb_syncIOBufs();
+    smb_cacheInvalidate(path);
+
     r = smb_Delete(UID, TID, path);
 
     smb_io_unlock();
@@ -512,6 +977,8 @@ int smb_mkdir(iop_file_t *f, const char *dirname, int mode)
 
     smb_io_lock();
 
+    smb_cacheInvalidate(path);
+
     r = smb_ManageDirectory(UID, TID, path, SMB_COM_CREATE_DIRECTORY);
 
     smb_io_unlock();
@@ -537,7 +1004,9 @@ int smb_rmdir(iop_file_t *f, const char *dirname)
 
     smb_io_lock();
 
-    r = smb_QueryPathInformation(UID, TID, &info, path);
+    smb_syncIOBufs();
+
+    r = smb_queryPath(path, &info);
     if (r < 0) {
         goto io_unlock;
     }
@@ -546,6 +1015,8 @@ int smb_rmdir(iop_file_t *f, const char *dirname)
         goto io_unlock;
     }
 
+    smb_cacheInvalidate(path);
+
     r = smb_ManageDirectory(UID, TID, path, SMB_COM_DELETE_DIRECTORY);
 
 io_unlock:
@@ -638,8 +1109,10 @@ int smb_dopen(iop_file_t *f, const char *dirname)
 
     smb_io_lock();
 
+    smb_syncIOBufs();
+
     // test if the dir exists
-    r = smb_QueryPathInformation(UID, TID, &info, path);
+    r = smb_queryPath(path, &info);
     if (r < 0) {
         goto io_unlock;
     }
@@ -657,6 +1130,9 @@ int smb_dopen(iop_file_t *f, const char *dirname)
         fh->filesize = 0;
         fh->position = 0;
 
+        fh->dir_fetched = 0;
+        fh->dir_eos     = 0;
+
         strncpy(fh->name, path, 255);
         if (fh->name[strlen(fh->name) - 1] != '\\')
             strcat(fh->name, "\\");
@@ -678,43 +1154,91 @@ int smb_dclose(iop_file_t *f)
     return smb_close(f);
 }
 
+//--------------------------------------------------------------
+// Reads the entry at the position of fh one entry per request, leaving the directory cache alone.
+// Used while the cache holds entries that another handle has not read yet.
+static int smb_dirFetchOne(FHANDLE *fh, iox_dirent_t *dirent)
+{
+    SearchInfo_t *info = (SearchInfo_t *)SearchBuf;
+    int r;
+
+    if (fh->position < fh->dir_fetched)
+        smb_dirSearchRestart(fh);
+
+    while (fh->dir_fetched <= fh->position) {
+        if (fh->dir_eos)
+            return 0;
+
+        r = smb_dirSearch(fh, 1);
+        if (r < 0)
+            return r;
+    }
+
+    // The last entry received is the one at the position.
+    smb_statFiller(&info->fileInfo, &dirent->stat);
+    strncpy(dirent->name, info->FileName, SMB_NAME_MAX);
+    fh->position++;
+
+    return 1;
+}
+
 //--------------------------------------------------------------
 int smb_dread(iop_file_t *f, iox_dirent_t *dirent)
 {
     FHANDLE *fh = (FHANDLE *)f->privdata;
-    int r;
+    FHANDLE *owner;
+    SMBDirCacheEntry_t *entry;
+    int r, dir_len;
 
     if ((UID == -1) || (TID == -1))
         return -ENOTCONN;
 
     smb_io_lock();
 
+    smb_syncIOBufs();
+
     memset((void *)dirent, 0, sizeof(iox_dirent_t));
 
-    SearchInfo_t *info = (SearchInfo_t *)SearchBuf;
+    // The search pattern is the directory followed by "*".
+    dir_len = strlen(fh->name) - 1;
 
-    if (fh->smb_fid == -1) {
-        r = smb_FindFirstNext2(UID, TID, fh->name, TRANS2_FIND_FIRST2, info);
-        if (r < 0) {
-            goto io_unlock;
+    while (1) {
+        if ((strlen(smb_dircache.path) == (unsigned int)dir_len) && !strncmp(smb_dircache.path, fh->name, dir_len)) {
+            // Other handles may only read a complete listing, that is still current.
+            if ((smb_dircache.fh == fh) || (smb_dircache.complete && smb_dircache.valid && smb_cacheIsFresh(smb_dircache.stamp))) {
+                entry = smb_dirCacheGet(fh->position);
+                if (entry != NULL) {
+                    smb_statFiller(&entry->info, &dirent->stat);
+                    strncpy(dirent->name, entry->name, SMB_NAME_MAX);
+                    fh->position++;
+                    r = 1;
+                    break;
+                }
+
+                if (smb_dircache.complete) {
+                    r = 0;
+                    break;
+                }
+            }
         }
-        fh->smb_fid = info->SID;
-        r           = 1;
-    } else {
-        info->SID = fh->smb_fid;
-        r         = smb_FindFirstNext2(UID, TID, NULL, TRANS2_FIND_NEXT2, info);
-        if (r < 0) {
-            goto io_unlock;
+
+        if (fh->dir_eos && (fh->position >= fh->dir_fetched)) {
+            r = 0;
+            break;
+        }
+
+        // Do not take the cache from a handle that has not read all of its entries yet.
+        owner = smb_dircache.fh;
+        if ((owner != NULL) && (owner != fh) && (owner->position < owner->dir_fetched)) {
+            r = smb_dirFetchOne(fh, dirent);
+            break;
         }
-        r = 1;
-    }
 
-    if (r == 1) {
-        smb_statFiller(&info->fileInfo, &dirent->stat);
-        strncpy(dirent->name, info->FileName, SMB_NAME_MAX);
+        r = smb_dirCacheFill(fh, fh->name, dir_len);
+        if (r < 0)
+            break;
     }
 
-io_unlock:
     smb_io_unlock();
 
     return r;
@@ -738,9 +1262,11 @@ int smb_getstat(iop_file_t *f, const char *filename, iox_stat_t *stat)
 
     smb_io_lock();
 
+    smb_syncIOBufs();
+
     memset((void *)stat, 0, sizeof(iox_stat_t));
 
-    r = smb_QueryPathInformation(UID, TID, &info, path);
+    r = smb_queryPath(path, &info);
     if (r < 0) {
         goto io_unlock;
     }
@@ -773,6 +1299,10 @@ int smb_rename(iop_file_t *f, const char *oldname, const char *newname)
 
     DPRINTF("smb_rename: oldname=%s newname=%s\n", oldname, newname);
 
+    smb_syncIOBufs();
+    smb_cacheInvalidate(oldpath);
+    smb_cacheInvalidate(newpath);
+
     r = smb_Rename(UID, TID, oldpath, newpath);
 
     smb_io_unlock();
@@ -809,7 +1339,7 @@ int smb_chdir(iop_file_t *f, const char *dirname)
     } else if (path[strlen(path) - 1] == '.') {
         smb_curdir[0] = 0;
     } else {
-        r = smb_QueryPathInformation(UID, TID, &info, path);
+        r = smb_queryPath(path, &info);
         if (r < 0) {
             goto io_unlock;
         }
@@ -1027,6 +1557,9 @@ static int smb_OpenShare(smbOpenShare_in_t *openshare)
         TID = -1;
     }
 
+    // Nothing that is known about the previous share applies to the new one.
+    smb_cacheClear();
+
     sprintf(tree_str, "\\\\%s\\%s", specs->ServerIP, openshare->ShareName);
     r = smb_TreeConnectAndX(UID, tree_str, openshare->Password, openshare->PasswordType);
     if (r < 0)
@@ -1073,6 +1606,18 @@ static int smb_QueryDiskInfo(smbQueryDiskInfo_out_t *querydiskinfo)
     return smb_QueryInformationDisk(UID, TID, querydiskinfo);
 }
 
+//--------------------------------------------------------------
+static int smb_SetCacheTTL(smbSetCacheTTL_in_t *setcachettl)
+{
+    if (setcachettl->ttl < 0)
+        return -EINVAL;
+
+    smb_cache_ttl = setcachettl->ttl;
+    smb_cacheClear();
+
+    return 0;
+}
+
 //--------------------------------------------------------------
 int smb_devctl(iop_file_t *f, const char *devname, int cmd, void *arg, unsigned int arglen, void *bufp, unsigned int buflen)
 {
@@ -1120,6 +1665,10 @@ int smb_devctl(iop_file_t *f, const char *devname, int cmd, void *arg, unsigned
             r = smb_QueryDiskInfo((smbQueryDiskInfo_out_t *)bufp);
             break;
 
+        case SMB_DEVCTL_SETCACHETTL:
+            r = smb_SetCacheTTL((smbSetCacheTTL_in_t *)arg);
+            break;
+
         default:
             r = -EINVAL;
     }
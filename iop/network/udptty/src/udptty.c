@@ -26,9 +26,10 @@
 #include <thevent.h>
 #include <ps2ip.h>
 #include <errno.h>
+#include <udptty.h>
 
 #define MODNAME "udptty"
-IRX_ID(MODNAME, 2, 1);
+IRX_ID(MODNAME, 2, 2);
 
 extern struct irx_export_table _exp_udptty;
 
@@ -37,10 +38,30 @@ extern struct irx_export_table _exp_udptty;
 static int udp_socket;
 static int tty_sema = -1;
 
+/* Buffered mode ("-b"): output is coalesced into datagrams of up to
+   UDPTTY_MAX_DATAGRAM bytes, each with a sequence number. A datagram is
+   sent when it is full, when "-n" newlines are pending, "-t" ms after the
+   first pending byte, or on UDPTTY_IOCTL_FLUSH. */
+static int tty_buffered = 0;
+static int tty_flush_usec = 20000;
+static int tty_flush_lines = 32;
+
+static struct
+{
+    udptty_hdr_t hdr;
+    char data[UDPTTY_MAX_DATAGRAM - sizeof(udptty_hdr_t)];
+} tty_tx;
+static int tty_tx_len;
+static int tty_tx_lines;
+static u32 tty_tx_seq;
+static int tty_timer_armed;
+static int tty_flush_eflag = -1;
+
 static int tty_init(iop_device_t *device);
 static int tty_deinit(iop_device_t *device);
 static int tty_stdout_fd(void);
 static int tty_write(iop_file_t *file, void *buf, size_t size);
+static int tty_ioctl(iop_file_t *file, int cmd, void *arg);
 
 IOMAN_RETURN_VALUE_IMPL(EIO);
 
@@ -54,7 +75,7 @@ static iop_device_ops_t tty_ops = {
     IOMAN_RETURN_VALUE(EIO), // read
     (void *)&tty_write, // write
     IOMAN_RETURN_VALUE(EIO), // lseek
-    IOMAN_RETURN_VALUE(EIO), // ioctl
+    (void *)&tty_ioctl, // ioctl
     IOMAN_RETURN_VALUE(EIO), // remove
     IOMAN_RETURN_VALUE(EIO), // mkdir
     IOMAN_RETURN_VALUE(EIO), // rmdir
@@ -185,10 +206,78 @@ static void kprtty_init(void)
 }
 #endif
 
+static void tty_flush_locked(void);
+
+/* Sends whatever is pending once the flush interval has passed since the
+   first byte was buffered. Sleeps while the buffer is empty. */
+static void tty_flush_thread(void *arg)
+{
+    u32 flags;
+
+    (void)arg;
+
+    while (1) {
+        WaitEventFlag(tty_flush_eflag, 1, WEF_AND | WEF_CLEAR, &flags);
+        DelayThread(tty_flush_usec);
+
+        WaitSema(tty_sema);
+        tty_timer_armed = 0;
+        tty_flush_locked();
+        SignalSema(tty_sema);
+    }
+}
+
+static int tty_buffered_init(void)
+{
+    iop_event_t efp;
+    iop_thread_t thp;
+    int thid;
+
+    efp.attr   = EA_SINGLE;
+    efp.option = 0;
+    efp.bits   = 0;
+
+    thp.attr      = TH_C;
+    thp.option    = 0;
+    thp.thread    = &tty_flush_thread;
+    thp.stacksize = 0x800;
+    thp.priority  = 8;
+
+    if ((tty_flush_eflag = CreateEventFlag(&efp)) < 0)
+        return -1;
+
+    if ((thid = CreateThread(&thp)) < 0) {
+        DeleteEventFlag(tty_flush_eflag);
+        return -1;
+    }
+    StartThread(thid, NULL);
+
+    tty_tx.hdr.magic = htonl(UDPTTY_MAGIC);
+    return 0;
+}
+
 int _start(int argc, char *argv[])
 {
-    (void)argc;
-    (void)argv;
+    argc--;
+    argv++;
+    while (argc > 0) {
+        if (!strcmp(argv[0], "-b")) {
+            tty_buffered = 1;
+        } else if (!strcmp(argv[0], "-t") && argc > 1) {
+            argc--;
+            argv++;
+            tty_flush_usec = (int)strtol(argv[0], NULL, 10) * 1000;
+        } else if (!strcmp(argv[0], "-n") && argc > 1) {
+            argc--;
+            argv++;
+            tty_flush_lines = (int)strtol(argv[0], NULL, 10);
+        } else {
+            printf("Usage: udptty [-b] [-t <flush ms>] [-n <flush lines>]\n");
+            return MODULE_NO_RESIDENT_END;
+        }
+        argc--;
+        argv++;
+    }
 
     // register exports
     RegisterLibraryEntries(&_exp_udptty);
@@ -198,6 +287,9 @@ int _start(int argc, char *argv[])
     if (udp_socket < 0)
         return MODULE_NO_RESIDENT_END;
 
+    if (tty_buffered && tty_buffered_init() < 0)
+        tty_buffered = 0;
+
     DelDrv(tty_device.name);
 
     if (AddDrv(&tty_device) < 0)
@@ -224,6 +316,12 @@ int _start(int argc, char *argv[])
 
 int _shutdown()
 {
+    if (tty_buffered) {
+        WaitSema(tty_sema);
+        tty_flush_locked();
+        SignalSema(tty_sema);
+    }
+
     lwip_close(udp_socket);
 
     return 0;
@@ -236,7 +334,7 @@ static int udp_send(void *buf, size_t size)
     struct sockaddr_in peer;
 
     peer.sin_family      = AF_INET;
-    peer.sin_port        = htons(18194);
+    peer.sin_port        = htons(UDPTTY_PORT);
     peer.sin_addr.s_addr = inet_addr("255.255.255.255");
 
     lwip_sendto(udp_socket, buf, size, 0, (struct sockaddr *)&peer, sizeof(peer));
@@ -244,6 +342,50 @@ static int udp_send(void *buf, size_t size)
     return 0;
 }
 
+/* Sends the pending datagram, if any. Called with tty_sema held. */
+static void tty_flush_locked(void)
+{
+    if (tty_tx_len == 0)
+        return;
+
+    tty_tx.hdr.seq = htonl(tty_tx_seq);
+    udp_send(&tty_tx, sizeof(tty_tx.hdr) + tty_tx_len);
+    tty_tx_seq++;
+    tty_tx_len   = 0;
+    tty_tx_lines = 0;
+}
+
+/* Appends to the pending datagram, sending it each time it fills up.
+   Called with tty_sema held. */
+static void tty_buffer_locked(const char *buf, size_t size)
+{
+    while (size > 0) {
+        size_t n = sizeof(tty_tx.data) - tty_tx_len;
+        size_t i;
+
+        if (n > size)
+            n = size;
+        for (i = 0; i < n; i++) {
+            if (buf[i] == '\n')
+                tty_tx_lines++;
+        }
+        memcpy(&tty_tx.data[tty_tx_len], buf, n);
+        tty_tx_len += n;
+        buf += n;
+        size -= n;
+
+        if (tty_tx_len == sizeof(tty_tx.data))
+            tty_flush_locked();
+    }
+
+    if (tty_flush_lines > 0 && tty_tx_lines >= tty_flush_lines)
+        tty_flush_locked();
+    else if (tty_tx_len > 0 && !tty_timer_armed) {
+        tty_timer_armed = 1;
+        SetEventFlag(tty_flush_eflag, 1);
+    }
+}
+
 /* TTY driver.  */
 
 static int tty_init(iop_device_t *device)
@@ -276,8 +418,29 @@ static int tty_write(iop_file_t *file, void *buf, size_t size)
     (void)file;
 
     WaitSema(tty_sema);
-    res = udp_send(buf, size);
+    if (tty_buffered) {
+        tty_buffer_locked(buf, size);
+        res = size;
+    } else
+        res = udp_send(buf, size);
     SignalSema(tty_sema);
 
     return res;
 }
+
+static int tty_ioctl(iop_file_t *file, int cmd, void *arg)
+{
+    (void)file;
+    (void)arg;
+
+    if (cmd != UDPTTY_IOCTL_FLUSH)
+        return -EIO;
+
+    if (tty_buffered) {
+        WaitSema(tty_sema);
+        tty_flush_locked();
+        SignalSema(tty_sema);
+    }
+
+    return 0;
+}
@@ -3,6 +3,18 @@
 
 #include "stdint.h"
 
+#define CRC16_MODE_BITWISE 1 /* Bitwise CRC16, run as a separate pass after reverse_buffer() */
+#define CRC16_MODE_TABLE   2 /* Bit reversal and slice-by-4 table CRC16 in a single pass, 2KiB of tables */
+
+#ifndef CRC16_MODE
+#define CRC16_MODE (CRC16_MODE_TABLE)
+#endif
+
 extern uint16_t crc16(void *buf, int len);
 
+#if CRC16_MODE == CRC16_MODE_TABLE
+/* Same result as reverse_buffer(buffer, count) followed by crc16(buffer, count * 4) */
+extern uint16_t reverse_buffer_crc16(uint32_t *buffer, uint32_t count);
+#endif
+
 #endif
@@ -3,6 +3,8 @@
 
 #include <stdint.h>
 
+#include "reverse_buffer.h"
+
 /*
  * Clock divider for 48MHz clock:
  * 1 = 48  MHz - Invalid setting
@@ -72,7 +74,4 @@ extern uint8_t mx_sio2_wait_equal(uint8_t value, uint32_t count);
 extern uint8_t mx_sio2_wait_not_equal(uint8_t value, uint32_t count);
 extern uint8_t mx_sio2_wait_equal_masked(uint8_t value, uint8_t mask, uint32_t count);
 
-/* misc */
-extern void reverse_buffer(uint32_t *buffer, uint32_t count);
-
 #endif
@@ -0,0 +1,32 @@
+#ifndef REVERSE_BUFFER_H
+#define REVERSE_BUFFER_H
+
+#include <stdint.h>
+
+/* Maximus32's C r3000 optimized byte reversal */
+/* 58-59uS avg on DECKARD */
+#pragma GCC push_options
+#pragma GCC optimize("-O3")
+static inline void reverse_buffer(uint32_t *buffer, uint32_t count)
+{
+    const uint32_t mask0F = 0x0F0F0F0F;
+    const uint32_t maskF0 = 0xF0F0F0F0;
+    const uint32_t mask33 = 0x33333333;
+    const uint32_t maskCC = 0xCCCCCCCC;
+    const uint32_t mask55 = 0x55555555;
+    const uint32_t maskAA = 0xAAAAAAAA;
+    uint32_t n;
+
+#pragma GCC unroll 2
+    for (uint32_t i = 0; i < count; i++) {
+        n = buffer[i];
+        n = ((n & maskF0) >> 4) | ((n & mask0F) << 4);
+        n = ((n & maskCC) >> 2) | ((n & mask33) << 2);
+        n = ((n & maskAA) >> 1) | ((n & mask55) << 1);
+
+        buffer[i] = n;
+    }
+}
+#pragma GCC pop_options
+
+#endif
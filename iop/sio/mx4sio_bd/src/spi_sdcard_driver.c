@@ -452,10 +452,14 @@ static int spisd_read_multi_do(void *buffer, uint16_t count)
             
             while (cmd.sectors_reversed < cmd.sectors_transferred && cmd.abort == 0) {
                 void *buf = (uint32_t *)&cmd.buffer[cmd.sectors_reversed * SECTOR_SIZE]; 
-                reverse_buffer(buf, SECTOR_SIZE / 4);
 
 #ifdef CONFIG_USE_CRC16
+#if CRC16_MODE == CRC16_MODE_TABLE
+                uint16_t crc_a = reverse_buffer_crc16(buf, SECTOR_SIZE / 4);
+#else
+                reverse_buffer(buf, SECTOR_SIZE / 4);
                 uint16_t crc_a = crc16(buf, SECTOR_SIZE);
+#endif
                 uint16_t crc_b = cmd.crc[cmd.sectors_reversed];
                 if (crc_a != crc_b) {
                     // CRC mismatch:
@@ -464,6 +468,8 @@ static int spisd_read_multi_do(void *buffer, uint16_t count)
                     M_DEBUG("CRC mismatch on sector %i, got: 0x%x, exp 0x%x\n", cmd.sectors_reversed, crc_b, crc_a);
                     cmd.abort = CMD_ERROR_CRC16_INVALID;
                 }
+#else
+                reverse_buffer(buf, SECTOR_SIZE / 4);
 #endif
                 if (cmd.abort == 0)
                     cmd.sectors_reversed++;
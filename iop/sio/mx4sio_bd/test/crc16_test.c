@@ -0,0 +1,92 @@
+/* Host check and benchmark of reverse_buffer_crc16() against the two pass
+ * reverse_buffer() + crc16() it replaces. Build and run with: make host-test */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "crc16.h"
+#include "reverse_buffer.h"
+
+#define SECTOR_SIZE 512
+
+static void random_sector(uint32_t *sector)
+{
+    for (int i = 0; i < SECTOR_SIZE / 4; i++)
+        sector[i] = ((uint32_t)rand() << 16) ^ (uint32_t)rand();
+}
+
+static uint16_t two_pass(uint32_t *sector)
+{
+    reverse_buffer(sector, SECTOR_SIZE / 4);
+    return crc16(sector, SECTOR_SIZE);
+}
+
+static int check(int sectors)
+{
+    uint32_t a[SECTOR_SIZE / 4], b[SECTOR_SIZE / 4];
+    int failed = 0;
+
+    for (int i = 0; i < sectors; i++) {
+        uint16_t crc_a, crc_b;
+
+        /* a few fixed patterns first, then random data */
+        if (i == 0)
+            memset(a, 0x00, sizeof(a));
+        else if (i == 1)
+            memset(a, 0xFF, sizeof(a));
+        else
+            random_sector(a);
+        memcpy(b, a, sizeof(a));
+
+        crc_a = two_pass(a);
+        crc_b = reverse_buffer_crc16(b, SECTOR_SIZE / 4);
+
+        if (crc_a != crc_b || memcmp(a, b, sizeof(a)) != 0) {
+            if (failed < 10)
+                printf("sector %d: crc %04x, expected %04x%s\n", i, crc_b, crc_a, memcmp(a, b, sizeof(a)) ? ", data differs" : "");
+            failed++;
+        }
+    }
+
+    printf("%d of %d sectors differ\n", failed, sectors);
+    return failed;
+}
+
+static void bench(int sectors)
+{
+    static uint32_t buf[256][SECTOR_SIZE / 4];
+    volatile uint16_t sink = 0;
+    clock_t start;
+    double t_two, t_fused;
+
+    for (int i = 0; i < 256; i++)
+        random_sector(buf[i]);
+
+    start = clock();
+    for (int i = 0; i < sectors; i++)
+        sink ^= two_pass(buf[i & 255]);
+    t_two = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+    start = clock();
+    for (int i = 0; i < sectors; i++)
+        sink ^= reverse_buffer_crc16(buf[i & 255], SECTOR_SIZE / 4);
+    t_fused = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+    printf("reverse_buffer + crc16: %8.1f MiB/s\n", sectors * (SECTOR_SIZE / 1048576.0) / t_two);
+    printf("reverse_buffer_crc16:   %8.1f MiB/s (%.2fx)\n", sectors * (SECTOR_SIZE / 1048576.0) / t_fused, t_two / t_fused);
+    (void)sink;
+}
+
+int main(int argc, char *argv[])
+{
+    int sectors = argc > 1 ? atoi(argv[1]) : 20000;
+
+    srand(1);
+    if (check(sectors) != 0)
+        return 1;
+
+    bench(sectors * 10);
+    return 0;
+}
@@ -19,6 +19,7 @@
 #include <sysmem.h>
 #include <intrman.h>
 #include <sifcmd.h>
+#include <sifman.h>
 #include <libsd.h>
 #include <sysclib.h>
 
@@ -77,6 +78,20 @@ static int fillbuf_threshold = 0;
 /** boolean to notify when format has changed */
 static int format_changed = 0;
 
+/* shared-ring streaming */
+/** non-zero while the EE DMAs audio straight into ringbuf */
+static int stream_active = 0;
+/** write cursor, DMA'd here by the EE after each chunk */
+static audsrv_stream_cursor_t stream_ctrl __attribute__((aligned (16)));
+/** read cursor, source of the DMA back to the EE */
+static audsrv_stream_cursor_t stream_status __attribute__((aligned (16)));
+/** EE address of the consumed-position cursor */
+static u32 stream_ee_status = 0;
+/** DMA descriptor used to publish the read cursor */
+static SifDmaTransfer_t stream_dmat;
+/** transfer id of the last read cursor update */
+static int stream_dma_id = 0;
+
 /** double buffer for streaming */
 static u8 core1_buf[0x1000] __attribute__((aligned (16)));
 
@@ -104,6 +119,53 @@ static int transfer_complete(void *arg)
 	return 1;
 }
 
+/** Returns the number of feed iterations held by the ring buffer
+ * @param feed_size   bytes consumed by the playing thread per iteration
+ * @returns iteration count
+ *
+ * The playing thread consumes whole iterations and rewinds at the end of
+ * the ring. In streaming mode the EE also DMAs into the ring in quadwords,
+ * so the ring size must be a multiple of 16 bytes as well.
+ */
+static int ringbuf_iterations(int feed_size)
+{
+	int iterations = 10;
+
+	if (stream_active)
+	{
+		while ((feed_size * iterations) & 15)
+		{
+			iterations++;
+		}
+	}
+
+	return iterations;
+}
+
+/** Publishes the read cursor to the EE
+ *
+ * Skipped if the previous update is still in flight; the next iteration of
+ * the playing thread will send a newer position anyway.
+ */
+static void stream_publish_readpos()
+{
+	int intr_state;
+
+	CpuSuspendIntr(&intr_state);
+
+	if (stream_dma_id == 0 || sceSifDmaStat(stream_dma_id) < 0)
+	{
+		stream_status.pos = readpos;
+		stream_dmat.src = &stream_status;
+		stream_dmat.dest = (void *)stream_ee_status;
+		stream_dmat.size = sizeof(stream_status);
+		stream_dmat.attr = 0;
+		stream_dma_id = sceSifSetDma(&stream_dmat, 1);
+	}
+
+	CpuResumeIntr(intr_state);
+}
+
 /** Apply volume changes, or keep mute if not playing */
 static void update_volume()
 {
@@ -177,7 +239,7 @@ int audsrv_format_ok(int freq, int bits, int channels)
  */
 int audsrv_set_format(int freq, int bits, int channels)
 {
-	int feed_size;
+	int feed_size, iterations;
 
 	if (audsrv_format_ok(freq, bits, channels) == 0)
 	{
@@ -202,10 +264,12 @@ int audsrv_set_format(int freq, int bits, int channels)
 
 	/* set ring buffer size to 10 iterations worth of data (~50 ms) */
 	feed_size = ((512 * core1_freq) / 48000) << core1_sample_shift;
-	ringbuf_size = feed_size * 10;
+	iterations = ringbuf_iterations(feed_size);
+	ringbuf_size = feed_size * iterations;
 
 	writepos = 0;
-	readpos = (feed_size * 5) & ~3;
+	readpos = (feed_size * (iterations / 2)) & ~3;
+	stream_ctrl.pos = writepos;
 
 	DPRINTF("freq %d bits %d channels %d ringbuf_sz %d feed_size %d shift %d\n", freq, bits, channels, ringbuf_size, feed_size, core1_sample_shift);
 
@@ -350,6 +414,12 @@ int audsrv_play_audio(const char *buf, int buflen)
 		return -AUDSRV_ERR_NOT_INITIALIZED;
 	}
 
+	if (stream_active)
+	{
+		/* the EE owns the write head */
+		return -AUDSRV_ERR_ARGS;
+	}
+
 	if (playing == 0)
 	{
 		/* audio is always playing, just change the volume */
@@ -403,6 +473,61 @@ int audsrv_set_volume(int vol)
 	return AUDSRV_ERR_NOERROR;
 }
 
+/** Switches to shared-ring streaming
+ * @param ee_status  EE address that receives the read cursor
+ * @param info       receives ring address, ring size, control block address,
+ *                   write cursor and read cursor
+ * @returns 0 on success, negative otherwise
+ *
+ * In streaming mode the EE DMAs audio straight into ringbuf and publishes
+ * its write cursor into the control block, so no RPC is needed per chunk.
+ * The playing thread DMAs its read cursor back to ee_status every
+ * iteration. The ring is reset, so the EE must take over the returned
+ * cursors.
+ */
+int audsrv_stream_start(u32 ee_status, u32 *info)
+{
+	if (initialized == 0)
+	{
+		return -AUDSRV_ERR_NOT_INITIALIZED;
+	}
+
+	if (ee_status == 0 || (ee_status & 15) != 0)
+	{
+		return -AUDSRV_ERR_ARGS;
+	}
+
+	stream_ee_status = ee_status;
+	stream_active = 1;
+
+	/* rebuild the ring with quadword granularity */
+	audsrv_set_format(core1_freq, core1_bits, core1_channels);
+	stream_publish_readpos();
+
+	info[0] = (u32)ringbuf;
+	info[1] = ringbuf_size;
+	info[2] = (u32)&stream_ctrl;
+	info[3] = writepos;
+	info[4] = readpos;
+
+	DPRINTF("streaming to 0x%x, ringbuf_sz %d\n", ee_status, ringbuf_size);
+	return AUDSRV_ERR_NOERROR;
+}
+
+/** Leaves shared-ring streaming
+ * @returns 0, always
+ */
+int audsrv_stream_stop()
+{
+	if (stream_active)
+	{
+		stream_active = 0;
+		audsrv_set_format(core1_freq, core1_bits, core1_channels);
+	}
+
+	return AUDSRV_ERR_NOERROR;
+}
+
 int audsrv_set_threshold(int amount)
 {
 	if (amount > (ringbuf_size / 2))
@@ -448,6 +573,17 @@ static void play_thread(void *arg)
 			format_changed = 0;
 		}
 
+		if (stream_active && stream_ctrl.pos != (u32)writepos)
+		{
+			/* EE has queued more data in the shared ring */
+			writepos = stream_ctrl.pos;
+			if (playing == 0)
+			{
+				playing = 1;
+				update_volume();
+			}
+		}
+
 		if (playing && upsampler != NULL)
 		{
 			up.src = (const unsigned char *)ringbuf + readpos;
@@ -461,6 +597,11 @@ static void play_thread(void *arg)
 				/* wrap around */
 				readpos = 0;
 			}
+
+			if (stream_active)
+			{
+				stream_publish_readpos();
+			}
 		}
 		else
 		{
@@ -512,6 +653,7 @@ static void play_thread(void *arg)
 int audsrv_quit()
 {
 	/* silence! */
+	stream_active = 0;
 	audsrv_stop_audio();
 	audsrv_stop_cd();
 	audsrv_adpcm_init();
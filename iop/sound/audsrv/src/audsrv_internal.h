@@ -25,4 +25,16 @@
 #define AUDSRV_VOICE_DMA_CH	0
 #define AUDSRV_BLOCK_DMA_CH	1
 
+/** Cursor published through SIF DMA in streaming mode.
+ * One quadword, as SIF DMA transfers are done in 16-byte units.
+ */
+typedef struct audsrv_stream_cursor
+{
+	volatile u32 pos;
+	u32 pad[3];
+} audsrv_stream_cursor_t;
+
+extern int audsrv_stream_start(u32 ee_status, u32 *info);
+extern int audsrv_stream_stop(void);
+
 #endif
@@ -165,6 +165,14 @@ static void *rpc_command(int func, unsigned *data, int size)
 		ret = audsrv_queued();
 		break;
 
+		case AUDSRV_STREAM_START:
+		ret = audsrv_stream_start(data[0], (u32 *)&data[1]);
+		break;
+
+		case AUDSRV_STREAM_STOP:
+		ret = audsrv_stream_stop();
+		break;
+
 		default:
 		ret = -1;
 		break;
@@ -125,6 +125,13 @@ typedef struct _fat_driver
     unsigned int clStack[MAX_CLUSTER_STACK]; // cluster allocation stack
     int clStackIndex;
     unsigned int clStackLast; // last free cluster of the fat table
+
+#define FAT_FREE_MAP_GROUPS  8192   // maximum number of groups in freeMap
+#define FAT_FREE_MAP_UNKNOWN 0xFFFF // the group was not scanned yet
+    unsigned short *freeMap;    // number of free clusters in each group of FAT sectors (NULL for FAT12)
+    unsigned int freeMapGroups; // number of groups
+    unsigned int freeMapShift;  // a group spans (1 << freeMapShift) FAT sectors
+    unsigned int maxCluster;    // highest cluster number of the volume
 } fat_driver;
 
 // Exported functions
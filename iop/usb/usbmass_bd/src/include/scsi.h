@@ -1,6 +1,15 @@
 #ifndef _SCSI_H
 #define _SCSI_H
 
+// One command of a batch passed to queue_cmds
+struct scsi_xfer
+{
+    unsigned char cmd[16];
+    unsigned int cmd_len;
+    unsigned char *data;
+    unsigned int data_len;
+};
+
 struct scsi_interface
 {
     void *priv;
@@ -9,6 +18,9 @@ struct scsi_interface
 
     int (*get_max_lun)(struct scsi_interface *scsi);
     int (*queue_cmd)(struct scsi_interface *scsi, const unsigned char *cmd, unsigned int cmd_len, unsigned char *data, unsigned int data_len, unsigned int data_wr);
+    // Optional: runs a batch of commands with data phases in the same direction, back to back without returning in between.
+    // Returns the number of commands that completed successfully, in order; the caller retries the rest.
+    int (*queue_cmds)(struct scsi_interface *scsi, const struct scsi_xfer *xfer, unsigned int count, unsigned int data_wr);
 };
 
 extern int scsi_init(void);
@@ -10,7 +10,9 @@
 #include "module_debug.h"
 
 #define getBI32(__buf)   ((((u8 *)(__buf))[3] << 0) | (((u8 *)(__buf))[2] << 8) | (((u8 *)(__buf))[1] << 16) | (((u8 *)(__buf))[0] << 24))
+#define getBI64(__buf)   (((u64)getBI32(__buf) << 32) | (u32)getBI32((u8 *)(__buf) + 4))
 #define SCSI_MAX_RETRIES 16
+#define SCSI_BATCH_CMDS  8 // Commands handed to queue_cmds at once
 
 typedef struct _inquiry_data
 {
@@ -44,6 +46,23 @@ typedef struct _read_capacity_data
     u8 block_length[4];
 } read_capacity_data;
 
+typedef struct _read_capacity_16_data
+{
+    u8 last_lba[8];
+    u8 block_length[4];
+    u8 res[20];
+} read_capacity_16_data;
+
+typedef struct _block_limits_vpd
+{
+    u8 peripheral_device_type;
+    u8 page_code; // B0h
+    u8 page_length[2];
+    u8 res[4];
+    u8 max_transfer_length[4]; // In logical blocks, 0 if not reported
+    u8 res2[52];
+} block_limits_vpd;
+
 #define NUM_DEVICES 2
 static struct block_device g_scsi_bd[NUM_DEVICES];
 
@@ -98,17 +117,45 @@ static inline int scsi_cmd_read_capacity(struct block_device *bd, void *buffer,
     return scsi_cmd(bd, 0x25, buffer, size, 0);
 }
 
-static int scsi_cmd_rw_sector(struct block_device *bd, u64 lba, const void *buffer, unsigned short int sectorCount, unsigned int write)
+static int scsi_cmd_inquiry_vpd(struct block_device *bd, u8 page, void *buffer, int size)
 {
-    unsigned char comData[12]   = {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0};
+    unsigned char comData[12]   = {0x12, 0x01, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0};
     struct scsi_interface *scsi = (struct scsi_interface *)bd->priv;
 
-    DEBUG_U64_2XU32(lba);
-    M_DEBUG("scsi_cmd_rw_sector - 0x%08x%08x %p 0x%04x\n", lba_u32[1], lba_u32[0], buffer, sectorCount);
+    M_DEBUG("%s\n", __func__);
+
+    comData[2] = page;
+    comData[4] = size;
+    return scsi->queue_cmd(scsi, comData, 12, buffer, size, 0);
+}
+
+static int scsi_cmd_read_capacity_16(struct block_device *bd, void *buffer, int size)
+{
+    unsigned char comData[16]   = {0x9e, 0x10, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0};
+    struct scsi_interface *scsi = (struct scsi_interface *)bd->priv;
+
+    M_DEBUG("%s\n", __func__);
+
+    comData[13] = size;
+    return scsi->queue_cmd(scsi, comData, 16, buffer, size, 0);
+}
+
+/* Builds READ/WRITE(10), or READ/WRITE(16) for the blocks past 2TiB (with 512-byte sectors). Returns the command length. */
+static unsigned int scsi_build_rw_sector(unsigned char *comData, u64 lba, unsigned short int sectorCount, unsigned int write)
+{
+    int i;
 
-    // Note: LBA from bdm is 64bit but SCSI commands being used are 32bit. These need to be updated to 64bit LBA SCSI
-    // commands to work with large capacity drives. For now the 32bit LBA will only support up to 2TB drives.
+    if ((lba + sectorCount) > 0xFFFFFFFF) {
+        memset(comData, 0, 16);
+        comData[0] = write ? 0x8a : 0x88;
+        for (i = 0; i < 8; i++)
+            comData[2 + i] = (lba >> (56 - (i * 8))) & 0xFF; // lba (MSB first)
+        comData[12] = (sectorCount & 0xFF00) >> 8; // Transfer length MSB
+        comData[13] = (sectorCount & 0xFF);        // Transfer length LSB
+        return 16;
+    }
 
+    memset(comData, 0, 12);
     comData[0] = write ? 0x2a : 0x28;
     comData[2] = (lba & 0xFF000000) >> 24;    // lba 1 (MSB)
     comData[3] = (lba & 0xFF0000) >> 16;      // lba 2
@@ -116,7 +163,50 @@ static int scsi_cmd_rw_sector(struct block_device *bd, u64 lba, const void *buff
     comData[5] = (lba & 0xFF);                // lba 4 (LSB)
     comData[7] = (sectorCount & 0xFF00) >> 8; // Transfer length MSB
     comData[8] = (sectorCount & 0xFF);        // Transfer length LSB
-    return scsi->queue_cmd(scsi, comData, 12, (void *)buffer, bd->sectorSize * sectorCount, write);
+    return 12;
+}
+
+static int scsi_cmd_rw_sector(struct block_device *bd, u64 lba, const void *buffer, unsigned short int sectorCount, unsigned int write)
+{
+    unsigned char comData[16];
+    unsigned int comLength;
+    struct scsi_interface *scsi = (struct scsi_interface *)bd->priv;
+
+    DEBUG_U64_2XU32(lba);
+    M_DEBUG("scsi_cmd_rw_sector - 0x%08x%08x %p 0x%04x\n", lba_u32[1], lba_u32[0], buffer, sectorCount);
+
+    comLength = scsi_build_rw_sector(comData, lba, sectorCount, write);
+    return scsi->queue_cmd(scsi, comData, comLength, (void *)buffer, bd->sectorSize * sectorCount, write);
+}
+
+/* Hands consecutive max_sectors chunks to the transport as one batch. Returns the number of sectors transferred. */
+static u16 scsi_rw_batch(struct block_device *bd, u64 sector, const void *buffer, u16 count, unsigned int write)
+{
+    struct scsi_interface *scsi = (struct scsi_interface *)bd->priv;
+    struct scsi_xfer xfer[SCSI_BATCH_CMDS];
+    u16 sc[SCSI_BATCH_CMDS];
+    u16 transferred;
+    int n, done, i;
+
+    for (n = 0; n < SCSI_BATCH_CMDS && count > 0; n++) {
+        sc[n] = count > scsi->max_sectors ? scsi->max_sectors : count;
+
+        xfer[n].cmd_len  = scsi_build_rw_sector(xfer[n].cmd, sector, sc[n], write);
+        xfer[n].data     = (unsigned char *)buffer;
+        xfer[n].data_len = bd->sectorSize * sc[n];
+
+        count -= sc[n];
+        sector += sc[n];
+        buffer = (const u8 *)buffer + xfer[n].data_len;
+    }
+
+    done = scsi->queue_cmds(scsi, xfer, n, write);
+
+    transferred = 0;
+    for (i = 0; i < done; i++)
+        transferred += sc[i];
+
+    return transferred;
 }
 
 //
@@ -174,6 +264,36 @@ static int scsi_warmup(struct block_device *bd)
     bd->sectorSize   = getBI32(&rcd.block_length);
     bd->sectorOffset = 0;
     bd->sectorCount  = getBI32(&rcd.last_lba);
+
+    // The last LBA does not fit in 32 bits: the device must support READ CAPACITY(16)
+    if (bd->sectorCount == 0xFFFFFFFF) {
+        read_capacity_16_data rcd16;
+
+        memset(&rcd16, 0, sizeof(read_capacity_16_data));
+        if ((stat = scsi_cmd_read_capacity_16(bd, &rcd16, sizeof(read_capacity_16_data))) == 0) {
+            bd->sectorSize  = getBI32(&rcd16.block_length);
+            bd->sectorCount = getBI64(&rcd16.last_lba);
+        } else {
+            M_PRINTF("ERROR: scsi_cmd_read_capacity_16 %d\n", stat);
+        }
+    }
+
+    // Many USB devices hang on VPD requests, so only ask the ones claiming SPC-3 or later.
+    if ((id.iso_ecma_ansi & 0x07) >= 5) {
+        block_limits_vpd bl;
+
+        memset(&bl, 0, sizeof(block_limits_vpd));
+        if (scsi_cmd_inquiry_vpd(bd, 0xb0, &bl, sizeof(block_limits_vpd)) == 0 && bl.page_code == 0xb0) {
+            unsigned int max_transfer = getBI32(&bl.max_transfer_length);
+
+            if (max_transfer > 0xFFFF)
+                max_transfer = 0xFFFF;
+            if (max_transfer > scsi->max_sectors) {
+                M_PRINTF("Maximum transfer length: %u blocks\n", max_transfer);
+                scsi->max_sectors = max_transfer;
+            }
+        }
+    }
     M_PRINTF("%u %u-byte logical blocks: (%uMB / %uMiB)\n", bd->sectorCount, bd->sectorSize, bd->sectorCount / ((1000 * 1000) / bd->sectorSize), bd->sectorCount / ((1024 * 1024) / bd->sectorSize));
 
     return 0;
@@ -192,7 +312,20 @@ static int scsi_read(struct block_device *bd, u64 sector, void *buffer, u16 coun
     M_DEBUG("%s: sector=0x%08x%08x, count=%d\n", __func__, sector_u32[1], sector_u32[0], count);
 
     while (sc_remaining > 0) {
-        u16 sc = sc_remaining > scsi->max_sectors ? scsi->max_sectors : sc_remaining;
+        u16 sc;
+
+        // Several chunks left: let the transport overlap them. It stops at the first failure, which is retried below.
+        if (scsi->queue_cmds != NULL && sc_remaining > scsi->max_sectors) {
+            sc = scsi_rw_batch(bd, sector, buffer, sc_remaining, 0);
+
+            sc_remaining -= sc;
+            sector += sc;
+            buffer = (u8 *)buffer + (sc * bd->sectorSize);
+            if (sc > 0)
+                continue;
+        }
+
+        sc = sc_remaining > scsi->max_sectors ? scsi->max_sectors : sc_remaining;
 
         for (retries = SCSI_MAX_RETRIES; retries > 0; retries--) {
             if (scsi_cmd_rw_sector(bd, sector, buffer, sc, 0) == 0)
@@ -235,9 +368,21 @@ static int scsi_write(struct block_device *bd, u64 sector, const void *buffer, u
     }
 
     while (sc_remaining > 0) {
-        u16 sc = sc_remaining > scsi->max_sectors ? scsi->max_sectors : sc_remaining;
+        u16 sc;
         const void *dst_buffer = buffer;
 
+        if (misalign_buffer == NULL && scsi->queue_cmds != NULL && sc_remaining > scsi->max_sectors) {
+            sc = scsi_rw_batch(bd, sector, buffer, sc_remaining, 1);
+
+            sc_remaining -= sc;
+            sector += sc;
+            buffer = (const u8 *)buffer + (sc * sectorSize);
+            if (sc > 0)
+                continue;
+        }
+
+        sc = sc_remaining > scsi->max_sectors ? scsi->max_sectors : sc_remaining;
+
         if (misalign_buffer != NULL) {
             memcpy(misalign_buffer, buffer, sectorSize);
             dst_buffer = misalign_buffer;
@@ -4,6 +4,7 @@
  */
 
 #include <errno.h>
+#include <intrman.h>
 #include <stdio.h>
 #include <sysclib.h>
 #include <thbase.h>
@@ -37,20 +38,6 @@
 #define CBW_TAG 0x43425355
 #define CSW_TAG 0x53425355
 
-typedef struct _mass_dev
-{
-    int controlEp;          // config endpoint id
-    int bulkEpI;            // in endpoint id
-    int bulkEpO;            // out endpoint id
-    int devId;              // device id
-    unsigned char configId; // configuration id
-    unsigned char status;
-    unsigned char interfaceNumber; // interface number
-    unsigned char interfaceAlt;    // interface alternate setting
-    int ioSema;
-    struct scsi_interface scsi;
-} mass_dev;
-
 typedef struct _cbw_packet
 {
     unsigned int signature;
@@ -80,6 +67,7 @@ typedef struct _usb_callback_data
 } usb_callback_data;
 
 #define USB_BLOCK_SIZE 4096 // Maximum single USB 1.1 transfer length.
+#define USB_XFER_DEPTH 2    // Data phase transfers kept queued in usbd by the pipelined transport.
 
 typedef struct _usb_transfer_callback_data
 {
@@ -90,9 +78,53 @@ typedef struct _usb_transfer_callback_data
     unsigned int remaining;
 } usb_transfer_callback_data;
 
+#ifndef ASYNC
+/* State of a batch run by the pipelined transport. Commands still follow each other as
+   bulk-only transport requires: the CBW of a command is sent from the completion callback of
+   the previous CSW. Only the data phase of a command is pipelined. */
+typedef struct _usb_pipeline
+{
+    struct _mass_dev *dev;
+    int sema;
+    int pending;  // Transfers in flight, plus one held by the submitting thread.
+    int returnCode;
+    int failed;   // Short data phase or bad CSW: stop the batch.
+    int filling;  // A context is queuing data transfers; others leave it to that one.
+    int pipe;     // Data phase pipe
+    u8 *buffer;   // Next data to queue
+    unsigned int unqueued;  // Data phase bytes not queued yet
+    unsigned int remaining; // Data phase bytes not transferred yet
+    int inflight; // Data phase transfers queued
+    const struct scsi_xfer *xfer;
+    unsigned int count;
+    unsigned int done; // Commands that completed with a good CSW
+    int data_wr;
+    cbw_packet cbw;
+    csw_packet csw;
+} usb_pipeline;
+#endif
+
+typedef struct _mass_dev
+{
+    int controlEp;          // config endpoint id
+    int bulkEpI;            // in endpoint id
+    int bulkEpO;            // out endpoint id
+    int devId;              // device id
+    unsigned char configId; // configuration id
+    unsigned char status;
+    unsigned char interfaceNumber; // interface number
+    unsigned char interfaceAlt;    // interface alternate setting
+    int ioSema;
+    struct scsi_interface scsi;
+#ifndef ASYNC
+    usb_pipeline pipeline; // Per device, so devices can run batches at the same time.
+#endif
+} mass_dev;
+
 #define NUM_DEVICES 2
 static mass_dev g_mass_device[NUM_DEVICES];
 static int usb_mass_update_sema;
+static unsigned int cbw_tag = 0;
 
 static void usb_callback(int resultCode, int bytes, void *arg);
 #ifndef ASYNC
@@ -423,6 +455,201 @@ static int usb_bulk_transfer(mass_dev *dev, int direction, void *buffer, unsigne
     return ret;
 }
 
+static void usb_pipeline_put(usb_pipeline *pl)
+{
+    int state, last;
+
+    CpuSuspendIntr(&state);
+    pl->pending--;
+    last = (pl->pending == 0);
+    CpuResumeIntr(state);
+
+    if (last)
+        SignalSema(pl->sema);
+}
+
+static void usb_pipeline_submit(usb_pipeline *pl, int pipe, void *data, unsigned int len, sceUsbdDoneCallback callback)
+{
+    int state, ret;
+
+    CpuSuspendIntr(&state);
+    pl->pending++;
+    CpuResumeIntr(state);
+
+    ret = sceUsbdBulkTransfer(pipe, data, len, callback, (void *)pl);
+    if (ret != USB_RC_OK) {
+        pl->returnCode = ret;
+        usb_pipeline_put(pl);
+    }
+}
+
+static void usb_pipeline_csw_callback(int resultCode, int bytes, void *arg);
+
+static void usb_pipeline_status(usb_pipeline *pl)
+{
+    pl->csw.signature   = 0;
+    pl->csw.tag         = 0;
+    pl->csw.dataResidue = 0;
+    pl->csw.status      = 0;
+    usb_pipeline_submit(pl, pl->dev->bulkEpI, &pl->csw, 13, usb_pipeline_csw_callback);
+}
+
+static void usb_pipeline_data_callback(int resultCode, int bytes, void *arg);
+
+/* Keeps up to USB_XFER_DEPTH data transfers queued. Transfers on a pipe complete in order,
+   so only one context may queue at a time; the other one just leaves the work to it. */
+static void usb_pipeline_fill(usb_pipeline *pl)
+{
+    int state;
+
+    CpuSuspendIntr(&state);
+    if (pl->filling) {
+        CpuResumeIntr(state);
+        return;
+    }
+    pl->filling = 1;
+
+    while (pl->returnCode == USB_RC_OK && !pl->failed && pl->unqueued > 0 && pl->inflight < USB_XFER_DEPTH) {
+        u8 *buffer       = pl->buffer;
+        unsigned int len = pl->unqueued > USB_BLOCK_SIZE ? USB_BLOCK_SIZE : pl->unqueued;
+        int ret;
+
+        pl->buffer += len;
+        pl->unqueued -= len;
+        pl->inflight++;
+        pl->pending++;
+        CpuResumeIntr(state);
+
+        ret = sceUsbdBulkTransfer(pl->pipe, buffer, len, usb_pipeline_data_callback, (void *)pl);
+
+        CpuSuspendIntr(&state);
+        if (ret != USB_RC_OK) {
+            pl->returnCode = ret;
+            pl->inflight--;
+            pl->pending--; // The submitting thread still holds its reference.
+        }
+    }
+
+    pl->filling = 0;
+    CpuResumeIntr(state);
+}
+
+static void usb_pipeline_data_callback(int resultCode, int bytes, void *arg)
+{
+    usb_pipeline *pl = (usb_pipeline *)arg;
+    unsigned int expected;
+    int state, last;
+
+    CpuSuspendIntr(&state);
+    expected = pl->remaining > USB_BLOCK_SIZE ? USB_BLOCK_SIZE : pl->remaining;
+    pl->inflight--;
+    if (resultCode != USB_RC_OK)
+        pl->returnCode = resultCode;
+    else if ((unsigned int)bytes != expected)
+        pl->failed = 1; // Short data phase: the CSW may have been read into the next transfer.
+    else
+        pl->remaining -= bytes;
+    last = (pl->returnCode == USB_RC_OK && !pl->failed && pl->remaining == 0);
+    CpuResumeIntr(state);
+
+    if (last)
+        usb_pipeline_status(pl);
+    else
+        usb_pipeline_fill(pl);
+    usb_pipeline_put(pl);
+}
+
+static void usb_pipeline_cbw_callback(int resultCode, int bytes, void *arg)
+{
+    usb_pipeline *pl = (usb_pipeline *)arg;
+
+    (void)bytes;
+
+    if (resultCode != USB_RC_OK)
+        pl->returnCode = resultCode;
+    else if (pl->remaining > 0)
+        usb_pipeline_fill(pl);
+    else
+        usb_pipeline_status(pl);
+
+    usb_pipeline_put(pl);
+}
+
+static void usb_pipeline_command(usb_pipeline *pl)
+{
+    const struct scsi_xfer *xfer = &pl->xfer[pl->done];
+
+    pl->cbw.signature          = CBW_TAG;
+    pl->cbw.tag                = ++cbw_tag;
+    pl->cbw.dataTransferLength = xfer->data_len;
+    pl->cbw.flags              = pl->data_wr ? 0 : 0x80;
+    pl->cbw.lun                = 0;
+    pl->cbw.comLength          = xfer->cmd_len;
+    memcpy(pl->cbw.comData, xfer->cmd, xfer->cmd_len);
+
+    pl->buffer    = xfer->data;
+    pl->unqueued  = xfer->data_len;
+    pl->remaining = xfer->data_len;
+    pl->inflight  = 0;
+
+    usb_pipeline_submit(pl, pl->dev->bulkEpO, &pl->cbw, 31, usb_pipeline_cbw_callback);
+}
+
+static void usb_pipeline_csw_callback(int resultCode, int bytes, void *arg)
+{
+    usb_pipeline *pl = (usb_pipeline *)arg;
+
+    if (resultCode != USB_RC_OK)
+        pl->returnCode = resultCode;
+    else if (bytes != 13 || pl->csw.signature != CSW_TAG || pl->csw.tag != pl->cbw.tag || pl->csw.status != 0)
+        pl->failed = 1;
+    else if (++pl->done < pl->count)
+        usb_pipeline_command(pl); // The status of this command is in: the next CBW may go out.
+
+    usb_pipeline_put(pl);
+}
+
+/* Runs the whole batch from usbd callbacks, so the thread is not woken between commands.
+   Within a command, USB_XFER_DEPTH data transfers are kept queued. */
+static int usb_queue_cmds(struct scsi_interface *scsi, const struct scsi_xfer *xfer, unsigned int count, unsigned int data_wr)
+{
+    mass_dev *dev    = (mass_dev *)scsi->priv;
+    usb_pipeline *pl = &dev->pipeline;
+
+    M_DEBUG("%s: %u commands\n", __func__, count);
+
+    if (dev->status & USBMASS_DEV_STAT_ERR) {
+        M_DEBUG("Rejecting I/O to offline device %d.\n", dev->devId);
+        return -EIO;
+    }
+
+    if (count == 0)
+        return 0;
+
+    pl->dev        = dev;
+    pl->sema       = dev->ioSema;
+    pl->pipe       = data_wr ? dev->bulkEpO : dev->bulkEpI;
+    pl->pending    = 1;
+    pl->returnCode = USB_RC_OK;
+    pl->failed     = 0;
+    pl->filling    = 0;
+    pl->xfer       = xfer;
+    pl->count      = count;
+    pl->done       = 0;
+    pl->data_wr    = data_wr;
+
+    usb_pipeline_command(pl);
+    usb_pipeline_put(pl);
+    WaitSema(pl->sema);
+
+    if (pl->returnCode != USB_RC_OK || pl->failed) {
+        M_DEBUG("ERROR: pipelined command %u failed (%d). Calling reset recovery.\n", pl->done, pl->returnCode);
+        usb_bulk_reset(dev, 3);
+    }
+
+    return pl->done;
+}
+
 #else
 
 static void scsi_cmd_callback(int resultCode, int bytes, void *arg)
@@ -449,11 +676,11 @@ int usb_queue_cmd(struct scsi_interface *scsi, const unsigned char *cmd, unsigne
 #ifndef ASYNC
     int rcode;
 #endif
-    static unsigned int tag = 0;
+    unsigned int tag;
 
     M_DEBUG("%s\n", __func__);
 
-    tag++;
+    tag = ++cbw_tag;
 
     // Create USB command
     ucmd.dev       = dev;
@@ -641,6 +868,8 @@ static int usb_mass_connect(int devId)
     dev->status  = 0;
     dev->bulkEpI = -1;
     dev->bulkEpO = -1;
+    // scsi_warmup raises this if the device reports its own limit
+    dev->scsi.max_sectors = 128;
 
     /* open the config endpoint */
     dev->controlEp = sceUsbdOpenPipe(devId, NULL);
@@ -815,6 +1044,11 @@ int usb_mass_init(void)
         g_mass_device[i].scsi.max_sectors = 128; // 0xffff
         g_mass_device[i].scsi.get_max_lun = usb_bulk_get_max_lun;
         g_mass_device[i].scsi.queue_cmd   = usb_queue_cmd;
+#ifndef ASYNC
+        g_mass_device[i].scsi.queue_cmds  = usb_queue_cmds;
+#else
+        g_mass_device[i].scsi.queue_cmds  = NULL;
+#endif
     }
 
     sema.attr            = 0;
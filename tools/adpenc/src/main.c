@@ -1,12 +1,15 @@
 #include <stdio.h>
+#include <stdlib.h>
 #include <errno.h>
 #include <string.h>
 #include <ctype.h>
 #include <math.h>
 
-#define VERSION	"1.2"
+#include "adpcm_encoder.h"
 
-extern int adpcm_encode(FILE* fp, FILE* sad, int offset, int sample_len, int flag_loop, int bytes_per_sample);
+#define VERSION	"1.3"
+
+extern int adpcm_encode(FILE* fp, FILE* sad, int channels, int sample_len, int flag_loop, int bytes_per_sample, int search, int threads);
 
 enum{ monoF = (1 << 0), stereo = (1 << 1), loopF = (1 << 2) } sad_flag;
 
@@ -20,7 +23,7 @@ struct AdpcmHeader{
 	unsigned int samples;
 };
 
-static int ConvertFile(const char *InputFile, const char *OutputFile, int flag_loop){
+static int ConvertFile(const char *InputFile, const char *OutputFile, int flag_loop, int search, int threads){
 	FILE *fp, *sad;
 	int sample_freq, sample_len, result;
 	char s[4];
@@ -149,21 +152,8 @@ static int ConvertFile(const char *InputFile, const char *OutputFile, int flag_l
 			};
 			fwrite(&AdpcmHeader, sizeof(AdpcmHeader), 1, sad);
 
-			if(channels == 1)
-			{
-				result=adpcm_encode(fp, sad, 0, sample_len, flag_loop, bytes_per_sample);
-			}
-			else
-			{
-				int data_offset = ftell(fp);
-
-				// Encode left
-				if((result=adpcm_encode(fp, sad, bytes_per_sample, sample_len, flag_loop, bytes_per_sample))==0){
-					fseek(fp, data_offset+bytes_per_sample, SEEK_SET);
-					// Encode right
-					result=adpcm_encode(fp, sad, bytes_per_sample, sample_len, flag_loop, bytes_per_sample);
-				}
-			}
+			// Stereo files are written left channel first, then right
+			result=adpcm_encode(fp, sad, channels, sample_len, flag_loop, bytes_per_sample, search, threads);
 
 			fclose(sad);
 		}
@@ -188,29 +178,38 @@ InputFileIOEnd:
 int main( int argc, char *argv[] )
 {
 	int result;
+	int flag_loop = 0;
+	int search = ADPCM_SEARCH_FAST;
+	int threads = 0;
+	int i;
 
-	if( argc == 4)
+	for(i = 1; i < argc && argv[i][0] == '-'; i++)
 	{
-		if( strncmp( argv[1], "-L", 2 ) )
-		{
-			printf("Error: Option '%s' not recognized\n", argv[1]);
-			result=EINVAL;
-		}
+		if(!strcmp(argv[i], "-L"))
+			flag_loop = 1;
+		else if(!strcmp(argv[i], "-E"))
+			search = ADPCM_SEARCH_EXHAUSTIVE;
+		else if(!strncmp(argv[i], "-j", 2))
+			threads = atoi(&argv[i][2]);
 		else
 		{
-			result=ConvertFile(argv[2], argv[3], 1);
+			printf("Error: Option '%s' not recognized\n", argv[i]);
+			return EINVAL;
 		}
 	}
-	else if(argc == 3)
+
+	if(argc - i == 2)
 	{
-		result=ConvertFile(argv[1], argv[2], 0);
+		result=ConvertFile(argv[i], argv[i + 1], flag_loop, search, threads);
 	}
 	else
 	{
 		printf(	"ADPCM Encoder %s\n"
-			"Usage: sadenc [-L] <input wave> <output sad>\n"
+			"Usage: sadenc [-L] [-E] [-j<threads>] <input wave> <output sad>\n"
 			"Options:\n"
-			"  -L  Loop\n", VERSION);
+			"  -L  Loop\n"
+			"  -E  Exhaustive (predictor, shift) search, slower but less noise\n"
+			"  -j  Number of threads used for the channels (default: one per CPU)\n", VERSION);
 		result=EINVAL;
 	}
 
@@ -8,68 +8,227 @@
 # Review ps2sdk README & LICENSE files for further details.
 */
 
+/*
+	The input is streamed in large chunks and every byte is formatted by
+	copying its text from a precomputed table into a large output buffer,
+	so the cost is a memcpy per byte rather than a fprintf. The C output is
+	byte-identical to what earlier versions produced.
+*/
+
+#define _FILE_OFFSET_BITS 64
+
 #include <sys/types.h>
 #include <sys/stat.h>
-#include <unistd.h>
-#include <fcntl.h>
+#include <limits.h>
 #include <stdlib.h>
 #include <stdio.h>
+#include <string.h>
 
-unsigned char *buffer;
+#define IN_CHUNK	(1024 * 1024)
+/* Each input byte becomes "0xNN, ", and each row of 16 gets "\n\t" */
+#define HEX_LEN		6
+#define ROW_BYTES	16
+#define OUT_CHUNK	(IN_CHUNK / ROW_BYTES * (ROW_BYTES * HEX_LEN + 2))
 
-int main(int argc, char *argv[])
+static char hex[256][HEX_LEN];
+
+static void build_hex_table(void)
 {
-	int fd_size;
-	FILE *source,*dest;
+	static const char digits[] = "0123456789abcdef";
 	int i;
 
-	if(argc != 4) {
-		printf("bin2c - from bin2s By Sjeep\n"
-			   "Usage: bin2c infile outfile label\n\n");
+	for(i=0;i<256;i+=1) {
+		hex[i][0] = '0';
+		hex[i][1] = 'x';
+		hex[i][2] = digits[i >> 4];
+		hex[i][3] = digits[i & 0xf];
+		hex[i][4] = ',';
+		hex[i][5] = ' ';
+	}
+}
+
+/* Formats len bytes that start at offset pos of the input. Returns the length of the text. */
+static size_t format_chunk(char *out, const unsigned char *in, size_t len, unsigned long long pos)
+{
+	char *p = out;
+	size_t i = 0;
+
+	/* Finish a row left open by the previous chunk */
+	while(i < len && (pos + i) % ROW_BYTES != 0) {
+		memcpy(p, hex[in[i]], HEX_LEN);
+		p += HEX_LEN;
+		i += 1;
+	}
+
+	for(;i + ROW_BYTES <= len;i+=ROW_BYTES) {
+		int j;
+
+		*p++ = '\n';
+		*p++ = '\t';
+		for(j=0;j<ROW_BYTES;j+=1) {
+			memcpy(p, hex[in[i + j]], HEX_LEN);
+			p += HEX_LEN;
+		}
+	}
+
+	if(i < len) {
+		*p++ = '\n';
+		*p++ = '\t';
+		for(;i<len;i+=1) {
+			memcpy(p, hex[in[i]], HEX_LEN);
+			p += HEX_LEN;
+		}
+	}
+
+	return p - out;
+}
+
+static int write_c(FILE *source, FILE *dest, unsigned int fd_size, const char *label)
+{
+	unsigned char *inbuf;
+	char *outbuf;
+	unsigned long long total;
+	size_t len;
+	int result;
+
+	inbuf = malloc(IN_CHUNK);
+	outbuf = malloc(OUT_CHUNK);
+	if(inbuf == NULL || outbuf == NULL) {
+		printf("Failed to allocate memory.\n");
+		free(inbuf);
+		free(outbuf);
 		return 1;
 	}
 
-	if((source=fopen( argv[1], "rb")) == NULL) {
-		printf("Error opening %s for reading.\n",argv[1]);
+	fprintf(dest, "#ifndef __%s__\n", label);
+	fprintf(dest, "#define __%s__\n\n", label);
+	fprintf(dest, "unsigned int size_%s = %u;\n", label, fd_size);
+	fprintf(dest, "unsigned char %s[] __attribute__((aligned(16))) = {", label);
+
+	result = 0;
+	total = 0;
+	while((len = fread(inbuf, 1, IN_CHUNK, source)) > 0) {
+		size_t outlen = format_chunk(outbuf, inbuf, len, total);
+
+		if(fwrite(outbuf, 1, outlen, dest) != outlen) {
+			printf("Failed to write output file.\n");
+			result = 1;
+			break;
+		}
+		total += len;
+	}
+
+	if(result == 0 && (ferror(source) || total != fd_size)) {
+		printf("Failed to read file.\n");
+		result = 1;
+	}
+
+	fprintf(dest, "\n};\n\n#endif\n");
+
+	free(inbuf);
+	free(outbuf);
+
+	return result;
+}
+
+/* The assembler reads the input itself, so it must still be reachable by this path at build time. */
+static int write_asm(FILE *dest, const char *infile, unsigned int fd_size, const char *label)
+{
+	const char *c;
+
+	fprintf(dest, "\t.data\n\n");
+	fprintf(dest, "\t.globl\tsize_%s\n", label);
+	fprintf(dest, "\t.type\tsize_%s, @object\n", label);
+	fprintf(dest, "\t.size\tsize_%s, 4\n", label);
+	fprintf(dest, "\t.balign\t4\n");
+	fprintf(dest, "size_%s:\n", label);
+	fprintf(dest, "\t.word\t%u\n\n", fd_size);
+	fprintf(dest, "\t.globl\t%s\n", label);
+	fprintf(dest, "\t.type\t%s, @object\n", label);
+	fprintf(dest, "\t.size\t%s, %u\n", label, fd_size);
+	fprintf(dest, "\t.balign\t16\n");
+	fprintf(dest, "%s:\n", label);
+	fprintf(dest, "\t.incbin\t\"");
+	for(c=infile;*c!='\0';c+=1) {
+		if(*c == '"' || *c == '\\')
+			fputc('\\', dest);
+		fputc(*c, dest);
+	}
+	fprintf(dest, "\"\n");
+
+	return 0;
+}
+
+static void usage(void)
+{
+	printf("bin2c - from bin2s By Sjeep\n"
+		   "Usage: bin2c [-s] infile outfile label\n"
+		   "  -s  write GNU assembler source that uses .incbin, instead of C\n\n");
+}
+
+int main(int argc, char *argv[])
+{
+	struct stat st;
+	FILE *source,*dest;
+	const char *infile, *outfile, *label;
+	int asm_output;
+	int result;
+
+	asm_output = 0;
+	if(argc == 5 && strcmp(argv[1], "-s") == 0) {
+		asm_output = 1;
+		argv += 1;
+		argc -= 1;
+	}
+
+	if(argc != 4) {
+		usage();
 		return 1;
 	}
 
-	fseek(source,0,SEEK_END);
-	fd_size = ftell(source);
-	fseek(source,0,SEEK_SET);
+	infile = argv[1];
+	outfile = argv[2];
+	label = argv[3];
 
-	buffer = malloc(fd_size);
-	if(buffer == NULL) {
-		printf("Failed to allocate memory.\n");
-		fclose(source);
+	if((source=fopen(infile, "rb")) == NULL) {
+		printf("Error opening %s for reading.\n",infile);
 		return 1;
 	}
 
-	if(fread(buffer,1,fd_size,source) != fd_size) {
+	if(fstat(fileno(source), &st) != 0 || !S_ISREG(st.st_mode)) {
 		printf("Failed to read file.\n");
 		fclose(source);
 		return 1;
 	}
-	fclose(source);
 
-	if((dest = fopen(argv[2],"w+")) == NULL) {
-		printf("Failed to open/create %s.\n",argv[2]);
+	/* size_<label> is an unsigned int */
+	if((unsigned long long)st.st_size > UINT_MAX) {
+		printf("%s is too large.\n", infile);
+		fclose(source);
 		return 1;
 	}
 
-	fprintf(dest, "#ifndef __%s__\n", argv[3]);
-	fprintf(dest, "#define __%s__\n\n", argv[3]);
-	fprintf(dest, "unsigned int size_%s = %d;\n", argv[3], fd_size);
-	fprintf(dest, "unsigned char %s[] __attribute__((aligned(16))) = {", argv[3]);
+	if((dest = fopen(outfile,"w+")) == NULL) {
+		printf("Failed to open/create %s.\n",outfile);
+		fclose(source);
+		return 1;
+	}
 
-	for(i=0;i<fd_size;i+=1) {
-		if((i % 16) == 0) fprintf(dest, "\n\t");
-		fprintf(dest, "0x%02x, ", buffer[i]);
+	if(asm_output) {
+		result = write_asm(dest, infile, (unsigned int)st.st_size, label);
+	} else {
+		build_hex_table();
+		result = write_c(source, dest, (unsigned int)st.st_size, label);
 	}
 
-	fprintf(dest, "\n};\n\n#endif\n");
+	fclose(source);
+	if(fclose(dest) != 0 && result == 0) {
+		printf("Failed to write output file.\n");
+		result = 1;
+	}
 
-	fclose(dest);
+	if(result != 0)
+		remove(outfile);
 
-	return 0;
-}
\ No newline at end of file
+	return result;
+}
@@ -0,0 +1,100 @@
+/*
+# _____     ___ ____     ___ ____
+#  ____|   |    ____|   |        | |____|
+# |     ___|   |____ ___|    ____| |    \    PS2DEV Open Source Project.
+#-----------------------------------------------------------------------
+# Copyright 2001-2004, ps2dev - http://www.ps2dev.org
+# Licenced under Academic Free License version 2.0
+# Review ps2sdk README & LICENSE files for further details.
+*/
+
+/**
+ * @file
+ * Reentrant SPU2 ADPCM (VAG) block encoder, shared by adpenc and ps2adpcm.
+ */
+
+#ifndef _ADPCM_ENCODER_H_
+#define _ADPCM_ENCODER_H_
+
+/** PCM samples encoded by one ADPCM block */
+#define ADPCM_BLOCK_SAMPLES 28
+/** Size of one ADPCM block in bytes */
+#define ADPCM_BLOCK_SIZE    16
+
+/** Classic VAG-packer heuristic: lowest peak residual, shift from that peak */
+#define ADPCM_SEARCH_FAST       0
+/** Try every (predictor, shift) pair and keep the lowest quantisation error */
+#define ADPCM_SEARCH_EXHAUSTIVE 1
+
+/** Per-channel encoder state. One per stream; never share between threads. */
+typedef struct
+{
+	/** Last two input samples, used to select the predictor */
+	int s_1, s_2;
+	/** Quantisation error history, fed back when packing */
+	double ps_1, ps_2;
+	/** One of ADPCM_SEARCH_x */
+	int search;
+} AdpcmEncoder;
+
+/** A run of samples of one channel, for AdpcmEncodeJobs() */
+typedef struct
+{
+	/** Encoder state, carried over between calls */
+	AdpcmEncoder *enc;
+	/** First sample of the channel */
+	const short *pcm;
+	/** Distance between two samples of the channel, in samples */
+	int stride;
+	/** Number of samples; the last block is zero-padded */
+	int samples;
+	/** Receives ADPCM_BLOCKS(samples) blocks, with their flags cleared */
+	unsigned char *out;
+} AdpcmJob;
+
+/** Number of blocks needed to encode the given number of samples */
+#define ADPCM_BLOCKS(samples) (((samples) + ADPCM_BLOCK_SAMPLES - 1) / ADPCM_BLOCK_SAMPLES)
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Resets an encoder for a new stream
+ * @param enc      encoder state
+ * @param search   ADPCM_SEARCH_FAST or ADPCM_SEARCH_EXHAUSTIVE
+ */
+extern void AdpcmEncoderInit(AdpcmEncoder *enc, int search);
+
+/** Encodes one block of ADPCM_BLOCK_SAMPLES samples
+ * @param enc      encoder state
+ * @param pcm      first sample
+ * @param stride   distance between two samples, in samples
+ * @param block    receives ADPCM_BLOCK_SIZE bytes; the flags byte is cleared
+ */
+extern void AdpcmEncodeBlock(AdpcmEncoder *enc, const short *pcm, int stride, unsigned char *block);
+
+/** Encodes a run of samples
+ * @param enc      encoder state
+ * @param pcm      first sample
+ * @param stride   distance between two samples, in samples
+ * @param samples  number of samples; the last block is zero-padded
+ * @param out      receives ADPCM_BLOCKS(samples) blocks
+ * @returns number of blocks written
+ */
+extern int AdpcmEncodeSamples(AdpcmEncoder *enc, const short *pcm, int stride, int samples, unsigned char *out);
+
+/** Encodes independent jobs (channels or files) on a pool of host threads
+ * @param jobs     jobs to run; each job must have its own encoder
+ * @param count    number of jobs
+ * @param threads  number of threads to use, 0 for one per online CPU
+ * @returns 0
+ *
+ * If fewer threads can be started, the remaining ones run all the jobs.
+ */
+extern int AdpcmEncodeJobs(AdpcmJob *jobs, int count, int threads);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _ADPCM_ENCODER_H_ */
@@ -0,0 +1,244 @@
+/*
+# _____     ___ ____     ___ ____
+#  ____|   |    ____|   |        | |____|
+# |     ___|   |____ ___|    ____| |    \    PS2DEV Open Source Project.
+#-----------------------------------------------------------------------
+# Copyright 2001-2004, ps2dev - http://www.ps2dev.org
+# Licenced under Academic Free License version 2.0
+# Review ps2sdk README & LICENSE files for further details.
+*/
+
+/*
+	Based on:
+	PSX VAG-Packer, hacked by bITmASTER@bigfoot.com
+
+	The predictor coefficients are multiples of 1/64 and the predictor is
+	selected from clamped 16-bit input, so the residuals are computed
+	exactly in integers scaled by 64. The output is bit-identical to the
+	original double-precision encoder in ADPCM_SEARCH_FAST mode.
+*/
+
+#include <limits.h>
+#include <string.h>
+#include "adpcm_encoder.h"
+
+#define PREDICTORS 5
+#define MAX_SHIFT  12
+
+/* Predictor coefficients, in 1/64 units */
+static const int coef[PREDICTORS][2] =
+{
+	{    0,  0 },
+	{  -60,  0 },
+	{ -115, 52 },
+	{  -98, 55 },
+	{ -122, 60 }
+};
+
+static const double f[PREDICTORS][2] =
+{
+	{           0.0, 0.0 },
+	{  -60.0 / 64.0, 0.0 },
+	{ -115.0 / 64.0, 52.0 / 64.0 },
+	{  -98.0 / 64.0, 55.0 / 64.0 },
+	{ -122.0 / 64.0, 60.0 / 64.0 }
+};
+
+void AdpcmEncoderInit(AdpcmEncoder *enc, int search)
+{
+	enc->s_1 = enc->s_2 = 0;
+	enc->ps_1 = enc->ps_2 = 0.0;
+	enc->search = search;
+}
+
+/* Computes the residual of every predictor (scaled by 64) and its peak.
+   The loops carry no dependency between samples so they vectorise. */
+static void find_residuals(AdpcmEncoder *enc, const short *pcm, int stride, int residual[PREDICTORS][ADPCM_BLOCK_SAMPLES], int peak[PREDICTORS])
+{
+	int x[ADPCM_BLOCK_SAMPLES + 2];
+	int i, j;
+
+	x[0] = enc->s_2;
+	x[1] = enc->s_1;
+
+	for (j = 0; j < ADPCM_BLOCK_SAMPLES; j++)
+	{
+		int s_0 = pcm[j * stride];
+
+		if (s_0 > 30719)
+			s_0 = 30719;
+		if (s_0 < -30720)
+			s_0 = -30720;
+		x[j + 2] = s_0;
+	}
+
+	for (i = 0; i < PREDICTORS; i++)
+	{
+		int max = 0;
+
+		for (j = 0; j < ADPCM_BLOCK_SAMPLES; j++)
+		{
+			int ds = 64 * x[j + 2] + coef[i][0] * x[j + 1] + coef[i][1] * x[j];
+			int abs_ds = (ds < 0) ? -ds : ds;
+
+			residual[i][j] = ds;
+			max = (abs_ds > max) ? abs_ds : max;
+		}
+
+		peak[i] = max;
+	}
+
+	enc->s_1 = x[ADPCM_BLOCK_SAMPLES + 1];
+	enc->s_2 = x[ADPCM_BLOCK_SAMPLES];
+}
+
+/* Quantises one block. Returns the quantisation error energy; updates the
+   error history and writes the nibbles only when asked to. di_max is the
+   positive clamp: the legacy encoder clamps to 32767, although only the top
+   nibble (0x7000) reaches the decoder. */
+static double pack(const int *residual, int predict, int shift, int di_max, double *ps_1, double *ps_2, unsigned char *nibbles)
+{
+	short four_bit[ADPCM_BLOCK_SAMPLES];
+	double s_1, s_2, error;
+	int i;
+
+	s_1 = *ps_1;
+	s_2 = *ps_2;
+	error = 0.0;
+
+	for (i = 0; i < ADPCM_BLOCK_SAMPLES; i++)
+	{
+		double ds, s_0;
+		int di;
+
+		s_0 = (residual[i] / 64.0) + s_1 * f[predict][0] + s_2 * f[predict][1];
+		ds = s_0 * (double)(1 << shift);
+
+		di = ((int)ds + 0x800) & 0xfffff000;
+
+		if (di > di_max)
+			di = di_max;
+		if (di < -32768)
+			di = -32768;
+
+		four_bit[i] = (short)di;
+
+		di = di >> shift;
+		s_2 = s_1;
+		s_1 = (double)di - s_0;
+		error += s_1 * s_1;
+	}
+
+	if (nibbles != NULL)
+	{
+		for (i = 0; i < ADPCM_BLOCK_SAMPLES / 2; i++)
+			nibbles[i] = ((four_bit[(i * 2) + 1] >> 8) & 0xf0) | ((four_bit[i * 2] >> 12) & 0xf);
+
+		*ps_1 = s_1;
+		*ps_2 = s_2;
+	}
+
+	return error;
+}
+
+void AdpcmEncodeBlock(AdpcmEncoder *enc, const short *pcm, int stride, unsigned char *block)
+{
+	int residual[PREDICTORS][ADPCM_BLOCK_SAMPLES];
+	int peak[PREDICTORS];
+	int predict, shift, di_max;
+
+	find_residuals(enc, pcm, stride, residual, peak);
+
+	if (enc->search == ADPCM_SEARCH_EXHAUSTIVE)
+	{
+		double best = -1.0;
+		int i, j;
+
+		/* Track exactly what the decoder will see */
+		di_max = 0x7000;
+		predict = 0;
+		shift = 0;
+
+		for (i = 0; i < PREDICTORS; i++)
+		{
+			for (j = 0; j <= MAX_SHIFT; j++)
+			{
+				double s_1 = enc->ps_1, s_2 = enc->ps_2;
+				double error = pack(residual[i], i, j, di_max, &s_1, &s_2, NULL);
+
+				if (best < 0.0 || error < best)
+				{
+					best = error;
+					predict = i;
+					shift = j;
+				}
+			}
+		}
+	}
+	else
+	{
+		int min = INT_MAX;
+		int min2, shift_mask, i;
+
+		di_max = 32767;
+		predict = 0;
+
+		for (i = 0; i < PREDICTORS; i++)
+		{
+			if (peak[i] < min)
+			{
+				min = peak[i];
+				predict = i;
+			}
+			if (min <= 7 * 64)
+			{
+				predict = 0;
+				break;
+			}
+		}
+
+		min2 = min / 64;
+		shift_mask = 0x4000;
+		shift = 0;
+
+		while (shift < MAX_SHIFT)
+		{
+			if (shift_mask & (min2 + (shift_mask >> 3)))
+				break;
+			shift++;
+			shift_mask = shift_mask >> 1;
+		}
+	}
+
+	block[0] = (predict << 4) | shift;
+	block[1] = 0;
+	pack(residual[predict], predict, shift, di_max, &enc->ps_1, &enc->ps_2, &block[2]);
+}
+
+int AdpcmEncodeSamples(AdpcmEncoder *enc, const short *pcm, int stride, int samples, unsigned char *out)
+{
+	int blocks;
+
+	for (blocks = 0; samples >= ADPCM_BLOCK_SAMPLES; blocks++)
+	{
+		AdpcmEncodeBlock(enc, pcm, stride, out);
+		pcm += ADPCM_BLOCK_SAMPLES * stride;
+		out += ADPCM_BLOCK_SIZE;
+		samples -= ADPCM_BLOCK_SAMPLES;
+	}
+
+	if (samples > 0)
+	{
+		short last[ADPCM_BLOCK_SAMPLES];
+		int i;
+
+		memset(last, 0, sizeof(last));
+		for (i = 0; i < samples; i++)
+			last[i] = pcm[i * stride];
+
+		AdpcmEncodeBlock(enc, last, 1, out);
+		blocks++;
+	}
+
+	return blocks;
+}
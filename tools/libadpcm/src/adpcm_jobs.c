@@ -0,0 +1,103 @@
+/*
+# _____     ___ ____     ___ ____
+#  ____|   |    ____|   |        | |____|
+# |     ___|   |____ ___|    ____| |    \    PS2DEV Open Source Project.
+#-----------------------------------------------------------------------
+# Copyright 2001-2004, ps2dev - http://www.ps2dev.org
+# Licenced under Academic Free License version 2.0
+# Review ps2sdk README & LICENSE files for further details.
+*/
+
+/*
+	Runs independent ADPCM encoding jobs on a pool of host threads. The
+	encoder state lives in the job, so workers share nothing but the
+	index of the next job to run.
+*/
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <pthread.h>
+#include <unistd.h>
+#include "adpcm_encoder.h"
+
+#define MAX_THREADS 64
+
+typedef struct
+{
+	pthread_mutex_t lock;
+	AdpcmJob *jobs;
+	int count;
+	int next;
+} JobQueue;
+
+static void run_job(AdpcmJob *job)
+{
+	AdpcmEncodeSamples(job->enc, job->pcm, job->stride, job->samples, job->out);
+}
+
+static void *worker(void *arg)
+{
+	JobQueue *queue = arg;
+
+	while (1)
+	{
+		int index;
+
+		pthread_mutex_lock(&queue->lock);
+		index = queue->next++;
+		pthread_mutex_unlock(&queue->lock);
+
+		if (index >= queue->count)
+			break;
+
+		run_job(&queue->jobs[index]);
+	}
+
+	return NULL;
+}
+
+int AdpcmEncodeJobs(AdpcmJob *jobs, int count, int threads)
+{
+	pthread_t tid[MAX_THREADS];
+	JobQueue queue;
+	int i, started;
+
+	if (threads <= 0)
+	{
+		long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+		threads = (cpus > 0) ? (int)cpus : 1;
+	}
+	if (threads > count)
+		threads = count;
+	if (threads > MAX_THREADS)
+		threads = MAX_THREADS;
+
+	if (threads <= 1)
+	{
+		for (i = 0; i < count; i++)
+			run_job(&jobs[i]);
+		return 0;
+	}
+
+	pthread_mutex_init(&queue.lock, NULL);
+	queue.jobs = jobs;
+	queue.count = count;
+	queue.next = 0;
+
+	/* The calling thread works too, so start one thread less */
+	for (started = 0; started < threads - 1; started++)
+	{
+		if (pthread_create(&tid[started], NULL, worker, &queue) != 0)
+			break;
+	}
+
+	worker(&queue);
+
+	for (i = 0; i < started; i++)
+		pthread_join(tid[i], NULL);
+
+	pthread_mutex_destroy(&queue.lock);
+
+	/* Running short of threads only costs time, every job was still run */
+	return 0;
+}
@@ -11,6 +11,8 @@
 #ifndef _ADPCM_H_
 #define _ADPCM_H_
 
+#include "adpcm_encoder.h"
+
 typedef int (*AdpcmGetPCMfunc)  (void *priv, double *pcm, int len); /* Length in samples */
 typedef int (*AdpcmPutADPCMfunc)(void *priv, void  *data, int len); /* Length in bytes */
 
@@ -18,8 +20,7 @@ typedef struct
 {
 	AdpcmGetPCMfunc   GetPCM;
 	AdpcmPutADPCMfunc PutADPCM;
-	double s_1, s_2;
-	double ps_1, ps_2;
+	AdpcmEncoder enc;
 	int curblock;  /* Current block */
 	int loopstart; /* Loop start position, in ADPCM blocks (28 PCM samples) */
 	void *getpriv;
@@ -65,6 +65,7 @@ int main(int argc, char *argv[])
 	FILE *fi, *fo;
 	int bpc = 1024; /* ADPCM (16byte, 28sample) blocks per chunk */
 	int loopstart = -1;
+	int search = ADPCM_SEARCH_FAST;
 	AdpcmSetup *set[2];
 	PcmBuffer pcm;
 
@@ -72,7 +73,7 @@ int main(int argc, char *argv[])
 
 	if (argc<3)
 	{
-		dprintf("usage:   %s <PCM Input> <ADPCM Output> -s(tereo) -c[chunksize] -l[loopstart]\n", argv[0]);
+		dprintf("usage:   %s <PCM Input> <ADPCM Output> -s(tereo) -c[chunksize] -l[loopstart] -e(xhaustive search)\n", argv[0]);
 		dprintf("example: %s - output.adpcm -s -c1024 -s1000\n", argv[0]);
 
 		return(1);
@@ -93,6 +94,7 @@ int main(int argc, char *argv[])
 		switch(argv[i][1])
 		{
 		case 's': pcm.ChannelCount = 2; break;
+		case 'e': search = ADPCM_SEARCH_EXHAUSTIVE; break;
 		case 'c':
 			if (num<=0 || num >= 65536)
 			{
@@ -144,6 +146,7 @@ int main(int argc, char *argv[])
 			dprintf("Failed to create ADPCM setup\n");
 			return(1);
 		}
+		set[i]->enc.search = search;
 	}
 
 	if (pcm.ChannelCount>1)
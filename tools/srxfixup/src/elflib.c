@@ -25,7 +25,13 @@ static void write_symtab(elf_file *elf, int sctindex, FILE *fp);
 static void write_rel(elf_file *elf, int sctindex, FILE *fp);
 static void write_mips_symbolic(elf_mips_symbolic_data *sycb, unsigned int basepos, FILE *fp);
 static void reorder_an_symtab(elf_file *elf, elf_section *scp);
-static size_t search_string_table(const char *tbltop, size_t endindex, const char *str);
+static unsigned int name_hash(const char *name);
+static void reset_name_index(Name_index *idx);
+static void init_name_index(Name_index *idx, const void *owner, unsigned int entries, unsigned int names);
+static int add_name_index(Name_index *idx, const char *name, unsigned int entry);
+static Name_index *get_section_index(elf_file *elf);
+static Name_index *get_symbol_index(elf_file *elf, elf_section *symtbl);
+static size_t search_string_index(const Name_index *idx, const char *tbltop, const char *str);
 static void rebuild_a_symbol_name_strings(elf_section *scp);
 static int comp_Elf_file_slot(const void *a1, const void *a2);
 
@@ -974,13 +980,25 @@ void add_section(elf_file *elf, elf_section *scp)
 {
 	Elf32_Ehdr *ehp;
 	int count;
+	int indexed;
 
 	ehp = elf->ehp;
+	indexed = elf->section_index.slot && elf->section_index.owner == elf->scp && elf->section_index.entries == ehp->e_shnum;
 	ehp->e_shnum += 1;
 	count = ehp->e_shnum;
 	elf->scp = (elf_section **)realloc(elf->scp, (count + 1) * sizeof(elf_section *));
 	elf->scp[count - 1] = scp;
 	elf->scp[count] = 0;
+	if ( indexed )
+	{
+		elf->section_index.owner = elf->scp;
+		elf->section_index.entries = count;
+		indexed = add_name_index(&elf->section_index, scp->name, count - 1);
+	}
+	if ( !indexed )
+	{
+		reset_name_index(&elf->section_index);
+	}
 	add_symbol(elf, 0, 0, 3, 0, scp, 0);
 }
 
@@ -1003,6 +1021,10 @@ elf_section *remove_section(elf_file *elf, Elf32_Word shtype)
 	{
 		elf->scp[s] = elf->scp[s + 1];
 	}
+	if ( rmsec )
+	{
+		invalidate_name_index(elf);
+	}
 	return rmsec;
 }
 
@@ -1025,6 +1047,10 @@ elf_section *remove_section_by_name(elf_file *elf, const char *secname)
 	{
 		elf->scp[s] = elf->scp[s + 1];
 	}
+	if ( rmsec )
+	{
+		invalidate_name_index(elf);
+	}
 	return rmsec;
 }
 
@@ -1042,18 +1068,104 @@ elf_section *search_section(elf_file *elf, Elf32_Word stype)
 	return 0;
 }
 
-elf_section *search_section_by_name(elf_file *elf, const char *secname)
+static unsigned int name_hash(const char *name)
+{
+	unsigned int hash;
+
+	// FNV-1a
+	hash = 2166136261u;
+	for ( ; *name; name += 1 )
+	{
+		hash = (hash ^ (uint8_t)*name) * 16777619u;
+	}
+	return hash;
+}
+
+static void reset_name_index(Name_index *idx)
+{
+	free(idx->slot);
+	memset(idx, 0, sizeof(Name_index));
+}
+
+static void init_name_index(Name_index *idx, const void *owner, unsigned int entries, unsigned int names)
+{
+	unsigned int size;
+
+	reset_name_index(idx);
+	// Half full at most once the table has doubled, so entries can be added in place
+	for ( size = 16; size < names * 4; size <<= 1 )
+	{
+	}
+	idx->owner = owner;
+	idx->entries = entries;
+	idx->size = size;
+	idx->slot = (unsigned int *)calloc(size, sizeof(unsigned int));
+}
+
+// Returns 0 when the index is full; the caller then drops it and it is rebuilt on the next lookup.
+static int add_name_index(Name_index *idx, const char *name, unsigned int entry)
+{
+	unsigned int mask;
+	unsigned int h;
+
+	if ( (idx->used + 1) * 2 > idx->size )
+	{
+		return 0;
+	}
+	mask = idx->size - 1;
+	for ( h = name_hash(name) & mask; idx->slot[h]; h = (h + 1) & mask )
+	{
+	}
+	idx->slot[h] = entry;
+	idx->used += 1;
+	return 1;
+}
+
+void invalidate_name_index(elf_file *elf)
+{
+	reset_name_index(&elf->section_index);
+	reset_name_index(&elf->symbol_index);
+}
+
+static Name_index *get_section_index(elf_file *elf)
 {
+	Name_index *idx;
 	int i;
 
+	idx = &elf->section_index;
+	if ( idx->slot && idx->owner == elf->scp && idx->entries == elf->ehp->e_shnum )
+	{
+		return idx;
+	}
+	init_name_index(idx, elf->scp, elf->ehp->e_shnum, elf->ehp->e_shnum);
 	for ( i = 1; i < elf->ehp->e_shnum; i += 1 )
 	{
-		if ( !strcmp(elf->scp[i]->name, secname) )
+		add_name_index(idx, elf->scp[i]->name, i);
+	}
+	return idx;
+}
+
+elf_section *search_section_by_name(elf_file *elf, const char *secname)
+{
+	Name_index *idx;
+	unsigned int mask;
+	unsigned int h;
+	unsigned int i;
+	unsigned int found;
+
+	idx = get_section_index(elf);
+	mask = idx->size - 1;
+	found = 0;
+	// Several sections may share a name: keep the first one, as a linear scan would
+	for ( h = name_hash(secname) & mask; idx->slot[h]; h = (h + 1) & mask )
+	{
+		i = idx->slot[h];
+		if ( (!found || i < found) && !strcmp(elf->scp[i]->name, secname) )
 		{
-			return elf->scp[i];
+			found = i;
 		}
 	}
-	return 0;
+	return found ? elf->scp[found] : 0;
 }
 
 unsigned int *get_section_data(elf_file *elf, unsigned int addr)
@@ -1072,28 +1184,60 @@ unsigned int *get_section_data(elf_file *elf, unsigned int addr)
 	return 0;
 }
 
-elf_syment *search_global_symbol(const char *name, elf_file *elf)
+static Name_index *get_symbol_index(elf_file *elf, elf_section *symtbl)
 {
+	Name_index *idx;
+	elf_syment **syp;
 	unsigned int entrise;
 	unsigned int i;
+
+	idx = &elf->symbol_index;
+	entrise = symtbl->shr.sh_size / symtbl->shr.sh_entsize;
+	syp = (elf_syment **)symtbl->data;
+	if ( idx->slot && idx->owner == syp && idx->entries == entrise )
+	{
+		return idx;
+	}
+	// All named symbols are indexed: the binding is checked on lookup, as callers change it in place
+	init_name_index(idx, syp, entrise, entrise);
+	for ( i = 1; i < entrise; i += 1 )
+	{
+		if ( syp[i] && syp[i]->name )
+		{
+			add_name_index(idx, syp[i]->name, i);
+		}
+	}
+	return idx;
+}
+
+elf_syment *search_global_symbol(const char *name, elf_file *elf)
+{
+	Name_index *idx;
 	elf_syment **syp;
 	elf_section *scp;
+	unsigned int mask;
+	unsigned int h;
+	unsigned int i;
+	unsigned int found;
 
 	scp = search_section(elf, SHT_SYMTAB);
 	if ( !scp )
 	{
 		return 0;
 	}
-	entrise = scp->shr.sh_size / scp->shr.sh_entsize;
+	idx = get_symbol_index(elf, scp);
 	syp = (elf_syment **)scp->data;
-	for ( i = 1; entrise > i; i += 1 )
+	mask = idx->size - 1;
+	found = 0;
+	for ( h = name_hash(name) & mask; idx->slot[h]; h = (h + 1) & mask )
 	{
-		if ( syp[i]->name && syp[i]->bind == STB_GLOBAL && !strcmp(syp[i]->name, name) )
+		i = idx->slot[h];
+		if ( (!found || i < found) && syp[i]->bind == STB_GLOBAL && !strcmp(syp[i]->name, name) )
 		{
-			return syp[i];
+			found = i;
 		}
 	}
-	return 0;
+	return found ? syp[found] : 0;
 }
 
 int is_defined_symbol(const elf_syment *sym)
@@ -1116,6 +1260,7 @@ int is_defined_symbol(const elf_syment *sym)
 elf_syment *add_symbol(elf_file *elf, const char *name, int bind, int type, int value, elf_section *scp, int st_shndx)
 {
 	unsigned int entrise;
+	int indexed;
 	elf_syment *sym;
 	elf_syment **newtab;
 	elf_section *symtbl;
@@ -1126,6 +1271,7 @@ elf_syment *add_symbol(elf_file *elf, const char *name, int bind, int type, int
 		return 0;
 	}
 	entrise = symtbl->shr.sh_size / symtbl->shr.sh_entsize;
+	indexed = elf->symbol_index.slot && elf->symbol_index.owner == symtbl->data && elf->symbol_index.entries == entrise;
 	newtab = (elf_syment **)realloc(symtbl->data, (entrise + 1) * sizeof(elf_syment *));
 	sym = (elf_syment *)calloc(1, sizeof(elf_syment));
 	newtab[entrise] = sym;
@@ -1148,6 +1294,19 @@ elf_syment *add_symbol(elf_file *elf, const char *name, int bind, int type, int
 	{
 		sym->sym.st_shndx = st_shndx;
 	}
+	if ( indexed )
+	{
+		elf->symbol_index.owner = newtab;
+		elf->symbol_index.entries = entrise + 1;
+		if ( name )
+		{
+			indexed = add_name_index(&elf->symbol_index, sym->name, entrise);
+		}
+	}
+	if ( !indexed )
+	{
+		reset_name_index(&elf->symbol_index);
+	}
 	return sym;
 }
 
@@ -1284,15 +1443,17 @@ void rebuild_section_name_strings(elf_file *elf)
 	}
 }
 
-static size_t search_string_table(const char *tbltop, size_t endindex, const char *str)
+static size_t search_string_index(const Name_index *idx, const char *tbltop, const char *str)
 {
-	size_t idx;
+	unsigned int mask;
+	unsigned int h;
 
-	for ( idx = 1; idx < endindex; idx += strlen(&tbltop[idx]) + 1 )
+	mask = idx->size - 1;
+	for ( h = name_hash(str) & mask; idx->slot[h]; h = (h + 1) & mask )
 	{
-		if ( !strcmp(str, &tbltop[idx]) )
+		if ( !strcmp(str, &tbltop[idx->slot[h]]) )
 		{
-			return idx;
+			return idx->slot[h];
 		}
 	}
 	return 0;
@@ -1302,8 +1463,10 @@ static void rebuild_a_symbol_name_strings(elf_section *scp)
 {
 	elf_section *strtab;
 	elf_syment **syp;
+	Name_index strindex;
 	size_t offset;
 	size_t namesize;
+	unsigned int names;
 	unsigned int entrise;
 	unsigned int i_1;
 	unsigned int i_2;
@@ -1312,29 +1475,38 @@ static void rebuild_a_symbol_name_strings(elf_section *scp)
 	strtab = scp->link;
 	syp = (elf_syment **)scp->data;
 	namesize = 1;
+	names = 0;
 	for ( i_1 = 1; i_1 < entrise; i_1 += 1 )
 	{
-		namesize = (syp[i_1] != NULL && syp[i_1]->name != NULL) ? (strlen(syp[i_1]->name) + namesize + 1) : namesize;
+		if ( syp[i_1] != NULL && syp[i_1]->name != NULL )
+		{
+			namesize += strlen(syp[i_1]->name) + 1;
+			names += 1;
+		}
 	}
 	if ( strtab->data )
 	{
 		free(strtab->data);
 	}
 	strtab->data = (uint8_t *)calloc(1, namesize);
+	memset(&strindex, 0, sizeof(strindex));
+	init_name_index(&strindex, strtab->data, 0, names);
 	offset = 1;
 	for ( i_2 = 1; i_2 < entrise; i_2 += 1 )
 	{
 		if ( syp[i_2] != NULL && syp[i_2]->name != NULL )
 		{
-			syp[i_2]->sym.st_name = search_string_table((char *)strtab->data, offset, syp[i_2]->name);
+			syp[i_2]->sym.st_name = search_string_index(&strindex, (char *)strtab->data, syp[i_2]->name);
 			if ( !syp[i_2]->sym.st_name )
 			{
 				strcpy((char *)&strtab->data[offset], syp[i_2]->name);
 				syp[i_2]->sym.st_name = offset;
+				add_name_index(&strindex, syp[i_2]->name, offset);
 				offset += strlen(syp[i_2]->name) + 1;
 			}
 		}
 	}
+	reset_name_index(&strindex);
 	strtab->shr.sh_size = offset;
 }
 
@@ -282,6 +282,14 @@ typedef struct _elf_proghead
 	elf_section **scp;
 	void *optdata;  // Not used
 } elf_proghead;
+typedef struct _name_index
+{
+	const void *owner;     // table the entries refer to
+	unsigned int entries;  // table length when the index was built
+	unsigned int used;
+	unsigned int size;     // power of 2
+	unsigned int *slot;    // entry number, 0 = empty
+} Name_index;
 typedef struct _elffile
 {
 	Elf32_Ehdr *ehp;
@@ -289,6 +297,8 @@ typedef struct _elffile
 	elf_proghead *php;
 	elf_section **scp;
 	void *optdata;
+	Name_index section_index;
+	Name_index symbol_index;
 } elf_file;
 
 // elflib.c, elfdump.c, srxgen.c
@@ -435,6 +445,7 @@ extern elf_section *remove_section(elf_file *elf, Elf32_Word shtype);
 extern elf_section *remove_section_by_name(elf_file *elf, const char *secname);
 extern elf_section *search_section(elf_file *elf, Elf32_Word stype);
 extern elf_section *search_section_by_name(elf_file *elf, const char *secname);
+extern void invalidate_name_index(elf_file *elf);
 extern unsigned int *get_section_data(elf_file *elf, unsigned int addr);
 extern elf_syment *search_global_symbol(const char *name, elf_file *elf);
 extern int is_defined_symbol(const elf_syment *sym);
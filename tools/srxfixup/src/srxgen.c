@@ -351,6 +351,7 @@ void strip_elf(elf_file *elf)
 		}
 	}
 	scp->shr.sh_size = d * scp->shr.sh_entsize;
+	invalidate_name_index(elf);
 }
 
 SegConf *lookup_segment(Srx_gen_table *conf, const char *segname, int msgsw)
@@ -530,6 +531,7 @@ void fixlocation_elf(elf_file *elf, unsigned int startaddr)
 		}
 	}
 	elf->ehp->e_shnum = d;
+	invalidate_name_index(elf);
 	elf->ehp->e_entry += startaddr;
 	modsect_1 = search_section(elf, SHT_SCE_IOPMOD);
 	if ( modsect_1 )
@@ -903,6 +905,7 @@ static int reorder_section_table(elf_file *elf)
 		}
 	}
 	free(scp);
+	invalidate_name_index(elf);
 	reorder_symtab(elf);
 	return 0;
 }
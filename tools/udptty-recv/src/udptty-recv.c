@@ -0,0 +1,176 @@
+/*
+# _____     ___ ____     ___ ____
+#  ____|   |    ____|   |        | |____|
+# |     ___|   |____ ___|    ____| |    \    PS2DEV Open Source Project.
+#-----------------------------------------------------------------------
+# Copyright 2001-2004, ps2dev - http://www.ps2dev.org
+# Licenced under Academic Free License version 2.0
+# Review ps2sdk README & LICENSE files for further details.
+*/
+
+/*
+	Receives udptty console output and writes it to stdout. Datagrams sent
+	in buffered mode carry a sequence number; gaps, reordering and sender
+	restarts are reported on stderr. Plain datagrams are printed as they are.
+	The wire format is described in common/include/udptty.h.
+*/
+
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(_WIN32) || defined(WIN32)
+#include <winsock2.h>
+typedef int socklen_t;
+#else
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#define closesocket close
+#endif
+
+/* Kept in step with common/include/udptty.h */
+#define UDPTTY_PORT         18194
+#define UDPTTY_MAGIC        0x55545459
+#define UDPTTY_HDR_SIZE     8
+#define UDPTTY_MAX_DATAGRAM 1472
+
+static volatile sig_atomic_t stop;
+
+static void on_signal(int sig)
+{
+	(void)sig;
+	stop = 1;
+}
+
+static unsigned int get_be32(const unsigned char *p)
+{
+	return ((unsigned int)p[0] << 24) | ((unsigned int)p[1] << 16) | ((unsigned int)p[2] << 8) | p[3];
+}
+
+static void usage(void)
+{
+	printf("udptty-recv - receives udptty console output\n"
+		   "Usage: udptty-recv [-p port] [-q]\n"
+		   "  -p  UDP port to listen on (default %d)\n"
+		   "  -q  do not report lost or reordered datagrams\n\n", UDPTTY_PORT);
+}
+
+int main(int argc, char *argv[])
+{
+	unsigned char buf[UDPTTY_MAX_DATAGRAM + 1];
+	struct sockaddr_in addr;
+	unsigned long datagrams, lost, reordered;
+	unsigned int expected;
+	int synced, quiet, port, sock, i;
+	int one = 1;
+
+	port = UDPTTY_PORT;
+	quiet = 0;
+	for(i=1;i<argc;i+=1) {
+		if(strcmp(argv[i], "-p") == 0 && i + 1 < argc) {
+			port = atoi(argv[++i]);
+		} else if(strcmp(argv[i], "-q") == 0) {
+			quiet = 1;
+		} else {
+			usage();
+			return 1;
+		}
+	}
+
+#if defined(_WIN32) || defined(WIN32)
+	{
+		WSADATA wsa;
+
+		if(WSAStartup(MAKEWORD(2, 2), &wsa) != 0) {
+			printf("Failed to start Winsock.\n");
+			return 1;
+		}
+	}
+#endif
+
+	if((sock = socket(AF_INET, SOCK_DGRAM, 0)) < 0) {
+		printf("Failed to create socket.\n");
+		return 1;
+	}
+	setsockopt(sock, SOL_SOCKET, SO_REUSEADDR, (const char *)&one, sizeof(one));
+
+	memset(&addr, 0, sizeof(addr));
+	addr.sin_family = AF_INET;
+	addr.sin_addr.s_addr = htonl(INADDR_ANY);
+	addr.sin_port = htons(port);
+	if(bind(sock, (struct sockaddr *)&addr, sizeof(addr)) != 0) {
+		printf("Failed to bind to UDP port %d.\n", port);
+		closesocket(sock);
+		return 1;
+	}
+
+	/* No SA_RESTART, so a signal interrupts recvfrom() and the totals get printed */
+#if defined(_WIN32) || defined(WIN32)
+	signal(SIGINT, on_signal);
+#else
+	{
+		struct sigaction sa;
+
+		memset(&sa, 0, sizeof(sa));
+		sa.sa_handler = on_signal;
+		sigaction(SIGINT, &sa, NULL);
+		sigaction(SIGTERM, &sa, NULL);
+	}
+#endif
+
+	datagrams = lost = reordered = 0;
+	expected = 0;
+	synced = 0;
+	while(!stop) {
+		int len = recvfrom(sock, (char *)buf, sizeof(buf), 0, NULL, NULL);
+		unsigned int seq;
+
+		if(len < 0)
+			continue;
+		datagrams += 1;
+
+		if(len < UDPTTY_HDR_SIZE || get_be32(buf) != UDPTTY_MAGIC) {
+			/* Unbuffered udptty: the datagram is all text */
+			fwrite(buf, 1, len, stdout);
+			fflush(stdout);
+			continue;
+		}
+
+		seq = get_be32(buf + 4);
+		if(synced && seq != expected) {
+			if(seq == 0) {
+				if(!quiet)
+					fprintf(stderr, "\n[udptty-recv: sender restarted]\n");
+			} else if(seq - expected < 0x80000000u) {
+				lost += seq - expected;
+				if(!quiet)
+					fprintf(stderr, "\n[udptty-recv: %u datagram(s) lost]\n", seq - expected);
+			} else {
+				/* Late arrival; its gap was already counted as lost */
+				reordered += 1;
+				if(lost > 0)
+					lost -= 1;
+				if(!quiet)
+					fprintf(stderr, "\n[udptty-recv: datagram %u arrived late]\n", seq);
+			}
+		}
+		if(!synced || seq - expected < 0x80000000u || seq == 0)
+			expected = seq + 1;
+		synced = 1;
+
+		fwrite(buf + UDPTTY_HDR_SIZE, 1, len - UDPTTY_HDR_SIZE, stdout);
+		fflush(stdout);
+	}
+
+	fprintf(stderr, "\n[udptty-recv: %lu datagram(s) received, %lu lost, %lu late]\n", datagrams, lost, reordered);
+
+	closesocket(sock);
+#if defined(_WIN32) || defined(WIN32)
+	WSACleanup();
+#endif
+
+	return 0;
+}